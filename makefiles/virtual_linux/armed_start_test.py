@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+	Name: armed_start_test.py
+	Description: Checks the armed motion start on a digital input edge (ENABLE_ARMED_START).
+
+		Builds the Linux virtual MCU with ENABLE_ARMED_START and runs random programs of moves of all axis
+		that are armed on a random DIN and started by a rising edge scheduled at a random time (--din-edge).
+		The step/dir trace is replayed to check that:
+		- no step is output before the edge
+		- the start is reported once ([TRIG:...]) and the step timer started within --max-start us of the edge
+		- the reported first step latency is the time from the edge to the first traced step
+		- the final positions and the step times (relative to the first step) are the ones of the same program
+		  started without arming
+		Prints the reported start and first step latencies.
+		Returns a non zero exit code if any check fails.
+
+		Usage:
+			./armed_start_test.py [--iterations 10] [--moves 5] [--seed 1]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+import itp_compare
+import trace_validate
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+AXIS = "XYZAB"
+# the armed start runs the first step ISR at F_STEP_MAX instead of the first segment rate
+TIME_TOLERANCE = 0.0005
+
+
+def build(jobs):
+    build_dir = os.path.join("build", "armed")
+    subprocess.run(["make", "-s", "-j%d" % jobs, "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=-DENABLE_ARMED_START"],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "uCNC")
+
+
+def program(moves):
+    lines = ["G21 G91"]
+    for _ in range(moves):
+        words = " ".join("%s%.3f" % (a, random.uniform(-5, 5)) for a in AXIS)
+        lines.append("G1 %s F%d" % (words, random.randint(100, 600)))
+    return lines
+
+
+def run(binary, lines, tmp, din=None, edge_ms=0):
+    eeprom = os.path.join(tmp, "eeprom")
+    trace = os.path.join(tmp, "trace")
+    program = os.path.join(tmp, "program.nc")
+    subprocess.run([binary, "--sim", "--eeprom", eeprom], input=b"$RST=*\n$SS\n", stdout=subprocess.DEVNULL,
+                   stderr=subprocess.DEVNULL, check=True, timeout=20)
+    head = ["$X"] + (["$ARM=%d,0" % din] if din is not None else [])
+    with open(program, "w") as f:
+        f.write("\n".join(head + lines) + "\n")
+    command = [binary, "--sim", "--eeprom", eeprom, "--trace", trace]
+    if din is not None:
+        command += ["--din-edge", "%d,%d" % (din, edge_ms)]
+    with open(program, "rb") as f:
+        proc = subprocess.run(command, stdin=f, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, check=True, timeout=300)
+    output = proc.stdout.decode("ascii", "replace")
+    reports = [tuple(int(v) for v in m) for m in re.findall(r"\[TRIG:(\d+),(\d+),(\d+)\]", output)]
+    errors = ["error reply"] if re.search(r"^error", output, re.M) else []
+    return trace, reports, errors
+
+
+def first_step(t):
+    for rtype, ticks, _ in t.records():
+        if rtype == trace_validate.TRACE_TOGGLE_STEPS:
+            return ticks
+    return None
+
+
+def relative(times):
+    start = min(s[0] for s in times if s)
+    return [[v - start for v in s] for s in times]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC armed motion start test")
+    parser.add_argument("--iterations", type=int, default=10, help="number of random programs")
+    parser.add_argument("--moves", type=int, default=5, help="moves per program")
+    parser.add_argument("--max-start", type=int, default=1000, help="max edge to step timer start latency (us)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    binary = build(args.jobs)
+
+    failures = []
+    starts = []
+    latencies = []
+    print("%3s %4s %8s %10s %12s  %s" % ("", "din", "edge", "start", "first step", "result"))
+    for i in range(args.iterations):
+        lines = program(args.moves)
+        din = random.randint(0, 7)
+        edge_ms = random.randint(200, 2000)
+        with tempfile.TemporaryDirectory() as tmp:
+            trace, reports, errors = run(binary, lines, tmp, din, edge_ms)
+            t = trace_validate.Trace(trace)
+            first = first_step(t)
+            times, pos, _ = itp_compare.steps(trace_validate.Trace(trace))
+        with tempfile.TemporaryDirectory() as tmp:
+            trace, _, _ = run(binary, lines, tmp)
+            ref_times, ref_pos, _ = itp_compare.steps(trace_validate.Trace(trace))
+
+        edge = edge_ms * (t.clock // 1000)
+        start = latency = None
+        if len(reports) != 1 or reports[0][0] != din:
+            errors.append("reported starts %s" % reports)
+        else:
+            _, start, latency = reports[0]
+            starts.append(start)
+            latencies.append(latency)
+            if start > args.max_start:
+                errors.append("step timer started %dus after the edge" % start)
+        if first is None or first < edge:
+            errors.append("step before the edge (tick %s, edge tick %d)" % (first, edge))
+        elif latency is not None and abs((first - edge) * 1000000 // t.clock - latency) > 1:
+            errors.append("first step traced %dus after the edge, reported %dus" % ((first - edge) * 1000000 // t.clock, latency))
+        if pos != ref_pos:
+            errors.append("final position %s instead of %s" % (pos, ref_pos))
+        else:
+            deviation = max((abs(a - b) for s, r in zip(relative(times), relative(ref_times)) for a, b in zip(s, r)), default=0)
+            if deviation > TIME_TOLERANCE:
+                errors.append("step times deviate %.3fms from the program without arming" % (deviation * 1000))
+
+        print("%3d %4d %6dms %8sus %10sus  %s" % (i, din, edge_ms, start, latency, "; ".join(errors) if errors else "PASS"))
+        if errors:
+            failures.append((i, lines))
+
+    if starts:
+        print("latency (reported, us): start avg %.1f max %d, first step avg %.1f max %d" % (
+            sum(starts) / len(starts), max(starts), sum(latencies) / len(latencies), max(latencies)))
+    for i, lines in failures:
+        print("iteration %d program:\n%s" % (i, "\n".join(lines)))
+    print("result: %s" % ("FAIL" if failures else "PASS"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
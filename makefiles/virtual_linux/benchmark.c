@@ -0,0 +1,219 @@
+/*
+	Name: benchmark.c
+	Description: Host benchmark of the parser → motion control → planner → interpolator pipeline.
+		Linked with the Linux virtual MCU build. The pipeline entry points are intercepted via the
+		linker --wrap option (no change to the core code) to count lines, planner blocks and
+		interpolator segments and to measure the exclusive host time spent in each stage.
+		--wrap only redirects calls between object files: a call made from the same source file
+		as the callee (mc_arc -> mc_line, itp_core_run -> itp_run) is not seen, so that time
+		stays with the caller stage. Segments are counted as the step ISR consumes them.
+		The report is printed to stderr when the virtual MCU exits (end of the input stream).
+
+		Usage: build/benchmark --sim < file.nc > /dev/null
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../../uCNC/src/cnc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_OTHER 0
+#define BENCH_PARSER 1
+#define BENCH_MOTION 2
+#define BENCH_PLANNER 3
+#define BENCH_ITP 4
+#define BENCH_STEP 5
+#define BENCH_TASKS 6
+#define BENCH_MCU 7
+#define BENCH_STAGES 8
+#define BENCH_MAX_DEPTH 16
+
+static const char *bench_stage_names[BENCH_STAGES] = {"other", "parser", "motion", "planner", "interpolator", "step isr", "main loop", "virtual mcu"};
+
+static uint64_t bench_time[BENCH_STAGES];
+static uint64_t bench_calls[BENCH_STAGES];
+static uint8_t bench_stack[BENCH_MAX_DEPTH];
+static uint8_t bench_depth;
+static uint64_t bench_last;
+static uint64_t bench_start;
+static uint64_t bench_lines;
+static uint64_t bench_blocks;
+static uint64_t bench_segments;
+
+static uint64_t bench_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+// time is exclusive (nested stages pause the caller stage)
+static void bench_enter(uint8_t stage)
+{
+	uint64_t now = bench_now();
+	bench_time[bench_stack[bench_depth]] += now - bench_last;
+	bench_last = now;
+	bench_calls[stage]++;
+	if (bench_depth < (BENCH_MAX_DEPTH - 1))
+	{
+		bench_stack[++bench_depth] = stage;
+	}
+}
+
+static void bench_leave(void)
+{
+	uint64_t now = bench_now();
+	bench_time[bench_stack[bench_depth]] += now - bench_last;
+	bench_last = now;
+	if (bench_depth)
+	{
+		bench_depth--;
+	}
+}
+
+static double bench_rate(uint64_t count, uint64_t ns)
+{
+	return (ns) ? ((double)count * 1e9 / (double)ns) : 0;
+}
+
+static void bench_report(void)
+{
+	uint64_t now = bench_now();
+	bench_time[bench_stack[bench_depth]] += now - bench_last;
+	uint64_t total = now - bench_start;
+	uint64_t pipeline = bench_time[BENCH_PARSER] + bench_time[BENCH_MOTION] + bench_time[BENCH_PLANNER] + bench_time[BENCH_ITP];
+	double machine_s = (double)mcu_millis() / 1000.0;
+
+	fprintf(stderr, "\nµCNC pipeline benchmark (PLANNER_BUFFER_SIZE=%d DSS_MAX_OVERSAMPLING=%d S_CURVE_ACCELERATION_LEVEL=%d)\n", PLANNER_BUFFER_SIZE, DSS_MAX_OVERSAMPLING, S_CURVE_ACCELERATION_LEVEL);
+	fprintf(stderr, "  lines            %10llu  %12.0f lines/s\n", (unsigned long long)bench_lines, bench_rate(bench_lines, pipeline));
+	fprintf(stderr, "  planner blocks   %10llu  %12.0f blocks/s\n", (unsigned long long)bench_blocks, bench_rate(bench_blocks, bench_time[BENCH_PLANNER]));
+	fprintf(stderr, "  itp segments     %10llu  %12.0f segments/s\n", (unsigned long long)bench_segments, bench_rate(bench_segments, bench_time[BENCH_ITP]));
+	fprintf(stderr, "  machine time     %10.3f s (%.0f lines/s of motion)\n", machine_s, (machine_s > 0) ? ((double)bench_lines / machine_s) : 0);
+	fprintf(stderr, "  host time        %10.3f s\n", (double)total / 1e9);
+	fprintf(stderr, "  stage                 calls     time(ms)  %%total   ns/call\n");
+	for (uint8_t i = 0; i < BENCH_STAGES; i++)
+	{
+		fprintf(stderr, "  %-14s %12llu %12.3f %6.1f%% %9.0f\n", bench_stage_names[i], (unsigned long long)bench_calls[i], (double)bench_time[i] / 1e6,
+				(total) ? (100.0 * (double)bench_time[i] / (double)total) : 0,
+				(bench_calls[i]) ? ((double)bench_time[i] / (double)bench_calls[i]) : 0);
+	}
+
+	// machine readable summary (used by benchmark.py)
+	fprintf(stderr, "BENCH lines=%llu blocks=%llu segments=%llu machine_ms=%lu total_ns=%llu",
+			(unsigned long long)bench_lines, (unsigned long long)bench_blocks, (unsigned long long)bench_segments,
+			(unsigned long)mcu_millis(), (unsigned long long)total);
+	for (uint8_t i = 0; i < BENCH_STAGES; i++)
+	{
+		fprintf(stderr, " stage%u_ns=%llu", i, (unsigned long long)bench_time[i]);
+	}
+	fprintf(stderr, "\n");
+}
+
+static void __attribute__((constructor)) bench_init(void)
+{
+	bench_start = bench_now();
+	bench_last = bench_start;
+	atexit(bench_report);
+}
+
+/**
+ * Wrapped pipeline entry points
+ * */
+uint8_t __real_parser_read_command(void);
+uint8_t __wrap_parser_read_command(void)
+{
+	bench_enter(BENCH_PARSER);
+	uint8_t error = __real_parser_read_command();
+	bench_leave();
+	bench_lines++;
+	return error;
+}
+
+uint8_t __real_mc_line(float *target, motion_data_t *block_data);
+uint8_t __wrap_mc_line(float *target, motion_data_t *block_data)
+{
+	bench_enter(BENCH_MOTION);
+	uint8_t error = __real_mc_line(target, block_data);
+	bench_leave();
+	return error;
+}
+
+uint8_t __real_mc_arc(float *target, float center_offset_a, float center_offset_b, float radius, uint8_t axis_0, uint8_t axis_1, bool isclockwise, motion_data_t *block_data);
+uint8_t __wrap_mc_arc(float *target, float center_offset_a, float center_offset_b, float radius, uint8_t axis_0, uint8_t axis_1, bool isclockwise, motion_data_t *block_data)
+{
+	bench_enter(BENCH_MOTION);
+	uint8_t error = __real_mc_arc(target, center_offset_a, center_offset_b, radius, axis_0, axis_1, isclockwise, block_data);
+	bench_leave();
+	return error;
+}
+
+void __real_planner_add_line(motion_data_t *block_data);
+void __wrap_planner_add_line(motion_data_t *block_data)
+{
+	bench_enter(BENCH_PLANNER);
+	__real_planner_add_line(block_data);
+	bench_leave();
+	bench_blocks++;
+}
+
+void __real_itp_run(void);
+void __wrap_itp_run(void)
+{
+	bench_enter(BENCH_ITP);
+	__real_itp_run();
+	bench_leave();
+}
+
+// main loop tasks called while waiting (planner full, dwell, sync)
+bool __real_cnc_dotasks(void);
+bool __wrap_cnc_dotasks(void)
+{
+	bench_enter(BENCH_TASKS);
+	bool result = __real_cnc_dotasks();
+	bench_leave();
+	return result;
+}
+
+// emulation overhead (UART, time keeping)
+void __real_mcu_dotasks(void);
+void __wrap_mcu_dotasks(void)
+{
+	bench_enter(BENCH_MCU);
+	__real_mcu_dotasks();
+	bench_leave();
+}
+
+// the step ISR is the only place where a segment leaves the interpolator buffer (at most one per call)
+void __real_mcu_step_cb(void);
+void __wrap_mcu_step_cb(void)
+{
+	itp_segment_t *sgm = itp_get_rt_segment();
+	bench_enter(BENCH_STEP);
+	__real_mcu_step_cb();
+	bench_leave();
+	if (sgm != NULL && sgm != itp_get_rt_segment())
+	{
+		bench_segments++;
+	}
+}
+
+void __real_mcu_step_reset_cb(void);
+void __wrap_mcu_step_reset_cb(void)
+{
+	bench_enter(BENCH_STEP);
+	__real_mcu_step_reset_cb();
+	bench_leave();
+}
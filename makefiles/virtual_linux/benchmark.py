@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+	Name: benchmark.py
+	Description: Builds and runs the µCNC host pipeline benchmark (benchmark.c) for several
+		build configurations and G-code files and prints a comparison table.
+
+		Each value list is swept one at a time against the baseline configuration
+		(or as a full grid with --grid).
+
+		Examples:
+			./benchmark.py
+			./benchmark.py --planner 10,20,40,80 --dss 3 --scurve 0
+			./benchmark.py --grid --planner 20,40 --dss 0,3 --scurve 0,2
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import itertools
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+GCODE_DIR = os.path.join(HERE, "..", "..", "tests", "gcode")
+DEFAULT_FILES = ["stress-tests.nc", "curves-as-lines.nc", "circle.nc"]
+STAGES = ["other", "parser", "motion", "planner", "itp", "step", "loop", "vmcu"]
+BASELINE = {"PLANNER_BUFFER_SIZE": 20, "DSS_MAX_OVERSAMPLING": 3, "S_CURVE_ACCELERATION_LEVEL": 0}
+
+
+def int_list(value):
+    return [int(v) for v in value.split(",") if v != ""]
+
+
+def configurations(args):
+    sweep = {
+        "PLANNER_BUFFER_SIZE": args.planner,
+        "DSS_MAX_OVERSAMPLING": args.dss,
+        "S_CURVE_ACCELERATION_LEVEL": args.scurve,
+    }
+    if args.grid:
+        keys = list(sweep.keys())
+        return [dict(zip(keys, values)) for values in itertools.product(*[sweep[k] for k in keys])]
+
+    configs = [dict(BASELINE)]
+    for key, values in sweep.items():
+        for value in values:
+            config = dict(BASELINE)
+            config[key] = value
+            if config not in configs:
+                configs.append(config)
+    return configs
+
+
+def fixed_point(configs):
+    # repeats each configuration with the fixed point interpolator
+    return configs + [dict(config, ENABLE_ITP_FIXED_POINT=1) for config in configs]
+
+
+def build(config, jobs):
+    tag = "_".join("%s%d" % (k.split("_")[0].lower(), v) for k, v in config.items())
+    build_dir = os.path.join("build_bench", tag)
+    options = " ".join("-D%s=%d" % (k, v) for k, v in config.items())
+    subprocess.run(["make", "-s", "-j%d" % jobs, "benchmark", "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=" + options],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "benchmark")
+
+
+def prepare_eeprom(binary, path):
+    # restores and saves the default settings
+    subprocess.run([binary, "--sim", "--eeprom", path], input=b"$RST=*\n$SS\n",
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True)
+
+
+def run(binary, gcode, eeprom):
+    with open(gcode, "rb") as f:
+        data = b"$X\n" + f.read()
+    result = subprocess.run([binary, "--sim", "--eeprom", eeprom], input=data,
+                            stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, check=True)
+    for line in result.stderr.decode(errors="replace").splitlines():
+        if line.startswith("BENCH "):
+            return {k: int(v) for k, v in (item.split("=") for item in line.split()[1:])}
+    raise RuntimeError("no benchmark output for %s" % gcode)
+
+
+def rate(count, ns):
+    return (count * 1e9 / ns) if ns else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC host pipeline benchmark")
+    parser.add_argument("--planner", type=int_list, default=[10, 20, 40], help="PLANNER_BUFFER_SIZE values")
+    parser.add_argument("--dss", type=int_list, default=[0, 3], help="DSS_MAX_OVERSAMPLING values")
+    parser.add_argument("--scurve", type=int_list, default=[0, 2], help="S_CURVE_ACCELERATION_LEVEL values")
+    parser.add_argument("--fixed", action="store_true", help="also run each configuration with ENABLE_ITP_FIXED_POINT")
+    parser.add_argument("--grid", action="store_true", help="run all combinations instead of one at a time sweeps")
+    parser.add_argument("--runs", type=int, default=3, help="runs per file (best host time is kept)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    parser.add_argument("files", nargs="*", default=DEFAULT_FILES, help="G-code files (relative to tests/gcode)")
+    args = parser.parse_args()
+
+    header = "%-24s %-20s %10s %12s %12s %12s %10s  %s" % ("config", "file", "lines", "lines/s", "blocks/s", "segments/s",
+                                                         "machine(s)", " ".join("%6s" % s for s in STAGES))
+    print(header)
+    print("-" * len(header))
+
+    configs = configurations(args)
+    if args.fixed:
+        configs = fixed_point(configs)
+
+    for config in configs:
+        name = "pl%d dss%d sc%d" % (config["PLANNER_BUFFER_SIZE"], config["DSS_MAX_OVERSAMPLING"], config["S_CURVE_ACCELERATION_LEVEL"])
+        if config.get("ENABLE_ITP_FIXED_POINT"):
+            name += " fx"
+        try:
+            binary = build(config, args.jobs)
+        except subprocess.CalledProcessError:
+            print("%-24s build failed" % name)
+            continue
+
+        with tempfile.TemporaryDirectory() as tmp:
+            eeprom = os.path.join(tmp, "eeprom")
+            prepare_eeprom(binary, eeprom)
+            for gcode in args.files:
+                path = gcode if os.path.isabs(gcode) else os.path.join(GCODE_DIR, gcode)
+                best = None
+                for _ in range(max(1, args.runs)):
+                    res = run(binary, path, eeprom)
+                    if best is None or res["total_ns"] < best["total_ns"]:
+                        best = res
+
+                pipeline = sum(best["stage%d_ns" % i] for i in range(1, 5))
+                split = " ".join("%5.1f%%" % (100.0 * best["stage%d_ns" % i] / best["total_ns"]) for i in range(len(STAGES)))
+                print("%-24s %-20s %10d %12.0f %12.0f %12.0f %10.3f  %s" % (
+                    name, os.path.basename(path), best["lines"], rate(best["lines"], pipeline),
+                    rate(best["blocks"], best["stage3_ns"]), rate(best["segments"], best["stage4_ns"]),
+                    best["machine_ms"] / 1000.0, split))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
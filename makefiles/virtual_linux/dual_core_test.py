@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+	Name: dual_core_test.py
+	Description: Stress test of the dual core motion split (ENABLE_DUAL_CORE_MOTION).
+
+		Builds the Linux virtual MCU with and without ENABLE_DUAL_CORE_MOTION (the dual core build runs the
+		interpolator and the step timer on a second thread), runs the same random G-code programs
+		(short G0/G1 moves in absolute and relative mode with random feeds, so that blocks are handed off
+		before the look-ahead is final) on both with the step/dir trace enabled and checks that
+		- the step count and final position of each stepper are the same
+		- the machine time matches within --time-tolerance (the look-ahead updates reach the executing block
+		  at a different time on each core so the junction speeds are not always the same)
+		- the step position checkpoints of the dual core trace match the step/dir records (trace_validate.py)
+		  and the dual core trace has no rate/acceleration/double step flags the single core trace does not have
+		Prints the handoff counters of the dual core build.
+		Returns a non zero exit code if any check fails.
+
+		Usage:
+			./dual_core_test.py [--iterations 20] [--moves 40] [--seed 1]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import contextlib
+import io
+import math
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+import itp_compare
+import trace_validate
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def build(dual, jobs):
+    build_dir = os.path.join("build", "dualcore" if dual else "singlecore")
+    options = "-DENABLE_DUAL_CORE_MOTION" if dual else ""
+    subprocess.run(["make", "-s", "-j%d" % jobs, "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=" + options],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "uCNC")
+
+
+def program(moves):
+    lines = ["$X", "G21 G90 G0 X0 Y0 Z0"]
+    relative = False
+    for _ in range(moves):
+        if random.random() < 0.3:
+            # chain of short segments along a curve (continuous junctions exercise the look-ahead)
+            lines.append("G91")
+            relative = True
+            angle = random.uniform(0, 2 * math.pi)
+            turn = random.uniform(-0.5, 0.5)
+            length = random.uniform(0.05, 0.5)
+            feed = random.randint(100, 500)
+            for _ in range(random.randint(5, 20)):
+                lines.append("G1 X%.3f Y%.3f F%d" % (length * math.cos(angle), length * math.sin(angle), feed))
+                angle += turn
+            continue
+        if random.random() < 0.2:
+            relative = not relative
+            lines.append("G91" if relative else "G90")
+        words = []
+        for axis in "XYZ":
+            if random.random() < 0.7:
+                value = random.uniform(-2, 2) if relative else random.uniform(-5, 5)
+                words.append("%s%.3f" % (axis, value))
+        if not words:
+            continue
+        if random.random() < 0.2:
+            lines.append("G0 " + " ".join(words))
+        else:
+            lines.append("G1 %s F%d" % (" ".join(words), random.randint(50, 500)))
+    return "\n".join(lines) + "\n"
+
+
+def run(binary, gcode, tmp):
+    eeprom = os.path.join(tmp, "eeprom")
+    trace = os.path.join(tmp, "trace")
+    subprocess.run([binary, "--sim", "--eeprom", eeprom], input=b"$RST=*\n$SS\n",
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True, timeout=20)
+    proc = subprocess.run([binary, "--sim", "--eeprom", eeprom, "--trace", trace], input=gcode.encode("ascii"),
+                          stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, check=True, timeout=300)
+    report = io.StringIO()
+    with contextlib.redirect_stdout(report):
+        trace_validate.analyse(trace_validate.Trace(trace), VALIDATE_ARGS)
+    return itp_compare.steps(trace_validate.Trace(trace)), report.getvalue(), proc.stderr.decode("ascii", "replace")
+
+
+# step intervals above 9ms (one step per 10ms interpolator segment at the minimum speed) count as stopped,
+# so that a reversal through the minimum speed is a stop and a start on both builds
+VALIDATE_ARGS = argparse.Namespace(window=50.0, stop=9.0, grid=1.0, tolerance=0.05, max_jitter=None)
+
+
+def flags(report):
+    # trace_validate.py flags of each stepper (the columns after the numbers)
+    result = {}
+    for line in report.splitlines():
+        columns = line.split()
+        if columns and columns[0].isdigit():
+            result[int(columns[0])] = set(c for c in columns[13:] if not c.startswith("x"))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC dual core motion stress test")
+    parser.add_argument("--iterations", type=int, default=20, help="number of random programs")
+    parser.add_argument("--moves", type=int, default=40, help="moves per program")
+    parser.add_argument("--time-tolerance", type=float, default=1.0, help="allowed machine time difference (%%)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    single_binary = build(False, args.jobs)
+    dual_binary = build(True, args.jobs)
+
+    failures = []
+    handoff = [0, 0]
+    print("%3s %11s %11s %9s  %s" % ("", "single", "dual", "time", "result"))
+    for i in range(args.iterations):
+        gcode = program(args.moves)
+        with tempfile.TemporaryDirectory() as tmp:
+            (ref_times, ref_pos, ref_duration), ref_report, _ = run(single_binary, gcode, tmp)
+        with tempfile.TemporaryDirectory() as tmp:
+            (times, pos, duration), report, err = run(dual_binary, gcode, tmp)
+        match = re.search(r"(\d+) blocks handed off, (\d+) before", err)
+        if match:
+            handoff[0] += int(match.group(1))
+            handoff[1] += int(match.group(2))
+
+        errors = []
+        if pos != ref_pos:
+            errors.append("final position %s != %s" % (pos, ref_pos))
+        for stepper, (a, b) in enumerate(zip(ref_times, times)):
+            if len(a) != len(b):
+                errors.append("stepper %d: %d steps != %d" % (stepper, len(b), len(a)))
+        time_error = (duration - ref_duration) / ref_duration if ref_duration else 0
+        if abs(time_error) * 100 > args.time_tolerance:
+            errors.append("machine time differs %.3f%%" % (time_error * 100))
+        if "position: reconstructed step position matches" not in report:
+            errors.append("step position mismatch\n" + report)
+        ref_flags = flags(ref_report)
+        for stepper, stepper_flags in flags(report).items():
+            new_flags = stepper_flags - ref_flags.get(stepper, set())
+            if new_flags:
+                errors.append("stepper %d: %s" % (stepper, " ".join(sorted(new_flags))))
+        print("%3d %10.3fs %10.3fs %+8.3f%%  %s" % (i, ref_duration, duration, time_error * 100, "; ".join(errors) if errors else "PASS"))
+        if errors:
+            failures.append((i, gcode))
+
+    print("dual core: %d blocks handed off, %d before the look-ahead was final" % (handoff[0], handoff[1]))
+    for i, gcode in failures:
+        print("iteration %d program:\n%s" % (i, gcode))
+    print("result: %s" % ("FAIL" if failures else "PASS"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+	Name: duty_cycle_test.py
+	Description: Checks the duty cycle limit of the stepper motions (ENABLE_DUTY_CYCLE_LIMIT).
+
+		Builds the Linux virtual MCU with ENABLE_DUTY_CYCLE_LIMIT, sets a short on time budget and cooling time
+		on all steppers ($150+ and $160+, scaled down from the 2 min on / 18 min off of the actuators),
+		runs random G-code programs with the step/dir trace enabled and replays the heat model on the traced step activity:
+		- the heat of each stepper (on time rising 1s per s while stepping, cooling on/off s per s while idle)
+		  must never exceed the on time budget by more than --tolerance
+		- the final position of each stepper must be the one of the same program without the limit
+		Prints the machine time of each program, the on time of the busiest stepper and the machine time of the same
+		program with a fixed dwell after each motion (cooling the full off/on of the motion time, the worst case schedule).
+		Returns a non zero exit code if any check fails.
+
+		Usage:
+			./duty_cycle_test.py [--on 2] [--off 18] [--iterations 5] [--moves 20] [--seed 1]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+import itp_compare
+import trace_validate
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# steps closer than this (s) belong to the same burst of activity
+ACTIVE_GAP = 0.05
+
+
+def build(jobs):
+    build_dir = os.path.join("build", "duty")
+    subprocess.run(["make", "-s", "-j%d" % jobs, "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=-DENABLE_DUTY_CYCLE_LIMIT"],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "uCNC")
+
+
+def program(moves):
+    lines = ["$X", "G21 G91"]
+    for _ in range(moves):
+        words = []
+        for axis in "XYZAB":
+            if random.random() < 0.4:
+                words.append("%s%.3f" % (axis, random.uniform(-5, 5)))
+        if words:
+            lines.append("G1 %s F%d" % (" ".join(words), random.randint(100, 500)))
+    return "\n".join(lines) + "\n"
+
+
+def run(binary, gcode, tmp, on, off):
+    eeprom = os.path.join(tmp, "eeprom")
+    trace = os.path.join(tmp, "trace")
+    proc = subprocess.run([binary, "--sim", "--eeprom", eeprom], input=b"$RST=*\n$SS\n$$\n", stdout=subprocess.PIPE,
+                          stderr=subprocess.DEVNULL, check=True, timeout=20)
+    # the on time settings of each stepper ($150+)
+    steppers = [int(line[3]) for line in proc.stdout.decode("ascii", "replace").split() if line.startswith("$15")]
+    settings = "".join("$15%d=%d\n$16%d=%d\n" % (i, on, i, off) for i in steppers)
+    subprocess.run([binary, "--sim", "--eeprom", eeprom], input=(settings + "$SS\n").encode("ascii"),
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True, timeout=20)
+    subprocess.run([binary, "--sim", "--eeprom", eeprom, "--trace", trace], input=gcode.encode("ascii"),
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True, timeout=300)
+    return itp_compare.steps(trace_validate.Trace(trace))
+
+
+def bursts(times):
+    result = []
+    for t in times:
+        if result and t - result[-1][1] < ACTIVE_GAP:
+            result[-1][1] = t
+        else:
+            result.append([t, t])
+    return result
+
+
+def max_heat(times, on, off):
+    heat = 0.0
+    peak = 0.0
+    end = None
+    for start, stop in bursts(times):
+        if end is not None:
+            heat = max(0.0, heat - (start - end) * on / off)
+        heat += stop - start
+        peak = max(peak, heat)
+        end = stop
+    return peak
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC duty cycle limit test")
+    parser.add_argument("--on", type=int, default=2, help="on time budget of each stepper (s)")
+    parser.add_argument("--off", type=int, default=18, help="cooling time of each stepper (s)")
+    parser.add_argument("--iterations", type=int, default=5, help="number of random programs")
+    parser.add_argument("--moves", type=int, default=20, help="moves per program")
+    parser.add_argument("--tolerance", type=float, default=0.1, help="allowed heat above the budget (s)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    binary = build(args.jobs)
+
+    failures = []
+    print("%3s %10s %10s %10s %10s  %s" % ("", "limited", "unlimited", "dwell", "on time", "result"))
+    for i in range(args.iterations):
+        gcode = program(args.moves)
+        with tempfile.TemporaryDirectory() as tmp:
+            times, pos, duration = run(binary, gcode, tmp, args.on, args.off)
+        with tempfile.TemporaryDirectory() as tmp:
+            ref_times, ref_pos, ref_duration = run(binary, gcode, tmp, 0, 0)
+
+        errors = []
+        if pos != ref_pos:
+            errors.append("final position %s != %s" % (pos, ref_pos))
+        on_time = 0.0
+        for stepper, stepper_times in enumerate(times):
+            peak = max_heat(stepper_times, args.on, args.off)
+            if peak > args.on + args.tolerance:
+                errors.append("stepper %d: heat %.3fs above the %ds budget" % (stepper, peak, args.on))
+            on_time = max(on_time, sum(stop - start for start, stop in bursts(stepper_times)))
+        # worst case schedule: each motion is followed by a dwell that fully cools it
+        dwell = ref_duration * (1 + float(args.off) / args.on)
+        print("%3d %9.1fs %9.1fs %9.1fs %9.1fs  %s" % (i, duration, ref_duration, dwell, on_time, "; ".join(errors) if errors else "PASS"))
+        if errors:
+            failures.append((i, gcode))
+
+    for i, gcode in failures:
+        print("iteration %d program:\n%s" % (i, gcode))
+    print("result: %s" % ("FAIL" if failures else "PASS"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+	Name: flash_kv_test.py
+	Description: Power fail test of the µCNC flash key/value settings store (ENABLE_FLASH_KV).
+
+		Runs the Linux virtual MCU over a simulated flash image and changes a machine setting ($SS),
+		a coordinate system (G10) and a startup block ($N0) in each iteration, cutting the power at a random
+		flash operation (--flash-fail). Every --bulk iteration instead changes all the decimal machine settings
+		in a single save ($SS), so that the save changes most of the blocks of the settings and spans the
+		compactions with the open save. After each iteration the controller is restarted and
+		- the settings must load without error (no error:7)
+		- each saved group ($$, $# and $N) must hold either the old or the new values (never a mix)
+		Prints the number of power fails, of saves that were kept or discarded, of the compactions and of the
+		records discarded at boot, and the longest commit (modelled STM32F1 program/erase time).
+		Returns a non zero exit code if any check fails.
+
+		The binary must be built with ENABLE_FLASH_KV and ENABLE_EXTRA_SETTINGS_CMDS ($SS).
+
+		Usage:
+			./flash_kv_test.py [--binary build/flashkv/uCNC] [--iterations 200] [--bulk 4] [--seed 1]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import os
+import random
+import re
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def run(binary, image, commands, fail=0):
+    args = [binary, "--sim", "--eeprom", image]
+    if fail:
+        args += ["--flash-fail", str(fail)]
+    try:
+        proc = subprocess.run(args, input=commands.encode("ascii"), stdout=subprocess.PIPE, stderr=subprocess.PIPE, timeout=20)
+    except subprocess.TimeoutExpired:
+        return -1, "", "timeout"
+    return proc.returncode, proc.stdout.decode("ascii", "replace"), proc.stderr.decode("ascii", "replace")
+
+
+def read_state(binary, image):
+    code, out, err = run(binary, image, "$$\n$#\n$N\n")
+    lines = [line.strip() for line in out.splitlines()]
+    state = {
+        "settings": tuple(line for line in lines if line.startswith("$") and not line.startswith("$N")),
+        "coordinates": tuple(line for line in lines if line.startswith("[G5")),
+        "startup": tuple(line for line in lines if line.startswith("$N")),
+    }
+    return code, state, ("error:7" in lines), err
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC flash key/value store power fail test")
+    parser.add_argument("--binary", default=os.path.join(HERE, "build", "flashkv", "uCNC"),
+                        help="virtual MCU binary (built with ENABLE_FLASH_KV and ENABLE_EXTRA_SETTINGS_CMDS)")
+    parser.add_argument("--image", default=os.path.join(HERE, "build", "flashkv", "flash.img"), help="simulated flash image")
+    parser.add_argument("--iterations", type=int, default=200, help="number of power fail iterations")
+    parser.add_argument("--max-fail", type=int, default=150, help="the power fails at a random flash operation up to this number")
+    parser.add_argument("--bulk", type=int, default=4, help="every Nth iteration changes all the decimal settings in one save (0 disables)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    if os.path.exists(args.image):
+        os.remove(args.image)
+    run(args.binary, args.image, "$RST=*\n$SS\n")
+    code, state, read_error, err = read_state(args.binary, args.image)
+    if code or read_error:
+        print("the settings could not be initialized")
+        return 1
+
+    # the settings with a decimal value (max rates, accelerations, travels, ...) that a bulk save changes
+    bulk_settings = [line.split("=")[0] for line in state["settings"] if "." in line]
+
+    failures = []
+    counts = {"fail": 0, "old": 0, "new": 0, "complete": 0, "compactions": 0, "discarded": 0, "bulk": 0}
+    max_commit = 0.0
+    for i in range(args.iterations):
+        value = random.randint(1, 9999)
+        bulk = args.bulk and (i % args.bulk) == (args.bulk - 1)
+        if bulk:
+            # a single save of the whole settings (it takes more flash operations than the other iterations)
+            commands = "".join("%s=%d\n" % (setting, value) for setting in bulk_settings) + "$SS\n"
+            fail = random.randint(1, args.max_fail * 4)
+            counts["bulk"] += 1
+        else:
+            commands = "$110=%d\n$SS\nG10 L2 P1 X%d\n$N0=F%d\n" % (value, value, value)
+            fail = random.randint(1, args.max_fail)
+        code, out, err = run(args.binary, args.image, commands, fail)
+        match = re.search(r"(\d+) compactions", err)
+        if match:
+            counts["compactions"] += int(match.group(1))
+        match = re.search(r"([\d.]+)ms max commit", err)
+        if match:
+            max_commit = max(max_commit, float(match.group(1)))
+        if code == 0:
+            counts["complete"] += 1
+        elif code == 3:
+            counts["fail"] += 1
+        else:
+            failures.append("iteration %d: exit code %d" % (i, code))
+            break
+
+        code, new_state, read_error, err = read_state(args.binary, args.image)
+        match = re.search(r"(\d+) compactions, (\d+) discarded", err)
+        if match:
+            counts["compactions"] += int(match.group(1))
+            counts["discarded"] += int(match.group(2))
+        if code or read_error:
+            failures.append("iteration %d: settings read error after a power fail at %d" % (i, fail))
+            break
+
+        for group in ("settings", "coordinates", "startup"):
+            old = state[group]
+            new = new_state[group]
+            if new == old:
+                counts["old"] += 1
+                continue
+            # the only changes allowed are the ones of this iteration
+            changed = [line for line in new if line not in old]
+            if not all(str(value) in line for line in changed):
+                failures.append("iteration %d: %s is neither the old nor the new value %s" % (i, group, changed))
+            counts["new"] += 1
+        state = new_state
+        if failures:
+            break
+
+    print("%d iterations (%d bulk saves): %d power fails, %d completed, %d groups kept the old values, %d the new values" % (
+        args.iterations, counts["bulk"], counts["fail"], counts["complete"], counts["old"], counts["new"]))
+    print("%d compactions, %d records discarded at boot, %.1fms max commit" % (
+        counts["compactions"], counts["discarded"], max_commit))
+    for failure in failures:
+        print(failure)
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
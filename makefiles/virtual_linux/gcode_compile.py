@@ -0,0 +1,345 @@
+#!/usr/bin/env python3
+"""
+	Name: gcode_compile.py
+	Description: Compiles a G-code file to a µCNC binary motion stream (ENABLE_MOTION_STREAM).
+
+		The G-code is parsed on the host and converted to motion records (axis position changes
+		in steps, feed, tool, dwell and path mode changes). Arcs are converted to line segments.
+		The records are packed in CRC protected frames and written as ':' + base64 lines
+		(see uCNC/src/core/motion_stream.h) that can be sent with any line based G-code sender
+		or piped to the virtual MCU.
+
+		Supported: G0 G1 G2 G3 G4 G17 G18 G19 G20 G21 G61 G61.1 G64 G90 G91 G92 G94 F S M3 M4 M5 M7 M8 M9 M48 M49
+		(comments, line numbers and program end words are ignored)
+
+		Axis positions are relative to the machine position when the stream starts (the first frame
+		has sequence number 0 and resyncs the firmware). The steps per mm must match the firmware settings.
+
+		Usage: ./gcode_compile.py file.nc [-o file.ucs] [--steps-per-mm 200,200,200] [--start 0,0,0]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import base64
+import math
+import re
+import struct
+import sys
+
+MOTION_STREAM_LINE = 0x00
+MOTION_STREAM_RAPID = 0x40
+MOTION_STREAM_FEED = 0x80
+MOTION_STREAM_EXTENDED = 0xC0
+MOTION_STREAM_EXT_TOOL = 0
+MOTION_STREAM_EXT_DWELL = 1
+MOTION_STREAM_EXT_MODE = 2
+MOTION_STREAM_EXT_SYNC = 3
+MOTION_STREAM_MODE_EXACT_STOP = 1
+MOTION_STREAM_MODE_CONTINUOUS = 2
+MOTION_STREAM_MODE_NO_FEED_OVERRIDE = 4
+MOTION_STREAM_FRAME_MAX = 90
+
+AXIS_LETTERS = "XYZABC"
+WORD = re.compile(r"([A-Z])\s*([-+]?(?:\d+\.?\d*|\.\d+))")
+
+
+def crc16(data):
+    # same CRC used by modbus
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def zigzag_varint(value):
+    v = (value << 1) if value >= 0 else ((-value) << 1) - 1
+    out = bytearray()
+    while True:
+        c = v & 0x7F
+        v >>= 7
+        if v:
+            out.append(c | 0x80)
+        else:
+            out.append(c)
+            return bytes(out)
+
+
+class CompileError(Exception):
+    pass
+
+
+class Compiler:
+    def __init__(self, axis, steps_per_mm, start, arc_tolerance):
+        self.axis = axis
+        self.steps_per_mm = steps_per_mm
+        self.arc_tolerance = arc_tolerance
+        # work position (mm) and position in steps relative to the stream start
+        self.pos = list(start)
+        self.start = list(start)
+        self.steps = [0] * len(axis)
+        self.motion = 0
+        self.absolute = True
+        self.inches = False
+        self.plane = (0, 1)
+        self.feed = None
+        self.sent_feed = None
+        self.spindle = 0
+        self.spindle_running = 0
+        self.coolant = 0
+        self.path_mode = 0
+        self.no_override = False
+        self.records = []
+        self.moves = 0
+
+    def emit_mode(self):
+        mode = self.path_mode | (MOTION_STREAM_MODE_NO_FEED_OVERRIDE if self.no_override else 0)
+        self.records.append(bytes([MOTION_STREAM_EXTENDED | MOTION_STREAM_EXT_MODE, mode]))
+
+    def emit_tool(self):
+        flags = self.spindle_running | (self.coolant << 2)
+        self.records.append(bytes([MOTION_STREAM_EXTENDED | MOTION_STREAM_EXT_TOOL, flags]) + struct.pack("<H", min(int(self.spindle), 0xFFFF)))
+
+    def emit_line(self, target, rapid):
+        mask = 0
+        payload = bytearray()
+        for i, value in enumerate(target):
+            steps = int(round((value - self.start[i]) * self.steps_per_mm[i]))
+            if steps != self.steps[i]:
+                mask |= 1 << i
+                payload += zigzag_varint(steps - self.steps[i])
+                self.steps[i] = steps
+        self.pos = list(target)
+        if not mask:
+            return
+        if not rapid:
+            if self.feed is None:
+                raise CompileError("undefined feed rate")
+            if self.feed != self.sent_feed:
+                self.records.append(bytes([MOTION_STREAM_FEED]) + struct.pack("<f", self.feed))
+                self.sent_feed = self.feed
+        self.records.append(bytes([(MOTION_STREAM_RAPID if rapid else MOTION_STREAM_LINE) | mask]) + payload)
+        self.moves += 1
+
+    def emit_arc(self, target, words, clockwise):
+        a0, a1 = self.plane
+        start = self.pos
+        scale = 25.4 if self.inches else 1.0
+        offsets = {0: words.get("I", 0.0) * scale, 1: words.get("J", 0.0) * scale, 2: words.get("K", 0.0) * scale}
+        if "R" in words:
+            # radius format (center on the side given by the radius sign, like the G-code parser)
+            r = words["R"] * scale
+            x = target[a0] - start[a0]
+            y = target[a1] - start[a1]
+            d = math.hypot(x, y)
+            if d == 0 or 4 * r * r < d * d:
+                raise CompileError("invalid arc radius")
+            h = math.sqrt(4 * r * r - d * d) / d
+            if not clockwise:
+                h = -h
+            if r < 0:
+                h = -h
+            offsets[a0] = 0.5 * (x - y * h)
+            offsets[a1] = 0.5 * (y + x * h)
+        ca = start[a0] + offsets[a0]
+        cb = start[a1] + offsets[a1]
+        p0a, p0b = start[a0] - ca, start[a1] - cb
+        p1a, p1b = target[a0] - ca, target[a1] - cb
+        radius = math.hypot(p0a, p0b)
+        angle = math.atan2(p0a * p1b - p0b * p1a, p0a * p1a + p0b * p1b)
+        if clockwise and angle >= 0:
+            angle -= 2 * math.pi
+        elif not clockwise and angle <= 0:
+            angle += 2 * math.pi
+        # same segment count as mc_arc
+        segments = int(math.floor(abs(radius * angle / 2) / math.sqrt(self.arc_tolerance * (2 * radius - self.arc_tolerance))))
+        segments = max(segments, 1)
+        a_start = math.atan2(p0b, p0a)
+        for k in range(1, segments):
+            t = k / segments
+            point = [start[i] + (target[i] - start[i]) * t for i in range(len(start))]
+            point[a0] = ca + radius * math.cos(a_start + angle * t)
+            point[a1] = cb + radius * math.sin(a_start + angle * t)
+            self.emit_line(point, False)
+        self.emit_line(target, False)
+
+    def line(self, text):
+        text = re.sub(r"\([^)]*\)", "", text.upper())
+        text = text.split(";")[0].strip()
+        if not text or text.startswith("%"):
+            return
+        words = {}
+        gcodes = []
+        mcodes = []
+        for letter, value in WORD.findall(text):
+            if letter == "G":
+                gcodes.append(float(value))
+            elif letter == "M":
+                mcodes.append(float(value))
+            elif letter == "N":
+                continue
+            else:
+                words[letter] = float(value)
+
+        motion = None
+        dwell = False
+        for g in gcodes:
+            if g in (0, 1, 2, 3):
+                motion = int(g)
+            elif g == 4:
+                dwell = True
+            elif g == 17:
+                self.plane = (0, 1)
+            elif g == 18:
+                self.plane = (2, 0)
+            elif g == 19:
+                self.plane = (1, 2)
+            elif g == 20:
+                self.inches = True
+            elif g == 21:
+                self.inches = False
+            elif g == 90:
+                self.absolute = True
+            elif g == 91:
+                self.absolute = False
+            elif g in (61, 61.1, 64):
+                self.path_mode = {61: 0, 61.1: MOTION_STREAM_MODE_EXACT_STOP, 64: MOTION_STREAM_MODE_CONTINUOUS}[g]
+                self.emit_mode()
+            elif g == 92:
+                # coordinate offset (the axis words set the current position and do not move)
+                scale = 25.4 if self.inches else 1.0
+                for i, letter in enumerate(self.axis):
+                    if letter in words:
+                        self.pos[i] = words[letter] * scale
+                        self.start[i] = self.pos[i] - self.steps[i] / self.steps_per_mm[i]
+                return
+            elif g in (54, 94, 40, 49, 80):
+                # work offsets do not matter (positions are relative to the stream start)
+                continue
+            else:
+                raise CompileError("unsupported G%g" % g)
+
+        for m in mcodes:
+            if m in (3, 4):
+                self.spindle_running = 1 if m == 3 else 2
+            elif m == 5:
+                self.spindle_running = 0
+            elif m == 7:
+                self.coolant |= 2
+            elif m == 8:
+                self.coolant |= 1
+            elif m == 9:
+                self.coolant = 0
+            elif m in (48, 49):
+                self.no_override = (m == 49)
+                self.emit_mode()
+                continue
+            elif m in (0, 1, 2, 30):
+                continue
+            else:
+                raise CompileError("unsupported M%g" % m)
+            if "S" not in words:
+                self.emit_tool()
+
+        scale = 25.4 if self.inches else 1.0
+        if "F" in words:
+            self.feed = words["F"] * scale
+        if "S" in words:
+            self.spindle = words["S"]
+            self.emit_tool()
+
+        if dwell:
+            self.records.append(bytes([MOTION_STREAM_EXTENDED | MOTION_STREAM_EXT_DWELL]) + struct.pack("<H", min(int(round(words.get("P", 0) * 1000)), 0xFFFF)))
+            return
+
+        if motion is not None:
+            self.motion = motion
+        if not any(letter in words for letter in self.axis):
+            return
+
+        target = list(self.pos)
+        for i, letter in enumerate(self.axis):
+            if letter in words:
+                target[i] = words[letter] * scale + (0 if self.absolute else self.pos[i])
+
+        if self.motion in (2, 3):
+            self.emit_arc(target, words, self.motion == 2)
+        else:
+            self.emit_line(target, self.motion == 0)
+
+    def frames(self):
+        # packs the records in frames (sequence 0 restarts the stream and then wraps 255 -> 1)
+        seq = 0
+        frame = bytearray([seq])
+        for record in self.records:
+            if len(frame) + len(record) + 2 > MOTION_STREAM_FRAME_MAX:
+                yield bytes(frame)
+                seq = seq + 1 if seq < 255 else 1
+                frame = bytearray([seq])
+            frame += record
+        if len(frame) > 1 or seq == 0:
+            yield bytes(frame)
+
+
+def encode(frame):
+    data = frame + struct.pack("<H", crc16(frame))
+    return ":" + base64.b64encode(data).decode().rstrip("=")
+
+
+def float_list(value):
+    return [float(v) for v in value.split(",")]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC G-code to binary motion stream compiler")
+    parser.add_argument("gcode", help="G-code file")
+    parser.add_argument("-o", "--output", help="output file (default stdout)")
+    parser.add_argument("--axis", default="XYZ", help="axis letters in the firmware axis order")
+    parser.add_argument("--steps-per-mm", type=float_list, default=None, help="steps per mm of each axis ($100-$10x, default 200)")
+    parser.add_argument("--start", type=float_list, default=None, help="work position of the machine when the stream starts")
+    parser.add_argument("--arc-tolerance", type=float, default=0.002, help="arc tolerance ($12)")
+    args = parser.parse_args()
+
+    n = len(args.axis)
+    steps_per_mm = args.steps_per_mm or [200.0] * n
+    start = args.start or [0.0] * n
+    if len(steps_per_mm) != n or len(start) != n:
+        parser.error("--steps-per-mm and --start must have one value per axis")
+
+    compiler = Compiler(args.axis.upper(), steps_per_mm, start, args.arc_tolerance)
+    with open(args.gcode) as f:
+        for lineno, text in enumerate(f, 1):
+            try:
+                compiler.line(text)
+            except CompileError as e:
+                print("%s:%d: %s" % (args.gcode, lineno, e), file=sys.stderr)
+                return 1
+
+    lines = [encode(frame) for frame in compiler.frames()]
+    out = open(args.output, "w") if args.output else sys.stdout
+    out.write("\n".join(lines) + "\n")
+    if args.output:
+        out.close()
+
+    size = sum(len(frame) for frame in compiler.frames())
+    print("%d moves, %d records, %d frames, %d bytes (%.2f bytes/move, %d bytes encoded)" % (
+        compiler.moves, len(compiler.records), len(lines), size, size / max(1, compiler.moves), sum(len(l) + 1 for l in lines)),
+        file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+	Name: homing_test.py
+	Description: Compares the serial and the parallel homing cycles (ENABLE_PARALLEL_HOMING).
+
+		Builds the Linux virtual MCU with and without ENABLE_PARALLEL_HOMING, enables homing ($21=1 and $22=1)
+		and runs $H with a simulated limit switch on each stepper (--switches) at a random distance from the start position.
+		The step/dir trace of each run is replayed to get the position of each stepper relative to it's switch:
+		- both homing cycles must finish without alarm and leave each stepper at the same distance from it's switch
+		- a switch out of reach of the search motion must fail the parallel homing cycle with an alarm
+		Prints the machine time of both homing cycles.
+		Returns a non zero exit code if any check fails.
+
+		Usage:
+			./homing_test.py [--iterations 5] [--max-distance 20] [--seed 1]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+import trace_validate
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def build(name, options, jobs):
+    build_dir = os.path.join("build", name)
+    subprocess.run(["make", "-s", "-j%d" % jobs, "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=" + options],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "uCNC")
+
+
+def settings(binary, eeprom):
+    subprocess.run([binary, "--sim", "--eeprom", eeprom], input=b"$RST=*\n$SS\n", stdout=subprocess.DEVNULL,
+                   stderr=subprocess.DEVNULL, check=True, timeout=20)
+    proc = subprocess.run([binary, "--sim", "--eeprom", eeprom], input=b"$21=1\n$22=1\n$SS\n$$\n", stdout=subprocess.PIPE,
+                          stderr=subprocess.DEVNULL, check=True, timeout=20)
+    values = {}
+    for line in proc.stdout.decode("ascii", "replace").split():
+        if line.startswith("$") and "=" in line:
+            key, value = line[1:].split("=", 1)
+            values[int(key)] = float(value)
+    return values
+
+
+def home(binary, switches, tmp):
+    eeprom = os.path.join(tmp, "eeprom")
+    trace = os.path.join(tmp, "trace")
+    values = settings(binary, eeprom)
+    proc = subprocess.run([binary, "--sim", "--eeprom", eeprom, "--trace", trace, "--switches", ",".join(str(s) for s in switches)],
+                          input=b"$H\nG4P0\n", stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, check=True, timeout=600)
+    output = proc.stdout.decode("ascii", "replace")
+    alarm = "ALARM" in output or "error" in output
+
+    # position of each stepper relative to it's switch
+    t = trace_validate.Trace(trace)
+    pos = list(switches)
+    dirs = 0
+    start = None
+    end = 0
+    for rtype, ticks, value in t.records():
+        if rtype == trace_validate.TRACE_SET_DIRS:
+            dirs = value
+        elif rtype == trace_validate.TRACE_TOGGLE_STEPS:
+            start = ticks if start is None else start
+            end = ticks
+            for i in range(len(pos)):
+                if value & (1 << i):
+                    pos[i] += -1 if dirs & (1 << i) else 1
+    duration = (end - start) / float(t.clock) if start is not None else 0
+    return alarm, pos, duration, values
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC parallel homing test")
+    parser.add_argument("--iterations", type=int, default=5, help="number of random switch positions")
+    parser.add_argument("--max-distance", type=float, default=20, help="max distance of the switches from the start (mm)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    serial = build("homing_serial", "", args.jobs)
+    parallel = build("homing_parallel", "-DENABLE_PARALLEL_HOMING", args.jobs)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        values = settings(parallel, os.path.join(tmp, "eeprom"))
+    steppers = sum(1 for key in values if 100 <= key < 110)
+    step_per_mm = [values[100 + i] for i in range(steppers)]
+
+    failures = 0
+    print("%3s %10s %10s  %s" % ("", "serial", "parallel", "result"))
+    for i in range(args.iterations):
+        switches = [int(random.uniform(0.5, args.max_distance) * step_per_mm[s]) for s in range(steppers)]
+        with tempfile.TemporaryDirectory() as tmp:
+            ref_alarm, ref_pos, ref_duration, _ = home(serial, switches, tmp)
+        with tempfile.TemporaryDirectory() as tmp:
+            alarm, pos, duration, _ = home(parallel, switches, tmp)
+
+        errors = []
+        if ref_alarm or alarm:
+            errors.append("homing failed (serial %s, parallel %s)" % (ref_alarm, alarm))
+        if pos != ref_pos:
+            errors.append("distance from the switches %s != %s" % (pos, ref_pos))
+        print("%3d %9.1fs %9.1fs  %s" % (i, ref_duration, duration, "; ".join(errors) if errors else "PASS"))
+        if errors:
+            print("    switches: %s" % switches)
+            failures += 1
+
+    # the last switch is beyond the search distance (1.5 x max travel)
+    switches = [int(args.max_distance * step_per_mm[s]) for s in range(steppers)]
+    switches[-1] = int(values[130 + steppers - 1] * 2 * step_per_mm[-1])
+    with tempfile.TemporaryDirectory() as tmp:
+        alarm, pos, duration, _ = home(parallel, switches, tmp)
+    print("%3s %10s %9.1fs  %s" % ("out", "", duration, "PASS" if alarm else "no alarm with a switch out of reach"))
+    if not alarm:
+        failures += 1
+
+    print("result: %s" % ("FAIL" if failures else "PASS"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+	Name: input_shaping_test.py
+	Description: Checks the input shaping stage (ENABLE_INPUT_SHAPING).
+
+		Builds the Linux virtual MCU with ENABLE_INPUT_SHAPING and runs the same random point to point program
+		with the step/dir trace enabled, without shaping and with the ZV, ZVD and EI impulse trains ($180+ to $200+).
+		The shaped runs use the acceleration ($120+) raised --gain times.
+		The step position of each stepper is replayed through a damped oscillator (the axis vibration mode at --freq
+		and --damping) and each move reports the residual vibration amplitude after its last step and the time from
+		its first step until the vibration stays below --threshold (move and settle time).
+		The shaper is tuned to the oscillator frequency with a --mismatch error (%).
+		Each trace must pass trace_validate.py, the final positions must match and the max residual vibration
+		of each shaped run must be below half the residual vibration without shaping.
+		Returns a non zero exit code if any check fails.
+
+		Usage:
+			./input_shaping_test.py [--freq 20] [--damping 0.05] [--mismatch 0] [--accel 500] [--gain 2] [--moves 10] [--seed 1]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import math
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+import trace_validate
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+AXIS = "XY"
+STEP_PER_MM = 200
+# dwell between the moves (s) and the shortest pause that splits two moves
+DWELL = 0.5
+PAUSE = 0.2
+# name and $200+ impulse train of each run (None runs without shaping)
+SHAPERS = [("off", None), ("ZV", 0), ("ZVD", 1), ("EI", 2)]
+
+
+def build(jobs):
+    build_dir = os.path.join("build", "shaper")
+    subprocess.run(["make", "-s", "-j%d" % jobs, "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=-DENABLE_INPUT_SHAPING"],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "uCNC")
+
+
+def program(moves, rate):
+    lines = ["$X", "G21 G91"]
+    for _ in range(moves):
+        words = " ".join("%s%.3f" % (axis, random.choice((-1, 1)) * random.uniform(2, 30)) for axis in AXIS)
+        lines.append("G1 %s F%d" % (words, rate))
+        lines.append("G4 P%g" % DWELL)
+    return "\n".join(lines) + "\n"
+
+
+def settings(rate, accel, freq, damping, shaper):
+    lines = []
+    for i in range(len(AXIS)):
+        lines.append("$10%d=%d\n$11%d=%d\n$12%d=%g\n" % (i, STEP_PER_MM, i, rate, i, accel))
+        if shaper is not None:
+            lines.append("$18%d=%g\n$19%d=%g\n$20%d=%d\n" % (i, freq, i, damping, i, shaper))
+    return "".join(lines)
+
+
+def positions(trace):
+    # step times (s) and position after the step (mm) of each stepper
+    steps = [[] for _ in range(trace.steppers)]
+    pos = [0] * trace.steppers
+    dirs = 0
+    inv_clock = 1.0 / trace.clock
+    for rtype, ticks, value in trace.records():
+        if rtype == trace_validate.TRACE_SET_DIRS:
+            dirs = value
+        elif rtype == trace_validate.TRACE_TOGGLE_STEPS:
+            for i in range(trace.steppers):
+                bit = 1 << i
+                if value & bit:
+                    pos[i] += -1 if (dirs & bit) else 1
+                    steps[i].append((ticks * inv_clock, pos[i] / STEP_PER_MM))
+    return steps, pos
+
+
+def vibration(steps, freq, damping, threshold):
+    # replays the steps of a stepper through the oscillator x'' = w^2 (u - x) - 2 zeta w x' (u is the step position)
+    # e = x - u oscillates freely between the steps and each step moves u (e jumps and e' is continuous)
+    # returns the residual amplitude after the last step and the settle time (from the first step) of each move
+    w = 2 * math.pi * freq
+    wd = w * math.sqrt(1 - damping * damping)
+    sigma = damping * w
+    e = de = 0.0
+    u = 0.0
+    t = None
+    moves = []
+    first = None
+    last = None
+    for ts, p in steps:
+        if t is not None:
+            h = ts - t
+            # exact free response of the damped oscillator over h
+            decay = math.exp(-sigma * h)
+            c = math.cos(wd * h)
+            s = math.sin(wd * h)
+            e, de = (decay * (e * c + (de + sigma * e) * s / wd),
+                     decay * (de * c - (w * w * e + sigma * de) * s / wd))
+        if last is not None and ts - last > PAUSE:
+            moves.append((first, last, residual))
+            first = None
+        first = ts if first is None else first
+        e -= p - u
+        u = p
+        t = last = ts
+        residual = math.hypot(e, (de + sigma * e) / wd)
+    if last is not None:
+        moves.append((first, last, residual))
+
+    result = []
+    for first, last, residual in moves:
+        settle = math.log(residual / threshold) / sigma if residual > threshold else 0.0
+        result.append((first, residual, last - first + settle))
+    return result
+
+
+def run(binary, gcode, tmp, config, args):
+    eeprom = os.path.join(tmp, "eeprom")
+    path = os.path.join(tmp, "trace")
+    subprocess.run([binary, "--sim", "--eeprom", eeprom], input=("$RST=*\n" + config + "$SS\n").encode("ascii"),
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True, timeout=20)
+    subprocess.run([binary, "--sim", "--eeprom", eeprom, "--trace", path], input=gcode.encode("ascii"),
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True, timeout=300)
+    proc = subprocess.run([sys.executable, os.path.join(HERE, "trace_validate.py"), path],
+                          stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    steps, pos = positions(trace_validate.Trace(path))
+    times = [t for stepper in steps for t, _ in stepper]
+    duration = (max(times) - min(times)) if times else 0.0
+    # max residual vibration and mean settle time of the slowest stepper of each move (all the axis move in every move)
+    moves = list(zip(*[vibration(stepper, args.freq, args.damping, args.threshold) for stepper in steps[:len(AXIS)]]))
+    residual = max((r for move in moves for _, r, _ in move), default=0.0)
+    settle = sum(max(s for _, _, s in move) for move in moves) / max(1, len(moves))
+    return pos, duration, residual, settle, proc.returncode == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC input shaping test")
+    parser.add_argument("--freq", type=float, default=20, help="vibration frequency of the axis (Hz)")
+    parser.add_argument("--damping", type=float, default=0.05, help="damping ratio of the axis")
+    parser.add_argument("--mismatch", type=float, default=0, help="error of the shaper frequency (%%)")
+    parser.add_argument("--accel", type=float, default=500, help="acceleration without shaping (mm/s^2)")
+    parser.add_argument("--gain", type=float, default=2, help="acceleration factor of the shaped runs")
+    parser.add_argument("--rate", type=int, default=3000, help="max rate and feed (mm/min)")
+    parser.add_argument("--threshold", type=float, default=0.01, help="settled vibration amplitude (mm)")
+    parser.add_argument("--moves", type=int, default=10, help="moves of the program")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    binary = build(args.jobs)
+    gcode = program(args.moves, args.rate)
+    shaper_freq = args.freq * (1 + args.mismatch / 100.0)
+
+    failures = []
+    ref = None
+    print("%-5s %10s %12s %14s %14s  %s" % ("", "accel", "machine (s)", "residual (mm)", "settle (ms)", "result"))
+    for name, shaper in SHAPERS:
+        accel = args.accel if shaper is None else args.accel * args.gain
+        with tempfile.TemporaryDirectory() as tmp:
+            pos, duration, residual, settle, ok = run(binary, gcode, tmp,
+                                                      settings(args.rate, accel, shaper_freq, args.damping, shaper), args)
+        errors = []
+        if not ok:
+            errors.append("trace failed trace_validate.py")
+        if ref is None:
+            ref = (pos, residual)
+        else:
+            if pos != ref[0]:
+                errors.append("final position %s != %s" % (pos, ref[0]))
+            if residual >= 0.5 * ref[1]:
+                errors.append("residual vibration not reduced")
+        print("%-5s %10g %12.3f %14.4f %14.1f  %s" % (name, accel, duration, residual, settle * 1000,
+                                                     "; ".join(errors) if errors else "PASS"))
+        if errors:
+            failures.append(name)
+
+    if failures:
+        print("program:\n%s" % gcode)
+    print("result: %s" % ("FAIL" if failures else "PASS"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+	Name: itp_compare.py
+	Description: Compares the fixed point interpolator (ENABLE_ITP_FIXED_POINT) against the float interpolator.
+
+		Builds the Linux virtual MCU with and without ENABLE_ITP_FIXED_POINT for each S-curve level,
+		runs the same G-code files with the step/dir trace enabled and compares the traces
+		- the step count and final position of each stepper must be the same
+		- the machine time must match within --time-tolerance
+		- the local step rate (measured over --window steps around each step) must match within --rate-tolerance
+		  for --percentile of the steps (compared step by step, so timing drifts do not accumulate;
+		  the few steps next to a block junction where both interpolators start the next segment at a
+		  different time are reported in the max column only)
+
+		Returns a non zero exit code if any difference is above the tolerances.
+
+		Examples:
+			./itp_compare.py
+			./itp_compare.py --scurve 0,2,4 stress-tests.nc
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+import trace_validate
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+GCODE_DIR = os.path.join(HERE, "..", "..", "tests", "gcode")
+DEFAULT_FILES = ["stress-tests.nc", "curves-as-lines.nc", "circle.nc"]
+
+
+def int_list(value):
+    return [int(v) for v in value.split(",") if v != ""]
+
+
+def build(scurve, fixed, jobs):
+    build_dir = os.path.join("build_itp", "sc%d_%s" % (scurve, "fx" if fixed else "flt"))
+    options = "-DS_CURVE_ACCELERATION_LEVEL=%d" % scurve
+    if fixed:
+        options += " -DENABLE_ITP_FIXED_POINT"
+    subprocess.run(["make", "-s", "-j%d" % jobs, "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=" + options],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "uCNC")
+
+
+def run(binary, gcode, tmp):
+    eeprom = os.path.join(tmp, "eeprom")
+    trace = os.path.join(tmp, "trace")
+    subprocess.run([binary, "--sim", "--eeprom", eeprom], input=b"$RST=*\n$SS\n",
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True)
+    with open(gcode, "rb") as f:
+        data = b"$X\n" + f.read()
+    subprocess.run([binary, "--sim", "--eeprom", eeprom, "--trace", trace], input=data,
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True)
+    return steps(trace_validate.Trace(trace))
+
+
+def steps(trace):
+    # step times (s) and final position of each stepper
+    n = trace.steppers
+    times = [[] for _ in range(n)]
+    pos = [0] * n
+    dirs = 0
+    start = None
+    end = 0
+    inv_clock = 1.0 / trace.clock
+    for rtype, ticks, value in trace.records():
+        if rtype == trace_validate.TRACE_POSITION:
+            pos = list(value)
+        elif rtype == trace_validate.TRACE_SET_DIRS:
+            dirs = value
+        elif rtype == trace_validate.TRACE_TOGGLE_STEPS:
+            t = ticks * inv_clock
+            start = t if start is None else start
+            end = t
+            for i in range(n):
+                if value & (1 << i):
+                    times[i].append(t)
+    return times, pos, (end - start) if start is not None else 0
+
+
+def local_rates(times, window, stop):
+    # step rate around each step (None across a stop)
+    rates = [None] * len(times)
+    for k in range(window, len(times) - window):
+        span = times[k + window] - times[k - window]
+        if span > 0 and span < stop * window:
+            rates[k] = 2 * window / span
+    return rates
+
+
+def compare(ref, test, args):
+    ref_times, ref_pos, ref_duration = ref
+    test_times, test_pos, test_duration = test
+    errors = []
+    if ref_pos != test_pos:
+        errors.append("final position %s != %s" % (test_pos, ref_pos))
+
+    rate_errors = []
+    for i, (a, b) in enumerate(zip(ref_times, test_times)):
+        if len(a) != len(b):
+            errors.append("stepper %d: %d steps != %d" % (i, len(b), len(a)))
+            continue
+        if not a:
+            continue
+        ra = local_rates(a, args.window, args.stop / 1000.0)
+        rb = local_rates(b, args.window, args.stop / 1000.0)
+        for x, y in zip(ra, rb):
+            if x is not None and y is not None:
+                rate_errors.append(abs(y - x) / x)
+
+    time_error = abs(test_duration - ref_duration) / ref_duration if ref_duration else 0
+    if time_error * 100 > args.time_tolerance:
+        errors.append("machine time differs %.3f%%" % (time_error * 100))
+    rate_errors.sort()
+    rate_error = rate_errors[max(0, int(len(rate_errors) * args.percentile / 100.0) - 1)] if rate_errors else 0
+    max_rate_error = rate_errors[-1] if rate_errors else 0
+    if rate_error * 100 > args.rate_tolerance:
+        errors.append("step rate differs %.3f%%" % (rate_error * 100))
+    return ref_duration, test_duration, time_error, rate_error, max_rate_error, errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC fixed point interpolator comparison")
+    parser.add_argument("--scurve", type=int_list, default=[0, 2, 4], help="S_CURVE_ACCELERATION_LEVEL values")
+    parser.add_argument("--window", type=int, default=8, help="steps on each side used to measure the local step rate")
+    parser.add_argument("--stop", type=float, default=15.0, help="step interval above which the stepper is considered stopped (ms)")
+    parser.add_argument("--time-tolerance", type=float, default=0.2, help="allowed machine time difference (%%)")
+    parser.add_argument("--rate-tolerance", type=float, default=5.0, help="allowed local step rate difference (%%)")
+    parser.add_argument("--percentile", type=float, default=99.0, help="percentile of the steps checked against --rate-tolerance")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    parser.add_argument("files", nargs="*", default=DEFAULT_FILES, help="G-code files (relative to tests/gcode)")
+    args = parser.parse_args()
+
+    failed = False
+    print("%-6s %-20s %12s %12s %10s %10s %10s  %s" % ("scurve", "file", "float(s)", "fixed(s)", "time", "rate", "max", "result"))
+    for scurve in args.scurve:
+        ref_binary = build(scurve, False, args.jobs)
+        test_binary = build(scurve, True, args.jobs)
+        for gcode in args.files:
+            path = gcode if os.path.isabs(gcode) else os.path.join(GCODE_DIR, gcode)
+            with tempfile.TemporaryDirectory() as tmp:
+                ref = run(ref_binary, path, tmp)
+            with tempfile.TemporaryDirectory() as tmp:
+                test = run(test_binary, path, tmp)
+            ref_duration, test_duration, time_error, rate_error, max_rate_error, errors = compare(ref, test, args)
+            failed |= bool(errors)
+            print("%-6d %-20s %12.3f %12.3f %9.3f%% %9.3f%% %9.3f%%  %s" % (
+                scurve, os.path.basename(path), ref_duration, test_duration, time_error * 100, rate_error * 100,
+                max_rate_error * 100,
+                "; ".join(errors) if errors else "PASS"))
+
+    print("result: %s" % ("FAIL" if failed else "PASS"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""
+	Name: jerk_test.py
+	Description: Checks the jerk limited planner (ENABLE_JERK_LIMITED_PLANNER).
+
+		Builds the Linux virtual MCU with the constant acceleration planner and with ENABLE_JERK_LIMITED_PLANNER
+		and runs the same random G-code programs with the step/dir trace enabled:
+		- the constant acceleration build with the --accel acceleration ($120+)
+		- the jerk limited build with the acceleration raised --gain times and the --jerk max jerk ($170+)
+		Each trace is replayed by trace_validate.py (no rate or acceleration above the settings) and the measured
+		jerk of the jerk limited build must stay below --jerk (plus the step quantization of the finite differences).
+		The final positions must match. Prints the machine time and the max measured acceleration and jerk of both builds.
+		G-code files given as arguments run instead of the random programs. Their paths of short lines have corners so
+		the acceleration and jerk are measured on the path speed (speed of the fastest axis) and must stay below
+		the settings of the jerk limited build (the acceleration flags of trace_validate.py are ignored).
+		Returns a non zero exit code if any check fails.
+
+		Usage:
+			./jerk_test.py [--accel 100] [--gain 2] [--jerk 2000] [--iterations 5] [--moves 20] [--seed 1] [file.nc ...]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+import itp_compare
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+AXIS = "XYZ"
+STEP_PER_MM = 200
+# smoothing window of the trace derivatives (ms)
+WINDOW = 50.0
+# position sampling grid and step interval above which a stepper is stopped (ms, as trace_validate.py)
+GRID = 1.0
+STOP = 15.0
+
+
+def build(jobs, jerk):
+    build_dir = os.path.join("build", "jerk" if jerk else "trapezoid")
+    options = "-DENABLE_JERK_LIMITED_PLANNER" if jerk else ""
+    subprocess.run(["make", "-s", "-j%d" % jobs, "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=" + options],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "uCNC")
+
+
+def program(moves, rate):
+    # strokes of collinear moves at random feeds with a stop between the strokes
+    # (the axis speed steps of the junctions at corners are set by the junction deviation and not by the planner profile)
+    lines = ["$X", "G21 G91"]
+    while len(lines) < moves + 2:
+        direction = [random.uniform(-1, 1) for _ in AXIS]
+        for _ in range(random.randint(1, 5)):
+            length = random.uniform(0.5, 20)
+            words = " ".join("%s%.3f" % (axis, length * d) for axis, d in zip(AXIS, direction))
+            lines.append("G1 %s F%d" % (words, random.randint(rate // 5, rate)))
+        lines.append("G4 P0.1")
+    return "\n".join(lines) + "\n"
+
+
+def path_derivatives(trace):
+    # max acceleration and jerk of the path speed (mm/s^2 and mm/s^3) measured as the speed of the fastest axis
+    # (the axis speeds step at the corners of a path of lines with the junction deviation but the speed of the fastest
+    # axis only changes with the planner profile)
+    # at a reversal the smoothed speed of the axis crosses zero with a corner so the differences of its signed speed
+    # are used if they are lower
+    n = trace.steppers
+    steps = [[] for _ in range(n)]
+    pos = [0] * n
+    dirs = 0
+    inv_clock = 1.0 / trace.clock
+    for rtype, ticks, value in trace.records():
+        if rtype == itp_compare.trace_validate.TRACE_SET_DIRS:
+            dirs = value
+        elif rtype == itp_compare.trace_validate.TRACE_TOGGLE_STEPS:
+            for i in range(n):
+                bit = 1 << i
+                if value & bit:
+                    pos[i] += -1 if (dirs & bit) else 1
+                    steps[i].append((ticks * inv_clock, pos[i]))
+    steps = [ev for ev in steps if ev]
+    if not steps:
+        return 0.0, 0.0
+
+    window = WINDOW / 1000.0
+    grid = GRID / 1000.0
+    stop = STOP / 1000.0
+    t0 = min(ev[0][0] for ev in steps) - window
+    count = int((max(ev[-1][0] for ev in steps) + window - t0) / grid) + 1
+    # position of each axis on a uniform grid (mm)
+    sampled = []
+    moving = [False] * count
+    for ev in steps:
+        column = []
+        j = 0
+        for k in range(count):
+            t = t0 + k * grid
+            while j < len(ev) and ev[j][0] <= t:
+                j += 1
+            if j == 0:
+                column.append(ev[0][1] - (1 if ev[0][1] > 0 else -1))
+            elif j == len(ev):
+                column.append(ev[-1][1])
+            else:
+                (ta, pa), (tb, pb) = ev[j - 1], ev[j]
+                if tb - ta > stop:
+                    column.append(pa)
+                else:
+                    column.append(pa + (pb - pa) * (t - ta) / (tb - ta))
+                    moving[k] = True
+        sampled.append([p / STEP_PER_MM for p in column])
+
+    # signed speed of each axis (only while all the moving axis don't stop)
+    w = max(1, int(round(window / grid)))
+    h = w * grid
+    still = [0] * (count + 1)
+    for k in range(count):
+        still[k + 1] = still[k] + (0 if moving[k] else 1)
+    speed = [None] * count
+    for k in range(w, count - w):
+        if not (still[k + w + 1] - still[k - w]):
+            speed[k] = [(column[k + w] - column[k - w]) / (2 * h) for column in sampled]
+
+    amax = jmax = 0.0
+    for k in range(w, count - w):
+        v0, v1, v2 = speed[k - w], speed[k], speed[k + w]
+        if v0 is None or v1 is None or v2 is None:
+            continue
+        fastest = max(range(len(v1)), key=lambda i: abs(v1[i]))
+        top = [max(abs(x) for x in v) for v in (v0, v1, v2)]
+        a = min(abs(top[2] - top[0]), abs(v2[fastest] - v0[fastest])) / (2 * h)
+        jk = min(abs(top[2] - 2 * top[1] + top[0]), abs(v2[fastest] - 2 * v1[fastest] + v0[fastest])) / (h * h)
+        amax = max(amax, a)
+        jmax = max(jmax, jk)
+    return amax, jmax
+
+
+def run(binary, gcode, tmp, settings, path=False):
+    eeprom = os.path.join(tmp, "eeprom")
+    trace = os.path.join(tmp, "trace")
+    subprocess.run([binary, "--sim", "--eeprom", eeprom], input=("$RST=*\n" + settings + "$SS\n").encode("ascii"),
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True, timeout=20)
+    subprocess.run([binary, "--sim", "--eeprom", eeprom, "--trace", trace], input=gcode.encode("ascii"),
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True, timeout=300)
+    proc = subprocess.run([sys.executable, os.path.join(HERE, "trace_validate.py"), "--window", str(WINDOW), trace],
+                          stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+    # stepper table rows: stp steps vmax rate vstart amax accel jmax ... flags
+    amax = jmax = 0.0
+    flags = []
+    for line in proc.stdout.decode("ascii", "replace").splitlines():
+        fields = line.split()
+        if len(fields) >= 13 and fields[0].isdigit():
+            amax = max(amax, float(fields[5]))
+            jmax = max(jmax, float(fields[7]))
+            flags.extend(fields[13:])
+        elif line.startswith("POSITION MISMATCH"):
+            flags.append("POSITION")
+    ok = proc.returncode == 0
+    if path:
+        # the axis acceleration steps at the corners of the path (only the acceleration flag is ignored)
+        ok = not [flag for flag in flags if flag != "ACCEL"]
+        amax, jmax = path_derivatives(itp_compare.trace_validate.Trace(trace))
+    _, pos, duration = itp_compare.steps(itp_compare.trace_validate.Trace(trace))
+    return pos, duration, amax, jmax, ok
+
+
+def settings(rate, accel, jerk=None):
+    lines = []
+    for i in range(len(AXIS)):
+        lines.append("$10%d=%d\n$11%d=%d\n$12%d=%g\n" % (i, STEP_PER_MM, i, rate, i, accel))
+        if jerk is not None:
+            lines.append("$17%d=%g\n" % (i, jerk))
+    return "".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC jerk limited planner test")
+    parser.add_argument("--accel", type=float, default=100, help="acceleration of the constant acceleration build (mm/s^2)")
+    parser.add_argument("--gain", type=float, default=2, help="acceleration factor of the jerk limited build")
+    parser.add_argument("--jerk", type=float, default=2000, help="max jerk of the jerk limited build (mm/s^3)")
+    parser.add_argument("--rate", type=int, default=3000, help="max rate and max feed (mm/min)")
+    parser.add_argument("--iterations", type=int, default=5, help="number of random programs")
+    parser.add_argument("--moves", type=int, default=20, help="moves per program")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("files", nargs="*", help="G-code files to run instead of the random programs")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    trapezoid = build(args.jobs, False)
+    jerk = build(args.jobs, True)
+    # step quantization of the 4 point jerk difference (same allowance as trace_validate.py for the acceleration)
+    h = WINDOW / 1000.0
+    jerk_limit = args.jerk * 1.05 + 3.0 / (STEP_PER_MM * h * h * h)
+    accel_limit = args.accel * args.gain * 1.05 + 2.0 / (STEP_PER_MM * h * h)
+
+    failures = []
+    print("%3s %21s %21s %21s  %s" % ("", "machine time (s)", "amax (mm/s^2)", "jmax (mm/s^3)", "result"))
+    print("%3s %10s %10s %10s %10s %10s %10s" % ("", "accel", "jerk", "accel", "jerk", "accel", "jerk"))
+    total = [0.0, 0.0]
+    if args.files:
+        programs = []
+        for name in args.files:
+            with open(name) as f:
+                programs.append("$X\n" + f.read())
+    else:
+        programs = [program(args.moves, args.rate) for _ in range(args.iterations)]
+    for i, gcode in enumerate(programs):
+        with tempfile.TemporaryDirectory() as tmp:
+            ref_pos, ref_duration, ref_amax, ref_jmax, ref_ok = run(trapezoid, gcode, tmp, settings(args.rate, args.accel),
+                                                                    bool(args.files))
+        with tempfile.TemporaryDirectory() as tmp:
+            pos, duration, amax, jmax, ok = run(jerk, gcode, tmp, settings(args.rate, args.accel * args.gain, args.jerk),
+                                                bool(args.files))
+        total[0] += ref_duration
+        total[1] += duration
+
+        errors = []
+        if not ref_ok:
+            errors.append("constant acceleration trace failed trace_validate.py")
+        if not ok:
+            errors.append("jerk limited trace failed trace_validate.py")
+        if pos != ref_pos:
+            errors.append("final position %s != %s" % (pos, ref_pos))
+        if args.files and amax > accel_limit:
+            errors.append("path acceleration %.1f above %.1f" % (amax, accel_limit))
+        if jmax > jerk_limit:
+            errors.append("jerk %.1f above %.1f" % (jmax, jerk_limit))
+        print("%3d %10.3f %10.3f %10.2f %10.2f %10.1f %10.1f  %s" % (i, ref_duration, duration, ref_amax, amax, ref_jmax, jmax,
+                                                                  "; ".join(errors) if errors else "PASS"))
+        if errors:
+            failures.append((i, gcode))
+
+    if total[0]:
+        print("machine time: jerk limited at %gx acceleration %.1f%% of constant acceleration" % (args.gain, 100.0 * total[1] / total[0]))
+    for i, gcode in failures:
+        if args.files:
+            print("iteration %d file: %s" % (i, args.files[i]))
+        else:
+            print("iteration %d program:\n%s" % (i, gcode))
+    print("result: %s" % ("FAIL" if failures else "PASS"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
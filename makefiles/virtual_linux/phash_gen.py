@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""
+	Name: phash_gen.py
+	Description: Generates the perfect hash tables of the µCNC named parameters and $ system commands.
+
+		Writes uCNC/src/core/parser_hash.h and uCNC/src/core/parser_hash.c with
+		- the named parameters hash (names and order read from the named_params table of core/parser_expr.c)
+		- the ids and hash of the $ system commands with 2 or more letters (SYSTEM_COMMANDS below)
+
+		The hash is updated with each char of the name while the parser reads it
+			h = ((h ^ c) * 0x0193) & 0xFFFF (starting with the table seed)
+		The low bits of h select the displacement of the bucket and the high byte plus the
+		displacement selects the table slot. The script searches the seed and the displacements
+		that put every name in its own slot, so each lookup is two table reads and a single
+		name compare.
+
+		Run it after changing the named_params table or the system commands.
+		With --check it only returns a non zero exit code if the generated files are outdated.
+
+		Usage:
+			./phash_gen.py
+			./phash_gen.py --check
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CORE = os.path.join(HERE, "..", "..", "uCNC", "src", "core")
+
+# $ system commands with 2 or more letters (the id order is kept, append new commands at the end)
+SYSTEM_COMMANDS = [
+    # core
+    "IE", "RST", "SS", "SL", "SR", "TLM", "DAQ", "DAQT", "DAQX", "DAQD", "WIN", "PRF", "PRFR",
+    # file system module
+    "LS", "CD", "LPR", "RUN",
+    # single axis homing module
+    "HX", "HY", "HZ", "HA", "HB", "HC",
+    # core (armed motion start)
+    "ARM", "ARMX",
+]
+
+HASH_MUL = 0x0193
+
+HEADER = """/*
+	Name: parser_hash.h
+	Description: Perfect hash lookup of the named parameters and $ system commands for µCNC.
+		Generated by makefiles/virtual_linux/phash_gen.py. Do not edit.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+"""
+
+SOURCE = HEADER.replace("parser_hash.h", "parser_hash.c").replace("Perfect hash lookup", "Perfect hash tables")
+
+
+def hash_name(seed, name):
+    h = seed
+    for c in name.encode("ascii"):
+        h = ((h ^ c) * HASH_MUL) & 0xFFFF
+    return h
+
+
+def build(names, size, buckets):
+    # hash and displace: the largest buckets are placed first
+    for seed in range(1, 0x10000):
+        hashes = [hash_name(seed, name) for name in names]
+        groups = {}
+        for i, h in enumerate(hashes):
+            groups.setdefault(h & (buckets - 1), []).append(i)
+        if any(len(set((hashes[i] >> 8) & (size - 1) for i in g)) != len(g) for g in groups.values()):
+            continue
+        slots = [0] * size
+        disp = [0] * buckets
+        for bucket, group in sorted(groups.items(), key=lambda kv: (-len(kv[1]), kv[0])):
+            for d in range(size):
+                targets = [((hashes[i] >> 8) + d) & (size - 1) for i in group]
+                if all(not slots[t] for t in targets):
+                    for i, t in zip(group, targets):
+                        slots[t] = i + 1
+                    disp[bucket] = d
+                    break
+            else:
+                break
+        else:
+            return seed, disp, slots
+    raise RuntimeError("no perfect hash found (increase the table size)")
+
+
+def table_size(count):
+    size = 8
+    while size < count + (count >> 3):
+        size <<= 1
+    return size
+
+
+def c_array(values, indent="\t\t"):
+    lines = []
+    for i in range(0, len(values), 16):
+        lines.append(indent + ", ".join("%d" % v for v in values[i:i + 16]))
+    return ",\n".join(lines)
+
+
+def generate():
+    with open(os.path.join(CORE, "parser_expr.c"), "r") as f:
+        named = re.findall(r"NAMED_PARAM\((\w+),\s*\d+\)", f.read())
+    if not named:
+        raise RuntimeError("named_params table not found")
+
+    np_size = table_size(len(named))
+    np_seed, np_disp, np_slots = build(named, np_size, np_size // 4)
+    cmd_size = table_size(len(SYSTEM_COMMANDS))
+    cmd_seed, cmd_disp, cmd_slots = build(SYSTEM_COMMANDS, cmd_size, cmd_size // 4)
+
+    h = [HEADER, "#ifndef PARSER_HASH_H\n#define PARSER_HASH_H\n\n#ifdef __cplusplus\nextern \"C\"\n{\n#endif\n\n#include <stdint.h>\n\n"]
+    h.append("// updates the hash with the next char of the name\n")
+    h.append("#define PARSER_HASH_STEP(h, c) ((uint16_t)(((h) ^ (uint8_t)(c)) * 0x%04X))\n" % HASH_MUL)
+    h.append("// the low bits of the hash select the bucket displacement and the high byte plus the displacement select the slot\n")
+    h.append("#define PARSER_HASH_SLOT(h, disp, buckets, size) ((uint8_t)(((h) >> 8) + rom_read_byte(&disp[(h) & ((buckets) - 1)])) & ((size) - 1))\n\n")
+    h.append("// named parameters (the slot holds the named_params index + 1 or 0 if empty)\n")
+    h.append("#define NAMED_PARAM_HASH_SEED %d\n" % np_seed)
+    h.append("#define NAMED_PARAM_HASH_COUNT %d\n" % len(named))
+    h.append("#define NAMED_PARAM_HASH_BUCKETS %d\n" % (np_size // 4))
+    h.append("#define NAMED_PARAM_HASH_SIZE %d\n" % np_size)
+    h.append("#ifdef ENABLE_NAMED_PARAMETERS\n")
+    h.append("\textern const uint8_t named_param_hash_disp[NAMED_PARAM_HASH_BUCKETS] __rom__;\n")
+    h.append("\textern const uint8_t named_param_hash_slot[NAMED_PARAM_HASH_SIZE] __rom__;\n#endif\n\n")
+    h.append("// $ system commands with 2 or more letters (the slot holds the command id or 0 if empty)\n")
+    h.append("#define GRBL_CMD_NONE 0\n")
+    for i, name in enumerate(SYSTEM_COMMANDS, 1):
+        h.append("#define GRBL_CMD_%s %d\n" % (name, i))
+    h.append("#define GRBL_CMD_HASH_SEED %d\n" % cmd_seed)
+    h.append("#define GRBL_CMD_HASH_COUNT %d\n" % len(SYSTEM_COMMANDS))
+    h.append("#define GRBL_CMD_HASH_BUCKETS %d\n" % (cmd_size // 4))
+    h.append("#define GRBL_CMD_HASH_SIZE %d\n" % cmd_size)
+    h.append("\textern const uint8_t grbl_cmd_hash_disp[GRBL_CMD_HASH_BUCKETS] __rom__;\n")
+    h.append("\textern const uint8_t grbl_cmd_hash_slot[GRBL_CMD_HASH_SIZE] __rom__;\n")
+    h.append("\textern const char *const grbl_cmd_names[GRBL_CMD_HASH_COUNT] __rom__;\n\n")
+    h.append("#ifdef __cplusplus\n}\n#endif\n\n#endif\n")
+
+    c = [SOURCE, "#include \"../cnc.h\"\n#include <stdint.h>\n\n"]
+    c.append("#ifdef ENABLE_NAMED_PARAMETERS\n")
+    c.append("const uint8_t named_param_hash_disp[NAMED_PARAM_HASH_BUCKETS] __rom__ = {\n%s};\n" % c_array(np_disp))
+    c.append("const uint8_t named_param_hash_slot[NAMED_PARAM_HASH_SIZE] __rom__ = {\n%s};\n#endif\n\n" % c_array(np_slots))
+    for name in SYSTEM_COMMANDS:
+        c.append("static const char grbl_cmd_%s[] __rom__ = \"%s\";\n" % (name, name))
+    c.append("const char *const grbl_cmd_names[GRBL_CMD_HASH_COUNT] __rom__ = {\n%s};\n" % ",\n".join(
+        "\t\tgrbl_cmd_%s" % name for name in SYSTEM_COMMANDS))
+    c.append("const uint8_t grbl_cmd_hash_disp[GRBL_CMD_HASH_BUCKETS] __rom__ = {\n%s};\n" % c_array(cmd_disp))
+    c.append("const uint8_t grbl_cmd_hash_slot[GRBL_CMD_HASH_SIZE] __rom__ = {\n%s};\n" % c_array(cmd_slots))
+
+    return {"parser_hash.h": "".join(h), "parser_hash.c": "".join(c)}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC perfect hash tables generator")
+    parser.add_argument("--check", action="store_true", help="only check if the generated files are up to date")
+    args = parser.parse_args()
+
+    outdated = False
+    for name, text in generate().items():
+        path = os.path.join(CORE, name)
+        current = open(path, "r").read() if os.path.exists(path) else None
+        if current == text:
+            continue
+        outdated = True
+        if args.check:
+            print("%s is outdated (run phash_gen.py)" % name)
+        else:
+            with open(path, "w") as f:
+                f.write(text)
+            print("%s generated" % name)
+
+    return 1 if (outdated and args.check) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
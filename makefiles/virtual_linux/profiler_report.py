@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+	Name: profiler_report.py
+	Description: Report for the µCNC cycle profiler (ENABLE_CYCLE_PROFILER).
+
+		Reads the $PRF output (captured from the serial port or the virtual MCU), converts the
+		cycles to us with the reported cycle counter clock and prints for each section the count,
+		min/avg/max, the 50th and 99th percentiles (upper bound of the histogram bucket) and the histogram.
+
+		Then checks the budgets that limit the firmware configuration
+		- step ISR: the worst mcu_step_cb + mcu_step_reset_cb time must fit in the step period at F_STEP_MAX
+		  (prints the F_STEP_MAX that keeps the step ISR below --isr-load of the CPU)
+		- main loop: the worst main loop iteration (IO + ITP + PLANNER) must be shorter than the motion
+		  buffered in the interpolator (INTERPOLATOR_BUFFER_SIZE segments of 1/INTERPOLATOR_FREQ seconds)
+		  or the step ISR runs out of segments (prints the minimum INTERPOLATOR_BUFFER_SIZE)
+
+		Returns a non zero exit code if a budget is exceeded.
+
+		Usage:
+			(printf '$X\\n$PRFR\\n'; cat ../../tests/gcode/stress-tests.nc; printf 'G4P0.1\\n$PRF\\n') | build/uCNC --sim -e eeprom > out.txt
+			./profiler_report.py out.txt --f-step-max 40000
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import math
+import sys
+
+
+def parse(data):
+    # returns the cycle counter clock and the sections of the last $PRF report
+    clock = None
+    sections = {}
+    for line in data.splitlines():
+        line = line.strip()
+        if not line.startswith("[PRF:") or not line.endswith("]"):
+            continue
+        fields = line[5:-1].split(",")
+        if len(fields) == 1:
+            clock = int(fields[0])
+            sections = {}
+        elif len(fields) >= 5:
+            count, cmin, avg, cmax = (int(v) for v in fields[1:5])
+            sections[fields[0]] = {"count": count, "min": cmin, "avg": avg, "max": cmax,
+                                   "histogram": [int(v) for v in fields[5:]]}
+    return clock, sections
+
+
+def percentile(section, p):
+    # upper bound (cycles) of the histogram bucket that holds the percentile
+    target = section["count"] * p / 100.0
+    total = 0
+    for bucket, n in enumerate(section["histogram"]):
+        total += n
+        if n and total >= target:
+            return min((1 << bucket) - 1, section["max"])
+    return section["max"]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC cycle profiler report")
+    parser.add_argument("capture", help="captured $PRF output ('-' for stdin)")
+    parser.add_argument("--f-step-max", type=float, default=40000, help="F_STEP_MAX of the build (Hz)")
+    parser.add_argument("--itp-freq", type=float, default=100, help="INTERPOLATOR_FREQ of the build (Hz)")
+    parser.add_argument("--itp-buffer", type=int, default=5, help="INTERPOLATOR_BUFFER_SIZE of the build")
+    parser.add_argument("--isr-load", type=float, default=50.0, help="maximum CPU load of the step ISR at F_STEP_MAX (%%)")
+    args = parser.parse_args()
+
+    if args.capture == "-":
+        data = sys.stdin.read()
+    else:
+        with open(args.capture, "r", errors="replace") as f:
+            data = f.read()
+
+    clock, sections = parse(data)
+    if clock is None or not sections:
+        print("no $PRF report found")
+        return 1
+
+    def us(cycles):
+        return cycles * 1e6 / clock
+
+    print("cycle counter clock %d Hz" % clock)
+    print("%-8s %10s %10s %10s %10s %10s %10s  %s" % ("section", "count", "min(us)", "avg(us)", "p50(us)", "p99(us)", "max(us)", "histogram"))
+    for name, s in sections.items():
+        if not s["count"]:
+            continue
+        histogram = " ".join("%d:%d" % (b, n) for b, n in enumerate(s["histogram"]) if n)
+        print("%-8s %10d %10.3f %10.3f %10.3f %10.3f %10.3f  %s" % (name, s["count"], us(s["min"]), us(s["avg"]),
+                                                                   us(percentile(s, 50)), us(percentile(s, 99)), us(s["max"]), histogram))
+
+    failed = False
+    zero = {"count": 0, "min": 0, "avg": 0, "max": 0, "histogram": []}
+    step = sections.get("STEP", zero)
+    reset = sections.get("STEPRST", zero)
+    if step["count"]:
+        isr = us(step["max"] + reset["max"])
+        avg = us(step["avg"] + reset["avg"])
+        period = 1e6 / args.f_step_max
+        limit = args.isr_load / 100.0 * 1e6 / isr if isr else 0
+        failed |= isr > period
+        print("step ISR     worst %.3f us avg %.3f us, step period at F_STEP_MAX %.3f us (%.1f%% load), F_STEP_MAX for %.0f%% load %.0f Hz%s" % (
+            isr, avg, period, 100.0 * avg / period, args.isr_load, limit, "  FAIL" if isr > period else ""))
+
+    loop = sum(us(sections.get(name, zero)["max"]) for name in ("IO", "ITP", "PLANNER"))
+    if loop:
+        segment = 1e6 / args.itp_freq
+        buffered = args.itp_buffer * segment
+        minimum = int(math.ceil(loop / segment)) + 1
+        failed |= loop > buffered
+        print("main loop    worst %.3f us, buffered motion %.3f us (%d segments), minimum INTERPOLATOR_BUFFER_SIZE %d%s" % (
+            loop, buffered, args.itp_buffer, minimum, "  FAIL" if loop > buffered else ""))
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
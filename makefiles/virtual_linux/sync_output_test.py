@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+"""
+	Name: sync_output_test.py
+	Description: Checks the digital outputs synchronized with the step stream (ENABLE_SYNC_OUTPUTS).
+
+		Builds the Linux virtual MCU with ENABLE_SYNC_OUTPUTS and runs random G-code programs where each motion
+		queues M62/M63 output changes at a random step position between the start and the end of the motion
+		(given in the work coordinates of a random G54 offset),
+		after a random time from the motion start or at the first step. The step/dir trace (with the output records)
+		is replayed to check that:
+		- each output change is reported once (in order) with the expected tag
+		- each position tagged output changes at the same timer tick as the step that reached the position
+		- each time tagged output changes no sooner than the delay after the motion start and at most
+		  TIME_TOLERANCE later (the virtual MCU fires them with the one shot timer)
+		- the step times are the ones of the same program without the M62/M63 commands (the motion is not stopped or split)
+		  as long as the pending changes fit in the SYNC_OUTPUT_COUNT slots (--slots, a new change waits for a free slot
+		  and the planner lookahead runs short meanwhile)
+		Prints the number of output changes, the reported latency of each tag type (from the step or the scheduled time
+		to the output change) and how late the time tagged outputs fired after the delay (reported tag - delay).
+		Returns a non zero exit code if any check fails.
+
+		Usage:
+			./sync_output_test.py [--iterations 5] [--moves 20] [--slots 32] [--seed 1]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+import itp_compare
+import trace_validate
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+AXIS = "XYZAB"
+# outputs used by the test (DOUT0 is the spindle direction and DOUT31 the activity LED)
+OUTPUTS = range(1, 31)
+# the time tags fire with the one shot timer (without it they fire in the first step ISR or RTC tick (1ms) after the delay)
+TIME_TOLERANCE = 0.00005
+
+
+def build(slots, jobs):
+    build_dir = os.path.join("build", "sync")
+    options = "-DENABLE_SYNC_OUTPUTS -DSYNC_OUTPUT_COUNT=%d" % slots
+    subprocess.run(["make", "-s", "-j%d" % jobs, "BUILD_DIR=" + build_dir, "BUILD_OPTIONS=" + options],
+                   cwd=HERE, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return os.path.join(HERE, build_dir, "uCNC")
+
+
+def settings(binary, eeprom):
+    proc = subprocess.run([binary, "--sim", "--eeprom", eeprom], input=b"$RST=*\n$SS\n$$\n", stdout=subprocess.PIPE,
+                          stderr=subprocess.DEVNULL, check=True, timeout=20)
+    return {int(k): float(v) for k, v in re.findall(r"^\$(\d+)=([-\d.]+)", proc.stdout.decode("ascii", "replace"), re.M)}
+
+
+def program(moves, step_per_mm):
+    # returns the program with and without the output commands and the expected output changes
+    # (output, value, tag type, target step position, stepper, delay in us)
+    # the simulated stream timing depends on the line count so the reference has a modal no-op line instead
+    # the program runs in a G54 work offset (whole steps) so that the position tags are converted to machine steps
+    offset = [random.randint(-1000, 1000) for _ in AXIS]
+    lines = ["$X", "G21 G90", "G10 L2 P1 " + " ".join("%s%.6f" % (AXIS[i], offset[i] / step_per_mm[i]) for i in range(len(AXIS))), "G54"]
+    ref = list(lines)
+    events = []
+    pos = [0] * len(AXIS)
+    for _ in range(moves):
+        target = list(pos)
+        for i in range(len(AXIS)):
+            if random.random() < 0.5:
+                target[i] = int(random.uniform(-5, 5) * step_per_mm[i])
+        moving = [i for i in range(len(AXIS)) if target[i] != pos[i]]
+        if not moving:
+            continue
+
+        for _ in range(random.randint(0, 2)):
+            output = OUTPUTS[len(events) % len(OUTPUTS)]
+            value = random.randint(0, 1)
+            kind = random.choice(("position", "position", "time", "first"))
+            command = "M%d P%d" % (62 if value else 63, output)
+            stepper = None
+            step = 0
+            delay = 0
+            if kind == "position":
+                stepper = random.choice(moving)
+                lo, hi = sorted((pos[stepper], target[stepper]))
+                step = random.randint(lo, hi)
+                if step == pos[stepper]:
+                    # already there (fires when the motion starts)
+                    step += 1 if target[stepper] > pos[stepper] else -1
+                command += " %s%.6f" % (AXIS[stepper], (step - offset[stepper]) / step_per_mm[stepper])
+            elif kind == "time":
+                delay = random.randint(0, 50)
+                command += " Q%d" % delay
+            lines.append(command)
+            ref.append("G21")
+            events.append((output, value, kind, step, stepper, delay * 1000))
+
+        words = " ".join("%s%.6f" % (AXIS[i], (target[i] - offset[i]) / step_per_mm[i]) for i in moving)
+        move = "G1 %s F%d" % (words, random.randint(100, 500))
+        lines.append(move)
+        ref.append(move)
+        pos = target
+    return "\n".join(lines) + "\n", "\n".join(ref) + "\n", events
+
+
+def run(binary, gcode, tmp):
+    eeprom = os.path.join(tmp, "eeprom")
+    trace = os.path.join(tmp, "trace")
+    program = os.path.join(tmp, "program.nc")
+    settings(binary, eeprom)
+    with open(program, "w") as f:
+        f.write(gcode)
+    # read from a file (the simulated stream timing depends on how the input pipe is filled)
+    with open(program, "rb") as f:
+        proc = subprocess.run([binary, "--sim", "--eeprom", eeprom, "--trace", trace], stdin=f,
+                              stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, check=True, timeout=300)
+    output = proc.stdout.decode("ascii", "replace")
+    reports = [tuple(int(v) for v in m) for m in re.findall(r"\[SYNC:(\d+),(\d+),(-?\d+),(\d+)\]", output)]
+    errors = ["error reply"] if re.search(r"^error", output, re.M) else []
+    return trace, reports, errors
+
+
+def replay(t):
+    # output records with the timer tick, the step position and the tick of the last step
+    n = t.steppers
+    pos = [0] * n
+    dirs = 0
+    last_step = None
+    base_set = False
+    outputs = []
+    for rtype, ticks, value in t.records():
+        if rtype == trace_validate.TRACE_POSITION:
+            if not base_set:
+                pos = list(value)
+                base_set = True
+        elif rtype == trace_validate.TRACE_SET_DIRS:
+            dirs = value
+        elif rtype == trace_validate.TRACE_TOGGLE_STEPS:
+            base_set = True
+            for i in range(n):
+                if value & (1 << i):
+                    pos[i] += -1 if dirs & (1 << i) else 1
+            last_step = ticks
+        elif rtype == trace_validate.TRACE_OUTPUT and (value & 0x7F) in OUTPUTS:
+            outputs.append((value & 0x7F, value >> 7, ticks, list(pos), last_step))
+    return outputs
+
+
+def check(events, reports, outputs):
+    errors = []
+    latency = {"position": [], "time": [], "first": []}
+    late = []
+    if len(reports) != len(events):
+        errors.append("%d reports for %d output changes" % (len(reports), len(events)))
+    if len(outputs) != len(events):
+        errors.append("%d traced output changes for %d output changes" % (len(outputs), len(events)))
+    # the outputs are not reused within a program (the reports of the same main loop run are in slot order)
+    for event in events:
+        report = next((r for r in reports if r[0] == event[0]), None)
+        traced = next((o for o in outputs if o[0] == event[0]), None)
+        if report is None or traced is None or report[:2] != event[:2] or traced[:2] != event[:2]:
+            errors.append("DOUT%d=%d: reported as %s and traced as %s" % (event[0], event[1], report, traced and traced[:2]))
+            continue
+        output, value, kind, step, stepper, delay = event
+        _, _, ticks, pos, last_step = traced
+        latency[kind].append(report[3])
+        if kind == "position":
+            if report[2] != step:
+                errors.append("DOUT%d: reported at step %d instead of %d" % (output, report[2], step))
+            if pos[stepper] != step or last_step != ticks:
+                errors.append("DOUT%d: traced at step %d (tick %d, last step tick %s) instead of the step %d" % (
+                    output, pos[stepper], ticks, last_step, step))
+        elif kind == "time":
+            late.append(report[2] - delay)
+            if report[2] < delay or report[2] > delay + TIME_TOLERANCE * 1e6:
+                errors.append("DOUT%d: fired %dus after the motion start instead of %dus" % (output, report[2], delay))
+        elif last_step != ticks:
+            errors.append("DOUT%d: first step change not traced with a step (tick %d, last step tick %s)" % (output, ticks, last_step))
+    return errors, latency, late
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC synchronized outputs test")
+    parser.add_argument("--iterations", type=int, default=5, help="number of random programs")
+    parser.add_argument("--moves", type=int, default=20, help="moves per program")
+    parser.add_argument("--slots", type=int, default=32, help="SYNC_OUTPUT_COUNT of the build")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parallel build jobs")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    binary = build(args.slots, args.jobs)
+    with tempfile.TemporaryDirectory() as tmp:
+        values = settings(binary, os.path.join(tmp, "eeprom"))
+    step_per_mm = [values[100 + i] for i in range(len(AXIS))]
+
+    failures = []
+    totals = {"position": [], "time": [], "first": []}
+    late = []
+    print("%3s %8s %10s  %s" % ("", "outputs", "duration", "result"))
+    for i in range(args.iterations):
+        gcode, ref_gcode, events = program(args.moves, step_per_mm)
+        with tempfile.TemporaryDirectory() as tmp:
+            trace, reports, errors = run(binary, gcode, tmp)
+            times, pos, duration = itp_compare.steps(trace_validate.Trace(trace))
+            outputs = replay(trace_validate.Trace(trace))
+        with tempfile.TemporaryDirectory() as tmp:
+            trace, _, _ = run(binary, ref_gcode, tmp)
+            ref_times, ref_pos, ref_duration = itp_compare.steps(trace_validate.Trace(trace))
+
+        result, latency, result_late = check(events, reports, outputs)
+        late += result_late
+        errors += result
+        if times != ref_times:
+            errors.append("step times differ from the program without outputs")
+        for kind in totals:
+            totals[kind] += latency[kind]
+        print("%3d %8d %9.1fs  %s" % (i, len(events), duration, "; ".join(errors) if errors else "PASS"))
+        if errors:
+            failures.append((i, gcode))
+
+    print("latency (reported, us): %s" % ", ".join(
+        "%s %d changes avg %.3f max %.3f" % (kind, len(v), sum(v) / 1000.0 / len(v), max(v) / 1000.0)
+        for kind, v in totals.items() if v))
+    if late:
+        print("time tags fired after the delay (us): avg %.1f max %d" % (sum(late) / float(len(late)), max(late)))
+    for i, gcode in failures:
+        print("iteration %d program:\n%s" % (i, gcode))
+    print("result: %s" % ("FAIL" if failures else "PASS"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+"""
+	Name: telemetry_decode.py
+	Description: Decoder for the µCNC binary frames (ENABLE_TELEMETRY and ENABLE_MOTION_SAMPLER).
+
+		Splits the captured serial output in lines, decodes the lines that start with the frame
+		start byte and checks their CRC. The text lines (ok, status reports, etc) are ignored.
+		Prints a summary of the telemetry (frames, CRC errors, dropped samples, sample rate and last sample)
+		and of the motion sampler dump ($DAQD) and optionally writes them to CSV files.
+
+		Returns a non zero exit code if a frame is corrupted.
+
+		Usage:
+			(printf '$X\\n$TLM=10\\n'; cat ../../tests/gcode/circle.nc) | build/uCNC --sim -e eeprom > out.bin
+			./telemetry_decode.py out.bin --csv samples.csv
+			(printf '$X\\n$DAQ=100,1\\nG1X5F300\\nG4P0.01\\n$DAQD\\n') | build/uCNC --sim -e eeprom > out.bin
+			./telemetry_decode.py out.bin --daq-csv daq.csv
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import struct
+import sys
+
+FRAME_START = 0xA5
+FRAME_ESC = 0xDB
+FRAME_ESC_EOL = 0xDC
+FRAME_ESC_ESC = 0xDD
+
+FRAME_TELEMETRY = 1
+FRAME_SAMPLER_HEADER = 2
+FRAME_SAMPLE = 3
+
+# proto_telemetry_t header (the step positions follow)
+HEADER = struct.Struct("<4BIf4B")
+# motion_sampler_header_t
+SAMPLER_HEADER = struct.Struct("<4BHHI")
+# motion_sampler_frame_t header and motion_sample_t (the step positions follow)
+SAMPLE = struct.Struct("<BBHIf")
+
+FLAGS = {1: "probe", 2: "alarm", 4: "check"}
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for c in data:
+        crc ^= c
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def unescape(data):
+    out = bytearray()
+    it = iter(data)
+    for c in it:
+        if c == FRAME_ESC:
+            c = next(it, None)
+            if c == FRAME_ESC_EOL:
+                c = 0x0A
+            elif c == FRAME_ESC_ESC:
+                c = FRAME_ESC
+            else:
+                return None
+        out.append(c)
+    return bytes(out)
+
+
+def decode(line):
+    # returns the frame payload or None if the frame is corrupted
+    data = unescape(line[1:])
+    if data is None or len(data) < 3:
+        return None
+    payload, crc = data[:-2], struct.unpack("<H", data[-2:])[0]
+    if crc16(payload) != crc:
+        return None
+    return payload
+
+
+def telemetry(payload):
+    ftype, seq, steppers, state, millis, feed, limits, controls, flags, _ = HEADER.unpack_from(payload)
+    if len(payload) != HEADER.size + 4 * steppers:
+        return None
+    steps = list(struct.unpack_from("<%di" % steppers, payload, HEADER.size))
+    return {"seq": seq, "millis": millis, "state": state, "feed": feed, "limits": limits,
+            "controls": controls, "flags": flags, "steps": steps}
+
+
+def sampler_header(payload):
+    if len(payload) != SAMPLER_HEADER.size:
+        return None
+    _, steppers, trigger, _, count, trigger_index, period = SAMPLER_HEADER.unpack(payload)
+    return {"steppers": steppers, "trigger": trigger, "count": count, "trigger_index": trigger_index, "period": period}
+
+
+def sample(payload):
+    _, _, index, micros, feed = SAMPLE.unpack_from(payload)
+    steppers = (len(payload) - SAMPLE.size) // 4
+    return {"index": index, "micros": micros, "feed": feed,
+            "steps": list(struct.unpack_from("<%di" % steppers, payload, SAMPLE.size))}
+
+
+def frames(data):
+    for line in data.split(b"\n"):
+        if line and line[0] == FRAME_START:
+            yield line
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC binary frame decoder")
+    parser.add_argument("capture", help="captured serial output ('-' for stdin)")
+    parser.add_argument("--csv", help="writes the telemetry samples to this CSV file")
+    parser.add_argument("--daq-csv", help="writes the motion sampler dump to this CSV file (time relative to the trigger)")
+    args = parser.parse_args()
+
+    if args.capture == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+
+    samples = []
+    header = None
+    daq = []
+    errors = 0
+    for line in frames(data):
+        payload = decode(line)
+        ftype = payload[0] if payload else None
+        if ftype == FRAME_TELEMETRY:
+            value = telemetry(payload)
+            if value is not None:
+                samples.append(value)
+                continue
+        elif ftype == FRAME_SAMPLER_HEADER:
+            header = sampler_header(payload)
+            daq = []
+            if header is not None:
+                continue
+        elif ftype == FRAME_SAMPLE and header is not None:
+            daq.append(sample(payload))
+            continue
+        errors += 1
+
+    dropped = 0
+    for prev, cur in zip(samples, samples[1:]):
+        dropped += (cur["seq"] - prev["seq"] - 1) & 0xFF
+
+    print("telemetry frames %d" % len(samples))
+    print("corrupted        %d" % errors)
+    print("dropped samples  %d" % dropped)
+    if len(samples) > 1:
+        span = samples[-1]["millis"] - samples[0]["millis"]
+        intervals = [b["millis"] - a["millis"] for a, b in zip(samples, samples[1:])]
+        if span > 0:
+            print("sample rate      %.1f Hz (interval %d-%d ms)" % (1000.0 * (len(samples) - 1) / span, min(intervals), max(intervals)))
+    if samples:
+        last = samples[-1]
+        flags = ",".join(name for bit, name in FLAGS.items() if last["flags"] & bit)
+        print("last sample      %d ms state 0x%02x feed %.3f limits 0x%02x controls 0x%02x flags [%s]" % (
+            last["millis"], last["state"], last["feed"], last["limits"], last["controls"], flags))
+        print("last position    %s" % " ".join(str(s) for s in last["steps"]))
+
+    if header is not None:
+        if len(daq) != header["count"] or any(s["index"] != i for i, s in enumerate(daq)):
+            print("sampler dump incomplete (%d of %d samples)" % (len(daq), header["count"]))
+            errors += 1
+        print("sampler samples  %d (period %d us, trigger %d at sample %d)" % (
+            len(daq), header["period"], header["trigger"], header["trigger_index"]))
+        if len(daq) > 1:
+            intervals = [b["micros"] - a["micros"] for a, b in zip(daq, daq[1:])]
+            print("sampler interval %d-%d us, %.3f ms recorded" % (min(intervals), max(intervals),
+                                                                  (daq[-1]["micros"] - daq[0]["micros"]) / 1000.0))
+
+    if args.daq_csv and header is not None:
+        with open(args.daq_csv, "w") as f:
+            count = len(daq[0]["steps"]) if daq else 0
+            trigger = daq[header["trigger_index"]]["micros"] if header["trigger_index"] < len(daq) else 0
+            f.write("index,t_us,feed,%s\n" % ",".join("step%d" % i for i in range(count)))
+            for s in daq:
+                t = (s["micros"] - trigger) & 0xFFFFFFFF
+                t = t - 0x100000000 if t & 0x80000000 else t
+                f.write("%d,%d,%.3f,%s\n" % (s["index"], t, s["feed"], ",".join(str(v) for v in s["steps"])))
+
+    if args.csv:
+        with open(args.csv, "w") as f:
+            count = len(samples[0]["steps"]) if samples else 0
+            f.write("seq,millis,state,feed,limits,controls,flags,%s\n" % ",".join("step%d" % i for i in range(count)))
+            for s in samples:
+                f.write("%d,%d,%d,%.3f,%d,%d,%d,%s\n" % (s["seq"], s["millis"], s["state"], s["feed"], s["limits"],
+                                                        s["controls"], s["flags"], ",".join(str(v) for v in s["steps"])))
+
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+"""
+	Name: trace_validate.py
+	Description: Offline validator for the µCNC step/dir binary trace (Linux virtual MCU --trace option).
+
+		Reconstructs the position of each stepper from the step/dir records and
+		- checks it against the real-time step position checkpoints (itp_rt_step_pos)
+		- estimates velocity, acceleration and jerk while moving (finite differences of the position
+		  sampled on a uniform grid over a smoothing window) and the start/stop speed
+		- flags violations of the max rate ($110-$11x) and acceleration ($120-$12x) settings
+		- reports the step timing jitter against the ideal step times (local quadratic fit)
+		- reports the minimum step pulse width and dir to step setup time
+
+		Returns a non zero exit code if any violation is found (can be used as a regression gate).
+
+		Usage: ./trace_validate.py trace.bin [--window 50] [--stop 15] [--tolerance 0.05]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import bisect
+import collections
+import math
+import struct
+import sys
+
+TRACE_SET_STEPS = 1
+TRACE_TOGGLE_STEPS = 2
+TRACE_SET_DIRS = 3
+TRACE_POSITION = 4
+TRACE_OUTPUT = 5
+
+
+class Trace:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        self.offset = 0
+        if self.data[:4] != b"UCTR":
+            raise ValueError("not a µCNC step trace")
+        self.version, self.steppers, self.step_invert, self.dir_invert = struct.unpack_from("<4B", self.data, 4)
+        self.clock = struct.unpack_from("<I", self.data, 8)[0]
+        self.offset = 12
+        self.step_per_mm = []
+        self.max_rate = []
+        self.acceleration = []
+        for _ in range(self.steppers):
+            spm, rate, accel = struct.unpack_from("<3f", self.data, self.offset)
+            self.offset += 12
+            self.step_per_mm.append(spm)
+            self.max_rate.append(rate)
+            self.acceleration.append(accel)
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            c = self.data[self.offset]
+            self.offset += 1
+            value |= (c & 0x7F) << shift
+            shift += 7
+            if not (c & 0x80):
+                return value
+
+    def records(self):
+        ticks = 0
+        while self.offset < len(self.data):
+            rtype = self.data[self.offset]
+            self.offset += 1
+            ticks += self.varint()
+            if rtype == TRACE_POSITION:
+                pos = []
+                for _ in range(self.steppers):
+                    v = self.varint()
+                    pos.append((v >> 1) ^ -(v & 1))
+                yield rtype, ticks, pos
+            else:
+                mask = self.data[self.offset]
+                self.offset += 1
+                yield rtype, ticks, mask
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p * len(values)))]
+
+
+def analyse(trace, args):
+    n = trace.steppers
+    # per stepper step events (time in seconds, position after the step)
+    steps = [[] for _ in range(n)]
+    pos = [0] * n
+    dirs = 0
+    step_level = trace.step_invert
+    last_step_edge = [None] * n
+    last_dir_change = [None] * n
+    min_pulse = [math.inf] * n
+    min_setup = [math.inf] * n
+    double_steps = [0] * n
+    pos_mismatch = 0
+    pos_checks = 0
+    first_mismatch = None
+    base_set = False
+    inv_clock = 1.0 / trace.clock
+
+    for rtype, ticks, value in trace.records():
+        t = ticks * inv_clock
+        if rtype == TRACE_POSITION:
+            if not base_set:
+                # initial position
+                pos = list(value)
+                base_set = True
+                continue
+            pos_checks += 1
+            if pos != value:
+                pos_mismatch += 1
+                if first_mismatch is None:
+                    first_mismatch = (t, list(pos), list(value))
+                # resyncs with the firmware position
+                pos = list(value)
+        elif rtype == TRACE_SET_DIRS:
+            changed = dirs ^ value
+            for i in range(n):
+                if changed & (1 << i):
+                    last_dir_change[i] = t
+            dirs = value
+        elif rtype == TRACE_TOGGLE_STEPS:
+            if not base_set:
+                base_set = True
+            for i in range(n):
+                bit = 1 << i
+                if value & bit:
+                    if (step_level ^ trace.step_invert) & bit:
+                        double_steps[i] += 1
+                    pos[i] += -1 if (dirs & bit) else 1
+                    steps[i].append((t, pos[i]))
+                    last_step_edge[i] = t
+                    if last_dir_change[i] is not None:
+                        min_setup[i] = min(min_setup[i], t - last_dir_change[i])
+                        last_dir_change[i] = None
+            step_level ^= value
+        elif rtype == TRACE_SET_STEPS:
+            for i in range(n):
+                bit = 1 << i
+                if ((step_level ^ value) & bit) and ((value ^ trace.step_invert) & bit) == 0 and last_step_edge[i] is not None:
+                    min_pulse[i] = min(min_pulse[i], t - last_step_edge[i])
+            step_level = value
+
+    failed = False
+    print("trace: %d steppers, timer clock %d Hz, %d position checkpoints" % (n, trace.clock, pos_checks))
+    if pos_mismatch:
+        failed = True
+        t, rec, fw = first_mismatch
+        print("POSITION MISMATCH: %d checkpoints differ from itp_rt_step_pos (first at %.6fs: trace %s, firmware %s)" % (pos_mismatch, t, rec, fw))
+    else:
+        print("position: reconstructed step position matches itp_rt_step_pos")
+
+    window = args.window / 1000.0
+    grid = args.grid / 1000.0
+    stop = args.stop / 1000.0
+    print("%-3s %9s %10s %10s %10s %10s %10s %10s %9s %9s %9s %9s %9s" % (
+        "stp", "steps", "vmax", "rate", "vstart", "amax", "accel", "jmax", "jit_rms", "jit_p99", "jit_max", "pulse", "setup"))
+    print("%-3s %9s %10s %10s %10s %10s %10s %10s %9s %9s %9s %9s %9s" % (
+        "", "", "mm/min", "$11x", "mm/min", "mm/s^2", "$12x", "mm/s^3", "us", "us", "us", "us", "us"))
+
+    for i in range(n):
+        ev = steps[i]
+        spm = trace.step_per_mm[i] if trace.step_per_mm[i] else 1.0
+        if not ev:
+            continue
+
+        # position on a uniform grid (linear interpolation between step events)
+        times = [e[0] for e in ev]
+        positions = [e[1] for e in ev]
+        t0 = times[0] - window
+        t1 = times[-1] + window
+        count = int((t1 - t0) / grid) + 1
+        sampled = []
+        moving = []
+        # step interval around each sample (the linear interpolation error between steps grows with it)
+        gaps = []
+        j = 0
+        for k in range(count):
+            t = t0 + k * grid
+            while j < len(times) and times[j] <= t:
+                j += 1
+            if j == 0:
+                sampled.append(positions[0] - (positions[1] - positions[0] if len(positions) > 1 else 1))
+                moving.append(False)
+                gaps.append(0.0)
+            elif j == len(times):
+                sampled.append(positions[-1])
+                moving.append(False)
+                gaps.append(0.0)
+            else:
+                ta, tb = times[j - 1], times[j]
+                pa, pb = positions[j - 1], positions[j]
+                # holds the position until the next step if the gap is larger than the stop interval
+                if tb - ta > stop:
+                    sampled.append(pa)
+                    moving.append(False)
+                    gaps.append(0.0)
+                else:
+                    sampled.append(pa + (pb - pa) * (t - ta) / (tb - ta))
+                    moving.append(True)
+                    gaps.append(tb - ta)
+
+        # the derivatives are only evaluated while moving
+        # (the start/stop speed is a velocity step and is reported separately)
+        w = max(1, int(round(window / grid)))
+        h = w * grid
+        still = [0] * (count + 1)
+        for k in range(count):
+            still[k + 1] = still[k] + (0 if moving[k] else 1)
+        # allowance for the step quantization of the second difference
+        # the position rebuilt between two steps of a motion at the acceleration limit is off by at most a * dt^2 / 8
+        # (dt is the step interval, so the step size over the speed) and the second difference adds 4 of these over h^2
+        accel = trace.acceleration[i] * spm
+        accel_excess = 0.0
+        gap_max = collections.deque()
+        vmax = amax = jmax = 0.0
+        for n in range(count):
+            # largest step interval of the samples n - 2w to n (the window of the sample k = n - w)
+            while gap_max and gaps[gap_max[-1]] <= gaps[n]:
+                gap_max.pop()
+            gap_max.append(n)
+            if gap_max[0] < n - 2 * w:
+                gap_max.popleft()
+            k = n - w
+            if k < 2 * w or k >= count - 2 * w:
+                continue
+            if still[k + w + 1] - still[k - w]:
+                continue
+            v = (sampled[k + w] - sampled[k - w]) / (2 * h)
+            a = (sampled[k + w] - 2 * sampled[k] + sampled[k - w]) / (h * h)
+            vmax = max(vmax, abs(v))
+            amax = max(amax, abs(a))
+            dt = gaps[gap_max[0]]
+            accel_excess = max(accel_excess, abs(a) - accel * (1 + args.tolerance + dt * dt / (2 * h * h)))
+            if still[k + 2 * w + 1] - still[k - 2 * w]:
+                continue
+            jk = (sampled[k + 2 * w] - 2 * sampled[k + w] + 2 * sampled[k - w] - sampled[k - 2 * w]) / (2 * h * h * h)
+            jmax = max(jmax, abs(jk))
+
+        # start/stop speed (first step interval after a stop or last before a stop)
+        vjump = 0.0
+        for k in range(1, len(times)):
+            dt = times[k] - times[k - 1]
+            if dt <= stop and ((k == 1) or (times[k - 1] - times[k - 2]) > stop or (k == len(times) - 1) or (times[k + 1] - times[k]) > stop):
+                vjump = max(vjump, 1.0 / dt)
+
+        vmax_mm = vmax / spm * 60.0
+        vjump_mm = vjump / spm * 60.0
+        amax_mm = amax / spm
+        jmax_mm = jmax / spm
+        # allowance for the step quantization of the finite differences
+        rate_limit = trace.max_rate[i] * (1 + args.tolerance) + 60.0 / (spm * h)
+
+        # jitter against the ideal step times
+        # (5 point quadratic Savitzky-Golay fit of the step times of continuous motion in the same direction)
+        jitter = []
+        for k in range(2, len(ev) - 2):
+            if (times[k + 2] - times[k - 2]) < window and abs(positions[k + 2] - positions[k - 2]) == 4:
+                ideal = (-3 * times[k - 2] + 12 * times[k - 1] + 17 * times[k] + 12 * times[k + 1] - 3 * times[k + 2]) / 35.0
+                jitter.append(abs(times[k] - ideal))
+        jit_rms = math.sqrt(sum(x * x for x in jitter) / len(jitter)) if jitter else 0
+        jit_p99 = percentile(jitter, 0.99)
+        jit_max = max(jitter) if jitter else 0
+
+        flags = []
+        if vmax_mm > rate_limit:
+            flags.append("RATE")
+        if accel_excess > 0:
+            flags.append("ACCEL")
+        if double_steps[i]:
+            flags.append("DOUBLE STEP x%d" % double_steps[i])
+        if args.max_jitter is not None and jit_max * 1e6 > args.max_jitter:
+            flags.append("JITTER")
+        if flags:
+            failed = True
+
+        print("%-3d %9d %10.2f %10.2f %10.2f %10.2f %10.2f %10.1f %9.2f %9.2f %9.2f %9.2f %9.2f %s" % (
+            i, len(ev), vmax_mm, trace.max_rate[i], vjump_mm, amax_mm, trace.acceleration[i], jmax_mm,
+            jit_rms * 1e6, jit_p99 * 1e6, jit_max * 1e6,
+            min_pulse[i] * 1e6 if min_pulse[i] != math.inf else 0,
+            min_setup[i] * 1e6 if min_setup[i] != math.inf else 0,
+            " ".join(flags)))
+
+    print("result: %s" % ("FAIL" if failed else "PASS"))
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC step/dir trace validator")
+    parser.add_argument("trace", help="binary trace file (uCNC --trace)")
+    parser.add_argument("--window", type=float, default=50.0, help="smoothing window for the derivatives (ms)")
+    parser.add_argument("--stop", type=float, default=15.0, help="step interval above which the stepper is considered stopped (ms)")
+    parser.add_argument("--grid", type=float, default=1.0, help="position sampling grid (ms)")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="allowed relative excess over the rate/acceleration settings")
+    parser.add_argument("--max-jitter", type=float, default=None, help="fail if the step timing jitter exceeds this value (us)")
+    args = parser.parse_args()
+    return analyse(Trace(args.trace), args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+"""
+	Name: window_sender.py
+	Description: Reference G-code sender for the µCNC windowed streaming protocol (ENABLE_WINDOWED_STREAMING).
+
+		Reads the RX buffer size with $WIN, switches the protocol on with $WIN=<batch> and streams the files
+		keeping the RX buffer full (character counting): a line is sent as soon as the bytes of all unacked
+		lines plus the new line fit in the RX buffer. Each line is prefixed with @<seq> (unless --no-seq)
+		and each ack (ok:<seq>,<free RX>,<free blocks> or error:<code>,<seq>,<free RX>,<free blocks>)
+		releases all lines up to seq.
+
+		With --ping the files are sent the classic way (one line, wait for its ok) for comparison.
+
+		Prints the number of lines, the elapsed time, the achieved lines/s, the number of acks
+		(lines per ack), the free planner blocks reported in the acks and the lines that failed.
+		Returns a non zero exit code if any line failed.
+
+		The sender talks to a serial port (--port, needs pyserial) or runs the Linux virtual MCU
+		(default, realtime unless --sim). --latency delays every received line to emulate the
+		USB/OS latency of a real host.
+
+		Examples:
+			./window_sender.py --unlock ../../tests/gcode/stress-tests.nc
+			./window_sender.py --unlock --latency 2 --ping ../../tests/gcode/stress-tests.nc
+			./window_sender.py --port /dev/ttyUSB0 --baud 115200 --batch 8 part.nc
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+"""
+
+import argparse
+import collections
+import os
+import queue
+import subprocess
+import sys
+import threading
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+class SimLink:
+    # the Linux virtual MCU on stdin/stdout
+    def __init__(self, binary, eeprom, sim):
+        if not os.path.exists(eeprom):
+            subprocess.run([binary, "--sim", "--eeprom", eeprom], input=b"$RST=*\n$SS\n",
+                           stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True)
+        args = [binary, "--eeprom", eeprom] + (["--sim"] if sim else [])
+        self.proc = subprocess.Popen(args, stdin=subprocess.PIPE, stdout=subprocess.PIPE, bufsize=0)
+
+    def write(self, data):
+        self.proc.stdin.write(data)
+
+    def readline(self):
+        return self.proc.stdout.readline()
+
+    def close(self):
+        self.proc.stdin.close()
+        self.proc.wait()
+
+
+class SerialLink:
+    def __init__(self, port, baud):
+        import serial
+        self.port = serial.Serial(port, baud, timeout=0.1)
+
+    def write(self, data):
+        self.port.write(data)
+
+    def readline(self):
+        # returns only complete lines (b"" is end of stream)
+        line = b""
+        while not line.endswith(b"\n"):
+            line += self.port.readline()
+        return line
+
+    def close(self):
+        self.port.close()
+
+
+class Receiver:
+    # reads the lines in a thread and delivers them after the emulated host latency
+    def __init__(self, link, latency):
+        self.lines = queue.Queue()
+        self.latency = latency
+        self.thread = threading.Thread(target=self.run, args=(link,), daemon=True)
+        self.thread.start()
+
+    def run(self, link):
+        while True:
+            line = link.readline()
+            if not line:
+                self.lines.put((time.monotonic(), None))
+                return
+            self.lines.put((time.monotonic(), line.decode("ascii", "replace").strip()))
+
+    def get(self, timeout=None):
+        try:
+            stamp, line = self.lines.get(timeout=timeout)
+        except queue.Empty:
+            return ""
+        delay = stamp + self.latency - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        if line is None:
+            raise EOFError("link closed")
+        return line
+
+
+def read_lines(files):
+    lines = []
+    for name in files:
+        with open(name, "r", errors="replace") as f:
+            for line in f:
+                line = line.strip()
+                if line:
+                    lines.append(line)
+    return lines
+
+
+def command(link, rx, cmd, verbose):
+    # sends a command in plain mode and returns the output lines up to its ok/error
+    link.write((cmd + "\n").encode("ascii"))
+    output = []
+    while True:
+        line = rx.get(timeout=5)
+        if verbose and line:
+            print(line)
+        if line == "ok" or line.startswith("error:"):
+            return output, line
+        output.append(line)
+
+
+def stream_window(link, rx, lines, batch, use_seq, verbose):
+    output, result = command(link, rx, "$WIN", verbose)
+    info = [line for line in output if line.startswith("[WIN:")]
+    if result != "ok" or not info:
+        raise RuntimeError("windowed streaming not supported (%s)" % result)
+    capacity, blocks = (int(v) for v in info[0][5:-1].split(",")[1:3])
+
+    stats = {"acks": 0, "errors": [], "blocks": [], "rx": []}
+    inflight = collections.deque()
+    used = 0
+
+    def ack(line):
+        nonlocal used
+        if line.startswith("ok:"):
+            code = 0
+            fields = line[3:].split(",")
+        elif line.startswith("error:") and line.count(",") == 3:
+            fields = line[6:].split(",")
+            code = int(fields.pop(0))
+        else:
+            if verbose and line:
+                print(line)
+            return
+        seq, free_rx, free_blocks = (int(v) for v in fields)
+        stats["acks"] += 1
+        stats["rx"].append(free_rx)
+        stats["blocks"].append(free_blocks)
+        while inflight:
+            sent_seq, size, text = inflight.popleft()
+            used -= size
+            if sent_seq == seq:
+                if code:
+                    stats["errors"].append((seq, code, text))
+                break
+
+    def send(seq, text):
+        nonlocal used
+        data = (("@%d" % seq) if use_seq else "") + text + "\n"
+        size = len(data)
+        # character counting (keeps the RX buffer full)
+        while inflight and used + size > capacity:
+            ack(rx.get())
+        link.write(data.encode("ascii"))
+        inflight.append((seq, size, text))
+        used += size
+
+    # the $WIN line is line 0 (sent without sequence number)
+    start = time.monotonic()
+    inflight.append((0, len("$WIN=%d\n" % batch), "$WIN=%d" % batch))
+    used = inflight[0][1]
+    link.write(("$WIN=%d\n" % batch).encode("ascii"))
+    seq = 1
+    for text in lines:
+        send(seq, text)
+        seq = (seq + 1) & 0xFFFF
+        # consumes the acks already received
+        while not rx.lines.empty():
+            ack(rx.get())
+    while inflight:
+        ack(rx.get())
+    elapsed = time.monotonic() - start
+
+    # back to one ok per line
+    command(link, rx, "$WIN=0", verbose)
+    stats["capacity"] = capacity
+    stats["planner"] = blocks
+    return elapsed, stats
+
+
+def stream_ping(link, rx, lines, verbose):
+    stats = {"acks": 0, "errors": [], "blocks": [], "rx": []}
+    start = time.monotonic()
+    for seq, text in enumerate(lines, 1):
+        _, result = command(link, rx, text, verbose)
+        stats["acks"] += 1
+        if result != "ok":
+            stats["errors"].append((seq, int(result[6:]), text))
+    return time.monotonic() - start, stats
+
+
+def main():
+    parser = argparse.ArgumentParser(description="µCNC windowed streaming sender")
+    parser.add_argument("files", nargs="+", help="G-code files")
+    parser.add_argument("--port", help="serial port (default: run the Linux virtual MCU)")
+    parser.add_argument("--baud", type=int, default=115200, help="serial port baud rate")
+    parser.add_argument("--binary", default=os.path.join(HERE, "build", "uCNC"), help="virtual MCU binary")
+    parser.add_argument("--eeprom", default=os.path.join(HERE, "build", "window.eeprom"), help="virtual MCU EEPROM file")
+    parser.add_argument("--sim", action="store_true", help="run the virtual MCU on simulated time")
+    parser.add_argument("--batch", type=int, default=8, help="acks are coalesced up to this number of lines")
+    parser.add_argument("--no-seq", action="store_true", help="do not prefix the lines with @<seq>")
+    parser.add_argument("--ping", action="store_true", help="send one line and wait for its ok (no window)")
+    parser.add_argument("--latency", type=float, default=0, help="emulated host latency of each received line (ms)")
+    parser.add_argument("--unlock", action="store_true", help="send $X before streaming")
+    parser.add_argument("--verbose", action="store_true", help="print the controller output")
+    args = parser.parse_args()
+
+    lines = read_lines(args.files)
+    if args.port:
+        link = SerialLink(args.port, args.baud)
+    else:
+        link = SimLink(args.binary, args.eeprom, args.sim)
+    rx = Receiver(link, args.latency / 1000.0)
+
+    # waits for the welcome message and the startup blocks
+    deadline = time.monotonic() + 5
+    while time.monotonic() < deadline:
+        line = rx.get(timeout=0.2)
+        if line.startswith("Grbl"):
+            deadline = time.monotonic() + 0.2
+    if args.unlock:
+        command(link, rx, "$X", args.verbose)
+
+    try:
+        if args.ping:
+            elapsed, stats = stream_ping(link, rx, lines, args.verbose)
+        else:
+            elapsed, stats = stream_window(link, rx, lines, args.batch, not args.no_seq, args.verbose)
+    finally:
+        link.close()
+
+    print("%s: %d lines in %.3f s, %.1f lines/s, %d acks (%.2f lines/ack)" % (
+        "ping" if args.ping else "window", len(lines), elapsed, len(lines) / elapsed if elapsed else 0,
+        stats["acks"], len(lines) / stats["acks"] if stats["acks"] else 0))
+    if stats["blocks"]:
+        print("RX buffer %d bytes, min free %d; planner %d blocks, min free %d, avg free %.1f" % (
+            stats["capacity"], min(stats["rx"]), stats["planner"], min(stats["blocks"]),
+            sum(stats["blocks"]) / len(stats["blocks"])))
+    for seq, code, text in stats["errors"]:
+        print("line %d error:%d %s" % (seq, code, text))
+
+    return 1 if stats["errors"] else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -59,3 +59,8 @@ $#<_value_returned>
 $#<_task>
 $#<_call_level>
 $#<_remap_level>
+$#<_nope>
+$#<_X>
+$#<_vmajo>
+$#<_vmajorx>
+$#<_abs_>
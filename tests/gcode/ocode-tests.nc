@@ -0,0 +1,7 @@
+(O-code subroutines, run with the virtual MCU file system mounted on the ocodes directory)
+O300 CALL [500]
+O100 CALL [10]
+O100 CALL [4]
+G0 X#4
+G0 X0 Y0 Z0
+$#4
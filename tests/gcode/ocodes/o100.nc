@@ -0,0 +1,16 @@
+(alternates X and Y moves #1 times)
+#2 = 0
+O101 WHILE [#2 LT #1]
+O102 IF [[#2 MOD 2] EQ 0]
+G1 X[#2] F2000
+O102 ELSE
+G1 Y[#2] F2000
+O102 ENDIF
+#2 = [#2 + 1]
+O101 ENDWHILE
+O103 REPEAT [3]
+G91 G1 Z0.1 F500
+O103 ENDREPEAT
+G90
+O200 CALL [#2]
+O100 ENDSUB
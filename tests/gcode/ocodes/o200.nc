@@ -0,0 +1,7 @@
+; returns to the origin after long runs
+O201 IF [#1 GT 5]
+G0 X0 Y0
+O201 ELSE
+G0 Z0
+O201 ENDIF
+O200 ENDSUB
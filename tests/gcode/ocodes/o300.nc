@@ -0,0 +1,17 @@
+(parser load: #1 iterations of expressions without motion)
+#3 = 0
+#4 = 0
+O301 WHILE [#3 LT #1]
+#4 = [#4 + SIN[#3] * COS[#3] + SQRT[#3 + 1]]
+O302 IF [#4 GT 1000]
+#4 = 0
+O302 ENDIF
+O303 IF [[#3 MOD 7] EQ 0]
+(skipped block of the if)
+#5 = [#3 / 7]
+#6 = [#5 * 2]
+#7 = [#6 + #5]
+O303 ENDIF
+#3 = [#3 + 1]
+O301 ENDWHILE
+O300 ENDSUB
@@ -37,6 +37,9 @@ extern "C"
 #define DIR3_PORT B
 #define DIR4_BIT 2
 #define DIR4_PORT A
+// the step/dir pins are on ports B and A (DMA step engine)
+#define STEP_DMA_PORT0 B
+#define STEP_DMA_PORT1 A
 #define STEP0_EN_BIT 12
 #define STEP0_EN_PORT B
 #define STEP1_EN_BIT 8
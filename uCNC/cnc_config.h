@@ -35,6 +35,38 @@ extern "C"
 #define BAUDRATE 115200
 #endif
 
+	/**
+	 * Large stream buffers
+	 * Uncomment to enable. Uses 16-bit ring buffer and stream indexes so that the RX buffer (RX_BUFFER_CAPACITY)
+	 * and the HAL TX buffers (UART_TX_BUFFER_SIZE, USB_TX_BUFFER_SIZE, etc...) can hold several kB and a fast
+	 * sender can keep many short lines queued. Without it the buffers are limited to 255 bytes.
+	 * */
+
+	// #define ENABLE_LARGE_STREAM_BUFFERS
+	// #define RX_BUFFER_CAPACITY 1024
+
+	/**
+	 * Stream bulk read
+	 * Uncomment to enable. The main protocol reads each line from the RX buffer with a single call
+	 * (on MCUs that implement mcu_<stream>_read and for files run from the file system) into a
+	 * GRBL_STREAM_LINE_SIZE line buffer instead of one locked dequeue per char.
+	 * */
+
+	// #define ENABLE_STREAM_BULK_READ
+	// #define GRBL_STREAM_LINE_SIZE 128
+
+	/**
+	 * Windowed streaming
+	 * Uncomment to enable. $WIN=<n> switches the protocol to batched acks that carry the line sequence number,
+	 * the free RX bytes and the free planner blocks, so that the host can keep the RX buffer full
+	 * (character counting) instead of waiting for an ok per line. $WIN=0 switches back.
+	 * See interface/grbl_protocol.h and makefiles/virtual_linux/window_sender.py.
+	 * */
+
+	// #define ENABLE_WINDOWED_STREAMING
+	// #define GRBL_WINDOW_MAX_BATCH 32
+	// #define GRBL_WINDOW_ACK_TIMEOUT 10
+
 #ifndef ENABLE_WIFI
 // #define ENABLE_WIFI
 #endif
@@ -108,6 +140,125 @@ extern "C"
 
 	// #define ENABLE_PARSING_TIME_DEBUG
 
+	/**
+	 * Cycle profiler
+	 * Uncomment to enable. Measures mcu_step_cb, mcu_step_reset_cb, mcu_rtc_cb, itp_run, planner_recalculate,
+	 * cnc_io_dotasks and the parser with the MCU cycle counter (DWT CYCCNT on the STM32F1, the host clock on the
+	 * virtual MCU and mcu_micros on MCUs without a cycle counter) and keeps the min/avg/max and a log2 histogram
+	 * of each section. $PRF prints the results and $PRFR resets them. See core/cycle_profiler.h.
+	 * */
+
+	// #define ENABLE_CYCLE_PROFILER
+	// #define CYCLE_PROFILER_BUCKETS 20
+
+	/**
+	 * Step/dir output trace
+	 * Uncomment to enable. Adds hooks to the step/dir outputs and to the real-time step position
+	 * that a step recorder can attach to (used by the Linux virtual MCU --trace option)
+	 * */
+
+	// #define ENABLE_STEP_TRACE
+
+	/**
+	 * Pre-compiled binary motion stream
+	 * Uncomment to enable. Lines starting with ':' are executed as binary motion frames
+	 * (compiled on the host by makefiles/virtual_linux/gcode_compile.py) directly in motion control,
+	 * skipping the G-code parser. See core/motion_stream.h for the frame format.
+	 * */
+
+	// #define ENABLE_MOTION_STREAM
+
+	/**
+	 * Binary telemetry
+	 * Uncomment to enable. $TLM=<ms> makes the RTC tick sample the realtime step position, feed, state,
+	 * limits and controls every <ms> milliseconds ($TLM=0 disables it). Samples are sent as compact
+	 * binary frames between the text messages without any float to ASCII conversion.
+	 * See interface/grbl_protocol.h for the frame format and makefiles/virtual_linux/telemetry_decode.py for a decoder.
+	 * */
+
+	// #define ENABLE_TELEMETRY
+
+	/**
+	 * Motion sampler
+	 * Uncomment to enable. Records the realtime step position and segment feed at a fixed rate (down to tens of us)
+	 * into a RAM ring buffer of MOTION_SAMPLER_SIZE samples around a trigger (DIN edge, motion start or command).
+	 * Armed with $DAQ=<period us>,<trigger>[,<pretrigger samples>[,<DIN>]] and dumped with $DAQD.
+	 * See core/motion_sampler.h for the commands. Not compatible with ENABLE_STEP_DMA.
+	 * */
+
+	// #define ENABLE_MOTION_SAMPLER
+	// #define MOTION_SAMPLER_SIZE 128
+
+	/**
+	 * DMA step engine
+	 * Uncomment to enable. The step ISR callbacks are executed from the main loop and their step/dir outputs
+	 * are written to a buffer that the MCU plays out to the step/dir ports via DMA at a fixed slot rate
+	 * (STEP_DMA_FREQ, 250kHz by default), removing the per step interrupt. Needs MCU support (STM32F1 and the Linux virtual MCU).
+	 * The reported step position runs ahead of the outputs by up to the buffer length (STEP_DMA_BUFFER_SIZE slots)
+	 * and a buffer that is not refilled in time raises alarm 15. See hal/mcus/step_dma.h.
+	 * */
+
+	// #define ENABLE_STEP_DMA
+
+	/**
+	 * Flash key/value settings store
+	 * Uncomment to enable. The flash emulated EEPROM is stored as an append only log of FLASH_KV_BLOCK_SIZE blocks
+	 * over two flash banks instead of erasing and rewriting the page on every save. A setting change programs a few
+	 * halfwords and the banks are only erased when the log is full (compaction). Each save is committed
+	 * on flush, so a power fail during a save keeps the previous settings.
+	 * Needs MCU support (STM32F1 and the Linux virtual MCU). The settings are reset on the first boot. See hal/mcus/flash_kv.h.
+	 * */
+
+	// #define ENABLE_FLASH_KV
+	// #define FLASH_KV_BLOCK_SIZE 8
+
+	/**
+	 * Dual core motion
+	 * Uncomment to enable. The second core (the motion core) runs the interpolator and services the step ISR while
+	 * the main core runs the protocol, parser, motion control and planner. The planned blocks are handed off to the
+	 * motion core through a lock-free ring of PLANNER_HANDOFF_SIZE blocks, so parsing and status reports never delay
+	 * the segment refill. Needs MCU support (RP2040 and the Linux virtual MCU, with a thread per core).
+	 * Not compatible with ENABLE_STEP_DMA and ENABLE_MOTION_CONTROL_PLANNER_HIJACKING.
+	 * */
+
+	// #define ENABLE_DUAL_CORE_MOTION
+	// #define PLANNER_HANDOFF_SIZE 4
+
+	/**
+	 * Duty cycle limit
+	 * Uncomment to enable. Keeps a heat model of each stepper from the interpolator step activity and holds each new
+	 * motion in motion control only until the steppers it moves have cooled enough to run it (motions longer than the
+	 * on time budget are split in inline blocks). $150+ sets the on time budget and $160+ the cooling time of each
+	 * stepper in seconds (0 disables the limit). The status report shows the remaining budget of each stepper (|Dc:)
+	 * and the cooling wait (|Dw:). The model starts cold at power on. See core/duty_cycle.h.
+	 * */
+
+	// #define ENABLE_DUTY_CYCLE_LIMIT
+	// #define DEFAULT_DUTY_CYCLE_ON_TIME 120
+	// #define DEFAULT_DUTY_CYCLE_OFF_TIME 1080
+
+	/**
+	 * Synchronized outputs
+	 * Uncomment to enable. M62 P<n> (set) and M63 P<n> (clear) change DOUT<n> with the next motion, without waiting
+	 * for the motions to finish. The change is fired by the step ISR at the first step of the motion, at the exact step
+	 * an axis reaches a position (M62 P<n> X<pos>, machine coordinates) or Q<ms> after the motion starts.
+	 * Each change is reported with its firing latency ([SYNC:...]). SYNC_OUTPUT_COUNT sets the number of changes
+	 * that can be pending (a new change waits for a free one while the motions run). Not available with ENABLE_STEP_DMA. See core/sync_output.h.
+	 * */
+
+	// #define ENABLE_SYNC_OUTPUTS
+	// #define SYNC_OUTPUT_COUNT 8
+
+	/**
+	 * Armed motion start
+	 * Uncomment to enable. $ARM=<n>,<edge> holds the next motions planned and loaded in the interpolator and the DIN<n>
+	 * change ISR starts the step ISR directly on the rising (0) or falling (1) edge, without host or parser latency.
+	 * The trigger to step timer start and to first step latencies are reported ([TRIG:...]). DIN<n> must have an ISR
+	 * (DIN<n>_ISR in the boardmap). Not available with ENABLE_DUAL_CORE_MOTION or ENABLE_STEP_DMA. See core/armed_start.h.
+	 * */
+
+	// #define ENABLE_ARMED_START
+
 	/**
 	 * Disable settings safety.
 	 * This is a feature introduced in version 1.11 to prevent user from using the machine in case of settings loading error and causing havoc
@@ -322,6 +473,13 @@ extern "C"
  * invoked the command
  */
 #define ENABLE_O_CODES_VERBOSE
+/**
+ * uncomment this to keep the O code subroutine files in a RAM cache (OCODE_CACHE_SIZE bytes for up to
+ * OCODE_CACHE_ENTRIES files). Loops and repeated calls run from RAM instead of re-reading the file one char
+ * at a time and the discarded blocks (if/else, while exit, break) jump directly to the next O word line.
+ * A cached file is reloaded on call if its size or timestamp changed. Files that don't fit run from the file system.
+ */
+// #define ENABLE_O_CODES_CACHE
 #endif
 
 /**
@@ -370,6 +528,28 @@ extern "C"
 	// #define ENABLE_PARSER_MODULES
 	// #define ENABLE_MOTION_CONTROL_MODULES
 
+	/**
+	 * File system cache
+	 * Uncomment to enable. Each open file of the file system module gets a FS_CACHE_PAGE_SIZE bytes page
+	 * (FS_CACHE_PAGES pages are shared by the open files) so that the drive is read and written a page at a time
+	 * instead of once per fs_read/fs_write call. Running files are moved to the stream straight from the page.
+	 * */
+
+	// #define ENABLE_FS_CACHE
+	// #define FS_CACHE_PAGE_SIZE 512
+	// #define FS_CACHE_PAGES 2
+
+	/**
+	 * Asynchronous Modbus master
+	 * Uncomment to enable. Modbus transactions are queued (up to MODBUS_QUEUE_SIZE) and run from the main loop
+	 * with timeouts, retries and CRC checks, so the controller keeps streaming and stepping while the slave answers.
+	 * The modbus VFD tool uses it to send the spindle commands.
+	 * For a fully non blocking link use the hardware UART2 (DETACH_UART2_FROM_MAIN_PROTOCOL and VFD_USE_UART2).
+	 * */
+
+	// #define ENABLE_MODBUS_ASYNC
+	// #define MODBUS_QUEUE_SIZE 4
+
 	/**
 	 * Settings extensions are enabled by default
 	 * Uncomment to disable this extension.
@@ -518,8 +698,12 @@ extern "C"
 	 * from 0 to 3. With a value o 0 the DSS will be disabled.
 	 * */
 
+#ifndef DSS_MAX_OVERSAMPLING
 #define DSS_MAX_OVERSAMPLING 3
+#endif
+#ifndef DSS_CUTOFF_FREQ
 #define DSS_CUTOFF_FREQ 500
+#endif
 
 	/**
 	 * Modifies the bresenham algorithm to use a 16-version (experimental).
@@ -545,7 +729,51 @@ extern "C"
 	 *
 	 * */
 
+#ifndef S_CURVE_ACCELERATION_LEVEL
 #define S_CURVE_ACCELERATION_LEVEL 0
+#endif
+
+	/**
+	 * Generates the interpolator segments in fixed point math (speeds in Q24.8 steps/s,
+	 * distances in Q16.16 steps) instead of float. The profile junctions are still computed
+	 * in float once per block. Shortens the segment refill time on MCU without FPU
+	 * (AVR, STM32F1, RP2040) at the cost of a small speed quantization (1/256 steps/s).
+	 * S-curve profiles are sampled to a table (below 0.1% error of the speed change).
+	 * */
+
+	// #define ENABLE_ITP_FIXED_POINT
+
+	/**
+	 * Jerk limited planner
+	 * Uncomment to enable. The look-ahead planner computes the entry and exit speeds of the blocks with
+	 * jerk limited (S-curve) speed changes instead of constant acceleration and the interpolator runs those
+	 * same profiles (the acceleration ramps from 0 to the max acceleration at the max jerk and back to 0
+	 * at the end of each speed change). $170+ sets the max jerk of each stepper in mm/s^3 (0 disables the limit
+	 * on that stepper). With the jerk bounded the max accelerations ($120+) can usually be raised.
+	 * The acceleration returns to 0 at each block junction. Needs S_CURVE_ACCELERATION_LEVEL 0
+	 * and is not available with ENABLE_ITP_FIXED_POINT.
+	 * */
+
+	// #define ENABLE_JERK_LIMITED_PLANNER
+	// #define DEFAULT_JERK 1000
+
+	/**
+	 * Input shaping
+	 * Uncomment to enable. The motion of each stepper is convolved with a ZV, ZVD or EI impulse train
+	 * tuned to the vibration frequency and damping of the axis before it's output, so the moves don't
+	 * excite that resonance and the max accelerations ($120+) can usually be raised.
+	 * $180+ sets the vibration frequency of each stepper in Hz (0 disables the shaping of that stepper),
+	 * $190+ the damping ratio and $200+ the impulse train (0 - ZV, 1 - ZVD, 2 - EI).
+	 * The shaped motion lags the commanded motion by up to one vibration period.
+	 * The commanded motion is kept in a delay line of INPUT_SHAPER_DELAY_SIZE samples of 1/INPUT_SHAPER_SAMPLE_FREQ
+	 * seconds (4 bytes per sample and stepper), that sets the lowest frequency that can be shaped
+	 * (about 1.6Hz for ZV and 3.2Hz for ZVD and EI with the default values).
+	 * Not available with ENABLE_ITP_FIXED_POINT and ENABLE_BACKLASH_COMPENSATION.
+	 * */
+
+	// #define ENABLE_INPUT_SHAPING
+	// #define INPUT_SHAPER_DELAY_SIZE 64
+	// #define INPUT_SHAPER_SAMPLE_FREQ 200
 
 	/**
 	 *
@@ -578,6 +806,8 @@ extern "C"
 	 * EXPERIMENTAL! Uncomment to enable itp step generation to run inside the RTC ISR/task.
 	 * This ensures ITP starving prevention. Usually this will be executed at the same sample
 	 * rate as the interpolator with an upper bound of 1Khz and a lower bound of 3Hz
+	 * The planner buffer is a lock-free ring so the ISR can take blocks while the main loop
+	 * is still planning (it only reads the entry speeds the look-ahead already committed)
 	 * */
 // #define ENABLE_ITP_FEED_TASK
 
@@ -116,6 +116,18 @@ extern "C"
  */
 // #define ENABLE_XY_SIMULTANEOUS_HOMING
 
+/**
+ * Uncomment this feature to home several axis in parallel (cartesian kinematics only)
+ * All axis in PARALLEL_HOMING_MASK run the search, pull-off and re-approach motions together
+ * and each one stops independently on it's own limit switch, so the homing cycle takes as long as the slowest axis.
+ * The other axis are homed first one at a time in the usual order (Z, X, Y, A, B, C).
+ * By default all axis with homing are homed in parallel.
+ * With this option every homing motion (also the XY simultaneous homing) moves each axis at the homing feed
+ * in the direction of it's own homing direction invert bit ($23).
+ */
+// #define ENABLE_PARALLEL_HOMING
+// #define PARALLEL_HOMING_MASK ((1 << AXIS_X) | (1 << AXIS_Y) | (1 << AXIS_A) | (1 << AXIS_B))
+
 /**
  * Rotational axis - disable limits after homing
  * Enable this option if you want to disable the limits for rotation axis to work
@@ -299,54 +311,54 @@ extern "C"
  * Tools can be any of the built in tools available in /src/hal/tools/tools/ or you can use your own custom tool.
  *
  * **/
-// assign the tools from 1 to 16
-#if (TOOL_COUNT >= 1)
+// assign the tools from 1 to 16 (a tool can also be assigned in the build options, for example -DTOOL2=vfd_modbus)
+#if (TOOL_COUNT >= 1) && !defined(TOOL1)
 // to allow build on virtual emulator
 #define TOOL1 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 2)
+#if (TOOL_COUNT >= 2) && !defined(TOOL2)
 #define TOOL2 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 3)
+#if (TOOL_COUNT >= 3) && !defined(TOOL3)
 #define TOOL3 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 4)
+#if (TOOL_COUNT >= 4) && !defined(TOOL4)
 #define TOOL4 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 5)
+#if (TOOL_COUNT >= 5) && !defined(TOOL5)
 #define TOOL5 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 6)
+#if (TOOL_COUNT >= 6) && !defined(TOOL6)
 #define TOOL6 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 7)
+#if (TOOL_COUNT >= 7) && !defined(TOOL7)
 #define TOOL7 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 8)
+#if (TOOL_COUNT >= 8) && !defined(TOOL8)
 #define TOOL8 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 9)
+#if (TOOL_COUNT >= 9) && !defined(TOOL9)
 #define TOOL9 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 10)
+#if (TOOL_COUNT >= 10) && !defined(TOOL10)
 #define TOOL10 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 11)
+#if (TOOL_COUNT >= 11) && !defined(TOOL11)
 #define TOOL11 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 12)
+#if (TOOL_COUNT >= 12) && !defined(TOOL12)
 #define TOOL12 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 13)
+#if (TOOL_COUNT >= 13) && !defined(TOOL13)
 #define TOOL13 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 14)
+#if (TOOL_COUNT >= 14) && !defined(TOOL14)
 #define TOOL14 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 15)
+#if (TOOL_COUNT >= 15) && !defined(TOOL15)
 #define TOOL15 spindle_pwm
 #endif
-#if (TOOL_COUNT >= 16)
+#if (TOOL_COUNT >= 16) && !defined(TOOL16)
 #define TOOL16 spindle_pwm
 #endif
 
@@ -20,6 +20,9 @@
 #include <string.h>
 #include <stdint.h>
 #include "cnc.h"
+#ifdef ENABLE_MODBUS_ASYNC
+#include "modules/modbus.h"
+#endif
 
 #define LOOP_STARTUP_RESET 0
 #define LOOP_UNLOCK 1
@@ -42,8 +45,19 @@ typedef struct
 	volatile int8_t alarm;
 } cnc_state_t;
 
+#ifndef ENABLE_DUAL_CORE_MOTION
 static uint8_t cnc_lock_itp;
+#endif
 static cnc_state_t cnc_state;
+
+#ifndef ENABLE_DUAL_CORE_MOTION
+#define EXEC_STATE_SET(mask) SETFLAG(cnc_state.exec_state, mask)
+#define EXEC_STATE_CLEAR(mask) CLEARFLAG(cnc_state.exec_state, mask)
+#else
+// the motion core also changes the execution state (EXEC_RUN and the step ISR alarms)
+#define EXEC_STATE_SET(mask) ATOMIC_FETCH_OR(cnc_state.exec_state, (mask))
+#define EXEC_STATE_CLEAR(mask) ATOMIC_FETCH_AND(cnc_state.exec_state, (uint8_t)~(mask))
+#endif
 bool cnc_status_report_lock;
 
 static void cnc_check_fault_systems(void);
@@ -158,7 +172,7 @@ void cnc_run(void)
 			if (grbl_stream_getc() == EOL)
 			{
 				proto_feedback(MSG_FEEDBACK_1);
-				proto_error(0);
+				proto_line_ack(0);
 			}
 		}
 		cnc_dotasks();
@@ -170,6 +184,32 @@ void cnc_run(void)
 	} while (cnc_state.loop_state == LOOP_REQUIRE_RESET || cnc_get_exec_state(EXEC_KILL));
 }
 
+#ifdef ENABLE_WINDOWED_STREAMING
+// checks the @<seq> line prefix (windowed streaming)
+static uint8_t cnc_parse_line_seq(void)
+{
+	float val = 0;
+	grbl_stream_getc(); // eat @
+	uint8_t result = parser_get_float(&val);
+	if (!result || (result & NUMBER_ISFLOAT) || val < 0 || val > UINT16_MAX)
+	{
+		parser_discard_command();
+		return STATUS_INVALID_STATEMENT;
+	}
+
+	uint16_t seq = (uint16_t)val;
+	if (seq != proto_window_next_seq())
+	{
+		// a line was lost or sent twice
+		proto_window_resync(seq);
+		parser_discard_command();
+		return STATUS_STREAM_SEQUENCE_ERROR;
+	}
+
+	return STATUS_OK;
+}
+#endif
+
 uint8_t cnc_parse_cmd(void)
 {
 #ifdef ENABLE_PARSING_TIME_DEBUG
@@ -191,23 +231,43 @@ uint8_t cnc_parse_cmd(void)
 			grbl_stream_getc();
 			break;
 		default:
+		{
+#ifdef ENABLE_WINDOWED_STREAMING
+			if (c == '@' && proto_window_get_batch())
+			{
+				error = cnc_parse_line_seq();
+				if (error != STATUS_OK)
+				{
+					break;
+				}
+				// empty line
+				if (grbl_stream_peek() == EOL)
+				{
+					grbl_stream_getc();
+					break;
+				}
+			}
+#endif
 #ifdef ENABLE_PARSING_TIME_DEBUG
 			if (!exec_time)
 			{
 				exec_time = mcu_millis();
 			}
 #endif
+			CYCLE_PROFILER_START(CYCLE_PROFILER_PARSER);
 			error = parser_read_command();
+			CYCLE_PROFILER_END(CYCLE_PROFILER_PARSER);
 #ifdef ENABLE_PARSING_TIME_DEBUG
 			exec_time = mcu_millis() - exec_time;
 			proto_info("Exec time: %lu", exec_time);
 #endif
-			break;
+		}
+		break;
 		}
 		// runs any rt command in queue
 		// this catches for example a ?\n situation sent by some GUI like UGS
 		cnc_exec_rt_commands();
-		proto_error(error);
+		proto_line_ack(error);
 		if (error)
 		{
 			itp_sync();
@@ -225,10 +285,27 @@ uint8_t cnc_parse_cmd(void)
 bool cnc_dotasks(void)
 {
 	// run io basic tasks
+	CYCLE_PROFILER_START(CYCLE_PROFILER_IO);
 	cnc_io_dotasks();
+	CYCLE_PROFILER_END(CYCLE_PROFILER_IO);
 
 	cnc_exec_rt_commands(); // executes all pending realtime commands
 
+#ifdef ENABLE_TELEMETRY
+	proto_telemetry();
+#endif
+
+#ifdef ENABLE_WINDOWED_STREAMING
+	proto_window_flush();
+#endif
+
+#ifdef ENABLE_SYNC_OUTPUTS
+	sync_output_report();
+#endif
+#ifdef ENABLE_ARMED_START
+	armed_start_report();
+#endif
+
 	// let µCNC finnish startup/reset code
 	if (cnc_state.loop_state == LOOP_STARTUP_RESET)
 	{
@@ -247,11 +324,16 @@ bool cnc_dotasks(void)
 		return !cnc_get_exec_state(EXEC_INTERLOCKING_FAIL);
 	}
 
-#ifndef ENABLE_ITP_FEED_TASK
+#if defined(ENABLE_DUAL_CORE_MOTION)
+	// the motion core runs the interpolator
+	planner_handoff();
+#elif !defined(ENABLE_ITP_FEED_TASK)
 	if (!cnc_lock_itp)
 	{
 		cnc_lock_itp = true;
+		CYCLE_PROFILER_START(CYCLE_PROFILER_ITP);
 		itp_run();
+		CYCLE_PROFILER_END(CYCLE_PROFILER_ITP);
 		cnc_lock_itp = false;
 	}
 #endif
@@ -268,6 +350,34 @@ bool cnc_dotasks(void)
 	return !cnc_get_exec_state(EXEC_KILL);
 }
 
+#ifdef ENABLE_DUAL_CORE_MOTION
+/**
+ * Motion core task
+ * The MCU calls this in a loop from the second core. The interpolator runs here and starts the step ISR
+ * on this core, while the main core runs the protocol, parser, motion control and planner (cnc_run).
+ * */
+void cnc_motion_core_dotasks(void)
+{
+	if ((cnc_state.loop_state == LOOP_RUNNING) && (cnc_state.alarm == EXEC_ALARM_NOALARM) && !cnc_get_exec_state(EXEC_INTERLOCKING_FAIL))
+	{
+		CYCLE_PROFILER_START(CYCLE_PROFILER_ITP);
+		itp_core_run();
+		CYCLE_PROFILER_END(CYCLE_PROFILER_ITP);
+	}
+
+#ifdef ENABLE_SYNC_OUTPUTS
+	// the time tagged outputs are fired on the step ISR core
+	if (sync_output_armed)
+	{
+		__ATOMIC__
+		{
+			sync_output_tick();
+		}
+	}
+#endif
+}
+#endif
+
 void cnc_store_motion(void)
 {
 #ifdef ENABLE_MOTION_CONTROL_PLANNER_HIJACKING
@@ -335,6 +445,7 @@ void cnc_restore_motion(void)
 #ifndef DISABLE_RTC_CODE
 MCU_CALLBACK void mcu_rtc_cb(uint32_t millis)
 {
+	CYCLE_PROFILER_START(CYCLE_PROFILER_RTC);
 	mcu_enable_global_isr();
 	uint8_t mls = (uint8_t)(0xff & millis);
 	if ((mls & CTRL_SCHED_CHECK_MASK) == CTRL_SCHED_CHECK_VAL)
@@ -360,7 +471,9 @@ MCU_CALLBACK void mcu_rtc_cb(uint32_t millis)
 		cnc_lock_itp = 1;
 		if ((cnc_state.loop_state == LOOP_RUNNING) && (cnc_state.alarm == EXEC_ALARM_NOALARM) && !cnc_get_exec_state(EXEC_INTERLOCKING_FAIL))
 		{
-			itp_run();
+			CYCLE_PROFILER_START(CYCLE_PROFILER_ITP);
+			itp_core_run();
+			CYCLE_PROFILER_END(CYCLE_PROFILER_ITP);
 		}
 		mls = (uint8_t)CLAMP(1, (1000 / INTERPOLATOR_FREQ), 255);
 		cnc_lock_itp = 0;
@@ -369,6 +482,36 @@ MCU_CALLBACK void mcu_rtc_cb(uint32_t millis)
 	itp_feed_counter = mls;
 #endif
 
+#ifdef ENABLE_TELEMETRY
+	proto_telemetry_sample(millis);
+#endif
+
+#ifdef ENABLE_MOTION_SAMPLER
+	// keeps sampling while stopped (the step ISR samples while moving)
+	if (motion_sampler_state & MOTION_SAMPLER_RUNNING)
+	{
+		__ATOMIC__
+		{
+			motion_sampler_sample();
+		}
+	}
+#endif
+
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+	duty_cycle_tick();
+#endif
+
+#if defined(ENABLE_SYNC_OUTPUTS) && !defined(ENABLE_DUAL_CORE_MOTION)
+	if (sync_output_armed)
+	{
+		// the step ISR can preempt the RTC
+		__ATOMIC__
+		{
+			sync_output_tick();
+		}
+	}
+#endif
+
 #ifdef ENABLE_MAIN_LOOP_MODULES
 	if (!cnc_get_exec_state(EXEC_ALARM))
 	{
@@ -383,6 +526,7 @@ MCU_CALLBACK void mcu_rtc_cb(uint32_t millis)
 		io_toggle_output(ACTIVITY_LED);
 	}
 #endif
+	CYCLE_PROFILER_END(CYCLE_PROFILER_RTC);
 }
 #endif
 
@@ -470,7 +614,7 @@ uint8_t cnc_unlock(bool force)
 		if (!(g_settings_error & SETTINGS_READ_ERROR))
 		{
 #endif
-			CLEARFLAG(cnc_state.exec_state, EXEC_UNHOMED);
+			EXEC_STATE_CLEAR(EXEC_UNHOMED);
 			cnc_state.alarm = EXEC_ALARM_NOALARM;
 #ifndef DISABLE_SAFE_SETTINGS
 		}
@@ -502,7 +646,7 @@ uint8_t cnc_unlock(bool force)
 		// on unlock any alarm caused by not having homing reference or hitting a limit switch is reset at user request
 		// this must be done directly because cnc_clear_exec_state will check the limit switch state
 		// all other alarm flags remain active if any input is still active
-		CLEARFLAG(cnc_state.exec_state, EXEC_UNHOMED);
+		EXEC_STATE_CLEAR(EXEC_UNHOMED);
 		// clears all other locking flags
 		cnc_clear_exec_state(EXEC_GCODE_LOCKED | EXEC_HOLD);
 		// signals stepper enable pins
@@ -529,7 +673,7 @@ uint8_t cnc_get_exec_state(uint8_t statemask)
 
 void cnc_set_exec_state(uint8_t statemask)
 {
-	SETFLAG(cnc_state.exec_state, statemask);
+	EXEC_STATE_SET(statemask);
 }
 
 void cnc_clear_exec_state(uint8_t statemask)
@@ -617,7 +761,7 @@ void cnc_clear_exec_state(uint8_t statemask)
 		}
 	}
 
-	CLEARFLAG(cnc_state.exec_state, statemask);
+	EXEC_STATE_CLEAR(statemask);
 }
 
 // executes delay
@@ -680,12 +824,12 @@ void cnc_call_rt_command(uint8_t command)
 		SETFLAG(cnc_state.rt_cmd, RT_CMD_RESET);
 		break;
 	case CMD_CODE_FEED_HOLD:
-		SETFLAG(cnc_state.exec_state, EXEC_HOLD);
+		EXEC_STATE_SET(EXEC_HOLD);
 		__FALL_THROUGH__
 	case CMD_CODE_JOG_CANCEL:
 		if (cnc_get_exec_state(EXEC_JOG))
 		{
-			SETFLAG(cnc_state.exec_state, EXEC_HOLD);
+			EXEC_STATE_SET(EXEC_HOLD);
 			SETFLAG(cnc_state.rt_cmd, RT_CMD_JOG_CANCEL);
 		}
 		break;
@@ -700,7 +844,7 @@ void cnc_call_rt_command(uint8_t command)
 		break;
 #if ASSERT_PIN(SAFETY_DOOR)
 	case CMD_CODE_SAFETY_DOOR:
-		SETFLAG(cnc_state.exec_state, (EXEC_HOLD | EXEC_DOOR));
+		EXEC_STATE_SET(EXEC_HOLD | EXEC_DOOR);
 		break;
 #endif
 	default:
@@ -1051,7 +1195,12 @@ bool cnc_check_interlocking(void)
 	// end of JOG
 	if (cnc_get_exec_state(EXEC_JOG | EXEC_HOLD) == EXEC_JOG)
 	{
-		if (itp_is_empty() && planner_buffer_is_empty())
+		if (itp_is_empty() && planner_buffer_is_empty()
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+			// the rest of the jog motion is waiting for the steppers to cool (can still be canceled)
+			&& !duty_cycle_is_waiting()
+#endif
+		)
 		{
 			cnc_clear_exec_state(EXEC_JOG);
 		}
@@ -1079,6 +1228,10 @@ static void cnc_io_dotasks(void)
 	EVENT_INVOKE(cnc_io_dotasks, NULL);
 #endif
 
+#ifdef ENABLE_MODBUS_ASYNC
+	modbus_task();
+#endif
+
 #ifdef ENABLE_STEPPERS_DISABLE_TIMEOUT
 	static uint32_t stepper_timeout = 0;
 
@@ -148,6 +148,13 @@ extern "C"
 #include "core/motion_control.h"
 #include "core/planner.h"
 #include "core/interpolator.h"
+#include "core/motion_stream.h"
+#include "core/motion_sampler.h"
+#include "core/cycle_profiler.h"
+#include "core/duty_cycle.h"
+#include "core/sync_output.h"
+#include "core/armed_start.h"
+#include "core/input_shaper.h"
 #include "modules/encoder.h"
 
 	/**
@@ -165,6 +172,10 @@ extern "C"
 	void cnc_run(void);
 	// do events returns true if all OK and false if an ABORT alarm is reached
 	bool cnc_dotasks(void);
+#ifdef ENABLE_DUAL_CORE_MOTION
+	// runs the interpolator (called in a loop by the second core)
+	void cnc_motion_core_dotasks(void);
+#endif
 	uint8_t cnc_home(void);
 	void cnc_alarm(int8_t code);
 	bool cnc_has_alarm(void);
@@ -2139,6 +2139,24 @@ typedef uint16_t step_t;
 #error "invalid s-curve velocity profile setting"
 #endif
 
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+#if (S_CURVE_ACCELERATION_LEVEL != 0)
+#error "ENABLE_JERK_LIMITED_PLANNER shapes the acceleration with its own jerk limited profile (S_CURVE_ACCELERATION_LEVEL must be 0)"
+#endif
+#ifdef ENABLE_ITP_FIXED_POINT
+#error "ENABLE_JERK_LIMITED_PLANNER is not supported with ENABLE_ITP_FIXED_POINT"
+#endif
+#endif
+
+#ifdef ENABLE_INPUT_SHAPING
+#ifdef ENABLE_ITP_FIXED_POINT
+#error "ENABLE_INPUT_SHAPING is not supported with ENABLE_ITP_FIXED_POINT"
+#endif
+#ifdef ENABLE_BACKLASH_COMPENSATION
+#error "ENABLE_INPUT_SHAPING is not supported with ENABLE_BACKLASH_COMPENSATION"
+#endif
+#endif
+
 #if (defined(IS_DELTA_KINEMATICS))
 #ifdef ENABLE_DUAL_DRIVE_AXIS
 #error "Delta does not support dual drive axis"
@@ -2238,7 +2256,7 @@ typedef uint16_t step_t;
 #error "Invalid config option STATUS_AUTOMATIC_REPORT_INTERVAL must be set between 0 and 1000"
 #endif
 
-#if defined(ENABLE_AXIS_AUTOLEVEL) || defined(IS_DELTA_KINEMATICS) || defined(ENABLE_XY_SIMULTANEOUS_HOMING)
+#if defined(ENABLE_AXIS_AUTOLEVEL) || defined(IS_DELTA_KINEMATICS) || defined(ENABLE_XY_SIMULTANEOUS_HOMING) || defined(ENABLE_PARALLEL_HOMING)
 #define ENABLE_MULTI_STEP_HOMING
 #endif
 
@@ -2273,6 +2291,20 @@ typedef uint16_t step_t;
 #define AXIS_C_HOMING_MASK 0
 #endif
 
+#ifdef ENABLE_PARALLEL_HOMING
+#if (KINEMATIC != KINEMATIC_CARTESIAN)
+#error "ENABLE_PARALLEL_HOMING is only available for the cartesian kinematics"
+#endif
+#ifndef PARALLEL_HOMING_MASK
+#define PARALLEL_HOMING_MASK (AXIS_X_HOMING_MASK | AXIS_Y_HOMING_MASK | AXIS_Z_HOMING_MASK | AXIS_A_HOMING_MASK | AXIS_B_HOMING_MASK | AXIS_C_HOMING_MASK)
+#endif
+// axis homed in parallel (only the ones with homing) and their limit switches
+#define PARALLEL_HOMING_AXIS_MASK (PARALLEL_HOMING_MASK & (AXIS_X_HOMING_MASK | AXIS_Y_HOMING_MASK | AXIS_Z_HOMING_MASK | AXIS_A_HOMING_MASK | AXIS_B_HOMING_MASK | AXIS_C_HOMING_MASK))
+#define PARALLEL_HOMING_LIMIT_MASK (((PARALLEL_HOMING_AXIS_MASK & AXIS_X_HOMING_MASK) ? LINACT0_LIMIT_MASK : 0) | ((PARALLEL_HOMING_AXIS_MASK & AXIS_Y_HOMING_MASK) ? LINACT1_LIMIT_MASK : 0) | ((PARALLEL_HOMING_AXIS_MASK & AXIS_Z_HOMING_MASK) ? LINACT2_LIMIT_MASK : 0) | ((PARALLEL_HOMING_AXIS_MASK & AXIS_A_HOMING_MASK) ? LINACT3_LIMIT_MASK : 0) | ((PARALLEL_HOMING_AXIS_MASK & AXIS_B_HOMING_MASK) ? LINACT4_LIMIT_MASK : 0) | ((PARALLEL_HOMING_AXIS_MASK & AXIS_C_HOMING_MASK) ? LINACT5_LIMIT_MASK : 0))
+#else
+#define PARALLEL_HOMING_AXIS_MASK 0
+#endif
+
 #if (LINACT0_IO_MASK & LINACT1_IO_MASK)
 #error "Linear actuator 0 and 1 have overlapped outputs and this can lead to unpredictable results"
 #endif
@@ -2443,6 +2475,20 @@ typedef uint16_t step_t;
 #endif
 #endif
 
+#ifdef ENABLE_DUAL_CORE_MOTION
+#ifndef MCU_HAS_DUAL_CORE
+#error "The MCU does not support ENABLE_DUAL_CORE_MOTION"
+#endif
+// the motion core already runs the interpolator
+#undef ENABLE_ITP_FEED_TASK
+#ifdef ENABLE_STEP_DMA
+#error "ENABLE_DUAL_CORE_MOTION can't be used with ENABLE_STEP_DMA"
+#endif
+#ifdef ENABLE_MOTION_CONTROL_PLANNER_HIJACKING
+#error "ENABLE_DUAL_CORE_MOTION can't be used with ENABLE_MOTION_CONTROL_PLANNER_HIJACKING"
+#endif
+#endif
+
 #include "hal/io_hal.h"
 
 #ifdef __cplusplus
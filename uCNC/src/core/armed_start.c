@@ -0,0 +1,183 @@
+/*
+	Name: armed_start.c
+	Description: Armed motion start on a digital input edge for µCNC.
+		The step ISR start is held while armed and started by the DIN change ISR on the armed edge.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include <stdint.h>
+
+#ifdef ENABLE_ARMED_START
+
+volatile uint8_t armed_start_state;
+static uint8_t armed_start_din;
+static uint8_t armed_start_edge;
+static volatile bool armed_start_pending;
+// step ISR timer at the max step rate (computed when armed to keep the float math out of the DIN ISR)
+static uint16_t armed_start_ticks;
+static uint16_t armed_start_prescaller;
+static uint32_t armed_start_trigger;
+static uint32_t armed_start_latency;
+static uint32_t armed_start_dispatch;
+
+static uint8_t armed_start_arm(void)
+{
+	// DIN, edge
+	float args[2] = {0, ARMED_START_EDGE_RISE};
+	uint8_t i = 0;
+	for (;;)
+	{
+		uint8_t result = parser_get_float(&args[i++]);
+		if (!result || (result & (NUMBER_ISFLOAT | NUMBER_ISNEGATIVE)))
+		{
+			return STATUS_BAD_NUMBER_FORMAT;
+		}
+
+		uint8_t c = grbl_stream_getc();
+		if (c == EOL)
+		{
+			break;
+		}
+		if (c != ',' || i == 2)
+		{
+			return STATUS_INVALID_STATEMENT;
+		}
+	}
+
+	// only the DIN with an ISR start the step ISR without waiting for the main loop
+	if (args[0] > 7 || args[1] > ARMED_START_EDGE_FALL || !((1 << (uint8_t)args[0]) & DIN_ONCHANGE_MASK))
+	{
+		return STATUS_INVALID_STATEMENT;
+	}
+
+	// the motions queued before arming would start right away
+	if (cnc_get_exec_state(EXEC_RUN) || !planner_buffer_is_empty() || !itp_is_empty())
+	{
+		return STATUS_IDLE_ERROR;
+	}
+
+	uint16_t ticks, prescaller;
+	mcu_freq_to_clocks(F_STEP_MAX, &ticks, &prescaller);
+	__ATOMIC__
+	{
+		armed_start_din = (uint8_t)args[0];
+		armed_start_edge = (uint8_t)args[1];
+		armed_start_ticks = ticks;
+		armed_start_prescaller = prescaller;
+		armed_start_latency = 0;
+		armed_start_dispatch = 0;
+		armed_start_pending = false;
+		armed_start_state = ARMED_START_ARMED;
+	}
+
+	return GRBL_SEND_ARM_STATUS;
+}
+
+uint8_t armed_start_command(uint8_t subcmd, uint8_t c)
+{
+	switch (subcmd)
+	{
+	case 0:
+		if (c == '=')
+		{
+			return armed_start_arm();
+		}
+		if (c == EOL)
+		{
+			return GRBL_SEND_ARM_STATUS;
+		}
+		break;
+	case 'X':
+		if (c == EOL)
+		{
+			__ATOMIC__
+			{
+				if (armed_start_state == ARMED_START_ARMED)
+				{
+					armed_start_state = ARMED_START_OFF;
+				}
+			}
+			return GRBL_SEND_ARM_STATUS;
+		}
+		break;
+	}
+
+	return STATUS_INVALID_STATEMENT;
+}
+
+void armed_start_status(void)
+{
+	proto_info("ARM:%d,%d,%d,%lu,%lu", armed_start_state, armed_start_din, armed_start_edge, armed_start_dispatch, armed_start_latency);
+}
+
+void armed_start_input(uint8_t inputs, uint8_t diff)
+{
+	uint8_t mask = (1 << armed_start_din);
+	if (armed_start_state != ARMED_START_ARMED || !(diff & mask))
+	{
+		return;
+	}
+
+	// the input level after the edge
+	if (((inputs & mask) != 0) == (armed_start_edge == ARMED_START_EDGE_FALL))
+	{
+		return;
+	}
+
+	armed_start_trigger = mcu_micros();
+	armed_start_state = ARMED_START_TRIGGERED;
+	if (!itp_start_armed(armed_start_ticks, armed_start_prescaller))
+	{
+		// no motion loaded yet
+		armed_start_state = ARMED_START_ARMED;
+		return;
+	}
+	armed_start_dispatch = mcu_micros() - armed_start_trigger;
+}
+
+void armed_start_step(void)
+{
+	armed_start_latency = mcu_micros() - armed_start_trigger;
+	armed_start_pending = true;
+	armed_start_state = ARMED_START_DONE;
+}
+
+void armed_start_clear(void)
+{
+	__ATOMIC__
+	{
+		if (armed_start_state != ARMED_START_DONE)
+		{
+			armed_start_state = ARMED_START_OFF;
+		}
+	}
+}
+
+void armed_start_report(void)
+{
+	if (armed_start_pending)
+	{
+		armed_start_pending = false;
+		proto_printf("[TRIG:%d,%lu,%lu" MSG_FEEDBACK_END, armed_start_din, armed_start_dispatch, armed_start_latency);
+	}
+}
+
+bool armed_start_has_report(void)
+{
+	return armed_start_pending;
+}
+
+#endif
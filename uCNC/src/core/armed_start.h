@@ -0,0 +1,87 @@
+/*
+	Name: armed_start.h
+	Description: Armed motion start on a digital input edge for µCNC.
+		The motions are planned and the interpolator segments loaded while the step ISR is held.
+		The step ISR is started directly from the DIN change ISR (mcu_inputs_changed_cb) when the configured edge arrives,
+		without waiting for the main loop.
+
+		$ARM=<n>,<edge> - arms the start on DIN<n> (0 to 7) rising (edge 0) or falling (edge 1) edge
+			the machine must be idle (no motions queued) and the DIN must have an ISR (DIN<n>_ISR defined in the boardmap)
+			the motions sent next are planned and held until the edge
+		$ARMX - disarms (the held motions start)
+		$ARM - prints the status
+			[ARM:<state>,<n>,<edge>,<start us>,<first step us>]
+			state 0 (off), 1 (armed), 2 (triggered) or 3 (done)
+		An edge without loaded motions is ignored (stays armed). Any stop that flushes the motions disarms.
+
+		The first step after the trigger is reported once as
+			[TRIG:<n>,<start us>,<first step us>]
+		where both latencies are measured from the DIN edge ISR, to the step timer start and to the first step output.
+		The step timer starts at F_STEP_MAX and the first step comes when the acceleration from a stop reaches it.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef ARMED_START_H
+#define ARMED_START_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_ARMED_START
+
+#ifdef ENABLE_DUAL_CORE_MOTION
+#error "ENABLE_ARMED_START is not supported with ENABLE_DUAL_CORE_MOTION (the step ISR runs on the motion core)"
+#endif
+#ifdef ENABLE_STEP_DMA
+#error "ENABLE_ARMED_START is not supported with ENABLE_STEP_DMA (the step ISR is replaced by the DMA step engine)"
+#endif
+
+#define ARMED_START_OFF 0
+#define ARMED_START_ARMED 1
+#define ARMED_START_TRIGGERED 2
+#define ARMED_START_DONE 3
+
+#define ARMED_START_EDGE_RISE 0
+#define ARMED_START_EDGE_FALL 1
+
+	extern volatile uint8_t armed_start_state;
+
+	// parses the $ARM commands (subcmd is the 4th letter of the command or 0)
+	uint8_t armed_start_command(uint8_t subcmd, uint8_t c);
+	// prints the status
+	void armed_start_status(void);
+	// starts the held motions on the armed edge (called by the DIN change ISR)
+	void armed_start_input(uint8_t inputs, uint8_t diff);
+	// records the first step after the trigger (called by the step ISR)
+	void armed_start_step(void);
+	// disarms (the motions were flushed)
+	void armed_start_clear(void);
+	// reports the trigger to first step latency (main loop)
+	void armed_start_report(void);
+	// the first step latency was not reported yet
+	bool armed_start_has_report(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
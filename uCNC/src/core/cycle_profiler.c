@@ -0,0 +1,69 @@
+/*
+	Name: cycle_profiler.c
+	Description: Cycle count profiler for µCNC.
+		Keeps the count, min, average and max cycles and a log2 histogram of each profiled code section.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ENABLE_CYCLE_PROFILER
+
+static cycle_profiler_section_t cycle_profiler_data[CYCLE_PROFILER_SECTIONS];
+
+// each section is only updated by a single context (ISR or main loop) so no locking is needed here
+void cycle_profiler_add(uint8_t section, uint32_t cycles)
+{
+	cycle_profiler_section_t *data = &cycle_profiler_data[section];
+	// bucket N holds the samples with N significant bits
+	uint8_t bucket = (cycles) ? (32 - __builtin_clz(cycles)) : 0;
+	if (bucket >= CYCLE_PROFILER_BUCKETS)
+	{
+		bucket = CYCLE_PROFILER_BUCKETS - 1;
+	}
+
+	data->histogram[bucket]++;
+	if (!data->count || cycles < data->min)
+	{
+		data->min = cycles;
+	}
+	if (cycles > data->max)
+	{
+		data->max = cycles;
+	}
+	data->count++;
+	data->sum += cycles;
+}
+
+void cycle_profiler_get(uint8_t section, cycle_profiler_section_t *data)
+{
+	// the ISR sections may be updating
+	__ATOMIC__
+	{
+		memcpy(data, &cycle_profiler_data[section], sizeof(cycle_profiler_section_t));
+	}
+}
+
+void cycle_profiler_reset(void)
+{
+	__ATOMIC__
+	{
+		memset(cycle_profiler_data, 0, sizeof(cycle_profiler_data));
+	}
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+	Name: cycle_profiler.h
+	Description: Cycle count profiler for µCNC.
+		Measures the execution time of the hot code sections (step ISR, RTC tick, interpolator,
+		planner, IO tasks and parser) with the MCU cycle counter (mcu_cycle_count) and keeps
+		the count, min, average and max cycles and a log2 histogram of each section.
+
+		The main loop sections include the time spent in any ISR that preempts them
+		and the parser section includes the time spent waiting for free space in the planner.
+
+		Commands:
+			$PRF - prints [PRF:<cycle counter clock Hz>] followed by one line per section
+				[PRF:<section>,<count>,<min>,<avg>,<max>,<h0>,<h1>,...]
+				where hN is the number of samples that took between 2^(N-1) and 2^N - 1 cycles
+				(the last bucket also counts all samples above it and the trailing empty buckets are not printed)
+			$PRFR - resets the profiler
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef CYCLE_PROFILER_H
+#define CYCLE_PROFILER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_CYCLE_PROFILER
+
+// number of histogram buckets per section (each bucket uses 4 bytes of RAM)
+#ifndef CYCLE_PROFILER_BUCKETS
+#define CYCLE_PROFILER_BUCKETS 20
+#endif
+
+// sections
+#define CYCLE_PROFILER_STEP 0		  // mcu_step_cb
+#define CYCLE_PROFILER_STEP_RESET 1 // mcu_step_reset_cb
+#define CYCLE_PROFILER_RTC 2		  // mcu_rtc_cb
+#define CYCLE_PROFILER_ITP 3		  // itp_run
+#define CYCLE_PROFILER_PLANNER 4	  // planner_recalculate
+#define CYCLE_PROFILER_IO 5		  // cnc_io_dotasks
+#define CYCLE_PROFILER_PARSER 6	  // parser_read_command
+#define CYCLE_PROFILER_SECTIONS 7
+
+	typedef struct cycle_profiler_section_
+	{
+		uint32_t count;
+		uint32_t min;
+		uint32_t max;
+		uint64_t sum;
+		uint32_t histogram[CYCLE_PROFILER_BUCKETS];
+	} cycle_profiler_section_t;
+
+	void cycle_profiler_add(uint8_t section, uint32_t cycles);
+	void cycle_profiler_get(uint8_t section, cycle_profiler_section_t *data);
+	void cycle_profiler_reset(void);
+
+// measures the code between the two macros (must be used in the same scope)
+#define CYCLE_PROFILER_START(section) uint32_t section##_start = mcu_cycle_count()
+#define CYCLE_PROFILER_END(section) cycle_profiler_add(section, mcu_cycle_count() - section##_start)
+
+#else
+#define CYCLE_PROFILER_START(section)
+#define CYCLE_PROFILER_END(section)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
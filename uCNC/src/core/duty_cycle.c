@@ -0,0 +1,277 @@
+/*
+	Name: duty_cycle.c
+	Description: Duty cycle limit of thermally limited actuators for µCNC.
+		Heat model of each stepper fed from the interpolator step activity and
+		the on time budget checks used by motion control to schedule the motions.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+
+#if (STEPPER_COUNT > 8)
+#error "The duty cycle limit supports up to 8 steppers"
+#endif
+
+// heat of each stepper (ms of on time not yet cooled down)
+static uint32_t duty_cycle_heat[STEPPER_COUNT];
+// on time of the blocks queued in the planner and interpolator that didn't run yet (ms)
+static uint32_t duty_cycle_pending[STEPPER_COUNT];
+// cooling accumulator (adds on per idle ms and removes 1ms of heat per off)
+static uint32_t duty_cycle_cooling[STEPPER_COUNT];
+// steppers and block on time (ms) motion control is waiting for
+static uint8_t duty_cycle_wait_mask;
+static uint32_t duty_cycle_wait_ms;
+
+static FORCEINLINE bool duty_cycle_enabled(uint8_t i)
+{
+	return (g_settings.duty_cycle_on_time[i] && g_settings.duty_cycle_off_time[i]);
+}
+
+static FORCEINLINE uint32_t duty_cycle_budget(uint8_t i)
+{
+	return (uint32_t)g_settings.duty_cycle_on_time[i] * 1000UL;
+}
+
+void duty_cycle_tick(void)
+{
+	uint8_t active = itp_get_rt_active_steppers();
+	// nothing queued (discards the predicted time that was not used)
+	bool flushed = (planner_buffer_is_empty() && itp_is_empty());
+
+	for (uint8_t i = STEPPER_COUNT; i != 0;)
+	{
+		i--;
+		if (!duty_cycle_enabled(i))
+		{
+			duty_cycle_heat[i] = 0;
+			duty_cycle_pending[i] = 0;
+			continue;
+		}
+
+		if (active & (1 << i))
+		{
+			duty_cycle_heat[i]++;
+			if (duty_cycle_pending[i])
+			{
+				duty_cycle_pending[i]--;
+			}
+		}
+		else if (duty_cycle_heat[i])
+		{
+			// cools at on/off ms per ms
+			uint32_t cooling = duty_cycle_cooling[i] + g_settings.duty_cycle_on_time[i];
+			uint16_t off = g_settings.duty_cycle_off_time[i];
+			if (cooling >= off)
+			{
+				uint32_t cooled = cooling / off;
+				cooling -= cooled * off;
+				duty_cycle_heat[i] -= MIN(cooled, duty_cycle_heat[i]);
+			}
+			duty_cycle_cooling[i] = cooling;
+		}
+		else
+		{
+			duty_cycle_cooling[i] = 0;
+		}
+
+		if (flushed)
+		{
+			duty_cycle_pending[i] = 0;
+		}
+	}
+}
+
+uint8_t duty_cycle_mask(motion_data_t *block_data)
+{
+	uint8_t mask = 0;
+	for (uint8_t i = STEPPER_COUNT; i != 0;)
+	{
+		i--;
+		if (block_data->steps[i] && duty_cycle_enabled(i))
+		{
+			mask |= (1 << i);
+		}
+	}
+
+	return mask;
+}
+
+uint32_t duty_cycle_predict(motion_data_t *block_data, uint32_t max_steps)
+{
+	// feed and acceleration are in steps/s and steps/s^2 of the main stepper
+	float feed = block_data->feed;
+	if (block_data->motion_flags.bit.feed_override)
+	{
+		// only the overrides that slow down the motion make it longer
+		if (g_planner_state.feed_override < 100)
+		{
+			feed *= 0.01f * (float)g_planner_state.feed_override;
+		}
+
+		if (g_planner_state.rapid_feed_override < 100)
+		{
+			feed = MIN(feed, 0.01f * (float)g_planner_state.rapid_feed_override * block_data->max_feed);
+		}
+	}
+
+	feed = MAX(feed, 1.0f);
+	float accel = MAX(block_data->max_accel, 1.0f);
+	float steps = (float)max_steps;
+	// worst case is starting and ending the block at rest (trapezoidal or triangular profile)
+	float t;
+	if (steps > (feed * feed / accel))
+	{
+		t = (steps / feed) + (feed / accel);
+	}
+	else
+	{
+		t = 2.0f * sqrtf(steps / accel);
+	}
+
+	return (uint32_t)(t * 1000.0f) + 1;
+}
+
+uint32_t duty_cycle_split(motion_data_t *block_data, uint32_t max_steps)
+{
+	uint8_t mask = duty_cycle_mask(block_data);
+	if (!mask)
+	{
+		return 1;
+	}
+
+	uint32_t budget = UINT32_MAX;
+	for (uint8_t i = STEPPER_COUNT; i != 0;)
+	{
+		i--;
+		if (mask & (1 << i))
+		{
+			budget = MIN(budget, duty_cycle_budget(i));
+		}
+	}
+
+	// each block starts and ends at rest so the sum of the parts is longer than the motion (a few tries are enough)
+	uint32_t blocks = 1;
+	for (uint8_t tries = 8; tries != 0; tries--)
+	{
+		uint32_t ms = duty_cycle_predict(block_data, (max_steps + blocks - 1) / blocks);
+		if (ms <= budget || blocks >= max_steps)
+		{
+			break;
+		}
+
+		blocks = MIN(max_steps, (uint32_t)ceilf((float)blocks * (float)ms / (float)budget));
+	}
+
+	return blocks;
+}
+
+bool duty_cycle_wait(uint8_t mask, uint32_t ms)
+{
+	bool wait = false;
+	__ATOMIC__
+	{
+		for (uint8_t i = STEPPER_COUNT; i != 0;)
+		{
+			i--;
+			// a block longer than the budget (could not be split) runs after a full cool down
+			uint32_t budget = duty_cycle_budget(i);
+			if ((mask & (1 << i)) && (duty_cycle_heat[i] + duty_cycle_pending[i] + MIN(ms, budget)) > budget)
+			{
+				wait = true;
+			}
+		}
+	}
+
+	duty_cycle_wait_mask = (wait) ? mask : 0;
+	duty_cycle_wait_ms = ms;
+	return wait;
+}
+
+void duty_cycle_queue(uint8_t mask, uint32_t ms)
+{
+	__ATOMIC__
+	{
+		for (uint8_t i = STEPPER_COUNT; i != 0;)
+		{
+			i--;
+			if (mask & (1 << i))
+			{
+				duty_cycle_pending[i] += ms;
+			}
+		}
+	}
+
+	duty_cycle_wait_mask = 0;
+}
+
+bool duty_cycle_is_waiting(void)
+{
+	return (duty_cycle_wait_mask != 0);
+}
+
+void duty_cycle_status(void)
+{
+	uint32_t heat[STEPPER_COUNT];
+	uint32_t pending[STEPPER_COUNT];
+	__ATOMIC__
+	{
+		memcpy(heat, duty_cycle_heat, sizeof(heat));
+		memcpy(pending, duty_cycle_pending, sizeof(pending));
+	}
+
+	uint32_t wait = 0;
+	proto_print(MSG_STATUS_DUTY);
+	for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+	{
+		if (i)
+		{
+			proto_putc(',');
+		}
+
+		if (!duty_cycle_enabled(i))
+		{
+			proto_itoa(100);
+			continue;
+		}
+
+		uint32_t budget = duty_cycle_budget(i);
+		uint32_t used = heat[i] + pending[i];
+		proto_itoa((used < budget) ? ((budget - used) / (budget / 100)) : 0);
+
+		if (duty_cycle_wait_mask & (1 << i))
+		{
+			// the queued blocks run first and then the stepper cools at on/off ms per ms
+			used += MIN(duty_cycle_wait_ms, budget);
+			if (used > budget)
+			{
+				float cooling = (float)(used - budget) * (float)g_settings.duty_cycle_off_time[i] / (float)g_settings.duty_cycle_on_time[i];
+				wait = MAX(wait, pending[i] + (uint32_t)cooling);
+			}
+		}
+	}
+
+	if (duty_cycle_wait_mask)
+	{
+		proto_print(MSG_STATUS_DUTY_WAIT);
+		proto_itoa((wait + 999) / 1000);
+	}
+}
+
+#endif
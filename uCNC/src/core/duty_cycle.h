@@ -0,0 +1,66 @@
+/*
+	Name: duty_cycle.h
+	Description: Duty cycle limit of thermally limited actuators for µCNC.
+		Keeps a heat model of each stepper fed from the interpolator step activity (sampled in the RTC tick)
+		and holds new motions in motion control until the steppers of the motion have cooled enough to run it.
+
+		Each stepper has an on time budget ($150+, in seconds) and a cooling time ($160+, in seconds).
+		The heat of a stepper rises 1ms for each ms it is stepping and cools down at on/off ms per ms while idle,
+		so a stepper can run the full on time after resting the full off time and never runs more than
+		on / (on + off) of the time on average. A budget of 0 disables the limit of that stepper.
+		The model starts cold at power on.
+
+		Status report:
+			|Dc:<remaining %>,... - on time that can still be queued for each stepper (100 without a limit)
+			|Dw:<seconds> - estimated time until the next motion can start (only while waiting for a stepper to cool)
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef DUTY_CYCLE_H
+#define DUTY_CYCLE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+
+	// updates the heat model (called by the RTC tick every ms)
+	void duty_cycle_tick(void);
+	// steppers with a duty cycle limit that move in the block
+	uint8_t duty_cycle_mask(motion_data_t *block_data);
+	// predicted on time of the block (ms) with max_steps of the main stepper
+	uint32_t duty_cycle_predict(motion_data_t *block_data, uint32_t max_steps);
+	// number of blocks a motion must be split into so that each one fits the on time budget of the steppers
+	uint32_t duty_cycle_split(motion_data_t *block_data, uint32_t max_steps);
+	// the steppers in mask can't run a block of ms yet (a call with mask 0 clears the waiting state)
+	bool duty_cycle_wait(uint8_t mask, uint32_t ms);
+	// adds a queued block of ms to the steppers in mask
+	void duty_cycle_queue(uint8_t mask, uint32_t ms);
+	// motion control is holding a block until the steppers cool
+	bool duty_cycle_is_waiting(void);
+	void duty_cycle_status(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,249 @@
+/*
+	Name: input_shaper.c
+	Description: Input shaping stage between the interpolator and the step output for µCNC.
+		Delay line of the commanded steps of each stepper and the ZV/ZVD/EI impulse trains.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef ENABLE_INPUT_SHAPING
+
+#if (INPUT_SHAPER_DELAY_SIZE < 4 || INPUT_SHAPER_DELAY_SIZE > 255)
+#error "INPUT_SHAPER_DELAY_SIZE must be between 4 and 255 samples"
+#endif
+
+#define INPUT_SHAPER_SAMPLE_T (1.0f / INPUT_SHAPER_SAMPLE_FREQ)
+// longest impulse train that fits the delay line (the newest sample is still being filled)
+#define INPUT_SHAPER_MAX_DURATION ((float)(INPUT_SHAPER_DELAY_SIZE - 2) * INPUT_SHAPER_SAMPLE_T)
+#define INPUT_SHAPER_IMPULSES 3
+// EI vibration tolerance (5%)
+#define INPUT_SHAPER_EI_VTOL 0.05f
+
+// commanded steps of each stepper in each sample of the delay line (the head sample is being filled)
+static float input_shaper_delay[INPUT_SHAPER_DELAY_SIZE][STEPPER_COUNT];
+static uint8_t input_shaper_head;
+static float input_shaper_head_time;
+// commanded steps not output yet
+static int32_t input_shaper_lag[STEPPER_COUNT];
+// fraction of a step of the commanded position (beyond the commanded steps) and of the shaped position (beyond the output steps)
+static float input_shaper_cmd_frac[STEPPER_COUNT];
+static float input_shaper_frac[STEPPER_COUNT];
+// time since the last commanded step
+static float input_shaper_quiet;
+// impulse amplitudes and delays of each stepper (the first impulse has no delay)
+static float input_shaper_amp[STEPPER_COUNT][INPUT_SHAPER_IMPULSES];
+static float input_shaper_time[STEPPER_COUNT][INPUT_SHAPER_IMPULSES];
+// delay of the last impulse of the longest train
+static float input_shaper_duration;
+static volatile bool input_shaper_settled;
+
+void input_shaper_clear(void)
+{
+	memset(input_shaper_delay, 0, sizeof(input_shaper_delay));
+	memset(input_shaper_lag, 0, sizeof(input_shaper_lag));
+	memset(input_shaper_cmd_frac, 0, sizeof(input_shaper_cmd_frac));
+	memset(input_shaper_frac, 0, sizeof(input_shaper_frac));
+	input_shaper_head = 0;
+	input_shaper_head_time = 0;
+	input_shaper_quiet = 0;
+	input_shaper_duration = 0;
+	input_shaper_settled = true;
+}
+
+bool input_shaper_is_settled(void)
+{
+	return input_shaper_settled;
+}
+
+// computes the impulse trains from the settings (only from a stop)
+static void input_shaper_load(void)
+{
+	input_shaper_duration = 0;
+	for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+	{
+		float *amp = input_shaper_amp[i];
+		float *time = input_shaper_time[i];
+		memset(amp, 0, sizeof(input_shaper_amp[i]));
+		memset(time, 0, sizeof(input_shaper_time[i]));
+		amp[0] = 1.0f;
+
+		float freq = g_settings.input_shaper_freq[i];
+		if (freq <= 0)
+		{
+			continue;
+		}
+
+		float zeta = CLAMP(0, g_settings.input_shaper_damping[i], 0.99f);
+		float df = sqrtf(1.0f - zeta * zeta);
+		float k = expf(-zeta * M_PI / df);
+		// damped vibration period
+		float td = 1.0f / (freq * df);
+		uint8_t type = g_settings.input_shaper_type[i];
+		float duration = (type == INPUT_SHAPER_ZV) ? (0.5f * td) : td;
+		// trains that don't fit the delay line are shaped for the lowest frequency that fits
+		if (duration > INPUT_SHAPER_MAX_DURATION)
+		{
+			td *= INPUT_SHAPER_MAX_DURATION / duration;
+			duration = INPUT_SHAPER_MAX_DURATION;
+		}
+
+		switch (type)
+		{
+		case INPUT_SHAPER_ZVD:
+			amp[1] = 2.0f * k;
+			amp[2] = k * k;
+			break;
+		case INPUT_SHAPER_EI:
+			amp[0] = 0.25f * (1.0f + INPUT_SHAPER_EI_VTOL);
+			amp[1] = 0.5f * (1.0f - INPUT_SHAPER_EI_VTOL) * k;
+			amp[2] = amp[0] * k * k;
+			break;
+		default:
+			amp[1] = k;
+			break;
+		}
+
+		time[1] = 0.5f * td;
+		time[2] = (amp[2] != 0) ? td : 0;
+		float sum = amp[0] + amp[1] + amp[2];
+		for (uint8_t j = 0; j < INPUT_SHAPER_IMPULSES; j++)
+		{
+			amp[j] /= sum;
+		}
+
+		input_shaper_duration = MAX(input_shaper_duration, duration);
+	}
+
+	// the samples older than the previous trains are stale
+	memset(input_shaper_delay, 0, sizeof(input_shaper_delay));
+	input_shaper_head = 0;
+	input_shaper_head_time = 0;
+}
+
+// adds the commanded steps of dt seconds to the delay line (spread over the samples at constant speed)
+static void input_shaper_push(const int32_t *steps, float dt)
+{
+	float left = dt;
+	for (;;)
+	{
+		float slice = MIN(left, INPUT_SHAPER_SAMPLE_T - input_shaper_head_time);
+		float fraction = (dt > 0) ? (slice / dt) : 1.0f;
+		float *sample = input_shaper_delay[input_shaper_head];
+		for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+		{
+			sample[i] += (float)steps[i] * fraction;
+		}
+		input_shaper_head_time += slice;
+		left -= slice;
+		if (left <= 0)
+		{
+			break;
+		}
+
+		// starts a new sample
+		if (++input_shaper_head == INPUT_SHAPER_DELAY_SIZE)
+		{
+			input_shaper_head = 0;
+		}
+		memset(input_shaper_delay[input_shaper_head], 0, sizeof(input_shaper_delay[0]));
+		input_shaper_head_time = 0;
+	}
+}
+
+// commanded steps of a stepper in the last tau seconds
+static float input_shaper_travel(uint8_t stepper, float tau)
+{
+	uint8_t index = input_shaper_head;
+	float sample_t = input_shaper_head_time;
+	float travel = 0;
+	for (uint8_t n = INPUT_SHAPER_DELAY_SIZE; n != 0; n--)
+	{
+		float value = input_shaper_delay[index][stepper];
+		if (tau <= sample_t)
+		{
+			// constant speed inside the sample
+			return (travel + value * tau / sample_t);
+		}
+		travel += value;
+		tau -= sample_t;
+		sample_t = INPUT_SHAPER_SAMPLE_T;
+		index = ((index != 0) ? index : INPUT_SHAPER_DELAY_SIZE) - 1;
+	}
+
+	return travel;
+}
+
+void input_shaper_run(const int32_t *steps, const float *frac, float dt, int32_t *shaped, float *phase)
+{
+	bool moves = false;
+	for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+	{
+		if (steps[i])
+		{
+			moves = true;
+		}
+	}
+
+	if (moves && input_shaper_settled)
+	{
+		input_shaper_load();
+	}
+
+	input_shaper_push(steps, dt);
+	input_shaper_quiet = (moves) ? 0 : (input_shaper_quiet + dt);
+	// the sample of the last commanded step left the longest train
+	bool settled = (input_shaper_quiet >= (input_shaper_duration + 2 * INPUT_SHAPER_SAMPLE_T));
+
+	for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+	{
+		int32_t lag = input_shaper_lag[i] + steps[i];
+		if (frac)
+		{
+			input_shaper_cmd_frac[i] = frac[i];
+		}
+
+		// shaped position = sum of the impulse amplitudes times the commanded position at each impulse delay
+		// (relative to the commanded position, the first impulse has no delay)
+		float target = input_shaper_cmd_frac[i];
+		for (uint8_t j = 1; j < INPUT_SHAPER_IMPULSES; j++)
+		{
+			if (input_shaper_amp[i][j] != 0)
+			{
+				target -= input_shaper_amp[i][j] * input_shaper_travel(i, input_shaper_time[i][j]);
+			}
+		}
+
+		float rounded = floorf(target + 0.5f);
+		int32_t out = lag + (int32_t)rounded;
+		// progress from the last step to the next one in the direction of the segment at the segment start
+		phase[i] = (out >= 0) ? (input_shaper_frac[i] + 0.5f) : (0.5f - input_shaper_frac[i]);
+		input_shaper_frac[i] = target - rounded;
+		shaped[i] = out;
+		lag -= out;
+		input_shaper_lag[i] = lag;
+		if (lag)
+		{
+			settled = false;
+		}
+	}
+
+	input_shaper_settled = settled;
+}
+
+#endif
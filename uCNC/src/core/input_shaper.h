@@ -0,0 +1,71 @@
+/*
+	Name: input_shaper.h
+	Description: Input shaping stage between the interpolator and the step output for µCNC.
+		Convolves the commanded motion of each stepper with a ZV, ZVD or EI impulse train tuned to the
+		vibration frequency and damping of the axis, so the motion does not excite that resonance.
+
+		The interpolator feeds the commanded steps of each segment and gets back the shaped steps
+		of the same segment (same duration). The commanded steps are kept in a delay line of
+		INPUT_SHAPER_DELAY_SIZE samples of 1/INPUT_SHAPER_SAMPLE_FREQ seconds, so the longest impulse train
+		(and the lowest frequency that can be shaped) is fixed at compile time. The shaped motion lags
+		the commanded motion and keeps running for up to the impulse train duration after it ends.
+
+		$180+ - vibration frequency of each stepper in Hz (0 disables the shaping of that stepper)
+		$190+ - damping ratio of each stepper (0 to 0.99)
+		$200+ - impulse train of each stepper (0 - ZV, 1 - ZVD, 2 - EI)
+		The settings are loaded at the start of each motion from a stop.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef INPUT_SHAPER_H
+#define INPUT_SHAPER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_INPUT_SHAPING
+
+#define INPUT_SHAPER_ZV 0
+#define INPUT_SHAPER_ZVD 1
+#define INPUT_SHAPER_EI 2
+
+#ifndef INPUT_SHAPER_DELAY_SIZE
+#define INPUT_SHAPER_DELAY_SIZE 64
+#endif
+#ifndef INPUT_SHAPER_SAMPLE_FREQ
+#define INPUT_SHAPER_SAMPLE_FREQ (2 * INTERPOLATOR_FREQ)
+#endif
+
+	// discards the delay line (the shaped position jumps to the commanded position)
+	void input_shaper_clear(void);
+	// feeds the commanded steps of each stepper in a segment of dt seconds and the fraction of a step of the commanded
+	// position at the end of the segment (NULL keeps the last one) and returns the shaped steps of the same segment
+	// and the progress to the next step (0 to 1) at the start of the segment (steps and shaped can be the same array)
+	void input_shaper_run(const int32_t *steps, const float *frac, float dt, int32_t *shaped, float *phase);
+	// the shaped motion reached the commanded position and the delay line is empty
+	bool input_shaper_is_settled(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
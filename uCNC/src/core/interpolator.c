@@ -35,7 +35,14 @@
 
 // circular buffers
 // creates new type PULSE_BLOCK_BUFFER
+#ifndef ENABLE_INPUT_SHAPING
 static itp_block_t itp_blk_data[INTERPOLATOR_BUFFER_SIZE];
+#else
+// each shaped segment has its own block (same index as the segment) and the last block holds the commanded motion
+static itp_block_t itp_blk_data[INTERPOLATOR_BUFFER_SIZE + 1];
+// direction of the steppers that don't move in the shaped segment (keeps the last direction)
+static uint8_t itp_shaper_dirbits;
+#endif
 static uint8_t itp_blk_data_write;
 
 static itp_segment_t itp_sgm_data[INTERPOLATOR_BUFFER_SIZE];
@@ -59,6 +66,63 @@ static itp_segment_t *itp_rt_sgm;
 #ifdef ENABLE_MULTI_STEP_HOMING
 static volatile uint8_t itp_step_lock;
 #endif
+#if (defined(ENABLE_DUAL_CORE_MOTION) || defined(ENABLE_ITP_FEED_TASK))
+/**
+ * Motion core handshake
+ * The main core sets itp_core_request to keep the motion core (or the RTC ISR with ENABLE_ITP_FEED_TASK)
+ * out of the interpolator (while it clears the buffers) and the motion core sets itp_core_busy while it runs the interpolator.
+ * Each core writes its flag before reading the other one (with a full barrier in between)
+ * so they are never both inside.
+ * */
+static volatile uint8_t itp_core_request;
+static volatile uint8_t itp_core_busy;
+#endif
+
+#ifdef ENABLE_ITP_FIXED_POINT
+/**
+ * Fixed point segment generation
+ * The profile junctions are still computed in float once per block (or profile update)
+ * and each segment is generated with integer math only
+ * 	speeds - Q24.8 steps/s
+ * 	distances - Q16.16 steps (64bit to hold the flushed steps)
+ * 	times - Q0.32 seconds
+ * 	S-curve position - Q2.30 (1.0 = 1 << 30)
+ * */
+#define ITP_FX_SPEED(x) ((int32_t)lroundf((x) * 256.0f))
+#define ITP_FX_TO_FLT(x) ((float)(x) * (1.0f / 256.0f))
+#define ITP_FX_TIME(x) ((uint32_t)(MIN((x), 0.9999999f) * 4294967296.0f))
+#define ITP_FX_DELTA_T ((uint32_t)(4294967296.0 / INTERPOLATOR_FREQ))
+#define ITP_FX_UNIT (1UL << 30)
+#define ITP_FX_UNIT_MAX ((uint32_t)(0.999 * ITP_FX_UNIT))
+
+#ifndef MCU_HAS_FIXED_FREQ_TO_CLOCKS
+#define mcu_freq_to_clocks_fixed(frequency, ticks, prescaller) mcu_freq_to_clocks(ITP_FX_TO_FLT(frequency), ticks, prescaller)
+#endif
+
+// speed at the start of the next segment
+static int32_t itp_fx_speed;
+static int32_t itp_fx_junction;
+static int32_t itp_fx_max_rate;
+static int64_t itp_fx_distance;
+// speed change and duration of the acceleration and deacceleration segments
+static int32_t itp_fx_acc_dv;
+static uint32_t itp_fx_acc_dt;
+static int32_t itp_fx_deac_dv;
+static uint32_t itp_fx_deac_dt;
+static float itp_fx_feed_convert;
+#if S_CURVE_ACCELERATION_LEVEL != 0
+static bool itp_fx_acc_down;
+static int32_t itp_fx_acc_scale;
+static int32_t itp_fx_acc_init;
+static uint32_t itp_fx_acc_step;
+static uint32_t itp_fx_acc_acum;
+static int32_t itp_fx_deac_scale;
+// speed at the end of the deacceleration (the scale is the difference of the rounded speeds so the S-curve ends on it)
+static int32_t itp_fx_deac_exit;
+static uint32_t itp_fx_deac_step;
+static uint32_t itp_fx_deac_acum;
+#endif
+#endif
 
 #ifdef ENABLE_RT_SYNC_MOTIONS
 // deprecated with new hooks
@@ -97,6 +161,10 @@ CREATE_HOOK(itp_rt_pre_stepbits);
 CREATE_HOOK(itp_rt_stepbits);
 #endif
 
+#ifdef ENABLE_STEP_TRACE
+CREATE_HOOK(itp_rt_step_trace);
+#endif
+
 static void itp_sgm_buffer_read(void);
 static void itp_sgm_buffer_write(void);
 FORCEINLINE static bool itp_sgm_is_full(void);
@@ -178,16 +246,24 @@ static void itp_sgm_clear(void)
 
 static void itp_blk_buffer_write(void)
 {
+#ifndef ENABLE_INPUT_SHAPING
 	// curcular always. No need to control override
 	if (++itp_blk_data_write == INTERPOLATOR_BUFFER_SIZE)
 	{
 		itp_blk_data_write = 0;
 	}
+#endif
 }
 
 static void itp_blk_clear(void)
 {
+#ifndef ENABLE_INPUT_SHAPING
 	itp_blk_data_write = 0;
+#else
+	itp_blk_data_write = INTERPOLATOR_BUFFER_SIZE;
+	itp_shaper_dirbits = 0;
+	input_shaper_clear();
+#endif
 	memset(itp_blk_data, 0, sizeof(itp_blk_data));
 }
 
@@ -301,6 +377,137 @@ static float s_curve_function(float pt)
 	}
 #endif
 }
+
+#ifdef ENABLE_ITP_FIXED_POINT
+// the S-curve is sampled to a table and linearly interpolated
+// (the error is bounded by the curvature of the profile and is below 0.25% of the speed change)
+#define ITP_FX_SCURVE_BITS 6
+#define ITP_FX_SCURVE_SLICES (1 << ITP_FX_SCURVE_BITS)
+static int32_t itp_fx_scurve_lut[ITP_FX_SCURVE_SLICES + 1];
+static int8_t itp_fx_scurve_profile = -1;
+
+static void itp_fx_scurve_init(void)
+{
+#if S_CURVE_ACCELERATION_LEVEL == -1
+	int8_t profile = (int8_t)g_settings.s_curve_profile;
+#else
+	int8_t profile = S_CURVE_ACCELERATION_LEVEL;
+#endif
+	if (profile == itp_fx_scurve_profile)
+	{
+		return;
+	}
+
+	itp_fx_scurve_profile = profile;
+	for (uint8_t i = 0; i <= ITP_FX_SCURVE_SLICES; i++)
+	{
+		float k = s_curve_function((float)i / (float)ITP_FX_SCURVE_SLICES);
+		itp_fx_scurve_lut[i] = (int32_t)lroundf(CLAMP(0, k, 1) * 65536.0f);
+	}
+}
+
+// scales a speed (Q24.8) by the S-curve value at pt (Q2.30)
+static int32_t itp_fx_scurve(int32_t scale, uint32_t pt)
+{
+	int32_t k;
+	if (pt >= ITP_FX_UNIT)
+	{
+		k = itp_fx_scurve_lut[ITP_FX_SCURVE_SLICES];
+	}
+	else
+	{
+		uint8_t i = (uint8_t)(pt >> (30 - ITP_FX_SCURVE_BITS));
+		int32_t frac = (int32_t)((pt >> (15 - ITP_FX_SCURVE_BITS)) & 0x7FFF);
+		k = itp_fx_scurve_lut[i] + (((itp_fx_scurve_lut[i + 1] - itp_fx_scurve_lut[i]) * frac) >> 15);
+	}
+
+	return (int32_t)(((int64_t)scale * k) >> 16);
+}
+#endif
+#endif
+
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+// jerk limited speed change profile (see planner_jerk_time)
+// receives the fraction of the duration (0 to 1) and the fraction of it of each acceleration ramp (0 to 0.5)
+// outputs the fraction of the speed change (the acceleration ramps at constant jerk and holds in between)
+static float itp_jerk_curve(float pt, float ramp)
+{
+	// peak acceleration (the mean acceleration is 1)
+	float peak = 1.0f / (1.0f - ramp);
+	if (pt < ramp)
+	{
+		return peak * pt * pt / (2.0f * ramp);
+	}
+
+	if (pt > (1.0f - ramp))
+	{
+		pt = 1.0f - pt;
+		return 1.0f - peak * pt * pt / (2.0f * ramp);
+	}
+
+	return peak * (pt - 0.5f * ramp);
+}
+
+// top speed of a speed change from speed that ends at end_speed after distance steps
+// if the speed change continues in the next blocks it can't exceed the max speed of the junctions it passes
+static float itp_jerk_top_speed(float speed, float end_speed, float max_speed, float distance, bool chains)
+{
+	float top_speed = planner_get_block_jerk_top_speed(speed, end_speed, distance);
+	return (chains) ? MIN(top_speed, max_speed) : top_speed;
+}
+
+// elapsed fraction of a speed change at the end of the next slice
+// the last slice ends with the speed change (its time is shortened) and after it the slices hold the end speed
+static float itp_jerk_slice_end(float step_acum, float step, float *integrator)
+{
+	if (step_acum >= 1.0f)
+	{
+		return 1.0f;
+	}
+
+	float acum = step_acum + step;
+	if (acum > 1.0f)
+	{
+		*integrator *= (1.0f - step_acum) / step;
+		acum = 1.0f;
+	}
+	return acum;
+}
+
+// part of an interpolator slice that ends at the end of the block (1 if the slice ends before the end of the block)
+// the speed change continues in the next block so it only advances for the time spent in this block
+static float itp_jerk_slice_part(float speed, float new_speed, float integrator, float distance, float steps)
+{
+	float slice_dist = fast_flt_div2(speed + new_speed) * integrator;
+	// ends just after the last step of the block (the remaining fraction of a step carries to the next block)
+	steps += 0.01f - distance;
+	return (slice_dist > steps) ? (steps / slice_dist) : 1.0f;
+}
+
+/*
+	Changes the speed change of a running profile (from the same start speed)
+	The profiles of all speed changes are the same until the acceleration ramps down so the elapsed time is kept
+	if it's before the acceleration ramps down in both profiles.
+	Returns false if the profile can't be changed.
+*/
+static bool itp_jerk_retarget(float scale, float *step, float *step_acum, float *t_integrator, float *ramp)
+{
+	float new_ramp;
+	float t = planner_jerk_time(itp_cur_plan_block, scale, &new_ramp);
+	float slices = floorf(INTERPOLATOR_FREQ * t);
+	// the elapsed time (the slices of the running profile can be shortened at the ends of the blocks)
+	float elapsed = *step_acum * (*t_integrator) / (*step);
+	if (slices < 1 || *step_acum > (1.0f - *ramp) || elapsed > (t * (1.0f - new_ramp)))
+	{
+		return false;
+	}
+
+	*step = fast_flt_inv(slices);
+	*step_acum = elapsed / t;
+	*t_integrator = t * (*step);
+	*ramp = new_ramp;
+	return true;
+}
 #endif
 
 FORCEINLINE static uint8_t itp_get_linact_dirs(uint8_t mask)
@@ -324,6 +531,105 @@ FORCEINLINE static uint8_t itp_get_linact_dirs(uint8_t mask)
 	return 0;
 }
 
+#ifdef ENABLE_INPUT_SHAPING
+// replaces the commanded segment (steps of each stepper in dt seconds) by the shaped segment of the same duration
+// the shaped segment runs its own bresenham line on the block with the same index
+// the error of each stepper starts at the progress to the next step so the steps keep their spacing across segments
+static void itp_shape_segment(itp_segment_t *sgm, int32_t *steps, const float *frac, float dt)
+{
+	itp_block_t *block = &itp_blk_data[itp_sgm_data_write];
+	float phase[STEPPER_COUNT];
+	input_shaper_run(steps, frac, dt, steps, phase);
+
+	memset(block, 0, sizeof(itp_block_t));
+#ifdef GCODE_PROCESS_LINE_NUMBERS
+	block->line = itp_blk_data[INTERPOLATOR_BUFFER_SIZE].line;
+#endif
+	uint32_t max_steps = 0;
+#ifdef STEP_ISR_SKIP_MAIN
+	uint8_t main_stepper = 0;
+#endif
+	for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+	{
+		uint8_t mask = (1 << i);
+		uint32_t s = (uint32_t)ABS(steps[i]);
+		if (s)
+		{
+			itp_shaper_dirbits = (steps[i] < 0) ? (itp_shaper_dirbits | mask) : (itp_shaper_dirbits & ~mask);
+		}
+		else
+		{
+#ifdef STEP_ISR_SKIP_IDLE
+			block->idle_axis |= mask;
+#endif
+		}
+
+		block->dirbits |= itp_get_linact_dirs(itp_shaper_dirbits & mask);
+		block->steps[i] = (step_t)(s << 1);
+		if (s > max_steps)
+		{
+			max_steps = s;
+#ifdef STEP_ISR_SKIP_MAIN
+			main_stepper = i;
+#endif
+		}
+	}
+
+	// slow segments run at the interpolator rate at least (keeps the duration of segments with few or no steps)
+	float rate = (float)max_steps / dt;
+	uint32_t ticks = max_steps;
+	if (rate < INTERPOLATOR_FREQ)
+	{
+		ticks = (uint32_t)MAX(1, floorf(dt * INTERPOLATOR_FREQ + 0.5f));
+		rate = (float)ticks / dt;
+	}
+
+	block->total_steps = (step_t)(ticks << 1);
+	for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+	{
+		// any error from 1 to total_steps outputs the same number of steps
+		float error = floorf(phase[i] * (float)block->total_steps + 0.5f);
+		block->errors[i] = (step_t)CLAMP(1, error, (float)block->total_steps);
+	}
+#ifdef STEP_ISR_SKIP_MAIN
+	block->main_stepper = (ticks == max_steps) ? main_stepper : 255;
+#endif
+
+	float max_step_rate = 1000000.f / g_settings.max_step_rate;
+#if (DSS_MAX_OVERSAMPLING != 0)
+	uint8_t dss = 0;
+	while (rate < DSS_CUTOFF_FREQ && dss < DSS_MAX_OVERSAMPLING && max_steps)
+	{
+		rate = fast_flt_mul2(rate);
+		dss++;
+	}
+	// the block is new so the oversampling is not relative to the previous segment
+	sgm->next_dss = dss;
+	sgm->remaining_steps = (uint16_t)(ticks << dss);
+#else
+	sgm->remaining_steps = (uint16_t)ticks;
+#endif
+	rate = MIN(rate, max_step_rate);
+	mcu_freq_to_clocks(rate, &(sgm->timer_counter), &(sgm->timer_prescaller));
+	sgm->block = block;
+	sgm->flags |= ITP_UPDATE_ISR;
+}
+
+// writes a segment of the shaped motion that is still running after the commanded motion stopped
+static void itp_shape_tail(void)
+{
+	int32_t steps[STEPPER_COUNT];
+	itp_segment_t *sgm = &itp_sgm_data[itp_sgm_data_write];
+	memset(steps, 0, sizeof(steps));
+	memset(sgm, 0, sizeof(itp_segment_t));
+#if TOOL_COUNT > 0
+	sgm->spindle = prev_spindle;
+#endif
+	itp_shape_segment(sgm, steps, NULL, INTERPOLATOR_DELTA_T);
+	itp_sgm_buffer_write();
+}
+#endif
+
 void itp_run(void)
 {
 	// conversion vars
@@ -331,19 +637,44 @@ void itp_run(void)
 	static uint32_t deaccel_from = 0;
 	static float junction_speed = 0;
 	static float feed_convert = 0;
+#ifndef ENABLE_ITP_FIXED_POINT
 	static float partial_distance = 0;
+#endif
 	static float t_acc_integrator = 0;
 	static float t_deac_integrator = 0;
 #if S_CURVE_ACCELERATION_LEVEL != 0
 	static float acc_step = 0;
+#ifndef ENABLE_ITP_FIXED_POINT
 	static float acc_step_acum = 0;
+#endif
 	static float acc_scale = 0;
 	static float acc_init_speed = 0;
 
 	static float deac_step = 0;
+#ifndef ENABLE_ITP_FIXED_POINT
 	static float deac_step_acum = 0;
+#endif
 	static float deac_scale = 0;
 
+#endif
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	// speed change fraction of each segment, elapsed fraction, speed change, start speed and ramp fraction
+	static float acc_step = 0;
+	static float acc_step_acum = 0;
+	static float acc_scale = 0;
+	static float acc_init_speed = 0;
+	static float acc_ramp = 0;
+	static float acc_dist = 0;
+	static bool acc_running = false;
+	static float deac_step = 0;
+	static float deac_step_acum = 0;
+	static float deac_exit_speed = 0;
+	static float deac_scale = 0;
+	static float deac_ramp = 0;
+	static bool deac_running = false;
+	static bool hold_running = false;
+	// the speed changes can continue in the next block (see planner_get_block_exit_decel)
+	static bool block_chains = false;
 #endif
 
 	itp_segment_t *sgm = NULL;
@@ -358,13 +689,34 @@ void itp_run(void)
 			return;
 		}
 
+#ifdef ENABLE_DUAL_CORE_MOTION
+		// the main core raised the exit speed of an handed off block (same as itp_update)
+		if (planner_handoff_exit_updated())
+		{
+			itp_needs_update = true;
+		}
+#endif
+
 		// no planner blocks has beed processed or last planner block was fully processed
 		if (itp_cur_plan_block == NULL)
 		{
 			// planner is empty or interpolator block buffer full. Nothing to be done
 			// itp block will never be full if itp segment is not full
+#ifndef ENABLE_DUAL_CORE_MOTION
 			if (planner_buffer_is_empty() /* || itp_blk_is_full()*/)
+#else
+			// only the blocks handed off to the motion core
+			if (planner_handoff_is_empty())
+#endif
 			{
+#ifdef ENABLE_INPUT_SHAPING
+				// the shaped motion runs after the end of the commanded motion
+				if (!input_shaper_is_settled())
+				{
+					itp_shape_tail();
+					continue;
+				}
+#endif
 				break;
 			}
 			// get the first block in the planner
@@ -381,6 +733,9 @@ void itp_run(void)
 			itp_blk_data[itp_blk_data_write].total_steps = total_steps << 1;
 
 			feed_convert = itp_cur_plan_block->feed_conversion;
+#ifdef ENABLE_ITP_FIXED_POINT
+			itp_fx_feed_convert = feed_convert * (1.0f / 256.0f);
+#endif
 
 #ifdef STEP_ISR_SKIP_IDLE
 			itp_blk_data[itp_blk_data_write].idle_axis = 0;
@@ -405,6 +760,14 @@ void itp_run(void)
 
 			// flags block for recalculation of speeds
 			itp_needs_update = true;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+			// the running speed changes continue in the new block unless it starts from rest
+			if (!block_chains || !itp_cur_plan_block->entry_feed_sqr)
+			{
+				acc_running = false;
+				deac_running = false;
+			}
+#endif
 
 			// checks for synched motion
 			if (itp_cur_plan_block->planner_flags.bit.synched)
@@ -421,7 +784,17 @@ void itp_run(void)
 		memset(sgm, 0, sizeof(itp_segment_t));
 		sgm->block = &itp_blk_data[itp_blk_data_write];
 
+#ifndef ENABLE_ITP_FIXED_POINT
 		float current_speed = fast_flt_sqrt(itp_cur_plan_block->entry_feed_sqr);
+#else
+		// the speed is only read from the planner block when the profile is updated
+		float current_speed = 0;
+		if (itp_needs_update)
+		{
+			current_speed = fast_flt_sqrt(itp_cur_plan_block->entry_feed_sqr);
+			itp_fx_speed = ITP_FX_SPEED(current_speed);
+		}
+#endif
 
 		// if an hold is active forces to deaccelerate
 		if (cnc_get_exec_state(EXEC_HOLD))
@@ -430,10 +803,132 @@ void itp_run(void)
 			accel_until = remaining_steps;
 			deaccel_from = remaining_steps;
 			itp_needs_update = true;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+			if (!hold_running)
+			{
+				// a jerk limited stop from the current speed (it can span several blocks)
+				hold_running = true;
+				acc_running = false;
+				deac_running = false;
+				float t = planner_jerk_time(itp_cur_plan_block, current_speed, &deac_ramp);
+				float slices = MAX(1.0f, floorf(INTERPOLATOR_FREQ * t));
+				deac_step = fast_flt_inv(slices);
+				t_deac_integrator = MAX(t * deac_step, INTERPOLATOR_DELTA_T);
+				deac_step_acum = 0;
+				deac_exit_speed = 0;
+			}
+#endif
+#ifdef ENABLE_ITP_FIXED_POINT
+			itp_fx_deac_dv = ITP_FX_SPEED(t_deac_integrator * itp_cur_plan_block->acceleration);
+#endif
 		}
 		else if (itp_needs_update) // forces recalculation of acceleration and deacceleration profiles
 		{
 			itp_needs_update = false;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+			if (hold_running)
+			{
+				// resumes from the current speed
+				hold_running = false;
+				deac_running = false;
+			}
+			// the speed changes end at the exit speed or continue through the junctions and end with the deceleration after them
+			float max_speed_sqr;
+			float end_speed_sqr;
+			float end_dist;
+			block_chains = planner_get_block_exit_decel(&max_speed_sqr, &end_speed_sqr, &end_dist);
+			// the speed doesn't rise above it (or the current speed if it's already above it)
+			float max_speed = MAX(fast_flt_sqrt(max_speed_sqr), current_speed);
+			float end_speed = fast_flt_sqrt(end_speed_sqr);
+			end_dist += (float)remaining_steps;
+			if (block_chains && !deac_running)
+			{
+				// the speed changes end at the junction if they can rise above the max speed in this block
+				float exit_speed = fast_flt_sqrt(planner_get_block_exit_speed_sqr());
+				float top_speed = (acc_running) ? planner_get_block_jerk_top_speed(acc_init_speed, exit_speed, acc_dist + (float)remaining_steps) : planner_get_block_jerk_top_speed(current_speed, exit_speed, (float)remaining_steps);
+				if (top_speed > max_speed)
+				{
+					block_chains = false;
+					end_speed = exit_speed;
+					end_dist = (float)remaining_steps;
+				}
+			}
+			float ramp;
+			// a running speed change is kept (restarting it would step the acceleration) and it ends by time
+			accel_until = remaining_steps;
+			if (acc_running)
+			{
+				accel_until = 0;
+				// the planner only raises the speeds so the top speed is still reachable and it can be raised
+				float top_speed = itp_jerk_top_speed(acc_init_speed, end_speed, max_speed, acc_dist + end_dist, block_chains);
+				if (acc_scale > 0 && top_speed > junction_speed && itp_jerk_retarget(top_speed - acc_init_speed, &acc_step, &acc_step_acum, &t_acc_integrator, &acc_ramp))
+				{
+					acc_scale = top_speed - acc_init_speed;
+					junction_speed = top_speed;
+				}
+			}
+			else if (!deac_running)
+			{
+				junction_speed = itp_jerk_top_speed(current_speed, end_speed, max_speed, end_dist, block_chains);
+				float t = planner_jerk_time(itp_cur_plan_block, junction_speed - current_speed, &ramp);
+				if (t > INTERPOLATOR_DELTA_T)
+				{
+					// slice up time in an integral number of periods
+					acc_step = fast_flt_inv(floorf(INTERPOLATOR_FREQ * t));
+					t_acc_integrator = t * acc_step;
+					acc_step_acum = 0;
+					acc_scale = junction_speed - current_speed;
+					acc_init_speed = current_speed;
+					acc_ramp = ramp;
+					acc_dist = 0;
+					acc_running = true;
+					accel_until = 0;
+				}
+				else
+				{
+					// if entry speed already a junction speed updates it.
+					itp_cur_plan_block->entry_feed_sqr = fast_flt_pow2(junction_speed);
+					current_speed = junction_speed;
+				}
+			}
+
+			// the deacceleration starts where the remaining distance to its end is the distance of the speed change
+			deaccel_from = 0;
+			if (deac_running)
+			{
+				deaccel_from = remaining_steps;
+				// the deacceleration ends at a higher speed if the planner raised it
+				float start_speed = deac_exit_speed + deac_scale;
+				if (end_speed > deac_exit_speed && end_speed < start_speed && itp_jerk_retarget(start_speed - end_speed, &deac_step, &deac_step_acum, &t_deac_integrator, &deac_ramp))
+				{
+					deac_exit_speed = end_speed;
+					deac_scale = start_speed - end_speed;
+				}
+			}
+			else
+			{
+				float t = planner_jerk_time(itp_cur_plan_block, junction_speed - end_speed, &ramp);
+				// distance of the deacceleration in this block (it can start in a later block)
+				float deaccel_dist = fast_flt_div2((junction_speed + end_speed) * t) - end_dist + (float)remaining_steps;
+				if (junction_speed > end_speed && deaccel_dist > 0 && t > INTERPOLATOR_DELTA_T)
+				{
+					deaccel_from = (uint32_t)MIN(ceilf(deaccel_dist), (float)remaining_steps);
+					deac_step = fast_flt_inv(floorf(INTERPOLATOR_FREQ * t));
+					t_deac_integrator = t * deac_step;
+					deac_step_acum = 0;
+					deac_exit_speed = end_speed;
+					deac_ramp = ramp;
+				}
+			}
+
+			if (acc_running && remaining_steps <= deaccel_from)
+			{
+				// the deacceleration starts where it was planned (the blocks of a chain can have slightly different limits)
+				acc_running = false;
+				accel_until = remaining_steps;
+				junction_speed = current_speed;
+			}
+#else
 			float exit_speed_sqr = planner_get_block_exit_speed_sqr();
 			float junction_speed_sqr = planner_get_block_top_speed(exit_speed_sqr);
 
@@ -450,7 +945,11 @@ void itp_run(void)
 				float t = ABS(junction_speed - current_speed);
 #if S_CURVE_ACCELERATION_LEVEL != 0
 				acc_scale = t;
+#ifndef ENABLE_ITP_FIXED_POINT
 				acc_step_acum = 0;
+#else
+				itp_fx_acc_acum = 0;
+#endif
 				acc_init_speed = current_speed;
 #endif
 				t *= accel_inv;
@@ -490,7 +989,11 @@ void itp_run(void)
 				float t = ABS(junction_speed - fast_flt_sqrt(exit_speed_sqr));
 #if S_CURVE_ACCELERATION_LEVEL != 0
 				deac_scale = t;
+#ifndef ENABLE_ITP_FIXED_POINT
 				deac_step_acum = 0;
+#else
+				itp_fx_deac_acum = 0;
+#endif
 #endif
 				t *= accel_inv;
 
@@ -513,8 +1016,31 @@ void itp_run(void)
 					deaccel_from = 0;
 				}
 			}
+
+#ifdef ENABLE_ITP_FIXED_POINT
+			// converts the profile to fixed point
+			itp_fx_speed = ITP_FX_SPEED(current_speed);
+			itp_fx_junction = ITP_FX_SPEED(junction_speed);
+			itp_fx_max_rate = ITP_FX_SPEED(1000000.f / g_settings.max_step_rate);
+			itp_fx_acc_dv = ITP_FX_SPEED(t_acc_integrator * itp_cur_plan_block->acceleration);
+			itp_fx_acc_dt = ITP_FX_TIME(ABS(t_acc_integrator));
+			itp_fx_deac_dv = ITP_FX_SPEED(t_deac_integrator * itp_cur_plan_block->acceleration);
+			itp_fx_deac_dt = ITP_FX_TIME(t_deac_integrator);
+#if S_CURVE_ACCELERATION_LEVEL != 0
+			itp_fx_scurve_init();
+			itp_fx_acc_down = (t_acc_integrator < 0);
+			itp_fx_acc_scale = ITP_FX_SPEED(acc_scale);
+			itp_fx_acc_init = ITP_FX_SPEED(acc_init_speed);
+			itp_fx_acc_step = (uint32_t)(MIN(acc_step, 1.0f) * ITP_FX_UNIT);
+			itp_fx_deac_exit = ITP_FX_SPEED(junction_speed - deac_scale);
+			itp_fx_deac_scale = itp_fx_junction - itp_fx_deac_exit;
+			itp_fx_deac_step = (uint32_t)(MIN(deac_step, 1.0f) * ITP_FX_UNIT);
+#endif
+#endif
+#endif
 		}
 
+#ifndef ENABLE_ITP_FIXED_POINT
 		float speed_change;
 		float profile_steps_limit;
 		float integrator;
@@ -531,18 +1057,36 @@ void itp_run(void)
 				(final_speed - initial_speed) = acceleration * INTERPOLATOR_DELTA_T;
 			*/
 			integrator = t_acc_integrator;
-#if S_CURVE_ACCELERATION_LEVEL != 0
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+			// the acceleration also ends where the deacceleration starts
+			profile_steps_limit = MAX(accel_until, deaccel_from);
+			float acum = itp_jerk_slice_end(acc_step_acum, acc_step, &integrator);
+			float new_speed = acc_init_speed + acc_scale * itp_jerk_curve(acum, acc_ramp);
+			float part = itp_jerk_slice_part(current_speed, new_speed, integrator, partial_distance, (float)remaining_steps - profile_steps_limit);
+			if (part < 1.0f)
+			{
+				integrator *= part;
+				acum = acc_step_acum + (acum - acc_step_acum) * part;
+				new_speed = acc_init_speed + acc_scale * itp_jerk_curve(acum, acc_ramp);
+			}
+			acc_step_acum = acum;
+			speed_change = new_speed - current_speed;
+			// the speed change ends with this segment
+			acc_running = (acum < 1.0f);
+#elif S_CURVE_ACCELERATION_LEVEL != 0
 			float acum = acc_step_acum;
 			acum += acc_step;
 			acc_step_acum = MIN(acum, 0.999f);
-			float new_speed = acc_scale * s_curve_function(acum) + acc_init_speed;
+			float new_speed = acc_scale * s_curve_function(acum);
 			new_speed = (t_acc_integrator >= 0) ? (new_speed + acc_init_speed) : (acc_init_speed - new_speed);
 			speed_change = new_speed - current_speed;
 #else
 			speed_change = integrator * itp_cur_plan_block->acceleration;
 #endif
 
+#ifndef ENABLE_JERK_LIMITED_PLANNER
 			profile_steps_limit = accel_until;
+#endif
 			sgm->flags = ITP_UPDATE_ISR | ITP_ACCEL;
 		}
 		else if (remaining_steps > deaccel_from)
@@ -556,7 +1100,30 @@ void itp_run(void)
 		else
 		{
 			integrator = t_deac_integrator;
-#if S_CURVE_ACCELERATION_LEVEL != 0
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+			if (deac_step_acum == 0)
+			{
+				// starts from the actual speed
+				deac_scale = current_speed - deac_exit_speed;
+			}
+			float acum = itp_jerk_slice_end(deac_step_acum, deac_step, &integrator);
+			float new_speed = deac_exit_speed + deac_scale * (1.0f - itp_jerk_curve(acum, deac_ramp));
+			float part = itp_jerk_slice_part(current_speed, new_speed, integrator, partial_distance, (float)remaining_steps);
+			if (part < 1.0f)
+			{
+				integrator *= part;
+				acum = deac_step_acum + (acum - deac_step_acum) * part;
+			}
+			deac_step_acum = acum;
+			// holds the exit speed after the end of the speed change and updates the profile
+			if (deac_running && acum >= 1.0f)
+			{
+				itp_needs_update = true;
+			}
+			deac_running = (acum < 1.0f);
+			new_speed = deac_exit_speed + deac_scale * (1.0f - itp_jerk_curve(deac_step_acum, deac_ramp));
+			speed_change = new_speed - current_speed;
+#elif S_CURVE_ACCELERATION_LEVEL != 0
 			float acum = deac_step_acum;
 			acum += deac_step;
 			deac_step_acum = MIN(acum, 0.999f);
@@ -595,12 +1162,30 @@ void itp_run(void)
 
 			if (cnc_get_exec_state(EXEC_HOLD))
 			{
+#ifdef ENABLE_INPUT_SHAPING
+				// the shaped motion stops after the commanded motion
+				if (!input_shaper_is_settled())
+				{
+					itp_shape_tail();
+					continue;
+				}
+#endif
 				return;
 			}
 
-			// flush remaining steps
-			segm_steps = (uint16_t)remaining_steps;
-			current_speed = -speed_change;
+			if (remaining_steps > accel_until && t_acc_integrator > 0)
+			{
+				// the acceleration is starting from rest (the first slices of the s-curve are still at zero speed)
+				segm_steps = 0;
+				current_speed = 0;
+			}
+			else
+			{
+				// flush remaining steps (they don't carry as a negative distance to the next segment)
+				segm_steps = (uint16_t)remaining_steps;
+				partial_distance = (float)segm_steps;
+				current_speed = -speed_change;
+			}
 		}
 
 		// computes how many steps it will perform at this speed and frame window
@@ -656,10 +1241,160 @@ void itp_run(void)
 #endif
 
 		sgm->feed = current_speed * feed_convert;
+#else
+		int32_t speed_change;
+		uint32_t profile_steps_limit;
+		uint32_t integrator;
+		// acceleration profile
+		if (remaining_steps > accel_until)
+		{
+			integrator = itp_fx_acc_dt;
+#if S_CURVE_ACCELERATION_LEVEL != 0
+			uint32_t acum = itp_fx_acc_acum + itp_fx_acc_step;
+			itp_fx_acc_acum = MIN(acum, ITP_FX_UNIT_MAX);
+			int32_t new_speed = itp_fx_scurve(itp_fx_acc_scale, acum);
+			new_speed = (!itp_fx_acc_down) ? (new_speed + itp_fx_acc_init) : (itp_fx_acc_init - new_speed);
+			speed_change = new_speed - itp_fx_speed;
+#else
+			speed_change = itp_fx_acc_dv;
+#endif
+			profile_steps_limit = accel_until;
+			sgm->flags = ITP_UPDATE_ISR | ITP_ACCEL;
+		}
+		else if (remaining_steps > deaccel_from)
+		{
+			// constant speed segment
+			speed_change = 0;
+			profile_steps_limit = deaccel_from;
+			integrator = ITP_FX_DELTA_T;
+			sgm->flags = (remaining_steps == accel_until) ? (ITP_UPDATE_ISR | ITP_CONST) : ITP_CONST;
+		}
+		else
+		{
+			integrator = itp_fx_deac_dt;
+#if S_CURVE_ACCELERATION_LEVEL != 0
+			uint32_t acum = itp_fx_deac_acum + itp_fx_deac_step;
+			itp_fx_deac_acum = MIN(acum, ITP_FX_UNIT_MAX);
+			int32_t new_speed = itp_fx_junction - itp_fx_scurve(itp_fx_deac_scale, acum);
+			speed_change = new_speed - itp_fx_speed;
+#else
+			speed_change = -itp_fx_deac_dv;
+#endif
+			profile_steps_limit = 0;
+			sgm->flags = ITP_UPDATE_ISR | ITP_DEACCEL;
+		}
+
+		// update speed at the end of segment
+		int32_t segment_speed = itp_fx_speed;
+		if (speed_change)
+		{
+			itp_fx_speed = ABS(itp_fx_speed + speed_change);
+			float exit_speed = ITP_FX_TO_FLT(itp_fx_speed);
+#if S_CURVE_ACCELERATION_LEVEL != 0
+			// the end of the deacceleration stores the float exit speed like the float path
+			// (a rounded speed can move the deacceleration start of the next block by one step)
+			if (remaining_steps <= deaccel_from && itp_fx_speed == itp_fx_deac_exit)
+			{
+				exit_speed = junction_speed - deac_scale;
+			}
+#endif
+			itp_cur_plan_block->entry_feed_sqr = fast_flt_pow2(exit_speed);
+		}
+
+		/*
+			common calculations for all three profiles (accel, constant and deaccel)
+		*/
+		uint16_t segm_steps;
+		speed_change >>= 1;
+		segment_speed += speed_change;
+
+		if (segment_speed > 0)
+		{
+			itp_fx_distance += (int64_t)(((uint64_t)(uint32_t)segment_speed * integrator) >> 24);
+			// computes how many steps it will perform at this speed and frame window
+			segm_steps = (uint16_t)(itp_fx_distance >> 16);
+		}
+		else
+		{
+			// speed can't be negative
+			itp_cur_plan_block->entry_feed_sqr = 0;
+			itp_fx_speed = 0;
+
+			if (cnc_get_exec_state(EXEC_HOLD))
+			{
+				return;
+			}
+
+			if (remaining_steps > accel_until && itp_fx_acc_dv > 0)
+			{
+				// the acceleration is starting from rest (see above)
+				segm_steps = 0;
+				segment_speed = 0;
+			}
+			else
+			{
+				// flush remaining steps
+				segm_steps = (uint16_t)remaining_steps;
+				segment_speed = -speed_change;
+			}
+		}
+
+		// computes how many steps it will perform at this speed and frame window
+		itp_fx_distance -= ((int64_t)segm_steps << 16);
+
+		// if computed steps exceed the remaining steps for the motion shortens the distance
+		if (segm_steps > (remaining_steps - profile_steps_limit))
+		{
+			segm_steps = (uint16_t)(remaining_steps - profile_steps_limit);
+		}
+
+		// DSS (see above) with the step rate in fixed point
+#if (DSS_MAX_OVERSAMPLING != 0)
+		int32_t dss_speed = MAX(((int32_t)INTERPOLATOR_FREQ << 8), segment_speed);
+		uint8_t dss = 0;
+#ifdef ENABLE_PLASMA_THC
+		// plasma THC forces DSS to always be enabled at level 1 at least
+		if (g_settings.laser_mode == PLASMA_THC_MODE)
+		{
+			dss_speed <<= 1;
+			// clamp top speed
+			segment_speed <<= 1;
+			segment_speed = MIN(segment_speed, itp_fx_max_rate);
+			dss = 1;
+		}
+#endif
+		while (dss_speed < ((int32_t)DSS_CUTOFF_FREQ << 8) && dss < DSS_MAX_OVERSAMPLING && segm_steps)
+		{
+			dss_speed <<= 1;
+			dss++;
+		}
+
+		if (dss != prev_dss)
+		{
+			sgm->flags = ITP_UPDATE_ISR;
+		}
+		sgm->next_dss = dss - prev_dss;
+		prev_dss = dss;
+
+		// completes the segment information (step speed, steps) and updates the block
+		sgm->remaining_steps = segm_steps << dss;
+		dss_speed = MIN(dss_speed, itp_fx_max_rate);
+		mcu_freq_to_clocks_fixed((uint32_t)dss_speed, &(sgm->timer_counter), &(sgm->timer_prescaller));
+#else
+		sgm->remaining_steps = segm_steps;
+		segment_speed = MIN(segment_speed, itp_fx_max_rate);
+		mcu_freq_to_clocks_fixed((uint32_t)MAX(((int32_t)INTERPOLATOR_FREQ << 8), segment_speed), &(sgm->timer_counter), &(sgm->timer_prescaller));
+#endif
+
+		sgm->feed = (float)segment_speed * itp_fx_feed_convert;
+#endif
 #if TOOL_COUNT > 0
 		// calculates dynamic laser power
 		if (g_settings.laser_mode == LASER_PWM_MODE)
 		{
+#ifdef ENABLE_ITP_FIXED_POINT
+			current_speed = ITP_FX_TO_FLT(segment_speed);
+#endif
 			float top_speed_inv = fast_flt_invsqrt(itp_cur_plan_block->feed_sqr);
 			int16_t newspindle = planner_get_spindle_speed(MIN(1, current_speed * top_speed_inv));
 
@@ -704,9 +1439,31 @@ void itp_run(void)
 #endif
 		remaining_steps -= segm_steps;
 
-		if (remaining_steps == accel_until && !cnc_get_exec_state(EXEC_HOLD)) // resets float additions error
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		// the acceleration ended and the block continues at the top speed
+		// (the speed changes can end at any step so only the end of the acceleration sets the speed)
+		acc_dist += segm_steps;
+		if (acc_running && remaining_steps <= deaccel_from)
+		{
+			// the deacceleration starts where it was planned (the blocks of a chain can have slightly different limits)
+			acc_running = false;
+			junction_speed = fast_flt_sqrt(itp_cur_plan_block->entry_feed_sqr);
+		}
+		bool accel_end = (!acc_running && !accel_until);
+		if (accel_end)
+		{
+			accel_until = remaining_steps;
+		}
+#else
+		bool accel_end = (remaining_steps == accel_until);
+#endif
+
+		if (accel_end && !cnc_get_exec_state(EXEC_HOLD)) // resets float additions error
 		{
 			itp_cur_plan_block->entry_feed_sqr = fast_flt_pow2(junction_speed);
+#ifdef ENABLE_ITP_FIXED_POINT
+			itp_fx_speed = itp_fx_junction;
+#endif
 		}
 
 		itp_cur_plan_block->steps[itp_cur_plan_block->main_stepper] = remaining_steps;
@@ -717,6 +1474,12 @@ void itp_run(void)
 			sgm->flags |= ITP_SYNC;
 		}
 
+#ifdef ENABLE_SYNC_OUTPUTS
+		// the first segment of the block arms the synchronized outputs
+		sgm->sync_output = itp_cur_plan_block->sync_output;
+		itp_cur_plan_block->sync_output = 0;
+#endif
+
 		// overwrites previous values
 #ifdef ENABLE_BACKLASH_COMPENSATION
 		if (itp_cur_plan_block->planner_flags.bit.backlash_comp)
@@ -725,11 +1488,34 @@ void itp_run(void)
 		}
 #endif
 
+#ifdef ENABLE_INPUT_SHAPING
+		// commanded steps of each stepper in the segment (rounded position along the bresenham line of the block)
+		// and the fraction of a step left at the end of the segment
+		// the segment is replaced by the shaped segment
+		{
+			int32_t steps[STEPPER_COUNT];
+			float frac[STEPPER_COUNT];
+			uint64_t total = itp_blk_data[itp_blk_data_write].total_steps >> 1;
+			uint64_t done = total - remaining_steps;
+			for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+			{
+				uint64_t line = itp_blk_data[itp_blk_data_write].steps[i] >> 1;
+				uint64_t position = (2 * line * done + total) / (2 * total);
+				int32_t delta = (int32_t)(position - ((2 * line * (done - segm_steps) + total) / (2 * total)));
+				float left = (float)((int64_t)(line * done) - (int64_t)(position * total)) / (float)total;
+				bool reverse = (itp_cur_plan_block->dirbits & (1 << i));
+				steps[i] = (reverse) ? -delta : delta;
+				frac[i] = (reverse) ? -left : left;
+			}
+			float segm_rate = MAX(INTERPOLATOR_FREQ, MIN(current_speed, max_step_rate));
+			itp_shape_segment(sgm, steps, frac, ((segm_steps) ? (float)segm_steps : 1.0f) / segm_rate);
+		}
+#endif
+
 		if (remaining_steps == 0)
 		{
 			itp_blk_buffer_write();
 			itp_cur_plan_block = NULL;
-			planner_discard_block(); // discards planner block
 #if (DSS_MAX_OVERSAMPLING != 0)
 			prev_dss = 0;
 #endif
@@ -739,6 +1525,13 @@ void itp_run(void)
 
 		// finally write the segment
 		itp_sgm_buffer_write();
+
+		if (remaining_steps == 0)
+		{
+			// discards the planner block after the last segment is written
+			// so the planner and the interpolator are never both empty while the block is still running
+			planner_discard_block();
+		}
 	}
 #if TOOL_COUNT > 0
 	// updated the coolant pins
@@ -762,6 +1555,10 @@ void itp_stop(void)
 	if (state & EXEC_RUN)
 	{
 		cnc_set_exec_state(EXEC_UNHOMED);
+#ifdef ENABLE_STEP_DMA
+		// discards the buffered steps
+		step_dma_abort();
+#endif
 	}
 
 	mcu_delay_us(10);
@@ -782,11 +1579,51 @@ void itp_stop_tools(void)
 	tool_stop();
 }
 
+#if (defined(ENABLE_DUAL_CORE_MOTION) || defined(ENABLE_ITP_FEED_TASK))
+static void itp_core_lock(void)
+{
+	itp_core_request = 1;
+	ATOMIC_FENCE();
+	while (ATOMIC_LOAD_ACQUIRE(itp_core_busy))
+		;
+}
+
+static void itp_core_unlock(void)
+{
+	ATOMIC_STORE_RELEASE(itp_core_request, 0);
+}
+
+void itp_core_run(void)
+{
+	itp_core_busy = 1;
+	ATOMIC_FENCE();
+	if (!ATOMIC_LOAD_ACQUIRE(itp_core_request))
+	{
+		itp_run();
+	}
+	ATOMIC_STORE_RELEASE(itp_core_busy, 0);
+}
+#endif
+
 void itp_clear(void)
 {
+#if (defined(ENABLE_DUAL_CORE_MOTION) || defined(ENABLE_ITP_FEED_TASK))
+	itp_core_lock();
+#endif
+	// the planner blocks are discarded with the interpolator buffers
+	planner_flush();
 	itp_cur_plan_block = NULL;
 	itp_blk_clear();
 	itp_sgm_clear();
+#ifdef ENABLE_SYNC_OUTPUTS
+	sync_output_clear();
+#endif
+#ifdef ENABLE_ARMED_START
+	armed_start_clear();
+#endif
+#if (defined(ENABLE_DUAL_CORE_MOTION) || defined(ENABLE_ITP_FEED_TASK))
+	itp_core_unlock();
+#endif
 }
 
 void itp_get_rt_position(int32_t *position)
@@ -840,8 +1677,43 @@ float itp_get_rt_feed(void)
 	return feed;
 }
 
+// steppers that move in the segment being executed
+uint8_t itp_get_rt_active_steppers(void)
+{
+	uint8_t mask = 0;
+	if (!cnc_get_exec_state(EXEC_RUN))
+	{
+		return mask;
+	}
+
+	if (!itp_sgm_is_empty())
+	{
+		itp_block_t *block = itp_sgm_data[itp_sgm_data_read].block;
+		if (block != NULL)
+		{
+			for (uint8_t i = STEPPER_COUNT; i != 0;)
+			{
+				i--;
+				if (block->steps[i])
+				{
+					mask |= (1 << i);
+				}
+			}
+		}
+	}
+
+	return mask;
+}
+
 bool itp_is_empty(void)
 {
+#ifdef ENABLE_INPUT_SHAPING
+	// the shaped motion can still be running after the commanded motion
+	if (!input_shaper_is_settled())
+	{
+		return false;
+	}
+#endif
 	return (itp_sgm_is_empty() && (itp_rt_sgm == NULL));
 }
 
@@ -889,8 +1761,17 @@ uint32_t itp_get_rt_line_number(void)
 // always fires after pulse
 MCU_CALLBACK void mcu_step_reset_cb(void)
 {
+	CYCLE_PROFILER_START(CYCLE_PROFILER_STEP_RESET);
 	// always resets all stepper pins
 	io_set_steps(g_settings.step_invert_mask);
+#ifdef ENABLE_MOTION_SAMPLER
+	// samples after the step pulse (does not delay the step outputs)
+	if (motion_sampler_state & MOTION_SAMPLER_RUNNING)
+	{
+		motion_sampler_sample();
+	}
+#endif
+	CYCLE_PROFILER_END(CYCLE_PROFILER_STEP_RESET);
 }
 
 MCU_CALLBACK void mcu_step_cb(void)
@@ -910,6 +1791,8 @@ MCU_CALLBACK void mcu_step_cb(void)
 		return;
 	}
 
+	CYCLE_PROFILER_START(CYCLE_PROFILER_STEP);
+
 #ifdef ENABLE_RT_PROBE_CHECKING
 	mcu_probe_changed_cb();
 #endif
@@ -923,7 +1806,17 @@ MCU_CALLBACK void mcu_step_cb(void)
 	if (itp_rt_sgm != NULL)
 	{
 		dirs = itp_rt_sgm->block->dirbits;
+#ifdef ENABLE_SYNC_OUTPUTS
+		// time of the step outputs (latency of the synchronized outputs)
+		uint32_t step_cycles = mcu_cycle_count();
+#endif
 		io_toggle_steps(new_stepbits);
+#ifdef ENABLE_ARMED_START
+		if (new_stepbits && armed_start_state == ARMED_START_TRIGGERED)
+		{
+			armed_start_step();
+		}
+#endif
 
 		// sets step bits
 #ifdef ENABLE_RT_SYNC_MOTIONS
@@ -1023,6 +1916,20 @@ MCU_CALLBACK void mcu_step_cb(void)
 		}
 #endif
 
+#ifdef ENABLE_STEP_TRACE
+		if (new_stepbits)
+		{
+			HOOK_INVOKE(itp_rt_step_trace, itp_rt_step_pos);
+		}
+#endif
+
+#ifdef ENABLE_SYNC_OUTPUTS
+		if (sync_output_armed)
+		{
+			sync_output_step(itp_rt_step_pos, new_stepbits, step_cycles);
+		}
+#endif
+
 		if (itp_rt_sgm->flags & ITP_UPDATE)
 		{
 			if (itp_rt_sgm->flags & ITP_UPDATE_ISR)
@@ -1116,6 +2023,12 @@ MCU_CALLBACK void mcu_step_cb(void)
 #endif
 				// set dir pins for current
 				io_set_dirs(itp_rt_sgm->block->dirbits);
+#ifdef ENABLE_SYNC_OUTPUTS
+				if (itp_rt_sgm->sync_output)
+				{
+					sync_output_arm(itp_rt_sgm->sync_output, itp_rt_step_pos);
+				}
+#endif
 			}
 		}
 		else
@@ -1328,10 +2241,18 @@ MCU_CALLBACK void mcu_step_cb(void)
 #else
 	stepbits = new_stepbits;
 #endif
+	CYCLE_PROFILER_END(CYCLE_PROFILER_STEP);
 }
 
 void itp_start(bool is_synched)
 {
+#ifdef ENABLE_ARMED_START
+	// the start is held until the armed DIN edge
+	if (armed_start_state == ARMED_START_ARMED)
+	{
+		return;
+	}
+#endif
 	// starts the step isr if is stopped and there are segments to execute
 	if (!cnc_get_exec_state(EXEC_RUN | EXEC_HOLD | EXEC_ALARM) && !itp_sgm_is_empty()) // exec state is not hold or alarm and not already running
 	{
@@ -1347,6 +2268,23 @@ void itp_start(bool is_synched)
 	}
 }
 
+#ifdef ENABLE_ARMED_START
+bool itp_start_armed(uint16_t ticks, uint16_t prescaller)
+{
+	if (cnc_get_exec_state(EXEC_RUN | EXEC_HOLD | EXEC_ALARM) || itp_sgm_is_empty())
+	{
+		return false;
+	}
+
+	// the ISR loads the first segment and outputs it's first step at the given rate
+	// the segment rate takes over at the first step
+	itp_sgm_data[itp_sgm_data_read].flags |= ITP_UPDATE_ISR;
+	cnc_set_exec_state(EXEC_RUN);
+	mcu_start_itp_isr(ticks, prescaller);
+	return true;
+}
+#endif
+
 itp_segment_t *itp_get_rt_segment()
 {
 	return (itp_sgm_is_empty()) ? NULL : &itp_sgm_data[itp_sgm_data_read];
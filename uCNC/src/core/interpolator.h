@@ -83,6 +83,9 @@ extern "C"
 #endif
 #if TOOL_COUNT > 0
 		int16_t spindle;
+#endif
+#ifdef ENABLE_SYNC_OUTPUTS
+		uint8_t sync_output;
 #endif
 		float feed;
 		uint8_t flags;
@@ -99,6 +102,7 @@ extern "C"
 	int32_t itp_get_rt_position_index(int8_t index);
 	void itp_reset_rt_position(float *origin);
 	float itp_get_rt_feed(void);
+	uint8_t itp_get_rt_active_steppers(void);
 	bool itp_is_empty(void);
 	uint8_t itp_sync(void);
 	itp_segment_t *itp_get_rt_segment();
@@ -106,9 +110,17 @@ extern "C"
 
 	void itp_sync_spindle(void);
 	void itp_start(bool is_synched);
+#ifdef ENABLE_ARMED_START
+	// starts the step ISR on the held segments at the given timer rate (armed start trigger ISR)
+	bool itp_start_armed(uint16_t ticks, uint16_t prescaller);
+#endif
 #ifdef ENABLE_MULTI_STEP_HOMING
 	void itp_lock_stepper(uint8_t lockmask);
 #endif
+#if (defined(ENABLE_DUAL_CORE_MOTION) || defined(ENABLE_ITP_FEED_TASK))
+	// runs the interpolator on the motion core or the RTC ISR (unless the main core is clearing it)
+	void itp_core_run(void);
+#endif
 #ifdef GCODE_PROCESS_LINE_NUMBERS
 	uint32_t itp_get_rt_line_number(void);
 #endif
@@ -119,6 +131,10 @@ extern "C"
 	DECL_HOOK(itp_rt_pre_stepbits, uint8_t *, uint8_t *);
 	DECL_HOOK(itp_rt_stepbits, uint8_t, uint8_t);
 #endif
+#ifdef ENABLE_STEP_TRACE
+	// real-time step position trace hook (fired after the step position is updated)
+	DECL_HOOK(itp_rt_step_trace, int32_t *);
+#endif
 
 #ifdef __cplusplus
 }
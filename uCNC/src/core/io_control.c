@@ -88,6 +88,10 @@ WEAK_EVENT_HANDLER(probe_disable)
 
 #endif
 
+#ifdef ENABLE_STEP_TRACE
+CREATE_HOOK(io_step_trace);
+#endif
+
 MCU_IO_CALLBACK void mcu_limits_changed_cb(void)
 {
 #ifdef DISABLE_ALL_LIMITS
@@ -296,6 +300,10 @@ MCU_IO_CALLBACK void mcu_inputs_changed_cb(void)
 
 	if (diff)
 	{
+#ifdef ENABLE_ARMED_START
+		// first (starts the motion)
+		armed_start_input(inputs, diff);
+#endif
 #if (ENCODERS > 0)
 		encoders_update(inputs, diff);
 #endif
@@ -485,6 +493,15 @@ void io_set_steps(uint8_t mask)
 	// #ifdef ENABLE_IO_MODULES
 	// 	EVENT_INVOKE(set_steps, &mask);
 	// #endif
+#ifdef ENABLE_STEP_DMA
+	if (step_dma_set_steps(mask))
+	{
+		return;
+	}
+#endif
+#ifdef ENABLE_STEP_TRACE
+	HOOK_INVOKE(io_step_trace, IO_TRACE_SET_STEPS, mask);
+#endif
 
 #if ASSERT_PIN(STEP0)
 	if (mask & STEP0_IO_MASK)
@@ -583,6 +600,16 @@ void io_toggle_steps(uint8_t mask)
 		return;
 	}
 
+#ifdef ENABLE_STEP_DMA
+	if (step_dma_toggle_steps(mask))
+	{
+		return;
+	}
+#endif
+#ifdef ENABLE_STEP_TRACE
+	HOOK_INVOKE(io_step_trace, IO_TRACE_TOGGLE_STEPS, mask);
+#endif
+
 #if ASSERT_PIN(STEP0)
 	if (mask & STEP0_IO_MASK)
 	{
@@ -664,6 +691,15 @@ void io_get_steps_pos(int32_t *position)
 
 void io_set_dirs(uint8_t mask)
 {
+#ifdef ENABLE_STEP_DMA
+	if (step_dma_set_dirs(mask ^ g_settings.dir_invert_mask))
+	{
+		return;
+	}
+#endif
+#ifdef ENABLE_STEP_TRACE
+	HOOK_INVOKE(io_step_trace, IO_TRACE_SET_DIRS, mask);
+#endif
 	mask ^= g_settings.dir_invert_mask;
 
 	// #ifdef ENABLE_IO_MODULES
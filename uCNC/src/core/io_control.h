@@ -156,6 +156,15 @@ extern io_probe_action_cb io_probe_custom_disable;
 // DECL_EVENT_HANDLER(set_output);
 #endif
 
+#ifdef ENABLE_STEP_TRACE
+#define IO_TRACE_SET_STEPS 1
+#define IO_TRACE_TOGGLE_STEPS 2
+#define IO_TRACE_SET_DIRS 3
+	// step/dir outputs trace hook (trace type, step/dir mask)
+	// the dir mask is the logical direction (before the dir invert mask is applied)
+	DECL_HOOK(io_step_trace, uint8_t, uint8_t);
+#endif
+
 #ifdef ENABLE_IO_ALARM_DEBUG
 	extern uint8_t io_alarm_limits;
 	extern uint8_t io_alarm_controls;
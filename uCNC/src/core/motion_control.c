@@ -52,6 +52,9 @@ static float mc_last_target[AXIS_COUNT];
 #ifdef ENABLE_BACKLASH_COMPENSATION
 static uint8_t mc_last_dirbits;
 #endif
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+static bool mc_duty_cycle_split;
+#endif
 
 #ifdef ENABLE_G39_H_MAPPING
 
@@ -131,6 +134,51 @@ static void FORCEINLINE mc_restore_step_mode(uint8_t *mode)
 
 static uint8_t mc_line_segment(int32_t *step_new_pos, motion_data_t *block_data)
 {
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+	// splits a motion that is longer than the on time budget of it's steppers in inline blocks
+	// so that the steppers can cool down between them
+	if (!mc_duty_cycle_split && !mc_checkmode && !cnc_get_exec_state(EXEC_HOMING))
+	{
+		uint32_t max_steps = 0;
+		for (uint8_t i = STEPPER_COUNT; i != 0;)
+		{
+			i--;
+			uint32_t steps = (uint32_t)ABS(step_new_pos[i] - mc_last_step_pos[i]);
+			block_data->steps[i] = (step_t)steps;
+			max_steps = MAX(max_steps, steps);
+		}
+
+		uint32_t blocks = duty_cycle_split(block_data, max_steps);
+		if (blocks > 1)
+		{
+			int32_t start_pos[STEPPER_COUNT];
+			int32_t block_pos[STEPPER_COUNT];
+			float m_inv = 1.0f / (float)blocks;
+			memcpy(start_pos, mc_last_step_pos, sizeof(start_pos));
+			mc_duty_cycle_split = true;
+			for (uint32_t j = 1; j < blocks; j++)
+			{
+				float m = m_inv * (float)j;
+				for (uint8_t i = STEPPER_COUNT; i != 0;)
+				{
+					i--;
+					block_pos[i] = start_pos[i] + (int32_t)lroundf(m * (float)(step_new_pos[i] - start_pos[i]));
+				}
+
+				uint8_t error = mc_line_segment(block_pos, block_data);
+				if (error)
+				{
+					mc_duty_cycle_split = false;
+					return error;
+				}
+				// after the first block all following blocks are inline
+				block_data->cos_theta = 1;
+			}
+			mc_duty_cycle_split = false;
+		}
+	}
+#endif
+
 // resets accumulator vars of the block
 #ifdef ENABLE_LINACT_PLANNER
 	block_data->full_steps = 0;
@@ -236,6 +284,22 @@ static uint8_t mc_line_segment(int32_t *step_new_pos, motion_data_t *block_data)
 			mc_flushed = mc_flush_pending;
 		}
 
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+		// holds the block until the steppers have cooled enough to run it
+		uint8_t duty_mask = (!cnc_get_exec_state(EXEC_HOMING)) ? duty_cycle_mask(block_data) : 0;
+		uint32_t duty_ms = (duty_mask) ? duty_cycle_predict(block_data, max_steps) : 0;
+		while (duty_cycle_wait(duty_mask, duty_ms) && !mc_flushed)
+		{
+			if (!cnc_dotasks())
+			{
+				duty_cycle_wait(0, 0);
+				return STATUS_CRITICAL_FAIL;
+			}
+			mc_flushed = mc_flush_pending;
+		}
+		duty_cycle_wait(0, 0);
+#endif
+
 		mc_flush_pending = false;
 
 		if (mc_flushed)
@@ -253,6 +317,9 @@ static uint8_t mc_line_segment(int32_t *step_new_pos, motion_data_t *block_data)
 #endif
 
 		planner_add_line(block_data);
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+		duty_cycle_queue(duty_mask, duty_ms);
+#endif
 		// dwell should only execute on the first request
 		block_data->dwell = 0;
 	}
@@ -391,6 +458,9 @@ uint8_t mc_line(float *target, motion_data_t *block_data)
 	// feed values
 	float max_feed = FLT_MAX;
 	float max_accel = FLT_MAX;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	float max_jerk = FLT_MAX;
+#endif
 	float feed = block_data->feed;
 	// angle between motion lines
 	block_data->cos_theta = 0;
@@ -411,9 +481,21 @@ uint8_t mc_line(float *target, motion_data_t *block_data)
 		max_feed = MIN(max_feed, denorm_param);
 		denorm_param = fast_flt_div(g_settings.acceleration[i], normal_vect);
 		max_accel = MIN(max_accel, denorm_param);
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		// 0 disables the jerk limit of the axis
+		if (g_settings.jerk[i] > 0)
+		{
+			denorm_param = fast_flt_div(g_settings.jerk[i], normal_vect);
+			max_jerk = MIN(max_jerk, denorm_param);
+		}
+#endif
 	}
 	max_feed *= inv_dist;
 	max_accel *= inv_dist;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	// 0 (no limit) if no moving axis has a jerk limit
+	max_jerk = (max_jerk != FLT_MAX) ? (max_jerk * inv_dist) : 0;
+#endif
 
 #ifdef ENABLE_LASER_PPI
 	g_settings.acceleration[STEPPER_COUNT - 1] = FLT_MAX;
@@ -469,6 +551,10 @@ uint8_t mc_line(float *target, motion_data_t *block_data)
 	// convert accel already in steps/s
 	// use max accel if accel is not already set by previous calculations (for example synched motions)
 	block_data->max_accel = (!block_data->max_accel) ? (feed_convert_to_steps_per_sec * max_accel) : (block_data->max_accel * inv_dist * feed_convert_to_steps_per_sec);
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	// jerk in steps/s^3
+	block_data->max_jerk = feed_convert_to_steps_per_sec * max_jerk;
+#endif
 	// convert feed from steps/min to steps/s
 	feed_convert_to_steps_per_sec *= MIN_SEC_MULT;
 	step_feed *= feed_convert_to_steps_per_sec;
@@ -757,6 +843,40 @@ bool mc_home_motion(uint8_t axis_mask, bool is_origin_search, motion_data_t *blo
 	mc_sync_position();
 	mc_get_position(target);
 
+#ifdef ENABLE_PARALLEL_HOMING
+	// all axis move the same distance so that they run at the same speed (each one stops on it's own limit)
+	float distance = (is_origin_search) ? 0 : g_settings.homing_offset * 5.0f;
+	uint8_t axis_count = 0;
+	for (uint8_t i = 0; i < AXIS_COUNT; i++)
+	{
+		if ((1 << i) & axis_mask)
+		{
+			axis_count++;
+			if (is_origin_search)
+			{
+				distance = MIN(distance, g_settings.max_distance[i] * -1.5f);
+			}
+		}
+	}
+
+	// Set movement distance for each axis
+	for (uint8_t i = 0; i < AXIS_COUNT; i++)
+	{
+		uint8_t imask = (1 << i);
+		if (imask & axis_mask)
+		{
+			// Invert the distance if configuration says so (each axis homes in it's own direction)
+			if (g_settings.homing_dir_invert_mask & imask)
+			{
+				target[i] -= distance;
+			}
+			else
+			{
+				target[i] += distance;
+			}
+		}
+	}
+#else
 	// Set movement distance for each axis
 	for (uint8_t i = 0; i < AXIS_COUNT; i++)
 	{
@@ -774,12 +894,25 @@ bool mc_home_motion(uint8_t axis_mask, bool is_origin_search, motion_data_t *blo
 			}
 		}
 	}
+#endif
 
 	if (cnc_unlock(true) != UNLOCK_OK)
 	{
 		return false;
 	}
+
+#ifdef ENABLE_PARALLEL_HOMING
+	// the feed is along the motion vector (each axis moves at the homing feed)
+	float feed = block_data->feed;
+	if (axis_count > 1)
+	{
+		block_data->feed *= sqrtf((float)axis_count);
+	}
+	mc_line(target, block_data);
+	block_data->feed = feed;
+#else
 	mc_line(target, block_data);
+#endif
 
 	if (itp_sync() != STATUS_OK)
 	{
@@ -855,8 +988,13 @@ uint8_t mc_home_axis(uint8_t axis_mask, uint8_t axis_limit)
 		cnc_delay_ms(g_settings.debounce_ms); // adds a delay before reading io pin (debounce)
 		limits_flags = io_get_limits();
 
+#ifdef ENABLE_PARALLEL_HOMING
+		// the wrong switch was activated or one of the axis didn't reach it's switch bails
+		if ((limits_flags & axis_limit) != axis_limit)
+#else
 		// the wrong switch was activated bails
 		if (!CHECKFLAG(limits_flags, axis_limit))
+#endif
 		{
 			cnc_set_exec_state(EXEC_UNHOMED);
 			cnc_alarm(EXEC_ALARM_HOMING_FAIL_APPROACH);
@@ -74,6 +74,9 @@ extern "C"
 		float feed;
 		float max_feed;
 		float max_accel;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		float max_jerk;
+#endif
 		float feed_conversion;
 		float cos_theta; // angle between current and previous motion
 		uint8_t main_stepper;
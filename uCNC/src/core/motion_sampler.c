@@ -0,0 +1,256 @@
+/*
+	Name: motion_sampler.c
+	Description: On-device motion sampler for µCNC.
+		Records the realtime step position and the active segment feed at a fixed rate
+		into a RAM ring buffer around a trigger event and dumps it afterwards as binary frames.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ENABLE_MOTION_SAMPLER
+
+#ifdef ENABLE_STEP_DMA
+#error "The motion sampler can't be used with the DMA step engine (the step position is computed ahead of the outputs)"
+#endif
+
+volatile uint8_t motion_sampler_state;
+static motion_sample_t motion_sampler_buffer[MOTION_SAMPLER_SIZE];
+// next sample to write and number of samples in the buffer
+static uint16_t motion_sampler_head;
+static uint16_t motion_sampler_count;
+// samples to record after the trigger and samples already recorded after the trigger
+static uint16_t motion_sampler_post;
+static uint16_t motion_sampler_triggered;
+static uint32_t motion_sampler_period;
+static uint32_t motion_sampler_next;
+static uint8_t motion_sampler_trigger;
+static uint8_t motion_sampler_din;
+static bool motion_sampler_din_level;
+
+static bool motion_sampler_check_trigger(motion_sample_t *sample)
+{
+	switch (motion_sampler_trigger)
+	{
+	case MOTION_SAMPLER_TRIGGER_MOTION:
+		if (motion_sampler_count)
+		{
+			// any stepper moved since the last sample
+			motion_sample_t *last = &motion_sampler_buffer[(motion_sampler_head ? motion_sampler_head : MOTION_SAMPLER_SIZE) - 1];
+			return (memcmp(sample->steps, last->steps, sizeof(sample->steps)) != 0);
+		}
+		break;
+	case MOTION_SAMPLER_TRIGGER_DIN_RISE:
+	case MOTION_SAMPLER_TRIGGER_DIN_FALL:
+	{
+		bool prev = motion_sampler_din_level;
+		bool level = (io_get_pinvalue(DIN0 + motion_sampler_din) > 0);
+		motion_sampler_din_level = level;
+		return (motion_sampler_trigger == MOTION_SAMPLER_TRIGGER_DIN_RISE) ? (level && !prev) : (!level && prev);
+	}
+	}
+
+	return false;
+}
+
+// called by the step ISR (after the step pulse) and the RTC tick (with ISR disabled) while running
+void motion_sampler_sample(void)
+{
+	uint32_t now = mcu_micros();
+	if ((int32_t)(now - motion_sampler_next) < 0)
+	{
+		return;
+	}
+
+	motion_sampler_next += motion_sampler_period;
+	if ((int32_t)(now - motion_sampler_next) >= 0)
+	{
+		// missed a period (stopped and only the RTC tick is sampling)
+		motion_sampler_next = now + motion_sampler_period;
+	}
+
+	motion_sample_t *sample = &motion_sampler_buffer[motion_sampler_head];
+	sample->micros = now;
+	sample->feed = itp_get_rt_feed();
+	itp_get_rt_position(sample->steps);
+
+	uint8_t state = motion_sampler_state;
+	if (state == MOTION_SAMPLER_ARMED && motion_sampler_check_trigger(sample))
+	{
+		state = MOTION_SAMPLER_TRIGGERED;
+	}
+
+	if (++motion_sampler_head == MOTION_SAMPLER_SIZE)
+	{
+		motion_sampler_head = 0;
+	}
+	if (motion_sampler_count < MOTION_SAMPLER_SIZE)
+	{
+		motion_sampler_count++;
+	}
+
+	if (state == MOTION_SAMPLER_TRIGGERED && ++motion_sampler_triggered >= motion_sampler_post)
+	{
+		state = MOTION_SAMPLER_DONE;
+	}
+
+	motion_sampler_state = state;
+}
+
+static uint8_t motion_sampler_arm(void)
+{
+	// period, trigger, pretrigger samples, DIN
+	float args[4] = {0, MOTION_SAMPLER_TRIGGER_NOW, (MOTION_SAMPLER_SIZE >> 2), 0};
+	uint8_t i = 0;
+	for (;;)
+	{
+		uint8_t result = parser_get_float(&args[i++]);
+		if (!result || (result & (NUMBER_ISFLOAT | NUMBER_ISNEGATIVE)))
+		{
+			return STATUS_BAD_NUMBER_FORMAT;
+		}
+
+		uint8_t c = grbl_stream_getc();
+		if (c == EOL)
+		{
+			break;
+		}
+		if (c != ',' || i == 4)
+		{
+			return STATUS_INVALID_STATEMENT;
+		}
+	}
+
+	if (args[0] < MOTION_SAMPLER_PERIOD_MIN || args[0] > 1000000 || args[1] > MOTION_SAMPLER_TRIGGER_DIN_FALL || args[2] >= MOTION_SAMPLER_SIZE || args[3] > 31)
+	{
+		return STATUS_INVALID_STATEMENT;
+	}
+
+	// the ISR may be sampling
+	__ATOMIC__
+	{
+		motion_sampler_period = (uint32_t)args[0];
+		motion_sampler_trigger = (uint8_t)args[1];
+		motion_sampler_post = (motion_sampler_trigger != MOTION_SAMPLER_TRIGGER_NOW) ? (MOTION_SAMPLER_SIZE - (uint16_t)args[2]) : MOTION_SAMPLER_SIZE;
+		motion_sampler_din = (uint8_t)args[3];
+		motion_sampler_din_level = (io_get_pinvalue(DIN0 + motion_sampler_din) > 0);
+		motion_sampler_head = 0;
+		motion_sampler_count = 0;
+		motion_sampler_triggered = 0;
+		motion_sampler_next = mcu_micros();
+		motion_sampler_state = (motion_sampler_trigger != MOTION_SAMPLER_TRIGGER_NOW) ? MOTION_SAMPLER_ARMED : MOTION_SAMPLER_TRIGGERED;
+	}
+
+	return GRBL_SEND_SAMPLER_STATUS;
+}
+
+// parses the $DAQ commands (subcmd is the 4th letter of the command or 0)
+uint8_t motion_sampler_command(uint8_t subcmd, uint8_t c)
+{
+	switch (subcmd)
+	{
+	case 0:
+		if (c == '=')
+		{
+			return motion_sampler_arm();
+		}
+		if (c == EOL)
+		{
+			return GRBL_SEND_SAMPLER_STATUS;
+		}
+		break;
+	case 'T':
+		if (c == EOL)
+		{
+			__ATOMIC__
+			{
+				if (motion_sampler_state == MOTION_SAMPLER_ARMED)
+				{
+					motion_sampler_state = MOTION_SAMPLER_TRIGGERED;
+				}
+			}
+			return GRBL_SEND_SAMPLER_STATUS;
+		}
+		break;
+	case 'X':
+		if (c == EOL)
+		{
+			__ATOMIC__
+			{
+				if (motion_sampler_state & MOTION_SAMPLER_RUNNING)
+				{
+					motion_sampler_state = MOTION_SAMPLER_DONE;
+				}
+			}
+			return GRBL_SEND_SAMPLER_STATUS;
+		}
+		break;
+	case 'D':
+		if (c == EOL)
+		{
+			return GRBL_SAMPLER_DUMP;
+		}
+		break;
+	}
+
+	return STATUS_INVALID_STATEMENT;
+}
+
+void motion_sampler_status(void)
+{
+	proto_info("DAQ:%d,%d,%lu,%d", motion_sampler_state, motion_sampler_count, motion_sampler_period, motion_sampler_trigger);
+}
+
+uint8_t motion_sampler_dump(void)
+{
+	// the dump blocks the main loop
+	if ((motion_sampler_state & MOTION_SAMPLER_RUNNING) || cnc_get_exec_state(EXEC_RUN))
+	{
+		return STATUS_IDLE_ERROR;
+	}
+
+	motion_sampler_header_t header = {0};
+	header.type = PROTO_FRAME_SAMPLER_HEADER;
+	header.steppers = STEPPER_COUNT;
+	header.trigger = motion_sampler_trigger;
+	header.count = motion_sampler_count;
+	header.trigger_index = motion_sampler_count - motion_sampler_triggered;
+	header.period = motion_sampler_period;
+	proto_frame_start();
+	proto_frame_write(&header, sizeof(header));
+	proto_frame_end();
+
+	motion_sampler_frame_t frame = {0};
+	frame.type = PROTO_FRAME_SAMPLE;
+	uint16_t index = (motion_sampler_count < MOTION_SAMPLER_SIZE) ? 0 : motion_sampler_head;
+	for (uint16_t i = 0; i < motion_sampler_count; i++)
+	{
+		frame.index = i;
+		memcpy(&frame.sample, &motion_sampler_buffer[index], sizeof(motion_sample_t));
+		proto_frame_start();
+		proto_frame_write(&frame, sizeof(frame));
+		proto_frame_end();
+		if (++index == MOTION_SAMPLER_SIZE)
+		{
+			index = 0;
+		}
+	}
+
+	return STATUS_OK;
+}
+
+#endif
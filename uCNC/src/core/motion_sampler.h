@@ -0,0 +1,109 @@
+/*
+	Name: motion_sampler.h
+	Description: On-device motion sampler for µCNC.
+		Records the realtime step position (itp_rt_step_pos) and the active segment feed
+		at a fixed rate into a RAM ring buffer around a trigger event (DIN edge, motion start or command)
+		and dumps it afterwards as binary frames.
+
+		Sampling is done at the end of the step pulse (mcu_step_reset_cb) while moving and in the RTC tick
+		while stopped, so mcu_step_cb timing is not affected. Each sample holds its own timestamp (us).
+
+		Commands:
+			$DAQ=<period us>,<trigger>[,<pretrigger samples>[,<DIN>]] - arms the sampler
+			$DAQT - triggers the sampler (any trigger mode)
+			$DAQX - stops the sampler
+			$DAQD - dumps the recorded samples (when not running)
+			$DAQ - prints [DAQ:<state>,<samples>,<period>,<trigger>]
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef MOTION_SAMPLER_H
+#define MOTION_SAMPLER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_MOTION_SAMPLER
+
+// number of samples in the ring buffer (each sample uses 8 + 4 * STEPPER_COUNT bytes of RAM)
+#ifndef MOTION_SAMPLER_SIZE
+#define MOTION_SAMPLER_SIZE 128
+#endif
+
+#ifndef MOTION_SAMPLER_PERIOD_MIN
+#define MOTION_SAMPLER_PERIOD_MIN 10
+#endif
+
+// states
+#define MOTION_SAMPLER_IDLE 0
+#define MOTION_SAMPLER_ARMED 1
+#define MOTION_SAMPLER_TRIGGERED 2
+#define MOTION_SAMPLER_DONE 4
+#define MOTION_SAMPLER_RUNNING (MOTION_SAMPLER_ARMED | MOTION_SAMPLER_TRIGGERED)
+
+// triggers
+#define MOTION_SAMPLER_TRIGGER_NOW 0
+#define MOTION_SAMPLER_TRIGGER_MOTION 1
+#define MOTION_SAMPLER_TRIGGER_MANUAL 2
+#define MOTION_SAMPLER_TRIGGER_DIN_RISE 3
+#define MOTION_SAMPLER_TRIGGER_DIN_FALL 4
+
+	typedef struct motion_sample_
+	{
+		uint32_t micros;
+		float feed; // active segment feed (units/min)
+		int32_t steps[STEPPER_COUNT];
+	} motion_sample_t;
+
+	// PROTO_FRAME_SAMPLER_HEADER frame (sent before the samples)
+	typedef struct motion_sampler_header_
+	{
+		uint8_t type;
+		uint8_t steppers;
+		uint8_t trigger;
+		uint8_t reserved;
+		uint16_t count;	  // number of samples that follow
+		uint16_t trigger_index; // index of the first sample after the trigger (count if not triggered)
+		uint32_t period;	  // us
+	} motion_sampler_header_t;
+
+	// PROTO_FRAME_SAMPLE frame
+	typedef struct motion_sampler_frame_
+	{
+		uint8_t type;
+		uint8_t reserved;
+		uint16_t index;
+		motion_sample_t sample;
+	} motion_sampler_frame_t;
+
+	extern volatile uint8_t motion_sampler_state;
+
+	void motion_sampler_sample(void);
+	uint8_t motion_sampler_command(uint8_t subcmd, uint8_t c);
+	void motion_sampler_status(void);
+	uint8_t motion_sampler_dump(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
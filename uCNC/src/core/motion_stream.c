@@ -0,0 +1,332 @@
+/*
+	Name: motion_stream.c
+	Description: Pre-compiled binary motion stream for µCNC.
+		Executes motion records compiled on the host (makefiles/virtual_linux/gcode_compile.py)
+		directly in motion control, bypassing the G-code parser.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#ifdef ENABLE_MOTION_STREAM
+
+#ifndef MAX_MODAL_GROUPS
+#define MAX_MODAL_GROUPS 14
+#endif
+
+// next expected frame sequence number (frame 0 always restarts the stream)
+static uint8_t motion_stream_seq;
+// axis position in steps of the axis (avoids accumulating rounding errors)
+static int32_t motion_stream_pos[AXIS_COUNT];
+// modal state of the stream
+static motion_data_t motion_stream_block;
+static float motion_stream_feed;
+
+static int8_t motion_stream_b64(uint8_t c)
+{
+	if (c >= 'A' && c <= 'Z')
+	{
+		return c - 'A';
+	}
+	if (c >= 'a' && c <= 'z')
+	{
+		return c - 'a' + 26;
+	}
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0' + 52;
+	}
+	switch (c)
+	{
+	case '+':
+		return 62;
+	case '/':
+		return 63;
+	}
+
+	return -1;
+}
+
+// same CRC used by modbus
+static uint16_t motion_stream_crc16(uint8_t *data, uint8_t len)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (uint8_t pos = 0; pos < len; pos++)
+	{
+		crc ^= (uint16_t)data[pos];
+		for (uint8_t i = 8; i != 0; i--)
+		{
+			if ((crc & 0x0001) != 0)
+			{
+				crc >>= 1;
+				crc ^= 0xA001;
+			}
+			else
+			{
+				crc >>= 1;
+			}
+		}
+	}
+
+	return crc;
+}
+
+// restarts the stream from the current position and parser modal state
+static void motion_stream_start(void)
+{
+	float target[AXIS_COUNT];
+	uint8_t modalgroups[MAX_MODAL_GROUPS];
+	uint16_t feed;
+	uint16_t spindle = 0;
+
+	mc_get_position(target);
+	for (uint8_t i = AXIS_COUNT; i != 0;)
+	{
+		i--;
+		motion_stream_pos[i] = (int32_t)lroundf(target[i] * g_settings.step_per_mm[i]);
+	}
+
+	parser_get_modes(modalgroups, &feed, &spindle);
+	memset(&motion_stream_block, 0, sizeof(motion_data_t));
+	motion_stream_block.motion_mode = MOTIONCONTROL_MODE_FEED;
+	motion_stream_block.motion_flags.bit.feed_override = (modalgroups[10] == 48) ? 1 : 0;
+#if TOOL_COUNT > 0
+	motion_stream_block.spindle = spindle;
+	motion_stream_block.motion_flags.bit.spindle_running = (modalgroups[8] != 5) ? (modalgroups[8] - 2) : 0;
+	motion_stream_block.motion_flags.bit.coolant = modalgroups[9];
+#endif
+	motion_stream_feed = feed;
+}
+
+static bool motion_stream_varint(uint8_t *data, uint8_t *pos, uint8_t len, int32_t *value)
+{
+	uint32_t v = 0;
+	uint8_t shift = 0;
+	uint8_t c;
+
+	do
+	{
+		if (*pos >= len || shift > 28)
+		{
+			return false;
+		}
+		c = data[(*pos)++];
+		v |= (uint32_t)(c & 0x7F) << shift;
+		shift += 7;
+	} while (c & 0x80);
+
+	// zigzag decoding
+	*value = (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+	return true;
+}
+
+// executes the frame records (executed returns the number of records executed)
+static uint8_t motion_stream_exec(uint8_t *data, uint8_t len, uint8_t *executed)
+{
+	uint8_t pos = 0;
+	uint8_t error = STATUS_OK;
+	float target[AXIS_COUNT];
+	int32_t steps[AXIS_COUNT];
+	uint16_t value;
+
+	*executed = 0;
+	while (pos < len && error == STATUS_OK)
+	{
+		uint8_t record = data[pos++];
+		switch (record & MOTION_STREAM_TYPE_MASK)
+		{
+		case MOTION_STREAM_LINE:
+		case MOTION_STREAM_RAPID:
+			for (uint8_t i = 0; i < AXIS_COUNT; i++)
+			{
+				steps[i] = motion_stream_pos[i];
+				if (record & (1 << i))
+				{
+					int32_t delta;
+					if (!motion_stream_varint(data, &pos, len, &delta))
+					{
+						return STATUS_STREAM_FRAME_ERROR;
+					}
+					steps[i] += delta;
+				}
+				target[i] = (float)steps[i] / g_settings.step_per_mm[i];
+			}
+
+			motion_stream_block.feed = ((record & MOTION_STREAM_TYPE_MASK) == MOTION_STREAM_RAPID) ? FLT_MAX : motion_stream_feed;
+			error = mc_line(target, &motion_stream_block);
+			// the position only moves if the line was executed (the record can be sent again)
+			if (error == STATUS_OK)
+			{
+				memcpy(motion_stream_pos, steps, sizeof(steps));
+			}
+			break;
+		case MOTION_STREAM_FEED:
+			if ((pos + 4) > len)
+			{
+				return STATUS_STREAM_FRAME_ERROR;
+			}
+			memcpy(&motion_stream_feed, &data[pos], 4);
+			pos += 4;
+			break;
+		default:
+			switch (record & ~MOTION_STREAM_TYPE_MASK)
+			{
+			case MOTION_STREAM_EXT_TOOL:
+				if ((pos + 3) > len)
+				{
+					return STATUS_STREAM_FRAME_ERROR;
+				}
+#if TOOL_COUNT > 0
+				motion_stream_block.motion_flags.bit.spindle_running = data[pos] & 0x03;
+				motion_stream_block.motion_flags.bit.coolant = (data[pos] >> 2) & 0x03;
+				motion_stream_block.spindle = data[pos + 1] | ((uint16_t)data[pos + 2] << 8);
+				error = mc_update_tools(&motion_stream_block);
+#endif
+				pos += 3;
+				break;
+			case MOTION_STREAM_EXT_DWELL:
+				if ((pos + 2) > len)
+				{
+					return STATUS_STREAM_FRAME_ERROR;
+				}
+				value = data[pos] | ((uint16_t)data[pos + 1] << 8);
+				pos += 2;
+				itp_sync();
+				motion_stream_block.dwell = value;
+				error = mc_dwell(&motion_stream_block);
+				motion_stream_block.dwell = 0;
+				break;
+			case MOTION_STREAM_EXT_MODE:
+				if (pos >= len)
+				{
+					return STATUS_STREAM_FRAME_ERROR;
+				}
+				motion_stream_block.motion_mode = MOTIONCONTROL_MODE_FEED;
+				if (data[pos] & MOTION_STREAM_MODE_EXACT_STOP)
+				{
+					motion_stream_block.motion_mode |= PLANNER_MOTION_EXACT_STOP;
+				}
+				if (data[pos] & MOTION_STREAM_MODE_CONTINUOUS)
+				{
+					motion_stream_block.motion_mode |= PLANNER_MOTION_CONTINUOUS;
+				}
+				motion_stream_block.motion_flags.bit.feed_override = (data[pos] & MOTION_STREAM_MODE_NO_FEED_OVERRIDE) ? 0 : 1;
+				pos++;
+				break;
+			case MOTION_STREAM_EXT_SYNC:
+				error = itp_sync();
+				break;
+			default:
+				return STATUS_STREAM_FRAME_ERROR;
+			}
+			break;
+		}
+
+		if (error == STATUS_OK)
+		{
+			(*executed)++;
+		}
+	}
+
+	return error;
+}
+
+/**
+ * Reads and executes a motion stream frame (the frame start char is the next char in the stream)
+ * */
+uint8_t motion_stream_read_frame(void)
+{
+	uint8_t frame[MOTION_STREAM_FRAME_MAX];
+	uint8_t len = 0;
+	uint16_t bits = 0;
+	uint8_t nbits = 0;
+	bool valid = true;
+
+	grbl_stream_getc(); // eat the frame start
+	for (;;)
+	{
+		uint8_t c = grbl_stream_getc();
+		if (c == EOL)
+		{
+			break;
+		}
+
+		int8_t v = (c != '=') ? motion_stream_b64(c) : 0;
+		if (v < 0 || len == MOTION_STREAM_FRAME_MAX)
+		{
+			// keeps reading until the end of the line
+			valid = false;
+		}
+
+		if (!valid || c == '=')
+		{
+			continue;
+		}
+
+		bits = (bits << 6) | (uint8_t)v;
+		nbits += 6;
+		if (nbits >= 8)
+		{
+			nbits -= 8;
+			frame[len++] = (uint8_t)(bits >> nbits);
+		}
+	}
+
+	// smallest frame is the sequence number and the CRC
+	if (!valid || len < 3)
+	{
+		return STATUS_STREAM_FRAME_ERROR;
+	}
+
+	len -= 2;
+	if (motion_stream_crc16(frame, len) != (frame[len] | ((uint16_t)frame[len + 1] << 8)))
+	{
+		return STATUS_STREAM_FRAME_ERROR;
+	}
+
+	uint8_t seq = frame[0];
+	if (!seq)
+	{
+		motion_stream_start();
+	}
+	else if (seq != motion_stream_seq)
+	{
+		// the retransmission of the last executed frame is acknowledged without executing it again
+		uint8_t last = (motion_stream_seq != 1) ? (motion_stream_seq - 1) : 255;
+		return (seq == last) ? STATUS_OK : STATUS_STREAM_SEQUENCE_ERROR;
+	}
+
+	uint8_t executed;
+	uint8_t error = motion_stream_exec(&frame[1], len - 1, &executed);
+	// keeps the G-code parser in sync with the streamed motions
+	parser_sync_position();
+	if (error != STATUS_OK)
+	{
+		// the frame is not executed (the records before the failed one were)
+		// the sender can send the remaining records again with the same sequence number
+		proto_info("STREAM:%d,%d", seq, executed);
+		return error;
+	}
+
+	motion_stream_seq = (seq != 255) ? (seq + 1) : 1;
+	return STATUS_OK;
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+	Name: motion_stream.h
+	Description: Pre-compiled binary motion stream for µCNC.
+		Executes motion records compiled on the host (makefiles/virtual_linux/gcode_compile.py)
+		directly in motion control, bypassing the G-code parser.
+
+		Each frame is a single line that starts with ':' followed by the base64 encoded frame
+		[seq][records...][crc16 (MODBUS) LSB first].
+		Since the frame is plain ASCII it goes through any stream (UART, USB, file system) and
+		realtime commands (feed hold, reset, status report) keep working while streaming.
+		Every frame is acknowledged with ok/error like a G-code line.
+		If a record fails the sequence number does not advance and [STREAM:<seq>,<n>] reports
+		that the first n records of the frame were executed. The remaining records can be sent again
+		in a frame with the same sequence number.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef MOTION_STREAM_H
+#define MOTION_STREAM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_MOTION_STREAM
+
+#define MOTION_STREAM_FRAME_START ':'
+
+// maximum decoded frame size (the encoded line is 4/3 of this size plus the start char)
+// must fit the RX buffer for character counting senders
+#ifndef MOTION_STREAM_FRAME_MAX
+#define MOTION_STREAM_FRAME_MAX 90
+#endif
+
+/**
+ * Record types (upper 2 bits of the record first byte)
+ * LINE and RAPID - the lower 6 bits are the mask of the axis that move
+ * 		followed by the axis position change (in steps of the axis) as zigzag varints
+ * FEED - followed by the feed rate (float LE in units/min)
+ * EXTENDED - the lower 6 bits are the extended record type
+ * */
+#define MOTION_STREAM_LINE 0x00
+#define MOTION_STREAM_RAPID 0x40
+#define MOTION_STREAM_FEED 0x80
+#define MOTION_STREAM_EXTENDED 0xC0
+#define MOTION_STREAM_TYPE_MASK 0xC0
+
+// spindle state/coolant flags (uint8) and spindle speed (uint16 LE)
+#define MOTION_STREAM_EXT_TOOL 0
+// dwell time in milliseconds (uint16 LE)
+#define MOTION_STREAM_EXT_DWELL 1
+// path mode and feed override flags (uint8)
+#define MOTION_STREAM_EXT_MODE 2
+// waits for all motions to complete
+#define MOTION_STREAM_EXT_SYNC 3
+
+#define MOTION_STREAM_MODE_EXACT_STOP 1
+#define MOTION_STREAM_MODE_CONTINUOUS 2
+#define MOTION_STREAM_MODE_NO_FEED_OVERRIDE 4
+
+	uint8_t motion_stream_read_frame(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
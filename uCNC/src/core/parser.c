@@ -30,6 +30,8 @@
 
 // extended codes
 #define M10 EXTENDED_MCODE(10)
+#define M62 EXTENDED_MCODE(62)
+#define M63 EXTENDED_MCODE(63)
 
 static parser_state_t parser_state;
 static parser_parameters_t parser_parameters;
@@ -216,6 +218,13 @@ uint8_t parser_read_command(void)
 		return STATUS_SYSTEM_GC_LOCK;
 	}
 
+#ifdef ENABLE_MOTION_STREAM
+	if (c == MOTION_STREAM_FRAME_START && !is_jogging)
+	{
+		return motion_stream_read_frame();
+	}
+#endif
+
 	return parser_gcode_command(is_jogging);
 }
 
@@ -371,12 +380,25 @@ void parser_update_probe_pos(void)
 	kinematics_steps_to_coordinates(rt_probe_step_pos, parser_parameters.last_probe_position);
 }
 
+// perfect hash lookup of the system commands with 2 or more letters (the name is compared only with the one in the slot)
+static uint8_t parser_grbl_cmd_id(uint8_t *cmd, uint16_t hash)
+{
+	uint8_t id = rom_read_byte(&grbl_cmd_hash_slot[PARSER_HASH_SLOT(hash, grbl_cmd_hash_disp, GRBL_CMD_HASH_BUCKETS, GRBL_CMD_HASH_SIZE)]);
+	if (id && !rom_strcmp((char *)cmd, (const char *)rom_strptr(&grbl_cmd_names[id - 1])))
+	{
+		return id;
+	}
+
+	return GRBL_CMD_NONE;
+}
+
 static uint8_t parser_grbl_command(void)
 {
 	grbl_stream_getc(); // eat $
 	uint8_t c = grbl_stream_peek();
 	uint8_t grbl_cmd_str[GRBL_CMD_MAX_LEN + 1];
 	uint8_t grbl_cmd_len = 0;
+	uint16_t grbl_cmd_hash = GRBL_CMD_HASH_SEED;
 
 	// if not IDLE
 	if (cnc_get_exec_state(EXEC_RUN))
@@ -388,6 +410,15 @@ static uint8_t parser_grbl_command(void)
 		case 'P':
 		case 'I':
 		case 'J':
+#ifdef ENABLE_TELEMETRY
+		case 'T':
+#endif
+#ifdef ENABLE_MOTION_SAMPLER
+		case 'D':
+#endif
+#ifdef ENABLE_WINDOWED_STREAMING
+		case 'W':
+#endif
 			break;
 		default:
 			parser_discard_command();
@@ -412,9 +443,11 @@ static uint8_t parser_grbl_command(void)
 
 		grbl_stream_getc();
 		grbl_cmd_str[grbl_cmd_len++] = c;
+		grbl_cmd_hash = PARSER_HASH_STEP(grbl_cmd_hash, c);
 	} while ((grbl_cmd_len < GRBL_CMD_MAX_LEN));
 
 	grbl_cmd_str[grbl_cmd_len] = 0;
+	uint8_t grbl_cmd_id = parser_grbl_cmd_id(grbl_cmd_str, grbl_cmd_hash);
 
 	uint16_t block_address = STARTUP_BLOCK0_ADDRESS_OFFSET;
 	uint8_t error = STATUS_INVALID_STATEMENT;
@@ -551,7 +584,8 @@ static uint8_t parser_grbl_command(void)
 						return STATUS_INVALID_STATEMENT;
 					}
 
-					settings_save(block_address, NULL, UINT16_MAX);
+					// the line is truncated to the startup block size (minus the crc byte)
+					settings_save(block_address, NULL, STARTUP_BLOCK_SIZE - 1);
 #ifdef ENABLE_MULTILINE_STARTUP_BLOCKS
 					uint16_t address = block_address;
 					uint8_t c = EOL;
@@ -619,18 +653,18 @@ static uint8_t parser_grbl_command(void)
 		}
 		break;
 	default:
-		switch (grbl_cmd_str[0])
+		switch (grbl_cmd_id)
 		{
 #if EMULATE_GRBL_STARTUP == 2
-		case 'I':
-			if (grbl_cmd_str[1] == 'E' && grbl_cmd_len == 2 && c == EOL)
+		case GRBL_CMD_IE:
+			if (c == EOL)
 			{
 				return GRBL_SEND_SYSTEM_INFO_EXTENDED;
 			}
 			break;
 #endif
-		case 'R':
-			if (grbl_cmd_str[1] == 'S' && grbl_cmd_str[2] == 'T' && c == '=' && grbl_cmd_len == 3)
+		case GRBL_CMD_RST:
+			if (c == '=')
 			{
 				grbl_cmd_str[3] = '=';
 				grbl_cmd_len++;
@@ -659,32 +693,105 @@ static uint8_t parser_grbl_command(void)
 			}
 			break;
 #ifdef ENABLE_EXTRA_SETTINGS_CMDS
-		case 'S':
-			// new settings command
-			if (c == EOL && grbl_cmd_len == 2)
+		// new settings command
+		case GRBL_CMD_SS:
+			if (c == EOL)
+			{
+				settings_save(SETTINGS_ADDRESS_OFFSET, (uint8_t *)&g_settings, (uint8_t)sizeof(settings_t));
+				return GRBL_SETTINGS_SAVED;
+			}
+			break;
+		case GRBL_CMD_SL:
+			if (c == EOL)
+			{
+				settings_init();
+				return GRBL_SETTINGS_LOADED;
+			}
+			break;
+		case GRBL_CMD_SR:
+			if (c == EOL)
+			{
+				settings_reset(false);
+				settings_save(SETTINGS_ADDRESS_OFFSET, (uint8_t *)&g_settings, (uint8_t)sizeof(settings_t));
+				return GRBL_SETTINGS_DEFAULT;
+			}
+			break;
+#endif
+#ifdef ENABLE_TELEMETRY
+		case GRBL_CMD_TLM:
+			// $TLM prints and $TLM=<ms> sets the telemetry period (0 disables it)
+			if (c == '=')
+			{
+				float val = 0;
+				error = parser_get_float(&val);
+				if (!error || (error & NUMBER_ISFLOAT) || val > UINT16_MAX || val < 0 || grbl_stream_getc() != EOL)
+				{
+					return STATUS_INVALID_STATEMENT;
+				}
+				proto_telemetry_set_period((uint16_t)val);
+			}
+			else if (c != EOL)
+			{
+				return STATUS_INVALID_STATEMENT;
+			}
+			return GRBL_SEND_TELEMETRY_PERIOD;
+#endif
+#ifdef ENABLE_MOTION_SAMPLER
+		case GRBL_CMD_DAQ:
+		case GRBL_CMD_DAQT:
+		case GRBL_CMD_DAQX:
+		case GRBL_CMD_DAQD:
+			// $DAQ, $DAQ=..., $DAQT, $DAQX and $DAQD
+			return motion_sampler_command(grbl_cmd_str[3], c);
+#endif
+#ifdef ENABLE_WINDOWED_STREAMING
+		case GRBL_CMD_WIN:
+			// $WIN prints and $WIN=<n> sets the windowed streaming ack batch (0 disables it)
+			if (c == '=')
 			{
-				switch (grbl_cmd_str[1])
+				float val = 0;
+				error = parser_get_float(&val);
+				if (!error || (error & NUMBER_ISFLOAT) || val > GRBL_WINDOW_MAX_BATCH || val < 0 || grbl_stream_getc() != EOL)
 				{
-				case 'S':
-					settings_save(SETTINGS_ADDRESS_OFFSET, (uint8_t *)&g_settings, (uint8_t)sizeof(settings_t));
-					return GRBL_SETTINGS_SAVED;
-				case 'L':
-					settings_init();
-					return GRBL_SETTINGS_LOADED;
-				case 'R':
-					settings_reset(false);
-					settings_save(SETTINGS_ADDRESS_OFFSET, (uint8_t *)&g_settings, (uint8_t)sizeof(settings_t));
-					return GRBL_SETTINGS_DEFAULT;
+					return STATUS_INVALID_STATEMENT;
 				}
+				proto_window_set_batch((uint8_t)val);
+				return STATUS_OK;
+			}
+			else if (c != EOL)
+			{
+				return STATUS_INVALID_STATEMENT;
+			}
+			return GRBL_SEND_WINDOW_STATUS;
+#endif
+#ifdef ENABLE_CYCLE_PROFILER
+		// $PRF prints and $PRFR resets the cycle profiler
+		case GRBL_CMD_PRF:
+			if (c == EOL)
+			{
+				return GRBL_SEND_CYCLE_PROFILER;
+			}
+			break;
+		case GRBL_CMD_PRFR:
+			if (c == EOL)
+			{
+				cycle_profiler_reset();
+				return STATUS_OK;
 			}
 			break;
+#endif
+#ifdef ENABLE_ARMED_START
+		case GRBL_CMD_ARM:
+		case GRBL_CMD_ARMX:
+			// $ARM, $ARM=... and $ARMX
+			return armed_start_command(grbl_cmd_str[3], c);
 #endif
 		}
 		break;
 	}
 
 #if (defined(ENABLE_PARSER_MODULES) || defined(BOARD_HAS_CUSTOM_SYSTEM_COMMANDS))
-	grbl_cmd_args_t args = {&error, grbl_cmd_str, grbl_cmd_len, c};
+	grbl_cmd_args_t args = {&error, grbl_cmd_str, grbl_cmd_len, c, grbl_cmd_id};
 	EVENT_INVOKE(grbl_cmd, &args);
 #endif
 
@@ -795,10 +902,37 @@ static uint8_t parser_grbl_exec_code(uint8_t code)
 		proto_pins_states();
 		break;
 #endif
+#ifdef ENABLE_CYCLE_PROFILER
+	case GRBL_SEND_CYCLE_PROFILER:
+		proto_cycle_profiler();
+		break;
+#endif
+#ifdef ENABLE_WINDOWED_STREAMING
+	case GRBL_SEND_WINDOW_STATUS:
+		proto_info("WIN:%d,%d,%d", proto_window_get_batch(), RX_BUFFER_CAPACITY, PLANNER_BUFFER_SIZE);
+		break;
+#endif
+#ifdef ENABLE_ARMED_START
+	case GRBL_SEND_ARM_STATUS:
+		armed_start_status();
+		break;
+#endif
 #ifdef ENABLE_SYSTEM_INFO
 	case GRBL_SEND_SYSTEM_INFO:
 		proto_cnc_info(false);
 		break;
+#ifdef ENABLE_TELEMETRY
+	case GRBL_SEND_TELEMETRY_PERIOD:
+		proto_info("TLM:%d", proto_telemetry_get_period());
+		break;
+#endif
+#ifdef ENABLE_MOTION_SAMPLER
+	case GRBL_SEND_SAMPLER_STATUS:
+		motion_sampler_status();
+		break;
+	case GRBL_SAMPLER_DUMP:
+		return motion_sampler_dump();
+#endif
 #if EMULATE_GRBL_STARTUP == 2
 	case GRBL_SEND_SYSTEM_INFO_EXTENDED:
 		proto_cnc_info(true);
@@ -1312,10 +1446,97 @@ static uint8_t parser_validate_command(parser_state_t *new_state, parser_words_t
 		}
 		break;
 #endif
+#ifdef ENABLE_SYNC_OUTPUTS
+	case M62:
+	case M63:
+		if (!CHECKFLAG(cmd->words, GCODE_WORD_P))
+		{
+			return STATUS_GCODE_VALUE_WORD_MISSING;
+		}
+		if (words->p < 0 || words->p > 31)
+		{
+			return STATUS_GCODE_MAX_VALUE_EXCEEDED;
+		}
+		// a single tag (one axis position or a time)
+		uint16_t tags = CHECKFLAG(cmd->words, (GCODE_ALL_AXIS | GCODE_WORD_Q));
+		if (tags & (tags - 1))
+		{
+			return STATUS_GCODE_AXIS_COMMAND_CONFLICT;
+		}
+		if (CHECKFLAG(cmd->words, GCODE_WORD_Q) && words->d < 0)
+		{
+			return STATUS_NEGATIVE_VALUE;
+		}
+#if (KINEMATIC != KINEMATIC_CARTESIAN)
+		// the position tag is the step position of the axis stepper (only the cartesian kinematics has one stepper per axis)
+		if (CHECKFLAG(cmd->words, GCODE_ALL_AXIS))
+		{
+			return STATUS_GCODE_AXIS_WORDS_EXIST;
+		}
+#endif
+		break;
+#endif
+	}
+
+	return STATUS_OK;
+}
+
+#ifdef ENABLE_SYNC_OUTPUTS
+static uint8_t parser_sync_output(parser_state_t *new_state, parser_words_t *words, parser_cmd_explicit_t *cmd)
+{
+	uint8_t tag = SYNC_OUTPUT_FIRST_STEP;
+	int32_t position = 0;
+	uint32_t delay = 0;
+	uint16_t axis_words = CHECKFLAG(cmd->words, GCODE_ALL_AXIS);
+
+	if (axis_words)
+	{
+		// step position of the stepper of the axis (the position is in work coordinates)
+		float target[AXIS_COUNT];
+		int32_t steps[STEPPER_COUNT];
+		mc_get_position(target);
+		for (uint8_t i = 0; i < AXIS_COUNT; i++)
+		{
+			if (axis_words & (1 << i))
+			{
+				tag = i;
+				target[i] = (new_state->groups.units == G20) ? (words->xyzabc[i] * INCH_MM_MULT) : words->xyzabc[i];
+				target[i] += parser_parameters.coord_system_offset[i] + parser_parameters.g92_offset[i];
+#ifdef AXIS_TOOL
+				if (i == AXIS_TOOL)
+				{
+					target[i] += parser_parameters.tool_length_offset;
+				}
+#endif
+			}
+		}
+		kinematics_apply_inverse(target, steps);
+		// on the cartesian kinematics the stepper of the axis has the same index
+		position = steps[tag];
+	}
+	else if (CHECKFLAG(cmd->words, GCODE_WORD_Q))
+	{
+		tag = SYNC_OUTPUT_TIME;
+		delay = (uint32_t)(words->d * 1000.0f);
+	}
+
+	// the slots are freed as the queued motions run and the outputs fire
+	while (!sync_output_add((uint8_t)words->p, (cmd->group_extended == M62) ? 1 : 0, tag, position, delay))
+	{
+		if (planner_buffer_is_empty() && itp_is_empty())
+		{
+			return STATUS_OVERFLOW;
+		}
+
+		if (!cnc_dotasks())
+		{
+			return STATUS_CRITICAL_FAIL;
+		}
 	}
 
 	return STATUS_OK;
 }
+#endif
 
 /**
  *
@@ -1363,6 +1584,14 @@ static uint8_t parser_exec_command(parser_state_t *new_state, parser_words_t *wo
 		new_state->groups.stopping = 0;
 	}
 
+#ifdef ENABLE_SYNC_OUTPUTS
+	// synchronized outputs are queued with the next motion (the motions keep running)
+	if (cmd->group_extended == M62 || cmd->group_extended == M63)
+	{
+		return parser_sync_output(new_state, words, cmd);
+	}
+#endif
+
 	// standalone extended command
 	// extended commands with positive codes will run here
 	// a special case (negative extended command) is reserved for additional motion commands
@@ -2643,6 +2872,17 @@ static uint8_t parser_mcode_word(uint8_t code, uint8_t mantissa, parser_state_t
 		cmd->group_extended = M10;
 		return STATUS_OK;
 #endif
+#ifdef ENABLE_SYNC_OUTPUTS
+	case 62:
+	case 63:
+		if (cmd->group_extended > 0)
+		{
+			// there is a collision of custom gcode commands (only one per line can be processed)
+			return STATUS_GCODE_MODAL_GROUP_VIOLATION;
+		}
+		cmd->group_extended = (code == 62) ? M62 : M63;
+		return STATUS_OK;
+#endif
 
 	default:
 		return STATUS_GCODE_UNSUPPORTED_COMMAND;
@@ -31,6 +31,7 @@ extern "C"
 
 #include "../module.h"
 #include "motion_control.h"
+#include "parser_hash.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -397,6 +398,8 @@ extern "C"
 		uint8_t *cmd;
 		uint8_t len;
 		uint8_t next_char;
+		// the command id (GRBL_CMD_NONE if the command is not in parser_hash.h)
+		uint8_t id;
 	} grbl_cmd_args_t;
 	DECL_EVENT_HANDLER(grbl_cmd);
 
@@ -104,6 +104,8 @@ DECL_NAMED_PARAM(_value_returned);
 DECL_NAMED_PARAM(_task);
 DECL_NAMED_PARAM(_call_level);
 DECL_NAMED_PARAM(_remap_level);
+// the lookup uses the perfect hash of core/parser_hash.c
+// run makefiles/virtual_linux/phash_gen.py after changing this table
 static const named_param_t named_params[] __rom__ = {
 		NAMED_PARAM(_vmajor, 6001),
 		NAMED_PARAM(_vminor, 6002),
@@ -204,6 +206,33 @@ static const named_param_t named_params[] __rom__ = {
 static fs_file_t *o_code_file;
 static uint32_t o_code_file_pos;
 static bool o_code_file_changed;
+#ifdef ENABLE_O_CODES_CACHE
+#ifndef OCODE_CACHE_SIZE
+#define OCODE_CACHE_SIZE 4096
+#endif
+#ifndef OCODE_CACHE_ENTRIES
+#define OCODE_CACHE_ENTRIES 8
+#endif
+// a cached subrotine (text and the offsets of the lines that start with an O word)
+// text and jumps are indexes of the 16-bit pool words
+typedef struct o_code_cache_
+{
+	uint16_t code;
+	uint16_t size;
+	uint32_t timestamp;
+	uint16_t text;
+	uint16_t jumps;
+	uint16_t jump_count;
+} o_code_cache_t;
+
+static uint16_t o_code_cache_pool[OCODE_CACHE_SIZE / 2];
+static uint16_t o_code_cache_pool_used;
+static o_code_cache_t o_code_cache[OCODE_CACHE_ENTRIES];
+static uint8_t o_code_cache_count;
+// subrotine running from the cache (no file is open)
+static o_code_cache_t *o_code_cached;
+static uint16_t o_code_cached_pos;
+#endif
 bool o_code_returned;
 float o_code_return_value;
 
@@ -783,15 +812,241 @@ uint8_t parser_get_float(float *value)
  */
 #ifdef ENABLE_O_CODES
 
-static uint8_t o_code_getc(void)
+#ifdef ENABLE_O_CODES_CACHE
+#define O_CODE_CACHE_TEXT(entry) ((const uint8_t *)&o_code_cache_pool[(entry)->text])
+
+static void o_code_cache_flush(void)
+{
+	o_code_cached = NULL;
+	o_code_cache_count = 0;
+	o_code_cache_pool_used = 0;
+}
+
+static o_code_cache_t *o_code_cache_find(uint16_t code)
+{
+	for (uint8_t i = 0; i < o_code_cache_count; i++)
+	{
+		if (o_code_cache[i].size && o_code_cache[i].code == code)
+		{
+			return &o_code_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+// drops the cached copy of a subrotine file that was changed
+static void o_code_cache_validate(uint16_t code, fs_file_info_t *finfo)
+{
+	o_code_cache_t *entry = o_code_cache_find(code);
+	if (entry && (entry->size != finfo->size || entry->timestamp != finfo->timestamp))
+	{
+		// the pool space is only recovered on the next flush
+		entry->size = 0;
+	}
+}
+
+// loads the subrotine file to the cache and builds the table of the lines that start with an O word
+// these are the only lines where o_code_discard can stop
+static o_code_cache_t *o_code_cache_load(uint16_t code, fs_file_t *fp)
+{
+	uint32_t size = fp->file_info.size;
+	uint16_t words = (uint16_t)((size + 1) >> 1);
+	if (!size || size >= UINT16_MAX || words > (sizeof(o_code_cache_pool) >> 1))
+	{
+		return NULL;
+	}
+
+	if (o_code_cache_count == OCODE_CACHE_ENTRIES || (o_code_cache_pool_used + words) > (sizeof(o_code_cache_pool) >> 1))
+	{
+		o_code_cache_flush();
+	}
+
+	o_code_cache_t *entry = &o_code_cache[o_code_cache_count];
+	entry->text = o_code_cache_pool_used;
+	uint8_t *text = (uint8_t *)&o_code_cache_pool[entry->text];
+	if (fs_read(fp, text, size) != size)
+	{
+		return NULL;
+	}
+
+	entry->jumps = entry->text + words;
+	entry->jump_count = 0;
+	uint16_t limit = (sizeof(o_code_cache_pool) >> 1) - entry->jumps;
+	uint16_t i = 0;
+	while (i < size)
+	{
+		uint16_t line = i;
+		// skips blanks and (...) comments
+		while (i < size)
+		{
+			uint8_t c = text[i];
+			if (c == '(')
+			{
+				while (i < size && text[i] != ')' && text[i] != '\n' && text[i] != '\r')
+				{
+					i++;
+				}
+				if (i < size && text[i] == ')')
+				{
+					i++;
+				}
+				continue;
+			}
+			if (c != ' ' && c != '\t')
+			{
+				break;
+			}
+			i++;
+		}
+
+		if (i < size && (text[i] == 'O' || text[i] == 'o'))
+		{
+			if (entry->jump_count == limit)
+			{
+				return NULL;
+			}
+			o_code_cache_pool[entry->jumps + entry->jump_count++] = line;
+		}
+
+		while (i < size && text[i] != '\n' && text[i] != '\r')
+		{
+			i++;
+		}
+		i++;
+	}
+
+	entry->code = code;
+	entry->size = (uint16_t)size;
+	entry->timestamp = fp->file_info.timestamp;
+	o_code_cache_pool_used = entry->jumps + entry->jump_count;
+	o_code_cache_count++;
+	return entry;
+}
+
+// after a discarded command jumps to the next line that starts with an O word
+static void o_code_cache_skip(void)
+{
+	if (!o_code_cached || o_code_file_changed)
+	{
+		return;
+	}
+
+	// binary search of the first O word line at or after the current position
+	const uint16_t *jumps = &o_code_cache_pool[o_code_cached->jumps];
+	uint16_t lo = 0, hi = o_code_cached->jump_count;
+	while (lo < hi)
+	{
+		uint16_t mid = (lo + hi) >> 1;
+		if (jumps[mid] < o_code_cached_pos)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	o_code_cached_pos = (lo < o_code_cached->jump_count) ? jumps[lo] : o_code_cached->size;
+}
+#endif
+
+static bool o_code_is_open(void)
+{
+#ifdef ENABLE_O_CODES_CACHE
+	if (o_code_cached)
+	{
+		return true;
+	}
+#endif
+	return (o_code_file != NULL);
+}
+
+// workaround to ftell
+static uint32_t o_code_tell(void)
 {
+#ifdef ENABLE_O_CODES_CACHE
+	if (o_code_cached)
+	{
+		return o_code_cached_pos;
+	}
+#endif
+	return (o_code_file) ? (o_code_file->file_info.size - fs_available(o_code_file)) : 0;
+}
+
+static void o_code_file_seek(uint32_t pos)
+{
+#ifdef ENABLE_O_CODES_CACHE
+	if (o_code_cached)
+	{
+		o_code_cached_pos = (uint16_t)MIN(pos, o_code_cached->size);
+		return;
+	}
+#endif
+	fs_seek(o_code_file, pos);
+}
+
+static void o_code_file_close(void)
+{
+#ifdef ENABLE_O_CODES_CACHE
+	o_code_cached = NULL;
+#endif
 	if (o_code_file)
+	{
+		fs_close(o_code_file);
+		o_code_file = NULL;
+	}
+}
+
+static bool o_code_file_open(uint16_t code)
+{
+#ifdef ENABLE_O_CODES_CACHE
+	o_code_cached = o_code_cache_find(code);
+	if (o_code_cached)
+	{
+		return true;
+	}
+#endif
+	char o_subrotine[32];
+	memset(o_subrotine, 0, sizeof(o_subrotine));
+	str_sprintf(o_subrotine, "/%c/o%d.nc", OCODE_DRIVE, code);
+	o_code_file = fs_open(o_subrotine, "r");
+	if (!o_code_file)
+	{
+		return false;
+	}
+#ifdef ENABLE_O_CODES_CACHE
+	// runs from RAM if the file fits the cache
+	o_code_cached = o_code_cache_load(code, o_code_file);
+	if (o_code_cached)
+	{
+		fs_close(o_code_file);
+		o_code_file = NULL;
+	}
+	else
+	{
+		fs_seek(o_code_file, 0);
+	}
+#endif
+	return true;
+}
+
+static uint8_t o_code_getc(void)
+{
+	if (o_code_is_open())
 	{
 		if (o_code_file_changed)
 		{
 			o_code_file_changed = false;
 			return EOL;
 		}
+#ifdef ENABLE_O_CODES_CACHE
+		if (o_code_cached)
+		{
+			return (o_code_cached_pos < o_code_cached->size) ? O_CODE_CACHE_TEXT(o_code_cached)[o_code_cached_pos++] : FILE_EOF;
+		}
+#endif
 		if (fs_available(o_code_file))
 		{
 			uint8_t c = 0;
@@ -818,23 +1073,14 @@ static void o_code_open(uint8_t index)
 {
 	if (o_code_stack[index].op == O_CODE_OP_CALL || o_code_stack[index].op == O_CODE_OP_SUB)
 	{
-		if (o_code_file)
-		{
-			fs_close(o_code_file);
-			o_code_file = NULL;
-		}
-
-		char o_subrotine[32];
-		memset(o_subrotine, 0, sizeof(o_subrotine));
-		str_sprintf(o_subrotine, "/%c/o%d.nc", OCODE_DRIVE, o_code_stack[index].code);
-		o_code_file = fs_open(o_subrotine, "r");
-		if (!o_code_file)
+		o_code_file_close();
+		if (!o_code_file_open(o_code_stack[index].code))
 		{
 			return;
 		}
 		o_code_stack[index].op = O_CODE_OP_SUB;
 		// reload file and rewind stack
-		fs_seek(o_code_file, o_code_file_pos);
+		o_code_file_seek(o_code_file_pos);
 
 		o_code_file_changed = true;
 #ifdef ENABLE_O_CODES_VERBOSE
@@ -863,11 +1109,7 @@ static uint8_t o_code_close(uint8_t index)
 	// close file
 	if (index)
 	{
-		if (o_code_file)
-		{
-			fs_close(o_code_file);
-			o_code_file = NULL;
-		}
+		o_code_file_close();
 
 		index = o_code_entry_point(index);
 	}
@@ -901,11 +1143,7 @@ bool o_code_end_subrotine(void)
 	}
 
 	// clear and close all
-	if (o_code_file)
-	{
-		fs_close(o_code_file);
-		o_code_file = NULL;
-	}
+	o_code_file_close();
 	memset(o_code_stack, 0, sizeof(o_code_stack));
 	o_code_stack_index = 0;
 	o_code_stack_context_index = 0;
@@ -916,9 +1154,9 @@ bool o_code_end_subrotine(void)
 
 static bool o_code_seek(uint32_t pos)
 {
-	if (o_code_file)
+	if (o_code_is_open())
 	{
-		fs_seek(o_code_file, pos - 1);
+		o_code_file_seek(pos - 1);
 		grbl_stream_readonly(o_code_getc, NULL, NULL);
 		return true;
 	}
@@ -956,6 +1194,9 @@ static void o_code_discard(void)
 	while (parser_get_next_preprocessed(true) != 'O')
 	{
 		parser_discard_command();
+#ifdef ENABLE_O_CODES_CACHE
+		o_code_cache_skip();
+#endif
 	}
 #ifdef PROCESS_COMMENTS
 	g_mute_comment_output = false;
@@ -967,11 +1208,7 @@ static void FORCEINLINE o_code_word_error(uint8_t *error)
 	if (*error >= STATUS_OCODE_ERROR_MIN && *error <= STATUS_OCODE_ERROR_MAX)
 	{
 		// Error in o-code, do not continue execution and empty the stack.
-		if (o_code_file)
-		{
-			fs_close(o_code_file);
-			o_code_file = NULL;
-		}
+		o_code_file_close();
 		if (o_code_stack_index)
 		{
 			for (uint16_t i = 0; i < RS274NGC_MAX_USER_VARS; i++)
@@ -1021,9 +1258,9 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 		parser_get_next_preprocessed(false);
 	}
 
-	if (o_code_file)
+	if (o_code_is_open())
 	{
-		loop_ret = o_code_file->file_info.size - fs_available(o_code_file);
+		loop_ret = o_code_tell();
 	}
 	op_arg_error = parser_get_float(&op_arg);
 
@@ -1065,7 +1302,11 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 		o_code_stack[index].context_index = i_context;
 
 		// workaround to ftell
-		o_code_stack[index].pos = (o_code_file) ? (o_code_file->file_info.size - fs_available(o_code_file)) : 0;
+		o_code_stack[index].pos = o_code_tell();
+#ifdef ENABLE_O_CODES_CACHE
+		// reloads the file if it was changed
+		o_code_cache_validate(ocode_id, &finfo);
+#endif
 		o_code_open(index);
 
 		o_code_stack_index++;
@@ -1283,12 +1524,12 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 				return error;
 			}
 
-			if (o_code_file && o_code_stack[index].op != O_CODE_OP_WHILE_DISCARD)
+			if (o_code_is_open() && o_code_stack[index].op != O_CODE_OP_WHILE_DISCARD)
 			{
 				// save position
-				if (o_code_file)
+				if (o_code_is_open())
 				{
-					loop_ret = o_code_file->file_info.size - fs_available(o_code_file); // backtrack 2 chars to catch the newline
+					loop_ret = o_code_tell(); // backtrack 2 chars to catch the newline
 				}
 				// rewind
 				if (!o_code_seek(o_code_stack[index].loop))
@@ -1419,7 +1660,7 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 		case 6:
 			index = o_code_stack_index++;
 			o_code_stack[index].code = ocode_id;
-			o_code_stack[index].pos = o_code_file->file_info.size - fs_available(o_code_file) + 1; // doesn't care about the re-eval de arg
+			o_code_stack[index].pos = o_code_tell() + 1; // doesn't care about the re-eval de arg
 			o_code_stack[index].loop = (int32_t)truncf(op_arg);
 			break;
 		}
@@ -1458,6 +1699,7 @@ uint8_t parser_ocode_word(uint16_t code, parser_state_t *new_state, parser_cmd_e
 uint8_t parser_get_namedparam_id(float *value)
 {
 	char namedparam[NAMED_PARAM_MAX_LEN];
+	uint16_t hash = NAMED_PARAM_HASH_SEED;
 	bool valid = false;
 	unsigned char c = parser_get_next_preprocessed(true);
 	c = TOUPPER(c);
@@ -1479,19 +1721,19 @@ uint8_t parser_get_namedparam_id(float *value)
 				break;
 			}
 			namedparam[i] = parser_get_next_preprocessed(false);
+			hash = PARSER_HASH_STEP(hash, namedparam[i]);
 		}
 
 		if (valid)
 		{
-			for (uint8_t i = 0; i < sizeof(named_params) / sizeof(named_param_t); i++)
+			// perfect hash lookup (the name is compared only with the one in the slot)
+			uint8_t index = rom_read_byte(&named_param_hash_slot[PARSER_HASH_SLOT(hash, named_param_hash_disp, NAMED_PARAM_HASH_BUCKETS, NAMED_PARAM_HASH_SIZE)]);
+			if (index && !rom_strcmp(namedparam, (const char *)rom_strptr(&(named_params[index - 1].name))))
 			{
-				if (!rom_strcmp(namedparam, (const char *)rom_strptr(&(named_params[i].name))))
-				{
-					named_param_t p = {0};
-					rom_memcpy(&p, &named_params[i], sizeof(named_param_t));
-					*value = (float)p.id;
-					return NUMBER_OK;
-				}
+				named_param_t p = {0};
+				rom_memcpy(&p, &named_params[index - 1], sizeof(named_param_t));
+				*value = (float)p.id;
+				return NUMBER_OK;
 			}
 		}
 	}
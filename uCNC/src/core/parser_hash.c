@@ -0,0 +1,87 @@
+/*
+	Name: parser_hash.c
+	Description: Perfect hash tables of the named parameters and $ system commands for µCNC.
+		Generated by makefiles/virtual_linux/phash_gen.py. Do not edit.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+#include "../cnc.h"
+#include <stdint.h>
+
+#ifdef ENABLE_NAMED_PARAMETERS
+const uint8_t named_param_hash_disp[NAMED_PARAM_HASH_BUCKETS] __rom__ = {
+		14, 5, 6, 0, 0, 0, 4, 0, 7, 16, 10, 7, 4, 0, 21, 35};
+const uint8_t named_param_hash_slot[NAMED_PARAM_HASH_SIZE] __rom__ = {
+		43, 42, 0, 37, 44, 33, 27, 29, 23, 26, 0, 50, 39, 48, 19, 41,
+		45, 46, 30, 12, 13, 47, 9, 40, 51, 0, 17, 53, 32, 28, 7, 22,
+		16, 4, 18, 56, 24, 52, 49, 14, 55, 0, 11, 0, 1, 0, 10, 20,
+		3, 15, 5, 36, 38, 0, 6, 2, 0, 34, 25, 8, 21, 31, 35, 54};
+#endif
+
+static const char grbl_cmd_IE[] __rom__ = "IE";
+static const char grbl_cmd_RST[] __rom__ = "RST";
+static const char grbl_cmd_SS[] __rom__ = "SS";
+static const char grbl_cmd_SL[] __rom__ = "SL";
+static const char grbl_cmd_SR[] __rom__ = "SR";
+static const char grbl_cmd_TLM[] __rom__ = "TLM";
+static const char grbl_cmd_DAQ[] __rom__ = "DAQ";
+static const char grbl_cmd_DAQT[] __rom__ = "DAQT";
+static const char grbl_cmd_DAQX[] __rom__ = "DAQX";
+static const char grbl_cmd_DAQD[] __rom__ = "DAQD";
+static const char grbl_cmd_WIN[] __rom__ = "WIN";
+static const char grbl_cmd_PRF[] __rom__ = "PRF";
+static const char grbl_cmd_PRFR[] __rom__ = "PRFR";
+static const char grbl_cmd_LS[] __rom__ = "LS";
+static const char grbl_cmd_CD[] __rom__ = "CD";
+static const char grbl_cmd_LPR[] __rom__ = "LPR";
+static const char grbl_cmd_RUN[] __rom__ = "RUN";
+static const char grbl_cmd_HX[] __rom__ = "HX";
+static const char grbl_cmd_HY[] __rom__ = "HY";
+static const char grbl_cmd_HZ[] __rom__ = "HZ";
+static const char grbl_cmd_HA[] __rom__ = "HA";
+static const char grbl_cmd_HB[] __rom__ = "HB";
+static const char grbl_cmd_HC[] __rom__ = "HC";
+static const char grbl_cmd_ARM[] __rom__ = "ARM";
+static const char grbl_cmd_ARMX[] __rom__ = "ARMX";
+const char *const grbl_cmd_names[GRBL_CMD_HASH_COUNT] __rom__ = {
+		grbl_cmd_IE,
+		grbl_cmd_RST,
+		grbl_cmd_SS,
+		grbl_cmd_SL,
+		grbl_cmd_SR,
+		grbl_cmd_TLM,
+		grbl_cmd_DAQ,
+		grbl_cmd_DAQT,
+		grbl_cmd_DAQX,
+		grbl_cmd_DAQD,
+		grbl_cmd_WIN,
+		grbl_cmd_PRF,
+		grbl_cmd_PRFR,
+		grbl_cmd_LS,
+		grbl_cmd_CD,
+		grbl_cmd_LPR,
+		grbl_cmd_RUN,
+		grbl_cmd_HX,
+		grbl_cmd_HY,
+		grbl_cmd_HZ,
+		grbl_cmd_HA,
+		grbl_cmd_HB,
+		grbl_cmd_HC,
+		grbl_cmd_ARM,
+		grbl_cmd_ARMX};
+const uint8_t grbl_cmd_hash_disp[GRBL_CMD_HASH_BUCKETS] __rom__ = {
+		0, 1, 0, 9, 5, 3, 0, 3};
+const uint8_t grbl_cmd_hash_slot[GRBL_CMD_HASH_SIZE] __rom__ = {
+		4, 21, 3, 5, 15, 16, 10, 0, 0, 22, 25, 0, 11, 8, 19, 13,
+		18, 12, 6, 1, 2, 20, 0, 7, 24, 9, 0, 0, 0, 14, 23, 17};
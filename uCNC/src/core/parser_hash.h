@@ -0,0 +1,83 @@
+/*
+	Name: parser_hash.h
+	Description: Perfect hash lookup of the named parameters and $ system commands for µCNC.
+		Generated by makefiles/virtual_linux/phash_gen.py. Do not edit.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+#ifndef PARSER_HASH_H
+#define PARSER_HASH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+// updates the hash with the next char of the name
+#define PARSER_HASH_STEP(h, c) ((uint16_t)(((h) ^ (uint8_t)(c)) * 0x0193))
+// the low bits of the hash select the bucket displacement and the high byte plus the displacement select the slot
+#define PARSER_HASH_SLOT(h, disp, buckets, size) ((uint8_t)(((h) >> 8) + rom_read_byte(&disp[(h) & ((buckets) - 1)])) & ((size) - 1))
+
+// named parameters (the slot holds the named_params index + 1 or 0 if empty)
+#define NAMED_PARAM_HASH_SEED 7
+#define NAMED_PARAM_HASH_COUNT 56
+#define NAMED_PARAM_HASH_BUCKETS 16
+#define NAMED_PARAM_HASH_SIZE 64
+#ifdef ENABLE_NAMED_PARAMETERS
+	extern const uint8_t named_param_hash_disp[NAMED_PARAM_HASH_BUCKETS] __rom__;
+	extern const uint8_t named_param_hash_slot[NAMED_PARAM_HASH_SIZE] __rom__;
+#endif
+
+// $ system commands with 2 or more letters (the slot holds the command id or 0 if empty)
+#define GRBL_CMD_NONE 0
+#define GRBL_CMD_IE 1
+#define GRBL_CMD_RST 2
+#define GRBL_CMD_SS 3
+#define GRBL_CMD_SL 4
+#define GRBL_CMD_SR 5
+#define GRBL_CMD_TLM 6
+#define GRBL_CMD_DAQ 7
+#define GRBL_CMD_DAQT 8
+#define GRBL_CMD_DAQX 9
+#define GRBL_CMD_DAQD 10
+#define GRBL_CMD_WIN 11
+#define GRBL_CMD_PRF 12
+#define GRBL_CMD_PRFR 13
+#define GRBL_CMD_LS 14
+#define GRBL_CMD_CD 15
+#define GRBL_CMD_LPR 16
+#define GRBL_CMD_RUN 17
+#define GRBL_CMD_HX 18
+#define GRBL_CMD_HY 19
+#define GRBL_CMD_HZ 20
+#define GRBL_CMD_HA 21
+#define GRBL_CMD_HB 22
+#define GRBL_CMD_HC 23
+#define GRBL_CMD_ARM 24
+#define GRBL_CMD_ARMX 25
+#define GRBL_CMD_HASH_SEED 1
+#define GRBL_CMD_HASH_COUNT 25
+#define GRBL_CMD_HASH_BUCKETS 8
+#define GRBL_CMD_HASH_SIZE 32
+	extern const uint8_t grbl_cmd_hash_disp[GRBL_CMD_HASH_BUCKETS] __rom__;
+	extern const uint8_t grbl_cmd_hash_slot[GRBL_CMD_HASH_SIZE] __rom__;
+	extern const char *const grbl_cmd_names[GRBL_CMD_HASH_COUNT] __rom__;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,16 +23,88 @@
 #include <math.h>
 #include <float.h>
 
-static planner_block_t planner_data[PLANNER_BUFFER_SIZE];
-static uint8_t planner_data_write;
-static uint8_t planner_data_read;
-static uint8_t planner_data_blocks;
+/*
+	Planner buffer
+	planner_data is a lock-free single producer/single consumer ring so that the interpolator can take blocks
+	at any time (even from the RTC ISR with ENABLE_ITP_FEED_TASK).
+	The planner (producer) only writes planner_data_write, planner_data_optimal and the blocks and the
+	interpolator (consumer) only writes planner_data_read. One slot is always free so the number of blocks is
+	given by the indexes alone.
+	The interpolator executes a copy of the first block (it updates the remaining steps and current speed)
+	and only reads the entry speed the planner commits to the next block (entry_commit_sqr) after the
+	look-ahead passes are done. Committed speeds are never lowered by later look-ahead passes.
+*/
+#define PLANNER_RING_SIZE (PLANNER_BUFFER_SIZE + 1)
+static planner_block_t planner_data[PLANNER_RING_SIZE];
+static volatile planner_index_t planner_data_write;
+static volatile planner_index_t planner_data_read;
+// last optimal block
+// the entry speed of this block and all blocks before it can't be improved and are final
+// the look-ahead passes only need to recalculate the blocks after this boundary
+static planner_index_t planner_data_optimal;
+#ifndef ENABLE_DUAL_CORE_MOTION
+// the block being executed by the interpolator and the speed at the end of the last executed block (consumer)
+static planner_block_t planner_exec;
+static bool planner_exec_started;
+static float planner_exec_speed_sqr;
+#endif
 planner_state_t g_planner_state;
 
+#ifdef ENABLE_DUAL_CORE_MOTION
+/*
+	Dual core handoff
+	The main core plans the blocks in planner_data and hands them off (copies them) to this lock-free
+	single producer/single consumer ring where the motion core executes them.
+	The main core only writes planner_handoff_write and the slots it hands off and the motion core only
+	writes planner_handoff_read and the slot it is executing.
+	The exit speed of a block is the entry speed of the next block when it's handed off.
+	The next block becomes the first block of the planner. If the block was handed off before its exit speed was final
+	the look-ahead can still raise the entry speed of the first block and the exit speed of the last handed off block
+	(the motion core is notified like itp_update on a single core). The exit speed is never lowered.
+	The exit speed fields are published as one unit with a sequence lock (exit_seq is odd while the main core
+	writes them and the motion core reads them again if the sequence changed).
+*/
+typedef struct planner_handoff_exit_
+{
+	float feed_sqr;
+	float rapid_feed_sqr;
+	bool feed_override;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	// max speed of the junctions and deceleration after the block if the speed changes continue in the next block (see planner_get_block_exit_decel)
+	bool chains;
+	float max_sqr;
+	float decel_sqr;
+	float decel_dist;
+#endif
+} planner_handoff_exit_t;
+
+typedef struct planner_handoff_block_
+{
+	planner_block_t block;
+	volatile uint8_t exit_seq;
+	volatile planner_handoff_exit_t exit;
+	bool started;
+} planner_handoff_block_t;
+
+static planner_handoff_block_t planner_handoff_data[PLANNER_HANDOFF_SIZE];
+static volatile uint8_t planner_handoff_write;
+static volatile uint8_t planner_handoff_read;
+// speed at the end of the last executed block (motion core)
+static float planner_handoff_speed_sqr;
+static planner_handoff_stats_t planner_handoff_stats;
+// the last handed off block exit speed is not final yet (main core)
+static bool planner_handoff_open;
+static volatile bool planner_handoff_updated;
+static void planner_handoff_exit_set(planner_handoff_block_t *handoff, planner_index_t index);
+static void planner_handoff_exit_update(planner_index_t index);
+static void planner_handoff_clear(void);
+#endif
+
 FORCEINLINE static void planner_add_block(void);
-FORCEINLINE static uint8_t planner_buffer_next(uint8_t index);
-FORCEINLINE static uint8_t planner_buffer_prev(uint8_t index);
-FORCEINLINE static void planner_recalculate(void);
+FORCEINLINE static planner_index_t planner_buffer_next(planner_index_t index);
+FORCEINLINE static planner_index_t planner_buffer_prev(planner_index_t index);
+FORCEINLINE static planner_index_t planner_buffer_count(planner_index_t from, planner_index_t to);
+FORCEINLINE static bool planner_recalculate(void);
 FORCEINLINE static void planner_buffer_clear(void);
 
 /*
@@ -56,7 +128,7 @@ void planner_add_line(motion_data_t *block_data)
 #endif
 
 	// clear the planner block
-	uint8_t index = planner_data_write;
+	planner_index_t index = planner_data_write;
 	float cos_theta = block_data->cos_theta;
 	memset(&planner_data[index], 0, sizeof(planner_block_t));
 	planner_data[index].dirbits = block_data->dirbits;
@@ -74,6 +146,16 @@ void planner_add_line(motion_data_t *block_data)
 
 	memcpy(planner_data[index].steps, block_data->steps, sizeof(planner_data[index].steps));
 
+#ifdef ENABLE_SYNC_OUTPUTS
+	// the synchronized outputs queued since the previous motion start with this one (not with a backlash block)
+#ifdef ENABLE_BACKLASH_COMPENSATION
+	if (!block_data->motion_flags.bit.backlash_comp)
+#endif
+	{
+		planner_data[index].sync_output = sync_output_bind();
+	}
+#endif
+
 	// calculates the normalized vector with the amount of motion in any linear actuator
 	// also calculates the maximum feedrate and acceleration for each linear actuator
 #ifdef ENABLE_LINACT_PLANNER
@@ -113,10 +195,13 @@ void planner_add_line(motion_data_t *block_data)
 	planner_data[index].feed_sqr = fast_flt_pow2(block_data->feed);
 	planner_data[index].rapid_feed_sqr = fast_flt_pow2(block_data->max_feed);
 	planner_data[index].acceleration = block_data->max_accel;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	planner_data[index].jerk = block_data->max_jerk;
+#endif
 
 	// consider initial angle factor of 1 (90 degree angle corner or more)
 	float angle_factor = 1.0f;
-	uint8_t prev = 0;
+	planner_index_t prev = 0;
 
 	if (!planner_buffer_is_empty())
 	{
@@ -136,6 +221,7 @@ void planner_add_line(motion_data_t *block_data)
 	cos_theta = CLAMP(0, cos_theta, 1.0f);
 
 	// if more than one move stored cals juntion speeds and recalculates speed profiles
+	bool updated = false;
 	if (cos_theta != 0 && !CHECKFLAG(block_data->motion_mode, PLANNER_MOTION_EXACT_STOP | MOTIONCONTROL_MODE_BACKLASH_COMPENSATION))
 	{
 		if (cos_theta != 1.0f)
@@ -174,11 +260,31 @@ void planner_add_line(motion_data_t *block_data)
 		}
 
 		// forces reaclculation with the new block
-		planner_recalculate();
+		CYCLE_PROFILER_START(CYCLE_PROFILER_PLANNER);
+		updated = planner_recalculate();
+		CYCLE_PROFILER_END(CYCLE_PROFILER_PLANNER);
+	}
+	else
+	{
+		// the block starts from a full stop
+		// all previous blocks are final and the block becomes the new optimal boundary
+		planner_data_optimal = index;
 	}
 
 	// advances the buffer
 	planner_add_block();
+
+#ifdef ENABLE_DUAL_CORE_MOTION
+	// the motion core is notified when the exit speed of an handed off block is raised
+	(void)updated;
+	planner_handoff();
+#else
+	// the new block is published so the interpolator can read the new exit speed of the executing block
+	if (updated)
+	{
+		itp_update();
+	}
+#endif
 }
 
 /*
@@ -187,62 +293,79 @@ void planner_add_line(motion_data_t *block_data)
 
 static void planner_add_block(void)
 {
-	uint8_t index = planner_data_write;
-	uint8_t blocks = planner_data_blocks;
+	planner_index_t index = planner_data_write;
 #if TOOL_COUNT > 0
 	// planner is empty update tools with current planner values
-	if (!blocks)
+	// (the interpolator only takes the block after it's published)
+	if (planner_buffer_is_empty())
 	{
 		g_planner_state.spindle_speed = planner_data[index].spindle;
 		g_planner_state.state_flags.reg = planner_data[index].planner_flags.reg;
 	}
 #endif
 
-	if (++index == PLANNER_BUFFER_SIZE)
+	if (++index == PLANNER_RING_SIZE)
 	{
 		index = 0;
 	}
 
-	planner_data_write = index;
-	blocks++;
-	planner_data_blocks = blocks;
+	// publishes the block to the interpolator
+	ATOMIC_STORE_RELEASE(planner_data_write, index);
 }
 
 void planner_discard_block(void)
 {
-	uint8_t blocks = planner_data_blocks;
-	if (!blocks)
+#ifdef ENABLE_DUAL_CORE_MOTION
+	// the motion core is done with the executing block
+	uint8_t read = planner_handoff_read;
+	if (read != ATOMIC_LOAD_ACQUIRE(planner_handoff_write))
 	{
-		return;
+		planner_handoff_speed_sqr = planner_handoff_data[read].block.entry_feed_sqr;
+		if (++read == PLANNER_HANDOFF_SIZE)
+		{
+			read = 0;
+		}
+		ATOMIC_STORE_RELEASE(planner_handoff_read, read);
 	}
-
-	uint8_t index = planner_data_read;
-	uint8_t prev_index = index;
-
-	if (++index == PLANNER_BUFFER_SIZE)
+#else
+	planner_index_t index = planner_data_read;
+	if (index == ATOMIC_LOAD_ACQUIRE(planner_data_write))
 	{
-		index = 0;
+		return;
 	}
 
-	// syncs blocks feedrates
-	planner_data[index].entry_feed_sqr = planner_data[prev_index].entry_feed_sqr;
+	// syncs blocks feedrates (the next block starts at the speed this block ended)
+	planner_exec_speed_sqr = planner_exec.entry_feed_sqr;
+	planner_exec_started = false;
+	// releases the slot to the planner
+	ATOMIC_STORE_RELEASE(planner_data_read, planner_buffer_next(index));
+#endif
+}
 
-	blocks--;
+void planner_flush(void)
+{
+#ifdef ENABLE_DUAL_CORE_MOTION
+	planner_handoff_clear();
+#endif
+	planner_index_t write = ATOMIC_LOAD_ACQUIRE(planner_data_write);
 #if TOOL_COUNT > 0
-	if (blocks)
+	if (planner_data_read != write)
 	{
-		g_planner_state.spindle_speed = planner_data[index].spindle;
-		g_planner_state.state_flags.reg = planner_data[index].planner_flags.reg;
+		planner_index_t last = planner_buffer_prev(write);
+		g_planner_state.spindle_speed = planner_data[last].spindle;
+		g_planner_state.state_flags.reg = planner_data[last].planner_flags.reg;
 	}
 #endif
-
-	planner_data_blocks = blocks;
-	planner_data_read = index;
+#ifndef ENABLE_DUAL_CORE_MOTION
+	planner_exec_speed_sqr = 0;
+	planner_exec_started = false;
+#endif
+	ATOMIC_STORE_RELEASE(planner_data_read, write);
 }
 
-static uint8_t planner_buffer_next(uint8_t index)
+static planner_index_t planner_buffer_next(planner_index_t index)
 {
-	if (++index == PLANNER_BUFFER_SIZE)
+	if (++index == PLANNER_RING_SIZE)
 	{
 		index = 0;
 	}
@@ -250,31 +373,42 @@ static uint8_t planner_buffer_next(uint8_t index)
 	return index;
 }
 
-static uint8_t planner_buffer_prev(uint8_t index)
+static planner_index_t planner_buffer_prev(planner_index_t index)
 {
 	if (index == 0)
 	{
-		index = PLANNER_BUFFER_SIZE;
+		index = PLANNER_RING_SIZE;
 	}
 
 	return --index;
 }
 
+// number of blocks from one index up to (but not including) the other
+static planner_index_t planner_buffer_count(planner_index_t from, planner_index_t to)
+{
+	return (to >= from) ? (to - from) : (to + PLANNER_RING_SIZE - from);
+}
+
 bool planner_buffer_is_empty(void)
 {
-	return (!planner_data_blocks);
+#ifdef ENABLE_DUAL_CORE_MOTION
+	if (!planner_handoff_is_empty())
+	{
+		return false;
+	}
+#endif
+	return (ATOMIC_LOAD_ACQUIRE(planner_data_read) == ATOMIC_LOAD_ACQUIRE(planner_data_write));
 }
 
 bool planner_buffer_is_full(void)
 {
-	return (planner_data_blocks == PLANNER_BUFFER_SIZE);
+	return (planner_buffer_count(ATOMIC_LOAD_ACQUIRE(planner_data_read), planner_data_write) == PLANNER_BUFFER_SIZE);
 }
 
 static void planner_buffer_clear(void)
 {
-	planner_data_write = 0;
-	planner_data_read = 0;
-	planner_data_blocks = 0;
+	// the interpolator already discarded all blocks (itp_clear) so only the planner side is reset
+	planner_data_optimal = planner_data_write;
 	memset(planner_data, 0, sizeof(planner_data));
 }
 
@@ -286,7 +420,15 @@ void planner_init(void)
 	planner_state.coolant = 0;
 #endif
 #endif
+	planner_data_write = 0;
+	planner_data_read = 0;
 	planner_buffer_clear();
+#ifdef ENABLE_DUAL_CORE_MOTION
+	planner_handoff_clear();
+#else
+	planner_exec_speed_sqr = 0;
+	planner_exec_started = false;
+#endif
 	planner_feed_ovr(100);
 	planner_rapid_feed_ovr(100);
 #if TOOL_COUNT > 0
@@ -306,34 +448,129 @@ void planner_clear(void)
 #endif
 }
 
+// the block being executed by the interpolator
+static FORCEINLINE planner_block_t *planner_exec_block(void)
+{
+#ifndef ENABLE_DUAL_CORE_MOTION
+	return &planner_exec;
+#else
+	return &planner_handoff_data[planner_handoff_read].block;
+#endif
+}
+
 planner_block_t *planner_get_block(void)
 {
-	return &planner_data[planner_data_read];
+#ifdef ENABLE_DUAL_CORE_MOTION
+	planner_handoff_block_t *handoff = &planner_handoff_data[planner_handoff_read];
+	if (!handoff->started && !planner_handoff_is_empty())
+	{
+		// syncs blocks feedrates (the block starts at the speed the previous block ended)
+		// and updates the tools (the main core already moved on to the next blocks)
+		handoff->started = true;
+		handoff->block.entry_feed_sqr = planner_handoff_speed_sqr;
+#if TOOL_COUNT > 0
+		g_planner_state.spindle_speed = handoff->block.spindle;
+		g_planner_state.state_flags.reg = handoff->block.planner_flags.reg;
+#endif
+	}
+#else
+	if (!planner_exec_started && !planner_buffer_is_empty())
+	{
+		// takes a copy of the first block (the planner can still plan it's entry speed while it executes)
+		// syncs blocks feedrates (the block starts at the speed the previous block ended)
+		// and updates the tools
+		memcpy(&planner_exec, &planner_data[planner_data_read], sizeof(planner_block_t));
+		planner_exec_started = true;
+		planner_exec.entry_feed_sqr = planner_exec_speed_sqr;
+#if TOOL_COUNT > 0
+		g_planner_state.spindle_speed = planner_exec.spindle;
+		g_planner_state.state_flags.reg = planner_exec.planner_flags.reg;
+#endif
+	}
+#endif
+	return planner_exec_block();
 }
 
 planner_block_t *planner_get_last_block(void)
 {
-	uint8_t last = planner_buffer_prev(planner_data_write);
+	planner_index_t last = planner_buffer_prev(planner_data_write);
 	return &planner_data[last];
 }
 
+#ifdef ENABLE_DUAL_CORE_MOTION
+// reads the exit of the executing block
+// the exit is set when the block is handed off (the main core can still raise it)
+static void planner_handoff_exit_read(planner_handoff_exit_t *exit)
+{
+	planner_handoff_block_t *handoff = &planner_handoff_data[planner_handoff_read];
+	uint8_t seq;
+	do
+	{
+		seq = ATOMIC_LOAD_ACQUIRE(handoff->exit_seq);
+		exit->feed_sqr = handoff->exit.feed_sqr;
+		exit->rapid_feed_sqr = handoff->exit.rapid_feed_sqr;
+		exit->feed_override = handoff->exit.feed_override;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		exit->chains = handoff->exit.chains;
+		exit->max_sqr = handoff->exit.max_sqr;
+		exit->decel_sqr = handoff->exit.decel_sqr;
+		exit->decel_dist = handoff->exit.decel_dist;
+#endif
+		ATOMIC_FENCE();
+	} while ((seq & 1) || seq != ATOMIC_LOAD_ACQUIRE(handoff->exit_seq));
+}
+#endif
+
+// applies the overrides to a speed at the exit of the executing block
+static float planner_exit_override(float exit_speed_sqr, float rapid_feed_sqr, bool feed_override)
+{
+	if (feed_override)
+	{
+		if (g_planner_state.feed_override != 100)
+		{
+			exit_speed_sqr *= fast_flt_pow2((float)g_planner_state.feed_override);
+			exit_speed_sqr *= 0.0001f;
+		}
+
+		// if rapid overrides are active the feed must not exceed the rapid motion feed
+		if (g_planner_state.rapid_feed_override != 100)
+		{
+			rapid_feed_sqr *= fast_flt_pow2((float)g_planner_state.rapid_feed_override);
+			rapid_feed_sqr *= 0.0001f;
+		}
+	}
+
+	return MIN(exit_speed_sqr, rapid_feed_sqr);
+}
+
 float planner_get_block_exit_speed_sqr(void)
 {
+#ifndef ENABLE_DUAL_CORE_MOTION
 	// only one block in the buffer (exit speed is 0)
-	if (planner_data_blocks < 2)
+	planner_index_t next = planner_buffer_next(planner_data_read);
+	if (next == ATOMIC_LOAD_ACQUIRE(planner_data_write))
 		return 0;
 
-	// exit speed = next block entry speed
-	uint8_t next = planner_buffer_next(planner_data_read);
-	float exit_speed_sqr = planner_data[next].entry_feed_sqr;
-	float rapid_feed_sqr = planner_data[next].rapid_feed_sqr;
+	// exit speed = next block committed entry speed
+	return planner_exit_override(planner_data[next].entry_commit_sqr, planner_data[next].rapid_feed_sqr, planner_data[next].planner_flags.bit.feed_override);
+#else
+	planner_handoff_exit_t exit;
+	planner_handoff_exit_read(&exit);
+	return planner_exit_override(exit.feed_sqr, exit.rapid_feed_sqr, exit.feed_override);
+#endif
+}
 
-	if (planner_data[next].planner_flags.bit.feed_override)
+// the max speed of the executing block (feed with the overrides and never above the rapid motion feed)
+static float planner_block_max_speed_sqr(planner_block_t *block)
+{
+	float rapid_feed_sqr = block->rapid_feed_sqr;
+	float target_speed_sqr = block->feed_sqr;
+	if (block->planner_flags.bit.feed_override)
 	{
 		if (g_planner_state.feed_override != 100)
 		{
-			exit_speed_sqr *= fast_flt_pow2((float)g_planner_state.feed_override);
-			exit_speed_sqr *= 0.0001f;
+			target_speed_sqr *= fast_flt_pow2((float)g_planner_state.feed_override);
+			target_speed_sqr *= 0.0001f;
 		}
 
 		// if rapid overrides are active the feed must not exceed the rapid motion feed
@@ -344,9 +581,319 @@ float planner_get_block_exit_speed_sqr(void)
 		}
 	}
 
-	return MIN(exit_speed_sqr, rapid_feed_sqr);
+	// can't ever exceed rapid move speed
+	return MIN(target_speed_sqr, rapid_feed_sqr);
+}
+
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+/*
+	Jerk limited speed changes
+	Each speed change starts and ends without acceleration. The acceleration ramps up at the max jerk (j),
+	holds at the max acceleration (a) if the speed change is large enough and ramps down at the max jerk.
+	For a speed change dv
+		dv > a^2/j		t = dv/a + a/j (ramps of a/j)
+		dv <= a^2/j		t = 2 * sqrt(dv/j) (ramps of t/2 that don't reach the max acceleration)
+	The profile is symmetric so the distance is the mean speed times the duration
+		d = (v0 + v1) / 2 * t
+	These use the exact float operations (the fast math approximations don't converge).
+
+	A speed change doesn't have to end at a junction. Two speed changes joined with zero acceleration take longer than
+	a single one over the same distance (the distance of a short change grows with the square of the speed change), so
+	the planner limits the entry speed of a block with the deceleration that ends at the next junction speed limit
+	(or the stop after the last block) and that can be several blocks ahead (decel_exit_sqr and decel_dist).
+	The interpolator runs the speed changes through the junctions (the acceleration isn't reset to 0 at them) and ends
+	them with that deceleration. The speed changes that end with it can't exceed the max speed of the junctions it passes
+	(decel_max_sqr) and they don't chain through a stop or into a junction that is entered above its max speed.
+*/
+float planner_jerk_time(planner_block_t *block, float speed_delta, float *ramp)
+{
+	float accel = block->acceleration;
+	float jerk = block->jerk;
+	speed_delta = ABS(speed_delta);
+	if (!jerk)
+	{
+		// constant acceleration
+		*ramp = 0;
+		return speed_delta / accel;
+	}
+
+	float ramp_time = accel / jerk;
+	float t;
+	if (speed_delta > accel * ramp_time)
+	{
+		t = speed_delta / accel + ramp_time;
+	}
+	else
+	{
+		ramp_time = sqrtf(speed_delta / jerk);
+		t = 2.0f * ramp_time;
+	}
+
+	*ramp = (t > 0) ? (ramp_time / t) : 0.5f;
+	return t;
+}
+
+// distance (steps) of a jerk limited speed change between two speeds
+static float planner_jerk_distance(planner_block_t *block, float from_speed, float to_speed)
+{
+	float ramp;
+	return 0.5f * (from_speed + to_speed) * planner_jerk_time(block, to_speed - from_speed, &ramp);
+}
+
+/*
+	A speed change of a block can continue in the next block if it allows the same acceleration and jerk
+	(the interpolator runs a speed change with the limits of the block where it started).
+	The limits of blocks in different directions are compared with a 1% margin for the rounding of the conversion to steps.
+*/
+static bool planner_jerk_chains(planner_block_t *block, planner_block_t *next)
+{
+	if (next->acceleration < (0.99f * block->acceleration))
+	{
+		return false;
+	}
+
+	if (!next->jerk)
+	{
+		return !block->jerk;
+	}
+
+	return (block->jerk && next->jerk >= (0.99f * block->jerk));
+}
+
+/*
+	Max speed reachable at the end of a distance from a speed at the start (or at the start from a speed at the end)
+	With constant acceleration
+		v^2 = v0^2 + 2 * a * d
+	With the max acceleration reached (dv > a^2/j = b) the distance equation is the quadratic
+		v^2 + b * v + (b * v0 - v0^2 - 2 * a * d) = 0
+	otherwise with s = sqrt(dv) it's the cubic
+		s^3 + 2 * v0 * s - d * sqrt(j) = 0
+	solved by Newton iterations from an upper bound of the root (converges from above since it's convex)
+*/
+static float planner_jerk_reach_speed_sqr(planner_block_t *block, float from_speed_sqr, float distance)
+{
+	float accel = block->acceleration;
+	float jerk = block->jerk;
+	if (!jerk)
+	{
+		return 2.0f * distance * accel + from_speed_sqr;
+	}
+
+	float from_speed = sqrtf(from_speed_sqr);
+	float b = accel * accel / jerk;
+	float k = (b - 2.0f * from_speed);
+	float speed = 0.5f * (sqrtf(k * k + 8.0f * accel * distance) - b);
+	if (speed - from_speed <= b)
+	{
+		// the max acceleration is not reached
+		k = distance * sqrtf(jerk);
+		float s = MIN(sqrtf(b), cbrtf(k));
+		if (from_speed > 0)
+		{
+			s = MIN(s, k / (2.0f * from_speed));
+		}
+
+		for (uint8_t i = 0; i < 8; i++)
+		{
+			float f = s * (s * s + 2.0f * from_speed) - k;
+			if (f <= 0)
+			{
+				break;
+			}
+			s -= f / (3.0f * s * s + 2.0f * from_speed);
+		}
+		speed = from_speed + s * s;
+	}
+
+	return speed * speed;
+}
+
+static FORCEINLINE float planner_reach_speed_sqr(planner_block_t *block, float from_speed_sqr)
+{
+	return planner_jerk_reach_speed_sqr(block, from_speed_sqr, (float)(block->steps[block->main_stepper]));
+}
+
+// a block at the max entry speed limits the blocks before it with the junction speed and not with its deceleration
+static FORCEINLINE bool planner_decel_at_max(planner_index_t block)
+{
+	return (planner_data[block].entry_feed_sqr >= planner_data[block].entry_max_feed_sqr);
+}
+
+/*
+	Max speed of the junctions a speed change that continues through the junction of the next block can't exceed
+	(the junction and the max speed of the ones the deceleration of the next block passes)
+	Before the deceleration starts the speed is below the entry speed of the junctions (a deceleration with zero
+	acceleration from the top speed still fits). The deceleration already runs when it passes a junction and can exceed
+	that entry speed by up to the speed change of an acceleration ramp (a^2/(2*j)) so only the junctions with a max speed
+	closer than that to their entry speed limit the top speed.
+*/
+static float planner_jerk_chain_max_sqr(planner_block_t *block, planner_block_t *next, float max_sqr)
+{
+	float margin = (block->jerk) ? (0.5f * block->acceleration * block->acceleration / block->jerk) : 0;
+	float speed = sqrtf(next->entry_feed_sqr) + margin;
+	if (next->entry_max_feed_sqr < (speed * speed))
+	{
+		max_sqr = MIN(max_sqr, next->entry_max_feed_sqr);
+	}
+
+	return max_sqr;
+}
+
+/*
+	Updates the deceleration that limits the speed after the start of a block (after the next block is updated)
+	It continues the deceleration of the next block if the speed change can continue through the junction, or else it
+	ends at the next block entry speed (or stops at the end of the last block).
+	The deceleration of a block at the max entry speed starts at its junction (speed and distance 0) for the blocks
+	before it but the block keeps the deceleration after the junction (it still limits the speed changes that
+	continue through the junction).
+	Returns true if the deceleration changed and the max entry speed in entry_feed_sqr.
+*/
+static bool planner_decel_update(planner_index_t block, planner_index_t next, planner_index_t last, float *entry_feed_sqr)
+{
+	planner_block_t *current = &planner_data[block];
+	float exit_sqr = 0;
+	float distance = (float)(current->steps[current->main_stepper]);
+	float max_sqr = current->rapid_feed_sqr;
+	if (block != last)
+	{
+		planner_block_t *following = &planner_data[next];
+		exit_sqr = following->entry_feed_sqr;
+		if (planner_jerk_chains(current, following) && !planner_decel_at_max(next))
+		{
+			exit_sqr = following->decel_exit_sqr;
+			distance += following->decel_dist;
+			max_sqr = planner_jerk_chain_max_sqr(current, following, following->decel_max_sqr);
+		}
+	}
+
+	float speed_sqr = planner_jerk_reach_speed_sqr(current, exit_sqr, distance);
+	*entry_feed_sqr = MIN(current->entry_max_feed_sqr, speed_sqr);
+	if (current->decel_exit_sqr == exit_sqr && current->decel_dist == distance && current->decel_max_sqr == max_sqr)
+	{
+		return false;
+	}
+
+	// the interpolator reads the values of the block after the executing block
+#ifdef ENABLE_ITP_FEED_TASK
+	__ATOMIC__
+#endif
+	{
+		current->decel_exit_sqr = exit_sqr;
+		current->decel_dist = distance;
+		current->decel_max_sqr = max_sqr;
+	}
+	return true;
+}
+
+/*
+	The speed changes of the executing block continue in the next block if the limits allow it (see planner_jerk_chains).
+	At a junction at its max speed the planner ends the deceleration of the block there so they only continue through
+	it if the block doesn't enter above that speed (they can't rise above it) and it's not a stop.
+*/
+static bool planner_jerk_exit_chains(planner_block_t *block, planner_index_t next)
+{
+	planner_block_t *following = &planner_data[next];
+	if (!planner_jerk_chains(block, following))
+	{
+		return false;
+	}
+
+	if (!planner_decel_at_max(next))
+	{
+		return true;
+	}
+
+	return (following->entry_max_feed_sqr && block->entry_feed_sqr <= following->entry_max_feed_sqr);
 }
 
+bool planner_get_block_exit_decel(float *max_speed_sqr, float *decel_sqr, float *distance)
+{
+	*distance = 0;
+#ifndef ENABLE_DUAL_CORE_MOTION
+	planner_index_t next = planner_buffer_next(planner_data_read);
+	if (next == ATOMIC_LOAD_ACQUIRE(planner_data_write))
+	{
+		*max_speed_sqr = 0;
+		*decel_sqr = 0;
+		return false;
+	}
+
+	planner_block_t *following = &planner_data[next];
+	if (!planner_jerk_exit_chains(&planner_exec, next))
+	{
+		// ends at the junction
+		*decel_sqr = planner_get_block_exit_speed_sqr();
+		*max_speed_sqr = *decel_sqr;
+		return false;
+	}
+
+	float exit_sqr;
+	float max_sqr;
+#ifdef ENABLE_ITP_FEED_TASK
+	__ATOMIC__
+#endif
+	{
+		exit_sqr = following->decel_exit_sqr;
+		*distance = following->decel_dist;
+		max_sqr = following->decel_max_sqr;
+	}
+	// the overrides of the next block apply to the whole deceleration
+	bool feed_override = following->planner_flags.bit.feed_override;
+	*max_speed_sqr = planner_exit_override(planner_jerk_chain_max_sqr(&planner_exec, following, max_sqr), following->rapid_feed_sqr, feed_override);
+	*decel_sqr = planner_exit_override(exit_sqr, following->rapid_feed_sqr, feed_override);
+	return true;
+#else
+	planner_handoff_exit_t exit;
+	planner_handoff_exit_read(&exit);
+	*distance = exit.decel_dist;
+	*max_speed_sqr = planner_exit_override(exit.max_sqr, exit.rapid_feed_sqr, exit.feed_override);
+	*decel_sqr = planner_exit_override(exit.decel_sqr, exit.rapid_feed_sqr, exit.feed_override);
+	return exit.chains;
+#endif
+}
+
+/*
+	With the jerk limit there is no closed form. The top speed is searched (bisection) between the entry/exit speed
+	and the max speed reachable from it for the distance of the speed changes to fit in the distance.
+*/
+float planner_get_block_jerk_top_speed(float entry_speed, float exit_speed, float distance)
+{
+	planner_block_t *block = planner_exec_block();
+	float junction_speed;
+	float low = MAX(entry_speed, exit_speed);
+	if (planner_jerk_distance(block, entry_speed, exit_speed) >= distance)
+	{
+		// can't reach the exit speed or overshoots it (accelerates or deaccelerates all the way)
+		junction_speed = (exit_speed > entry_speed) ? sqrtf(planner_jerk_reach_speed_sqr(block, entry_speed * entry_speed, distance)) : entry_speed;
+	}
+	else
+	{
+		float high = sqrtf(planner_jerk_reach_speed_sqr(block, low * low, distance));
+		for (uint8_t i = 0; i < 16; i++)
+		{
+			float speed = 0.5f * (low + high);
+			if ((planner_jerk_distance(block, entry_speed, speed) + planner_jerk_distance(block, speed, exit_speed)) <= distance)
+			{
+				low = speed;
+			}
+			else
+			{
+				high = speed;
+			}
+		}
+		junction_speed = low;
+	}
+
+	return MIN(junction_speed, sqrtf(planner_block_max_speed_sqr(block)));
+}
+#else
+static FORCEINLINE float planner_reach_speed_sqr(planner_block_t *block, float from_speed_sqr)
+{
+	float speedchange = ((float)(block->steps[block->main_stepper] << 1)) * block->acceleration;
+	return speedchange + from_speed_sqr;
+}
+#endif
+
 float planner_get_block_top_speed(float exit_speed_sqr)
 {
 	/*
@@ -364,50 +911,35 @@ float planner_get_block_top_speed(float exit_speed_sqr)
 
 	v_max^2 = (v_exit^2 + 2 * acceleration * distance + v_entry)/2
 	*/
+	planner_block_t *block = planner_exec_block();
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	float junction_speed = planner_get_block_jerk_top_speed(sqrtf(block->entry_feed_sqr), sqrtf(exit_speed_sqr), (float)(block->steps[block->main_stepper]));
+	return junction_speed * junction_speed;
+#else
 	// calculates the difference between the entry speed and the exit speed
-	uint8_t index = planner_data_read;
-	float speed_delta = exit_speed_sqr - planner_data[index].entry_feed_sqr;
+	float speed_delta = exit_speed_sqr - block->entry_feed_sqr;
 	// calculates the speed increase/decrease for the given distance
-	float junction_speed_sqr = planner_data[index].acceleration * (float)(planner_data[index].steps[planner_data[index].main_stepper]);
+	float junction_speed_sqr = block->acceleration * (float)(block->steps[block->main_stepper]);
 	junction_speed_sqr = fast_flt_mul2(junction_speed_sqr);
 	// if there is enough space to accelerate computes the junction speed
 	if (junction_speed_sqr >= speed_delta)
 	{
-		junction_speed_sqr += exit_speed_sqr + planner_data[index].entry_feed_sqr;
+		junction_speed_sqr += exit_speed_sqr + block->entry_feed_sqr;
 		junction_speed_sqr = fast_flt_div2(junction_speed_sqr);
 	}
-	else if (exit_speed_sqr > planner_data[index].entry_feed_sqr)
+	else if (exit_speed_sqr > block->entry_feed_sqr)
 	{
 		// will never reach the desired exit speed even accelerating all the way
-		junction_speed_sqr += planner_data[index].entry_feed_sqr;
+		junction_speed_sqr += block->entry_feed_sqr;
 	}
 	else
 	{
 		// will overshoot the desired exit speed even deaccelerating all the way
-		junction_speed_sqr = planner_data[index].entry_feed_sqr;
-	}
-
-	float rapid_feed_sqr = planner_data[index].rapid_feed_sqr;
-	float target_speed_sqr = planner_data[index].feed_sqr;
-	if (planner_data[index].planner_flags.bit.feed_override)
-	{
-		if (g_planner_state.feed_override != 100)
-		{
-			target_speed_sqr *= fast_flt_pow2((float)g_planner_state.feed_override);
-			target_speed_sqr *= 0.0001f;
-		}
-
-		// if rapid overrides are active the feed must not exceed the rapid motion feed
-		if (g_planner_state.rapid_feed_override != 100)
-		{
-			rapid_feed_sqr *= fast_flt_pow2((float)g_planner_state.rapid_feed_override);
-			rapid_feed_sqr *= 0.0001f;
-		}
+		junction_speed_sqr = block->entry_feed_sqr;
 	}
 
-	// can't ever exceed rapid move speed
-	target_speed_sqr = MIN(target_speed_sqr, rapid_feed_sqr);
-	return MIN(junction_speed_sqr, target_speed_sqr);
+	return MIN(junction_speed_sqr, planner_block_max_speed_sqr(block));
+#endif
 }
 
 #if TOOL_COUNT > 0
@@ -424,7 +956,7 @@ int16_t planner_get_spindle_speed(float scale)
 			scaled_spindle *= scale; // scale calculated in laser mode (otherwise scale is always 1)
 		}
 
-		if (planner_data[planner_data_read].planner_flags.bit.feed_override && g_planner_state.spindle_speed_override != 100)
+		if (planner_exec_block()->planner_flags.bit.feed_override && g_planner_state.spindle_speed_override != 100)
 		{
 			scaled_spindle = 0.01f * (float)g_planner_state.spindle_speed_override * scaled_spindle;
 		}
@@ -438,65 +970,223 @@ int16_t planner_get_spindle_speed(float scale)
 }
 #endif
 
-static void planner_recalculate(void)
+// publishes the entry speed of a block (a float store is not atomic on 8-bit MCUs)
+static FORCEINLINE void planner_commit_entry(planner_index_t index)
 {
-	uint8_t last = planner_data_write;
-	uint8_t first = planner_data_read;
-	uint8_t block = last;
+#if (defined(ENABLE_ITP_FEED_TASK) && (__SIZEOF_POINTER__ < 4))
+	__ATOMIC__
+#endif
+	{
+		planner_data[index].entry_commit_sqr = planner_data[index].entry_feed_sqr;
+	}
+}
+
+/*
+	Recalculates the entry speeds of the blocks after the last optimal block
+	The backward and forward passes stop at the last optimal boundary (blocks before it are final)
+	and the boundary advances every time a block entry speed can no longer be improved (it's
+	at the junction maximum or it's limited by the acceleration from the previous block).
+	Only the tail affected by the new block is recalculated so the cost per block is
+	(amortized) constant and does not grow with the planner buffer size.
+	The final entry speeds are committed to the interpolator in the forward pass.
+	Returns true if the committed exit speed of the executing block changed (the other blocks
+	commit silently since the interpolator reads their exit speed when it takes them).
+*/
+static bool planner_recalculate(void)
+{
+	planner_index_t last = planner_data_write;
+	// the interpolator may take blocks during the recalculation
+	// the blocks before the first block are no longer read by the interpolator
+	planner_index_t first = ATOMIC_LOAD_ACQUIRE(planner_data_read);
+	planner_index_t optimal = planner_data_optimal;
+	planner_index_t block = last;
+	bool updated = false;
+
+	// the optimal boundary never stays behind the executing block
+	if (planner_buffer_count(first, optimal) > planner_buffer_count(first, last))
+	{
+		optimal = first;
+	}
 
 	// starts in the last added block
 	// calculates the maximum entry speed of the block so that it can do a full stop in the end
-	if (planner_data_blocks < 1)
+	if (first == last)
 	{
 		planner_data[block].entry_feed_sqr = 0;
-		return;
+		planner_data_optimal = block;
+#ifdef ENABLE_DUAL_CORE_MOTION
+		// the block before is executing on the motion core and was going to stop
+		if (planner_handoff_open)
+		{
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+			float entry_feed_sqr;
+			planner_decel_update(block, block, last, &entry_feed_sqr);
+			planner_data[block].entry_feed_sqr = entry_feed_sqr;
+#else
+			float entry_feed_sqr = planner_reach_speed_sqr(&planner_data[block], 0);
+			planner_data[block].entry_feed_sqr = MIN(planner_data[block].entry_max_feed_sqr, entry_feed_sqr);
+#endif
+			planner_handoff_exit_update(block);
+		}
+#endif
+		return false;
 	}
 	// optimizes entry speeds given the current exit speed (backward pass)
-	uint8_t next = block;
+	planner_index_t next = block;
 	float speedchange;
 
-	while (!planner_data[block].planner_flags.bit.optimal && block != first)
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	// the entry speeds from the optimal boundary back are final but the decelerations of the blocks still continue
+	// in the new blocks (they limit the speed changes that continue through the junctions)
+	bool final = false;
+	while (block != first)
+	{
+		final = final || (block == optimal);
+		bool at_max = planner_decel_at_max(block);
+		if (!planner_decel_update(block, next, last, &speedchange))
+		{
+			// the blocks before this one are not affected by the new block
+			break;
+		}
+
+		if (!final)
+		{
+			planner_data[block].entry_feed_sqr = speedchange;
+		}
+#ifndef ENABLE_DUAL_CORE_MOTION
+		// the interpolator reads the deceleration of the block after the executing block
+		if (planner_buffer_prev(block) == first)
+		{
+			updated = true;
+		}
+#endif
+
+		if (at_max)
+		{
+			// reached the maximum entry speed
+			// the blocks before this one are only limited by its junction speed
+			break;
+		}
+
+		next = block;
+		block = planner_buffer_prev(block);
+	}
+#else
+	while (block != optimal && block != first)
 	{
-		if ((planner_data[block].entry_feed_sqr >= planner_data[block].entry_max_feed_sqr) || planner_data[block].planner_flags.bit.optimal)
+		if (planner_data[block].entry_feed_sqr >= planner_data[block].entry_max_feed_sqr)
 		{
-			// found optimal
+			// reached the maximum entry speed
+			// the blocks before this one are not affected by the new block
 			break;
 		}
-		speedchange = ((float)(planner_data[block].steps[planner_data[block].main_stepper] << 1)) * planner_data[block].acceleration;
-		speedchange += (block != last) ? planner_data[next].entry_feed_sqr : 0;
+		speedchange = planner_reach_speed_sqr(&planner_data[block], (block != last) ? planner_data[next].entry_feed_sqr : 0);
 		planner_data[block].entry_feed_sqr = MIN(planner_data[block].entry_max_feed_sqr, speedchange);
 
 		next = block;
 		block = planner_buffer_prev(block);
 	}
+#endif
+
+#ifdef ENABLE_DUAL_CORE_MOTION
+	// the block before the first block is executing on the motion core and its exit speed is not final yet
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	if (block == first && planner_handoff_open)
+	{
+		// the deceleration of the first block is the exit of the executing block
+		bool changed = planner_decel_update(block, next, last, &speedchange);
+		if (speedchange > planner_data[block].entry_feed_sqr)
+		{
+			planner_data[block].entry_feed_sqr = speedchange;
+			changed = true;
+		}
+
+		if (changed)
+		{
+			planner_handoff_exit_update(block);
+		}
+	}
+#else
+	if (block == first && planner_handoff_open)
+	{
+		speedchange = planner_reach_speed_sqr(&planner_data[block], (block != last) ? planner_data[next].entry_feed_sqr : 0);
+		speedchange = MIN(planner_data[block].entry_max_feed_sqr, speedchange);
+		if (speedchange > planner_data[block].entry_feed_sqr)
+		{
+			planner_data[block].entry_feed_sqr = speedchange;
+			planner_handoff_exit_update(block);
+		}
+	}
+#endif
+#endif
 
 	// optimizes exit speeds (forward pass)
+	// starts at the optimal boundary
+	block = optimal;
+	next = planner_buffer_next(block);
 	while (block != last)
 	{
+		planner_block_t *current = &planner_data[block];
+		float entry_feed_sqr = current->entry_feed_sqr;
+#ifndef ENABLE_DUAL_CORE_MOTION
+		// the executing block continues from the current speed with the remaining steps (written by the interpolator)
+		// and the block the interpolator didn't take yet starts at the speed the previous block ended
+		if (block == first)
+		{
+			if (planner_exec_started)
+			{
+				current = &planner_exec;
+				entry_feed_sqr = planner_exec.entry_feed_sqr;
+			}
+			else
+			{
+				entry_feed_sqr = planner_exec_speed_sqr;
+			}
+		}
+#endif
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		// the speed change continues through the junction and the entry speed is only limited by the backward pass
+		bool chains = planner_jerk_chains(current, &planner_data[next]);
+#else
+		bool chains = false;
+#endif
 		// next block is moving at a faster speed
-		if (planner_data[block].entry_feed_sqr < planner_data[next].entry_feed_sqr)
+		if (!chains && entry_feed_sqr < planner_data[next].entry_feed_sqr)
 		{
-			speedchange = ((float)(planner_data[block].steps[planner_data[block].main_stepper] << 1)) * planner_data[block].acceleration;
 			// check if the next block entry speed can be achieved
-			speedchange += planner_data[block].entry_feed_sqr;
+			speedchange = planner_reach_speed_sqr(current, entry_feed_sqr);
 			if (speedchange < planner_data[next].entry_feed_sqr)
 			{
 				// lowers next entry speed (aka exit speed) to the maximum reachable speed from current block
 				// optimization achieved for this movement
 				planner_data[next].entry_feed_sqr = speedchange;
-				planner_data[next].planner_flags.bit.optimal = true;
+				optimal = next;
 			}
 		}
 
-		// if the executing block was updated then update the interpolator limits
-		if (block == first)
+		// next block is already at the maximum junction speed
+		if (planner_data[next].entry_feed_sqr >= planner_data[next].entry_max_feed_sqr)
+		{
+			optimal = next;
+		}
+
+		// the next block entry speed is final for now and is committed to the interpolator
+		if (planner_data[next].entry_commit_sqr != planner_data[next].entry_feed_sqr)
 		{
-			itp_update();
+			planner_commit_entry(next);
+			// if the executing block exit speed was updated then update the interpolator limits
+			if (block == first)
+			{
+				updated = true;
+			}
 		}
 
 		block = next;
 		next = planner_buffer_next(block);
 	}
+
+	planner_data_optimal = optimal;
+	return updated;
 }
 
 void planner_sync_tools(motion_data_t *block_data)
@@ -591,33 +1281,190 @@ void planner_coolant_ovr_reset(void)
 }
 #endif
 
-uint8_t planner_get_buffer_freeblocks()
+planner_index_t planner_get_buffer_freeblocks()
 {
-	return PLANNER_BUFFER_SIZE - planner_data_blocks;
+	return PLANNER_BUFFER_SIZE - planner_buffer_count(ATOMIC_LOAD_ACQUIRE(planner_data_read), planner_data_write);
 }
 
+#ifdef ENABLE_DUAL_CORE_MOTION
+bool planner_handoff_is_empty(void)
+{
+	return (ATOMIC_LOAD_ACQUIRE(planner_handoff_read) == ATOMIC_LOAD_ACQUIRE(planner_handoff_write));
+}
+
+/*
+	Hands off the planned blocks to the motion core
+	A block is handed off when its exit speed is final (the next block is before the optimal boundary)
+	or before that if the motion core is running low on blocks, so that it never waits for the look-ahead.
+*/
+void planner_handoff(void)
+{
+	uint8_t write = planner_handoff_write;
+	for (;;)
+	{
+		planner_index_t blocks = planner_buffer_count(planner_data_read, planner_data_write);
+		if (!blocks)
+		{
+			break;
+		}
+
+		uint8_t read = ATOMIC_LOAD_ACQUIRE(planner_handoff_read);
+		uint8_t next = write + 1;
+		if (next == PLANNER_HANDOFF_SIZE)
+		{
+			next = 0;
+		}
+		if (next == read)
+		{
+			// full
+			break;
+		}
+
+		uint8_t level = (write >= read) ? (write - read) : (write + PLANNER_HANDOFF_SIZE - read);
+		planner_index_t index = planner_data_read;
+		// the exit speed of the last block is final only after the next block is added
+		bool early = (index == planner_data_optimal) || (blocks == 1);
+		if (early && level >= (PLANNER_HANDOFF_SIZE >> 1))
+		{
+			// the look-ahead may still raise the exit speed
+			break;
+		}
+
+		planner_handoff_block_t *handoff = &planner_handoff_data[write];
+		memcpy(&handoff->block, &planner_data[index], sizeof(planner_block_t));
+		handoff->started = false;
+		handoff->exit.feed_sqr = 0;
+		handoff->exit.rapid_feed_sqr = 0;
+		handoff->exit.feed_override = false;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		handoff->exit.chains = false;
+		handoff->exit.max_sqr = 0;
+		handoff->exit.decel_sqr = 0;
+		handoff->exit.decel_dist = 0;
+#endif
+		planner_index_t next_block = planner_buffer_next(index);
+		if (blocks > 1)
+		{
+			planner_handoff_exit_set(handoff, next_block);
+		}
+
+		// removes the block from the planner (the next block becomes the first block)
+		if (planner_data_optimal == index)
+		{
+			planner_data_optimal = next_block;
+		}
+		planner_data_read = next_block;
+
+		write = next;
+		ATOMIC_STORE_RELEASE(planner_handoff_write, write);
+		planner_handoff_open = early;
+		planner_handoff_stats.blocks++;
+		if (early)
+		{
+			planner_handoff_stats.early++;
+		}
+	}
+}
+
+// sets the exit of a handed off block from the entry of the next block
+static void planner_handoff_exit_set(planner_handoff_block_t *handoff, planner_index_t index)
+{
+	planner_block_t *next = &planner_data[index];
+	handoff->exit.feed_sqr = next->entry_feed_sqr;
+	handoff->exit.rapid_feed_sqr = next->rapid_feed_sqr;
+	handoff->exit.feed_override = next->planner_flags.bit.feed_override;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	// the deceleration continues in the next block or else ends at the junction
+	handoff->exit.chains = planner_jerk_exit_chains(&handoff->block, index);
+	if (handoff->exit.chains)
+	{
+		handoff->exit.max_sqr = planner_jerk_chain_max_sqr(&handoff->block, next, next->decel_max_sqr);
+		handoff->exit.decel_sqr = next->decel_exit_sqr;
+		handoff->exit.decel_dist = next->decel_dist;
+	}
+	else
+	{
+		handoff->exit.max_sqr = next->entry_feed_sqr;
+		handoff->exit.decel_sqr = next->entry_feed_sqr;
+		handoff->exit.decel_dist = 0;
+	}
+#endif
+}
+
+// publishes the raised entry speed of the first block as the exit speed of the last handed off block
+static void planner_handoff_exit_update(planner_index_t index)
+{
+	uint8_t last = planner_handoff_write;
+	last = (!last) ? (PLANNER_HANDOFF_SIZE - 1) : (last - 1);
+	planner_handoff_block_t *handoff = &planner_handoff_data[last];
+	uint8_t seq = handoff->exit_seq;
+	// the motion core may be reading the exit speed (odd sequence while it's written)
+	ATOMIC_STORE_RELEASE(handoff->exit_seq, (uint8_t)(seq + 1));
+	ATOMIC_FENCE();
+	planner_handoff_exit_set(handoff, index);
+	ATOMIC_STORE_RELEASE(handoff->exit_seq, (uint8_t)(seq + 2));
+	ATOMIC_STORE_RELEASE(planner_handoff_updated, true);
+}
+
+bool planner_handoff_exit_updated(void)
+{
+	return ATOMIC_EXCHANGE(planner_handoff_updated, false);
+}
+
+static void planner_handoff_clear(void)
+{
+	planner_handoff_write = 0;
+	planner_handoff_read = 0;
+	planner_handoff_speed_sqr = 0;
+	planner_handoff_open = false;
+	planner_handoff_updated = false;
+}
+
+void planner_handoff_get_stats(planner_handoff_stats_t *stats)
+{
+	memcpy(stats, &planner_handoff_stats, sizeof(planner_handoff_stats_t));
+}
+#endif
+
 #ifdef ENABLE_MOTION_CONTROL_PLANNER_HIJACKING
-static planner_block_t planner_data_copy[PLANNER_BUFFER_SIZE];
-static uint8_t planner_data_write_copy;
-static uint8_t planner_data_read_copy;
-static uint8_t planner_data_blocks_copy;
+static planner_block_t planner_data_copy[PLANNER_RING_SIZE];
+static planner_index_t planner_data_write_copy;
+static planner_index_t planner_data_read_copy;
+static planner_index_t planner_data_optimal_copy;
+static planner_block_t planner_exec_copy;
+static bool planner_exec_started_copy;
+static float planner_exec_speed_sqr_copy;
 static planner_state_t g_planner_state_copy;
 // creates a full copy of the planner state
 void planner_store(void)
 {
-	memcpy(planner_data_copy, planner_data, sizeof(planner_data));
-	planner_data_write_copy = planner_data_write;
-	planner_data_read_copy = planner_data_read;
-	planner_data_blocks_copy = planner_data_blocks;
-	memcpy(&g_planner_state_copy, &g_planner_state, sizeof(planner_state_t));
+	// the RTC ISR can't take blocks while the planner is copied
+	__ATOMIC__
+	{
+		memcpy(planner_data_copy, planner_data, sizeof(planner_data));
+		planner_data_write_copy = planner_data_write;
+		planner_data_read_copy = planner_data_read;
+		planner_data_optimal_copy = planner_data_optimal;
+		memcpy(&planner_exec_copy, &planner_exec, sizeof(planner_block_t));
+		planner_exec_started_copy = planner_exec_started;
+		planner_exec_speed_sqr_copy = planner_exec_speed_sqr;
+		memcpy(&g_planner_state_copy, &g_planner_state, sizeof(planner_state_t));
+	}
 }
 // restores the planner to it's previous saved state
 void planner_restore(void)
 {
-	memcpy(planner_data, planner_data_copy, sizeof(planner_data));
-	planner_data_write = planner_data_write_copy;
-	planner_data_read = planner_data_read_copy;
-	planner_data_blocks = planner_data_blocks_copy;
-	memcpy(&g_planner_state, &g_planner_state_copy, sizeof(planner_state_t));
+	// the RTC ISR can't take blocks while the planner is restored
+	__ATOMIC__
+	{
+		memcpy(planner_data, planner_data_copy, sizeof(planner_data));
+		planner_data_write = planner_data_write_copy;
+		planner_data_read = planner_data_read_copy;
+		planner_data_optimal = planner_data_optimal_copy;
+		memcpy(&planner_exec, &planner_exec_copy, sizeof(planner_block_t));
+		planner_exec_started = planner_exec_started_copy;
+		planner_exec_speed_sqr = planner_exec_speed_sqr_copy;
+		memcpy(&g_planner_state, &g_planner_state_copy, sizeof(planner_state_t));
+	}
 }
 #endif
@@ -33,6 +33,13 @@ extern "C"
 #define PLANNER_BUFFER_SIZE 20
 #endif
 
+// buffers with more than 254 blocks need 16-bit indexes (the ring has one extra free slot)
+#if (PLANNER_BUFFER_SIZE > 254)
+	typedef uint16_t planner_index_t;
+#else
+	typedef uint8_t planner_index_t;
+#endif
+
 #define PLANNER_MOTION_EXACT_PATH 32 // default (not used)
 #define PLANNER_MOTION_EXACT_STOP 64
 #define PLANNER_MOTION_CONTINUOUS 128
@@ -50,13 +57,23 @@ extern "C"
 		uint8_t main_stepper;
 		float feed_conversion;
 		float entry_feed_sqr;
+		volatile float entry_commit_sqr; // final entry speed published to the interpolator
 		float entry_max_feed_sqr;
 		float feed_sqr;
 		float rapid_feed_sqr;
 		float acceleration;
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		float jerk; // max jerk in steps/s^3 (0 no limit)
+		float decel_exit_sqr; // speed at the end of the deceleration that limits the speed after the start of the block
+		float decel_dist; // steps from the start of the block to the end of that deceleration
+		float decel_max_sqr; // max speed of the junctions that deceleration passes (the block feed if it ends at the end of the block)
+#endif
 
 #if TOOL_COUNT > 0
 		int16_t spindle;
+#endif
+#ifdef ENABLE_SYNC_OUTPUTS
+		uint8_t sync_output; // group of synchronized outputs armed when the block starts (0 none)
 #endif
 		// uint8_t action;
 		planner_flags_t planner_flags;
@@ -85,11 +102,24 @@ extern "C"
 	planner_block_t *planner_get_last_block(void);
 	float planner_get_block_exit_speed_sqr(void);
 	float planner_get_block_top_speed(float exit_speed_sqr);
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+	// duration of a jerk limited speed change of a block (the acceleration ramps up and down at the max jerk)
+	// ramp receives the fraction of the duration of each acceleration ramp (0 to 0.5)
+	float planner_jerk_time(planner_block_t *block, float speed_delta, float *ramp);
+	// limits of the speed changes of the executing block that can continue in the next block (returns true if they can)
+	// the max speed of the junctions they pass and the deceleration after the block (speed at its end and steps after the block)
+	// if the speed changes can't continue both speeds are the exit speed
+	bool planner_get_block_exit_decel(float *max_speed_sqr, float *decel_sqr, float *distance);
+	// top speed of the executing block from a speed for a deceleration to the exit speed that ends after distance steps
+	float planner_get_block_jerk_top_speed(float entry_speed, float exit_speed, float distance);
+#endif
 #if TOOL_COUNT > 0
 	int16_t planner_get_spindle_speed(float scale);
 	uint8_t planner_get_coolant(void);
 #endif
 	void planner_discard_block(void);
+	// discards all blocks and keeps the tool state of the last block (only while the interpolator can't take blocks)
+	void planner_flush(void);
 	void planner_add_line(motion_data_t *block_data);
 	void planner_add_analog_output(uint8_t output, uint8_t value);
 	void planner_add_digital_output(uint8_t output, uint8_t value);
@@ -106,7 +136,31 @@ extern "C"
 	void planner_coolant_ovr_reset(void);
 #endif
 
-	uint8_t planner_get_buffer_freeblocks();
+	planner_index_t planner_get_buffer_freeblocks();
+
+#ifdef ENABLE_DUAL_CORE_MOTION
+// blocks in flight between the main core and the motion core (one slot is always free)
+#ifndef PLANNER_HANDOFF_SIZE
+#define PLANNER_HANDOFF_SIZE 4
+#endif
+#if (PLANNER_HANDOFF_SIZE < 3 || PLANNER_HANDOFF_SIZE > 255)
+#error "PLANNER_HANDOFF_SIZE must be between 3 and 255"
+#endif
+
+	typedef struct planner_handoff_stats_
+	{
+		uint32_t blocks; // blocks handed off to the motion core
+		uint32_t early;	 // blocks handed off before the look-ahead made their exit speed final
+	} planner_handoff_stats_t;
+
+	// hands off the planned blocks to the motion core (runs on the main core)
+	void planner_handoff(void);
+	// no blocks were handed off to the motion core (it has nothing to execute)
+	bool planner_handoff_is_empty(void);
+	// the exit speed of an handed off block was raised since the last call (runs on the motion core)
+	bool planner_handoff_exit_updated(void);
+	void planner_handoff_get_stats(planner_handoff_stats_t *stats);
+#endif
 
 #ifdef ENABLE_MOTION_CONTROL_PLANNER_HIJACKING
 	// creates a full copy of the planner state
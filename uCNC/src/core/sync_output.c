@@ -0,0 +1,321 @@
+/*
+	Name: sync_output.c
+	Description: Digital outputs synchronized with the step stream for µCNC.
+		Output changes queued by M62/M63, bound to the next planner block and fired by the step ISR.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../cnc.h"
+#include <stdint.h>
+
+#ifdef ENABLE_SYNC_OUTPUTS
+
+/**
+ * Each slot goes FREE -> QUEUED (parser) -> PLANNED (planner) -> ARMED (step ISR at the block start) -> FIRED (step ISR) -> FREE (main loop report)
+ * The main loop and the step ISR never change a slot in the same state
+ * */
+#define SYNC_OUTPUT_FREE 0
+#define SYNC_OUTPUT_QUEUED 1
+#define SYNC_OUTPUT_PLANNED 2
+#define SYNC_OUTPUT_ARMED 3
+#define SYNC_OUTPUT_FIRED 4
+
+/**
+ * The time tags are checked by the step ISR and the RTC ISR (1ms) and the one that is due before the next RTC tick
+ * is fired by the MCU one shot timer. Without the one shot timer (or if it's used by the laser PPI) the time tags fire
+ * up to 1ms late (the RTC tick resolution) or one step ISR period late if that is shorter.
+ * With the dual core motion the time tags are checked by the motion core loop.
+ * */
+#if defined(MCU_HAS_ONESHOT_TIMER) && !defined(ENABLE_LASER_PPI) && !defined(ENABLE_DUAL_CORE_MOTION)
+#define SYNC_OUTPUT_ONESHOT
+#define SYNC_OUTPUT_ONESHOT_WINDOW 1000
+#endif
+
+typedef struct sync_output_
+{
+	volatile uint8_t state;
+	uint8_t group;
+	uint8_t output;
+	uint8_t value;
+	uint8_t tag;
+	int32_t position;	// target step position (position tag) or step position when fired
+	uint32_t delay;		// delay from the motion start (time tag in us)
+	uint32_t start;		// motion start (us) or time since the motion start when fired (us)
+	uint32_t latency; // firing latency (cycles)
+} sync_output_t;
+
+static sync_output_t sync_output_slots[SYNC_OUTPUT_COUNT];
+static uint8_t sync_output_group;
+volatile uint8_t sync_output_armed;
+#ifdef SYNC_OUTPUT_ONESHOT
+static volatile bool sync_output_oneshot_running;
+static uint32_t sync_output_oneshot_deadline;
+#endif
+
+static void sync_output_fire(sync_output_t *slot, uint32_t latency)
+{
+	io_set_pinvalue(SYNC_OUTPUT_PIN_OFFSET + slot->output, slot->value);
+	slot->latency = latency;
+	slot->state = SYNC_OUTPUT_FIRED;
+	sync_output_armed--;
+}
+
+bool sync_output_add(uint8_t output, uint8_t value, uint8_t tag, int32_t position, uint32_t delay_us)
+{
+	for (uint8_t i = 0; i < SYNC_OUTPUT_COUNT; i++)
+	{
+		sync_output_t *slot = &sync_output_slots[i];
+		if (slot->state == SYNC_OUTPUT_FREE)
+		{
+			slot->output = output;
+			slot->value = value;
+			slot->tag = tag;
+			slot->position = position;
+			slot->delay = delay_us;
+			slot->state = SYNC_OUTPUT_QUEUED;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint8_t sync_output_bind(void)
+{
+	uint8_t group = 0;
+	for (uint8_t i = 0; i < SYNC_OUTPUT_COUNT; i++)
+	{
+		sync_output_t *slot = &sync_output_slots[i];
+		if (slot->state == SYNC_OUTPUT_QUEUED)
+		{
+			if (!group)
+			{
+				// 0 means no outputs
+				group = (++sync_output_group) ? sync_output_group : ++sync_output_group;
+			}
+			slot->group = group;
+			slot->state = SYNC_OUTPUT_PLANNED;
+		}
+	}
+
+	return group;
+}
+
+// fires a time tagged output if the delay elapsed and returns the time left (us) or 0 if it fired
+static uint32_t sync_output_timeout(sync_output_t *slot, uint32_t now)
+{
+	uint32_t elapsed = now - slot->start;
+	if (elapsed >= slot->delay)
+	{
+		slot->start = elapsed;
+		sync_output_fire(slot, (elapsed - slot->delay) * (MCU_CYCLE_COUNTER_CLOCK / 1000000UL));
+		return 0;
+	}
+
+	return slot->delay - elapsed;
+}
+
+#ifdef SYNC_OUTPUT_ONESHOT
+static MCU_CALLBACK void sync_output_oneshot_cb(void);
+
+// starts the one shot timer if the next time tag is due before the next RTC tick
+static void sync_output_schedule(uint32_t now, uint32_t left)
+{
+	if (left >= SYNC_OUTPUT_ONESHOT_WINDOW)
+	{
+		return;
+	}
+
+	uint32_t deadline = now + left;
+	// an earlier time tag restarts the timer
+	if (sync_output_oneshot_running && (int32_t)(deadline - sync_output_oneshot_deadline) >= 0)
+	{
+		return;
+	}
+
+	sync_output_oneshot_running = true;
+	sync_output_oneshot_deadline = deadline;
+	mcu_config_timeout(&sync_output_oneshot_cb, left);
+	mcu_start_timeout();
+}
+
+static MCU_CALLBACK void sync_output_oneshot_cb(void)
+{
+	sync_output_oneshot_running = false;
+	if (sync_output_armed)
+	{
+		// the step ISR can preempt the timer
+		__ATOMIC__
+		{
+			sync_output_tick();
+		}
+	}
+}
+#else
+#define sync_output_schedule(now, left)
+#endif
+
+void sync_output_arm(uint8_t group, int32_t *position)
+{
+	uint32_t now = mcu_micros();
+	uint32_t next = UINT32_MAX;
+	for (uint8_t i = 0; i < SYNC_OUTPUT_COUNT; i++)
+	{
+		sync_output_t *slot = &sync_output_slots[i];
+		if (slot->state == SYNC_OUTPUT_PLANNED && slot->group == group)
+		{
+			slot->start = now;
+			slot->state = SYNC_OUTPUT_ARMED;
+			sync_output_armed++;
+			// already at the position
+			if (slot->tag < STEPPER_COUNT && position[slot->tag] == slot->position)
+			{
+				sync_output_fire(slot, 0);
+			}
+			else if (slot->tag == SYNC_OUTPUT_TIME)
+			{
+				uint32_t left = sync_output_timeout(slot, now);
+				if (left && left < next)
+				{
+					next = left;
+				}
+			}
+		}
+	}
+
+	if (next != UINT32_MAX)
+	{
+		sync_output_schedule(now, next);
+	}
+}
+
+void sync_output_step(int32_t *position, uint8_t stepbits, uint32_t step_cycles)
+{
+	uint32_t now = 0;
+	uint32_t next = UINT32_MAX;
+	for (uint8_t i = 0; i < SYNC_OUTPUT_COUNT; i++)
+	{
+		sync_output_t *slot = &sync_output_slots[i];
+		if (slot->state != SYNC_OUTPUT_ARMED)
+		{
+			continue;
+		}
+
+		uint8_t tag = slot->tag;
+		if (tag == SYNC_OUTPUT_TIME)
+		{
+			if (!now)
+			{
+				now = mcu_micros();
+			}
+
+			uint32_t left = sync_output_timeout(slot, now);
+			if (left && left < next)
+			{
+				next = left;
+			}
+		}
+		else if (tag == SYNC_OUTPUT_FIRST_STEP)
+		{
+			if (stepbits)
+			{
+				sync_output_fire(slot, mcu_cycle_count() - step_cycles);
+			}
+		}
+		else if ((stepbits & (1 << tag)) && position[tag] == slot->position)
+		{
+			sync_output_fire(slot, mcu_cycle_count() - step_cycles);
+		}
+	}
+
+	if (next != UINT32_MAX)
+	{
+		sync_output_schedule(now, next);
+	}
+}
+
+void sync_output_tick(void)
+{
+	uint32_t now = mcu_micros();
+	uint32_t next = UINT32_MAX;
+	for (uint8_t i = 0; i < SYNC_OUTPUT_COUNT; i++)
+	{
+		sync_output_t *slot = &sync_output_slots[i];
+		if (slot->state == SYNC_OUTPUT_ARMED && slot->tag == SYNC_OUTPUT_TIME)
+		{
+			uint32_t left = sync_output_timeout(slot, now);
+			if (left && left < next)
+			{
+				next = left;
+			}
+		}
+	}
+
+	if (next != UINT32_MAX)
+	{
+		sync_output_schedule(now, next);
+	}
+}
+
+void sync_output_clear(void)
+{
+	__ATOMIC__
+	{
+		for (uint8_t i = 0; i < SYNC_OUTPUT_COUNT; i++)
+		{
+			sync_output_slots[i].state = SYNC_OUTPUT_FREE;
+		}
+		sync_output_armed = 0;
+	}
+}
+
+void sync_output_report(void)
+{
+	for (uint8_t i = 0; i < SYNC_OUTPUT_COUNT; i++)
+	{
+		sync_output_t *slot = &sync_output_slots[i];
+		if (slot->state != SYNC_OUTPUT_FIRED)
+		{
+			continue;
+		}
+
+		int32_t tag = (slot->tag == SYNC_OUTPUT_TIME) ? (int32_t)slot->start : ((slot->tag < STEPPER_COUNT) ? slot->position : 0);
+		uint32_t latency = (uint32_t)(((uint64_t)slot->latency * 1000000000ULL) / MCU_CYCLE_COUNTER_CLOCK);
+		proto_printf("[SYNC:%d,%d,", slot->output, slot->value);
+		// the print format is unsigned
+		if (tag < 0)
+		{
+			proto_putc('-');
+			tag = -tag;
+		}
+		proto_printf("%lu,%lu" MSG_FEEDBACK_END, (uint32_t)tag, latency);
+		slot->state = SYNC_OUTPUT_FREE;
+	}
+}
+
+bool sync_output_has_report(void)
+{
+	for (uint8_t i = 0; i < SYNC_OUTPUT_COUNT; i++)
+	{
+		if (sync_output_slots[i].state == SYNC_OUTPUT_FIRED)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#endif
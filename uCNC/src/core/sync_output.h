@@ -0,0 +1,92 @@
+/*
+	Name: sync_output.h
+	Description: Digital outputs synchronized with the step stream for µCNC.
+		The outputs are queued with the next motion and fired from the step ISR (mcu_step_cb)
+		at the exact step a stepper reaches a position, a time after the motion start or at its first step,
+		without stopping the motion or splitting the blocks.
+
+		M62 P<n> [<axis><position> | Q<ms>] - sets DOUT<n> synchronized with the next motion
+		M63 P<n> [<axis><position> | Q<ms>] - clears DOUT<n> synchronized with the next motion
+			without a tag the output changes with the first step of the next motion
+			<axis><position> - when the axis reaches the position (work coordinates, cartesian kinematics only)
+			Q<ms> - after Q milliseconds of the next motion (fired by the MCU one shot timer, if the MCU has none or the laser PPI
+				uses it the resolution is the 1ms RTC tick or the step ISR period if shorter)
+		The outputs are armed when the next motion starts and stay armed (across the following motions) until they fire.
+		Any stop that flushes the motions discards them.
+		With all the SYNC_OUTPUT_COUNT slots pending a new change waits for the queued motions to fire one
+		(error 11 if no motion is queued).
+
+		Each output that fires is reported as
+			[SYNC:<n>,<value>,<tag>,<latency ns>]
+		where the tag is the step position (position tag), the microseconds since the motion start (time tag) or 0 (first step)
+		and the latency is measured from the step output (or the scheduled time) to the output change.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef SYNC_OUTPUT_H
+#define SYNC_OUTPUT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_SYNC_OUTPUTS
+
+#ifndef SYNC_OUTPUT_COUNT
+#define SYNC_OUTPUT_COUNT 8
+#endif
+#if (SYNC_OUTPUT_COUNT < 1 || SYNC_OUTPUT_COUNT > 32)
+#error "SYNC_OUTPUT_COUNT must be between 1 and 32"
+#endif
+#ifdef ENABLE_STEP_DMA
+#error "ENABLE_SYNC_OUTPUTS is not supported with ENABLE_STEP_DMA (the step ISR runs ahead of the outputs)"
+#endif
+
+// pin number of DOUT0
+#define SYNC_OUTPUT_PIN_OFFSET 47
+// tags (stepper index for the position tags)
+#define SYNC_OUTPUT_FIRST_STEP 254
+#define SYNC_OUTPUT_TIME 255
+
+	extern volatile uint8_t sync_output_armed;
+
+	// queues an output change for the next motion (false if there are no free slots)
+	bool sync_output_add(uint8_t output, uint8_t value, uint8_t tag, int32_t position, uint32_t delay_us);
+	// binds the queued outputs to a new planner block (returns the group to arm when the block starts or 0)
+	uint8_t sync_output_bind(void);
+	// arms the outputs of the group (called by the step ISR when the block starts)
+	void sync_output_arm(uint8_t group, int32_t *position);
+	// fires the armed outputs that reached their tag (called by the step ISR after the step position update)
+	void sync_output_step(int32_t *position, uint8_t stepbits, uint32_t step_cycles);
+	// fires the armed time tagged outputs (RTC ISR, one shot timer or motion core loop, the step ISR period can be longer at low step rates)
+	void sync_output_tick(void);
+	// discards all outputs (the motions were flushed)
+	void sync_output_clear(void);
+	// reports the outputs that fired (main loop)
+	void sync_output_report(void);
+	// an output fired and was not reported yet
+	bool sync_output_has_report(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -184,6 +184,9 @@ extern "C"
 // RP2350
 #elif (BOARD == BOARD_RPI_PICO2)
 #define BOARDMAP "rp2350/boardmap_rpi_pico2.h"
+// VIRTUAL
+#elif (BOARD == BOARD_VIRTUAL)
+#define BOARDMAP "virtual/boardmap_virtual.h"
 // CUSTOM
 #elif (BOARD == BOARD_CUSTOM) || (BOARD == BOARD_UNDEFINED)
 #define BOARDMAP "../../../boardmap_overrides.h"
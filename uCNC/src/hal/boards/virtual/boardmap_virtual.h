@@ -0,0 +1,42 @@
+/*
+		Name: boardmap_virtual.h
+		Description: Contains all MCU and PIN definitions for a virtual board running on a PC.
+
+		Copyright: Copyright (c) João Martins
+		Author: João Martins
+		Date: 17/10/2026
+
+		µCNC is free software: you can redistribute it and/or modify
+		it under the terms of the GNU General Public License as published by
+		the Free Software Foundation, either version 3 of the License, or
+		(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+		µCNC is distributed WITHOUT ANY WARRANTY;
+		Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+		See the	GNU General Public License for more details.
+*/
+
+#ifndef BOARDMAP_VIRTUAL_H
+#define BOARDMAP_VIRTUAL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifndef MCU
+#define MCU MCU_VIRTUAL_LINUX
+#endif
+
+#ifndef BOARD_NAME
+#define BOARD_NAME "Virtual"
+#endif
+
+	// all pins (steps, dirs, limits, inputs, outputs, pwm, analog) are fixed
+	// and declared in mcumap_virtual.h
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
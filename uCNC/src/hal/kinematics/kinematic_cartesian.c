@@ -23,6 +23,9 @@
 
 #include <math.h>
 
+// axis that are homed one at a time (before the ones homed in parallel)
+#define SERIAL_HOMING_MASK(mask) ((mask) & ~PARALLEL_HOMING_AXIS_MASK)
+
 void kinematics_init(void)
 {
 }
@@ -49,7 +52,7 @@ uint8_t kinematics_home(void)
 	uint8_t error = STATUS_OK;
 
 #ifndef DISABLE_ALL_LIMITS
-#if AXIS_Z_HOMING_MASK != 0
+#if SERIAL_HOMING_MASK(AXIS_Z_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_Z_HOMING_MASK, LINACT2_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
@@ -59,7 +62,7 @@ uint8_t kinematics_home(void)
 
 #ifndef ENABLE_XY_SIMULTANEOUS_HOMING
 
-#if AXIS_X_HOMING_MASK != 0
+#if SERIAL_HOMING_MASK(AXIS_X_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_X_HOMING_MASK, LINACT0_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
@@ -67,7 +70,7 @@ uint8_t kinematics_home(void)
 	}
 #endif
 
-#if AXIS_Y_HOMING_MASK != 0
+#if SERIAL_HOMING_MASK(AXIS_Y_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_Y_HOMING_MASK, LINACT1_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
@@ -77,19 +80,19 @@ uint8_t kinematics_home(void)
 
 #else
 
-#if AXIS_X_HOMING_MASK != 0 && AXIS_Y_HOMING_MASK != 0
+#if SERIAL_HOMING_MASK(AXIS_X_HOMING_MASK) != 0 && SERIAL_HOMING_MASK(AXIS_Y_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_X_HOMING_MASK | AXIS_Y_HOMING_MASK, LINACT0_LIMIT_MASK | LINACT1_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
 		return error;
 	}
-#elif AXIS_X_HOMING_MASK != 0
+#elif SERIAL_HOMING_MASK(AXIS_X_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_X_HOMING_MASK, LINACT0_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
 		return error;
 	}
-#elif AXIS_Y_HOMING_MASK != 0
+#elif SERIAL_HOMING_MASK(AXIS_Y_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_Y_HOMING_MASK, LINACT1_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
@@ -99,7 +102,7 @@ uint8_t kinematics_home(void)
 
 #endif
 
-#if AXIS_A_HOMING_MASK != 0
+#if SERIAL_HOMING_MASK(AXIS_A_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_A_HOMING_MASK, LINACT3_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
@@ -107,7 +110,7 @@ uint8_t kinematics_home(void)
 	}
 #endif
 
-#if AXIS_B_HOMING_MASK != 0
+#if SERIAL_HOMING_MASK(AXIS_B_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_B_HOMING_MASK, LINACT4_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
@@ -115,7 +118,7 @@ uint8_t kinematics_home(void)
 	}
 #endif
 
-#if AXIS_C_HOMING_MASK != 0
+#if SERIAL_HOMING_MASK(AXIS_C_HOMING_MASK) != 0
 	error = mc_home_axis(AXIS_C_HOMING_MASK, LINACT5_LIMIT_MASK);
 	if (error != STATUS_OK)
 	{
@@ -123,6 +126,14 @@ uint8_t kinematics_home(void)
 	}
 #endif
 
+#if PARALLEL_HOMING_AXIS_MASK != 0
+	error = mc_home_axis(PARALLEL_HOMING_AXIS_MASK, PARALLEL_HOMING_LIMIT_MASK);
+	if (error != STATUS_OK)
+	{
+		return error;
+	}
+#endif
+
 	cnc_unlock(true);
 	motion_data_t block_data = {0};
 	mc_get_position(target);
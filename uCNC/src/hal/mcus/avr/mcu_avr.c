@@ -610,7 +610,7 @@ uint8_t mcu_uart_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart_available(void)
+buffer_index_t mcu_uart_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart_rx);
 }
@@ -649,7 +649,7 @@ uint8_t mcu_uart2_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart2_available(void)
+buffer_index_t mcu_uart2_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart2_rx);
 }
@@ -133,7 +133,7 @@ extern "C"
 		return c;
 	}
 
-	uint8_t mcu_bt_available(void)
+	buffer_index_t mcu_bt_available(void)
 	{
 		return BUFFER_READ_AVAILABLE(bt_rx);
 	}
@@ -160,7 +160,7 @@ extern "C"
 			{
 				uint8_t tmp[BLUETOOTH_TX_BUFFER_SIZE + 1];
 				memset(tmp, 0, sizeof(tmp));
-				uint8_t r;
+				buffer_index_t r;
 
 				BUFFER_READ(bt_tx, tmp, BLUETOOTH_TX_BUFFER_SIZE, r);
 				SerialBT.write(tmp, r);
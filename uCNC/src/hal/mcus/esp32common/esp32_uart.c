@@ -77,11 +77,18 @@ uint8_t mcu_uart_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart_available(void)
+buffer_index_t mcu_uart_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart_rx);
 }
 
+buffer_index_t mcu_uart_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(uart_rx, buffer, len, read);
+	return read;
+}
+
 void mcu_uart_clear(void)
 {
 	BUFFER_CLEAR(uart_rx);
@@ -103,7 +110,7 @@ void mcu_uart_flush(void)
 		uint8_t tmp[UART_TX_BUFFER_SIZE + 1];
 		uint8_t *p = tmp;
 		memset(tmp, 0, sizeof(tmp));
-		uint8_t r;
+		buffer_index_t r;
 
 		BUFFER_READ(uart_tx, tmp, UART_TX_BUFFER_SIZE, r);
 		while (r)
@@ -179,11 +186,18 @@ uint8_t mcu_uart2_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart2_available(void)
+buffer_index_t mcu_uart2_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart2_rx);
 }
 
+buffer_index_t mcu_uart2_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(uart2_rx, buffer, len, read);
+	return read;
+}
+
 void mcu_uart2_clear(void)
 {
 	BUFFER_CLEAR(uart2_rx);
@@ -205,7 +219,7 @@ void mcu_uart2_flush(void)
 		uint8_t tmp[UART2_TX_BUFFER_SIZE + 1];
 		uint8_t *p = tmp;
 		memset(tmp, 0, sizeof(tmp));
-		uint8_t r;
+		buffer_index_t r;
 
 		BUFFER_READ(uart2_tx, tmp, UART2_TX_BUFFER_SIZE, r);
 		while (r)
@@ -152,11 +152,18 @@ extern "C"
 		return c;
 	}
 
-	uint8_t mcu_usb_available(void)
+	buffer_index_t mcu_usb_available(void)
 	{
 		return BUFFER_READ_AVAILABLE(usb_rx);
 	}
 
+	buffer_index_t mcu_usb_read(uint8_t *buffer, buffer_index_t len)
+	{
+		buffer_index_t read;
+		BUFFER_READ_LINE(usb_rx, buffer, len, read);
+		return read;
+	}
+
 	void mcu_usb_clear(void)
 	{
 		BUFFER_CLEAR(usb_rx);
@@ -177,7 +184,7 @@ extern "C"
 		{
 			uint8_t tmp[USB_TX_BUFFER_SIZE + 1];
 			memset(tmp, 0, sizeof(tmp));
-			uint8_t r;
+			buffer_index_t r;
 
 			BUFFER_READ(usb_tx, tmp, USB_TX_BUFFER_SIZE, r);
 			USBSerial.write(tmp, r);
@@ -718,7 +718,7 @@ extern "C"
 		return c;
 	}
 
-	uint8_t mcu_wifi_available(void)
+	buffer_index_t mcu_wifi_available(void)
 	{
 		return BUFFER_READ_AVAILABLE(wifi_rx);
 	}
@@ -745,7 +745,7 @@ extern "C"
 			{
 				uint8_t tmp[WIFI_TX_BUFFER_SIZE + 1];
 				memset(tmp, 0, sizeof(tmp));
-				uint8_t r;
+				buffer_index_t r;
 
 				BUFFER_READ(wifi_tx, tmp, WIFI_TX_BUFFER_SIZE, r);
 				server_client.write(tmp, r);
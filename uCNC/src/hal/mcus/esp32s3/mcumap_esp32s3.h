@@ -4457,6 +4457,8 @@ extern "C"
 #define BAUDRATE2 BAUDRATE
 #endif
 #endif
+// mcu_usb_read, mcu_uart_read and mcu_uart2_read
+#define MCU_HAS_STREAM_READ
 #if (defined(USB_DP) && defined(USB_DM))
 #define MCU_HAS_USB
 #endif
@@ -812,7 +812,7 @@ extern "C"
 		return c;
 	}
 
-	uint8_t mcu_wifi_available(void)
+	buffer_index_t mcu_wifi_available(void)
 	{
 		return BUFFER_READ_AVAILABLE(wifi_rx);
 	}
@@ -838,7 +838,7 @@ extern "C"
 			{
 				uint8_t tmp[WIFI_TX_BUFFER_SIZE + 1];
 				memset(tmp, 0, sizeof(tmp));
-				uint8_t r;
+				buffer_index_t r;
 				uint8_t max = (uint8_t)MIN(telnet_client.availableForWrite(), WIFI_TX_BUFFER_SIZE);
 
 				BUFFER_READ(wifi_tx, tmp, max, r);
@@ -0,0 +1,397 @@
+/*
+	Name: flash_kv.c
+	Description: Wear levelled log structured key/value store for µCNC flash emulated EEPROM.
+		See flash_kv.h for the flash format.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../../cnc.h"
+
+#ifdef ENABLE_FLASH_KV
+
+#define FLASH_KV_MAGIC 0x4B56
+#define FLASH_KV_ERASED 0xFFFF
+// key flag of the records of a save that is not closed yet
+#define FLASH_KV_OPEN 0x8000
+// closes a save when the last block was not changed (not a block)
+#define FLASH_KV_COMMIT_KEY 0x7FFE
+#define FLASH_KV_NO_KEY 0xFFFF
+
+static uint8_t flash_kv_bank;
+static uint16_t flash_kv_seq;
+// append offset
+static uint16_t flash_kv_pos;
+// offset after the last closed record
+static uint16_t flash_kv_committed;
+// offset of the latest record of each block (0 if the block was never written and reads 0)
+static uint16_t flash_kv_index[FLASH_KV_KEYS];
+// write back cache of the last accessed block
+static uint16_t flash_kv_cache_key;
+static uint8_t flash_kv_cache[FLASH_KV_BLOCK_SIZE];
+static bool flash_kv_cache_dirty;
+static flash_kv_stats_t flash_kv_stats;
+
+static uint16_t flash_kv_crc(uint16_t crc, uint8_t c)
+{
+	crc ^= c;
+	for (uint8_t i = 8; i != 0; i--)
+	{
+		crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+	}
+	return crc;
+}
+
+// reads a record and returns true if it's complete
+static bool flash_kv_read_record(uint8_t bank, uint16_t offset, uint16_t *key, uint8_t *data)
+{
+	uint16_t k = mcu_flash_kv_read(bank, offset);
+	uint16_t crc = flash_kv_crc(flash_kv_crc(0xFFFF, (uint8_t)k), (uint8_t)(k >> 8));
+	offset += 2;
+	for (uint8_t i = 0; i < FLASH_KV_BLOCK_SIZE; i += 2)
+	{
+		uint16_t value = mcu_flash_kv_read(bank, offset);
+		offset += 2;
+		data[i] = (uint8_t)value;
+		data[i + 1] = (uint8_t)(value >> 8);
+		crc = flash_kv_crc(flash_kv_crc(crc, data[i]), data[i + 1]);
+	}
+
+	*key = k;
+	return ((crc & 0x7FFF) == mcu_flash_kv_read(bank, offset));
+}
+
+static void flash_kv_write_record(uint8_t bank, uint16_t offset, uint16_t key, const uint8_t *data)
+{
+	uint16_t crc = flash_kv_crc(flash_kv_crc(0xFFFF, (uint8_t)key), (uint8_t)(key >> 8));
+	mcu_flash_kv_program(bank, offset, key);
+	offset += 2;
+	for (uint8_t i = 0; i < FLASH_KV_BLOCK_SIZE; i += 2)
+	{
+		crc = flash_kv_crc(flash_kv_crc(crc, data[i]), data[i + 1]);
+		mcu_flash_kv_program(bank, offset, data[i] | ((uint16_t)data[i + 1] << 8));
+		offset += 2;
+	}
+	// the check is the last halfword written
+	mcu_flash_kv_program(bank, offset, crc & 0x7FFF);
+	flash_kv_stats.records++;
+}
+
+static void flash_kv_write_header(uint8_t bank, uint16_t seq)
+{
+	mcu_flash_kv_program(bank, 0, seq);
+	mcu_flash_kv_program(bank, 2, FLASH_KV_MAGIC);
+}
+
+// offset of the last closed record of a block in the active bank (0 if none)
+static uint16_t flash_kv_find_closed(uint16_t key)
+{
+	uint8_t data[FLASH_KV_BLOCK_SIZE];
+	uint16_t found = 0;
+	for (uint16_t offset = FLASH_KV_HEADER_SIZE; offset < flash_kv_committed; offset += FLASH_KV_RECORD_SIZE)
+	{
+		uint16_t k;
+		if (flash_kv_read_record(flash_kv_bank, offset, &k, data) && (k & ~FLASH_KV_OPEN) == key)
+		{
+			found = offset;
+		}
+	}
+	return found;
+}
+
+static bool flash_kv_is_zero(const uint8_t *data)
+{
+	for (uint8_t i = 0; i < FLASH_KV_BLOCK_SIZE; i++)
+	{
+		if (data[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Copies the latest record of each block to the other bank.
+ * The blocks changed by the open save keep both versions (the last closed one and the open one),
+ * so the save is still discarded if the power fails before it's closed
+ * (the bank size check in flash_kv.h ensures there is always room for both versions).
+ * */
+static void flash_kv_compact(void)
+{
+	uint8_t from = flash_kv_bank;
+	uint8_t to = from ^ 1;
+	uint8_t data[FLASH_KV_BLOCK_SIZE];
+	uint8_t open[(FLASH_KV_KEYS + 7) >> 3];
+
+	memset(open, 0, sizeof(open));
+	for (uint16_t key = 0; key < FLASH_KV_KEYS; key++)
+	{
+		if (flash_kv_index[key] >= flash_kv_committed)
+		{
+			open[key >> 3] |= (1 << (key & 7));
+		}
+	}
+
+	mcu_flash_kv_erase(to);
+
+	// closed versions
+	uint16_t pos = FLASH_KV_HEADER_SIZE;
+	for (uint16_t key = 0; key < FLASH_KV_KEYS; key++)
+	{
+		uint16_t offset = flash_kv_index[key];
+		bool is_open = (open[key >> 3] & (1 << (key & 7)));
+		if (is_open)
+		{
+			offset = flash_kv_find_closed(key);
+		}
+		if (!offset)
+		{
+			continue;
+		}
+
+		uint16_t k;
+		flash_kv_read_record(from, offset, &k, data);
+		if (flash_kv_is_zero(data))
+		{
+			// a block that was never written reads 0
+			if (!is_open)
+			{
+				flash_kv_index[key] = 0;
+			}
+			continue;
+		}
+
+		flash_kv_write_record(to, pos, key, data);
+		if (!is_open)
+		{
+			flash_kv_index[key] = pos;
+		}
+		pos += FLASH_KV_RECORD_SIZE;
+	}
+	uint16_t committed = pos;
+
+	// open versions
+	for (uint16_t key = 0; key < FLASH_KV_KEYS; key++)
+	{
+		if (open[key >> 3] & (1 << (key & 7)))
+		{
+			uint16_t k;
+			flash_kv_read_record(from, flash_kv_index[key], &k, data);
+			flash_kv_write_record(to, pos, key | FLASH_KV_OPEN, data);
+			flash_kv_index[key] = pos;
+			pos += FLASH_KV_RECORD_SIZE;
+		}
+	}
+
+	// the new bank is valid after the header is written
+	flash_kv_seq++;
+	if (flash_kv_seq == FLASH_KV_ERASED)
+	{
+		flash_kv_seq = 0;
+	}
+	flash_kv_write_header(to, flash_kv_seq);
+	flash_kv_bank = to;
+	flash_kv_pos = pos;
+	flash_kv_committed = committed;
+	flash_kv_stats.compactions++;
+}
+
+static void flash_kv_append(uint16_t key, const uint8_t *data, bool close)
+{
+	if ((flash_kv_pos + FLASH_KV_RECORD_SIZE) > FLASH_KV_BANK_SIZE)
+	{
+		flash_kv_compact();
+	}
+
+	flash_kv_write_record(flash_kv_bank, flash_kv_pos, (close) ? key : (key | FLASH_KV_OPEN), data);
+	if (key < FLASH_KV_KEYS)
+	{
+		flash_kv_index[key] = flash_kv_pos;
+	}
+	flash_kv_pos += FLASH_KV_RECORD_SIZE;
+	if (close)
+	{
+		flash_kv_committed = flash_kv_pos;
+	}
+}
+
+// scans the bank and returns the offset after the last closed record (the end of the log is stored in flash_kv_pos)
+static uint16_t flash_kv_scan(uint8_t bank)
+{
+	uint8_t data[FLASH_KV_BLOCK_SIZE];
+	uint16_t committed = FLASH_KV_HEADER_SIZE;
+	uint16_t offset = FLASH_KV_HEADER_SIZE;
+	for (; (offset + FLASH_KV_RECORD_SIZE) <= FLASH_KV_BANK_SIZE; offset += FLASH_KV_RECORD_SIZE)
+	{
+		uint16_t key;
+		if (mcu_flash_kv_read(bank, offset) == FLASH_KV_ERASED)
+		{
+			break;
+		}
+		if (flash_kv_read_record(bank, offset, &key, data) && !(key & FLASH_KV_OPEN))
+		{
+			committed = offset + FLASH_KV_RECORD_SIZE;
+		}
+	}
+
+	flash_kv_pos = offset;
+	return committed;
+}
+
+void flash_kv_init(void)
+{
+	uint8_t data[FLASH_KV_BLOCK_SIZE];
+	int8_t bank = -1;
+
+	memset(flash_kv_index, 0, sizeof(flash_kv_index));
+	memset(&flash_kv_stats, 0, sizeof(flash_kv_stats_t));
+	flash_kv_cache_key = FLASH_KV_NO_KEY;
+	flash_kv_cache_dirty = false;
+
+	// the active bank is the valid bank with the highest sequence
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		uint16_t seq = mcu_flash_kv_read(i, 0);
+		if (mcu_flash_kv_read(i, 2) != FLASH_KV_MAGIC || seq == FLASH_KV_ERASED)
+		{
+			continue;
+		}
+		if (bank < 0 || (int16_t)(seq - flash_kv_seq) > 0)
+		{
+			bank = i;
+			flash_kv_seq = seq;
+		}
+	}
+
+	if (bank < 0)
+	{
+		// blank or unknown flash
+		mcu_flash_kv_erase(0);
+		flash_kv_seq = 0;
+		flash_kv_write_header(0, 0);
+		bank = 0;
+	}
+
+	flash_kv_bank = (uint8_t)bank;
+	flash_kv_committed = flash_kv_scan(flash_kv_bank);
+
+	// builds the index from the closed records
+	for (uint16_t offset = FLASH_KV_HEADER_SIZE; offset < flash_kv_committed; offset += FLASH_KV_RECORD_SIZE)
+	{
+		uint16_t key;
+		if (flash_kv_read_record(flash_kv_bank, offset, &key, data))
+		{
+			key &= ~FLASH_KV_OPEN;
+			if (key < FLASH_KV_KEYS)
+			{
+				flash_kv_index[key] = offset;
+			}
+		}
+	}
+
+	if (flash_kv_pos != flash_kv_committed)
+	{
+		// the power failed during a save (the open and torn records are dropped by a compaction)
+		flash_kv_stats.discarded = (flash_kv_pos - flash_kv_committed) / FLASH_KV_RECORD_SIZE;
+		flash_kv_compact();
+	}
+}
+
+uint8_t flash_kv_getc(uint16_t address)
+{
+	if (address >= NVM_STORAGE_SIZE)
+	{
+		return 0;
+	}
+
+	uint16_t key = address / FLASH_KV_BLOCK_SIZE;
+	uint8_t i = address % FLASH_KV_BLOCK_SIZE;
+	if (key == flash_kv_cache_key)
+	{
+		return flash_kv_cache[i];
+	}
+
+	uint16_t offset = flash_kv_index[key];
+	if (!offset)
+	{
+		return 0;
+	}
+
+	uint16_t value = mcu_flash_kv_read(flash_kv_bank, offset + 2 + (i & ~1));
+	return (i & 1) ? (uint8_t)(value >> 8) : (uint8_t)value;
+}
+
+void flash_kv_putc(uint16_t address, uint8_t value)
+{
+	if (address >= NVM_STORAGE_SIZE)
+	{
+		return;
+	}
+
+	uint16_t key = address / FLASH_KV_BLOCK_SIZE;
+	uint8_t i = address % FLASH_KV_BLOCK_SIZE;
+	if (key != flash_kv_cache_key)
+	{
+		if (flash_kv_cache_dirty)
+		{
+			flash_kv_append(flash_kv_cache_key, flash_kv_cache, false);
+			flash_kv_cache_dirty = false;
+		}
+
+		uint16_t k;
+		memset(flash_kv_cache, 0, FLASH_KV_BLOCK_SIZE);
+		if (flash_kv_index[key])
+		{
+			flash_kv_read_record(flash_kv_bank, flash_kv_index[key], &k, flash_kv_cache);
+		}
+		flash_kv_cache_key = key;
+	}
+
+	if (flash_kv_cache[i] != value)
+	{
+		flash_kv_cache[i] = value;
+		flash_kv_cache_dirty = true;
+	}
+}
+
+void flash_kv_flush(void)
+{
+	if (flash_kv_cache_dirty)
+	{
+		flash_kv_append(flash_kv_cache_key, flash_kv_cache, true);
+		flash_kv_cache_dirty = false;
+	}
+	else if (flash_kv_pos != flash_kv_committed)
+	{
+		uint8_t data[FLASH_KV_BLOCK_SIZE];
+		memset(data, 0, FLASH_KV_BLOCK_SIZE);
+		flash_kv_append(FLASH_KV_COMMIT_KEY, data, true);
+	}
+	else
+	{
+		return;
+	}
+
+	flash_kv_stats.commits++;
+}
+
+void flash_kv_get_stats(flash_kv_stats_t *stats)
+{
+	memcpy(stats, &flash_kv_stats, sizeof(flash_kv_stats_t));
+	stats->bank = flash_kv_bank;
+	stats->used = (flash_kv_pos - FLASH_KV_HEADER_SIZE) / FLASH_KV_RECORD_SIZE;
+}
+
+#endif
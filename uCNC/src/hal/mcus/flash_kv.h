@@ -0,0 +1,109 @@
+/*
+	Name: flash_kv.h
+	Description: Wear levelled log structured key/value store for µCNC flash emulated EEPROM.
+		The EEPROM address space is split in blocks of FLASH_KV_BLOCK_SIZE bytes (the keys).
+		Each change of a block is appended as a record to the active flash bank instead of
+		erasing and rewriting the page. When the bank is full the latest record of each block is
+		copied to the other bank (compaction) and the banks swap roles.
+
+		Bank format (halfwords): [sequence][magic] followed by records
+		Record format (halfwords): [key | open flag][data (FLASH_KV_BLOCK_SIZE / 2)][check]
+		- the check (CRC16 of key and data with bit 15 clear) is written last so a torn record is never valid
+		- the open flag (bit 15 of the key) is cleared on the last record of each flush. The records after the
+		  last closed record are discarded at boot so a settings save is either fully written or not at all
+		- the magic of the bank header is written after the compaction, so a torn compaction is ignored
+		  and the bank with the highest sequence is the active one
+
+		A RAM index holds the offset of the latest record of each block, so reads are direct and the boot
+		scan is linear on the number of records.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef FLASH_KV_H
+#define FLASH_KV_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_FLASH_KV
+
+/**
+ * The MCU must define
+ * 	FLASH_KV_BANK_SIZE - the size of each of the two banks (a multiple of the flash page size)
+ * and implement
+ * 	mcu_flash_kv_erase - erases a bank (all halfwords read 0xFFFF)
+ * 	mcu_flash_kv_program - programs an erased halfword of a bank
+ * 	mcu_flash_kv_read - reads a halfword of a bank
+ * The MCU EEPROM functions (mcu_eeprom_getc/putc/flush) call flash_kv_getc/putc/flush
+ * and mcu_init calls flash_kv_init.
+ * */
+#ifndef FLASH_KV_BANK_SIZE
+#error "The MCU does not support the flash key/value store"
+#endif
+
+#ifndef FLASH_KV_BLOCK_SIZE
+#define FLASH_KV_BLOCK_SIZE 8
+#endif
+
+#define FLASH_KV_KEYS ((NVM_STORAGE_SIZE + FLASH_KV_BLOCK_SIZE - 1) / FLASH_KV_BLOCK_SIZE)
+#define FLASH_KV_HEADER_SIZE 4
+#define FLASH_KV_RECORD_SIZE (FLASH_KV_BLOCK_SIZE + 4)
+#define FLASH_KV_RECORDS ((FLASH_KV_BANK_SIZE - FLASH_KV_HEADER_SIZE) / FLASH_KV_RECORD_SIZE)
+
+#if (FLASH_KV_BLOCK_SIZE & 1)
+#error "FLASH_KV_BLOCK_SIZE must be even"
+#endif
+// a compaction keeps the closed and the open version of every block and must still leave room for a new record
+// (a save that changes every block stays power fail safe)
+#if (FLASH_KV_RECORDS < ((2 * FLASH_KV_KEYS) + 1))
+#error "FLASH_KV_BANK_SIZE is too small for NVM_STORAGE_SIZE (increase the bank or the block size)"
+#endif
+#ifdef DISABLE_EEPROM_EMULATION
+#error "ENABLE_FLASH_KV can't be used with DISABLE_EEPROM_EMULATION"
+#endif
+
+	typedef struct flash_kv_stats_
+	{
+		uint32_t records;		 // records appended
+		uint32_t commits;		 // flushes that closed a save
+		uint16_t compactions;
+		uint16_t discarded; // open or torn records found at boot
+		uint8_t bank;
+		uint16_t used; // records in the active bank
+	} flash_kv_stats_t;
+
+	void mcu_flash_kv_erase(uint8_t bank);
+	void mcu_flash_kv_program(uint8_t bank, uint16_t offset, uint16_t value);
+	uint16_t mcu_flash_kv_read(uint8_t bank, uint16_t offset);
+
+	void flash_kv_init(void);
+	uint8_t flash_kv_getc(uint16_t address);
+	void flash_kv_putc(uint16_t address, uint8_t value);
+	// writes the pending block and closes the save (power fail safe commit)
+	void flash_kv_flush(void);
+	void flash_kv_get_stats(flash_kv_stats_t *stats);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -624,7 +624,7 @@ uint8_t mcu_uart_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart_available(void)
+buffer_index_t mcu_uart_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart_rx);
 }
@@ -672,7 +672,7 @@ uint8_t mcu_uart2_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart2_available(void)
+buffer_index_t mcu_uart2_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart2_rx);
 }
@@ -898,7 +898,7 @@ void mcu_usb_flush(void)
 		// bulk sending
 		uint8_t tmp[USB_TX_BUFFER_SIZE + 1];
 		memset(tmp, 0, sizeof(tmp));
-		uint8_t r;
+		buffer_index_t r;
 
 		BUFFER_READ(usb_tx, tmp, USB_TX_BUFFER_SIZE, r);
 		lpc176x_usb_write(tmp, r);
@@ -922,7 +922,7 @@ uint8_t mcu_usb_getc(void)
 	return (uint8_t)c;
 }
 
-uint8_t mcu_usb_available(void)
+buffer_index_t mcu_usb_available(void)
 {
 	return BUFFER_READ_AVAILABLE(usb_rx);
 }
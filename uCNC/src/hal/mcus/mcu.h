@@ -288,6 +288,14 @@ extern "C"
 	 * */
 	float mcu_clocks_to_freq(uint16_t ticks, uint16_t prescaller);
 
+#ifdef MCU_HAS_FIXED_FREQ_TO_CLOCKS
+	/**
+	 * convert step rate/frequency in fixed point (Q24.8 steps/s) to timer ticks and prescaller
+	 * used by the fixed point interpolator (ENABLE_ITP_FIXED_POINT)
+	 * */
+	void mcu_freq_to_clocks_fixed(uint32_t frequency, uint16_t *ticks, uint16_t *prescaller);
+#endif
+
 	/**
 	 * starts the timer interrupt that generates the step pulses for the interpolator
 	 * */
@@ -327,6 +335,16 @@ extern "C"
 	uint32_t mcu_free_micros(void);
 #endif
 
+/**
+ * gets a free running 32-bit cycle counter (used by ENABLE_CYCLE_PROFILER)
+ * MCU_CYCLE_COUNTER_CLOCK is the counter frequency in Hz
+ * if the MCU has no cycle counter the microseconds counter is used
+ * */
+#ifndef mcu_cycle_count
+#define mcu_cycle_count() mcu_micros()
+#define MCU_CYCLE_COUNTER_CLOCK 1000000UL
+#endif
+
 #ifndef mcu_nop
 #define mcu_nop() asm volatile("nop\n\t")
 #endif
@@ -567,6 +585,19 @@ extern "C"
 	void mcu_i2c_config(uint32_t frequency);
 #endif
 
+#endif
+
+	/**
+	 * ring buffer and stream index type
+	 * ENABLE_LARGE_STREAM_BUFFERS uses 16-bit indexes so that the RX/TX buffers can be larger than 255 bytes
+	 *
+	 * MCUs that define MCU_HAS_STREAM_READ also implement mcu_<stream>_read for the USB and UART streams
+	 * that reads up to len chars from the RX buffer stopping after the first end of line char ('\n', '\r' or 0)
+	 * */
+#ifdef ENABLE_LARGE_STREAM_BUFFERS
+	typedef uint16_t buffer_index_t;
+#else
+	typedef uint8_t buffer_index_t;
 #endif
 
 	/**
@@ -576,8 +607,11 @@ extern "C"
 
 #ifdef MCU_HAS_USB
 	uint8_t mcu_usb_getc(void);
-	uint8_t mcu_usb_available(void);
+	buffer_index_t mcu_usb_available(void);
 	void mcu_usb_clear(void);
+#ifdef MCU_HAS_STREAM_READ
+	buffer_index_t mcu_usb_read(uint8_t *buffer, buffer_index_t len);
+#endif
 	void mcu_usb_putc(uint8_t c);
 	void mcu_usb_flush(void);
 #ifdef DETACH_USB_FROM_MAIN_PROTOCOL
@@ -587,8 +621,11 @@ extern "C"
 
 #ifdef MCU_HAS_UART
 	uint8_t mcu_uart_getc(void);
-	uint8_t mcu_uart_available(void);
+	buffer_index_t mcu_uart_available(void);
 	void mcu_uart_clear(void);
+#ifdef MCU_HAS_STREAM_READ
+	buffer_index_t mcu_uart_read(uint8_t *buffer, buffer_index_t len);
+#endif
 	void mcu_uart_putc(uint8_t c);
 	void mcu_uart_flush(void);
 #ifdef DETACH_UART_FROM_MAIN_PROTOCOL
@@ -598,8 +635,11 @@ extern "C"
 
 #ifdef MCU_HAS_UART2
 	uint8_t mcu_uart2_getc(void);
-	uint8_t mcu_uart2_available(void);
+	buffer_index_t mcu_uart2_available(void);
 	void mcu_uart2_clear(void);
+#ifdef MCU_HAS_STREAM_READ
+	buffer_index_t mcu_uart2_read(uint8_t *buffer, buffer_index_t len);
+#endif
 	void mcu_uart2_putc(uint8_t c);
 	void mcu_uart2_flush(void);
 #ifdef DETACH_UART2_FROM_MAIN_PROTOCOL
@@ -609,7 +649,7 @@ extern "C"
 
 #ifdef MCU_HAS_WIFI
 	uint8_t mcu_wifi_getc(void);
-	uint8_t mcu_wifi_available(void);
+	buffer_index_t mcu_wifi_available(void);
 	void mcu_wifi_clear(void);
 	void mcu_wifi_putc(uint8_t c);
 	void mcu_wifi_flush(void);
@@ -620,7 +660,7 @@ extern "C"
 
 #ifdef MCU_HAS_BLUETOOTH
 	uint8_t mcu_bt_getc(void);
-	uint8_t mcu_bt_available(void);
+	buffer_index_t mcu_bt_available(void);
 	void mcu_bt_clear(void);
 	void mcu_bt_putc(uint8_t c);
 	void mcu_bt_flush(void);
@@ -105,7 +105,7 @@ extern "C"
 #endif
 #endif
 
-#if (MCU == MCU_VIRTUAL_WIN)
+#if (MCU == MCU_VIRTUAL_WIN) || (MCU == MCU_VIRTUAL_LINUX)
 #include "virtual/mcumap_virtual.h"
 #endif
 
@@ -118,6 +118,8 @@ extern "C"
 #endif
 
 #include "mcu.h" //exposes the MCU HAL interface
+#include "step_dma.h"
+#include "flash_kv.h"
 
 #ifdef __cplusplus
 }
@@ -38,6 +38,7 @@ extern "C"
 #define MCU_ESP32S3 52
 #define MCU_RP2040 60
 #define MCU_RP2350 61
+#define MCU_VIRTUAL_LINUX 98
 #define MCU_VIRTUAL_WIN 99
 
 #ifdef __cplusplus
@@ -304,7 +304,12 @@ void loop1()
 {
 	for (;;)
 	{
+#ifndef ENABLE_DUAL_CORE_MOTION
 		cnc_run();
+#else
+		// the interpolator starts the step ISR on this core
+		cnc_motion_core_dotasks();
+#endif
 	}
 }
 
@@ -1194,6 +1194,8 @@ extern "C"
 #if (defined(TX2) && defined(RX2))
 #define MCU_HAS_UART2
 #endif
+// mcu_usb_read, mcu_uart_read and mcu_uart2_read
+#define MCU_HAS_STREAM_READ
 #if (defined(USB_DP) && defined(USB_DM))
 #define MCU_HAS_USB
 #endif
@@ -1442,8 +1444,8 @@ extern "C"
 		memset(ptr, 0, buffer.elem_size);                 \
 	}
 #define BUFFER_ENQUEUE(buffer, ptr) queue_try_add((queue_t *)buffer.data, ptr)
-#define BUFFER_WRITE(buffer, ptr, len, written) ({for(uint8_t i = 0; i<len; i++){if(!queue_try_add((queue_t*)buffer.data, &ptr[i])){break;}written++;} })
-#define BUFFER_READ(buffer, ptr, len, read) ({for(uint8_t i = 0; i<len; i++){if(!queue_try_remove((queue_t*)buffer.data, &ptr[i])){break;}read++;} })
+#define BUFFER_WRITE(buffer, ptr, len, written) ({for(buffer_index_t i = 0; i<len; i++){if(!queue_try_add((queue_t*)buffer.data, &ptr[i])){break;}written++;} })
+#define BUFFER_READ(buffer, ptr, len, read) ({for(buffer_index_t i = 0; i<len; i++){if(!queue_try_remove((queue_t*)buffer.data, &ptr[i])){break;}read++;} })
 #define BUFFER_CLEAR(buffer)                        \
 	while (!queue_is_empty((queue_t *)buffer.data))   \
 	{                                                 \
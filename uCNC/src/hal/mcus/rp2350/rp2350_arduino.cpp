@@ -853,7 +853,7 @@ uint8_t mcu_wifi_getc(void)
 	return c;
 }
 
-uint8_t mcu_wifi_available(void)
+buffer_index_t mcu_wifi_available(void)
 {
 	return BUFFER_READ_AVAILABLE(wifi_rx);
 }
@@ -880,7 +880,7 @@ void mcu_wifi_flush(void)
 		{
 			uint8_t tmp[WIFI_TX_BUFFER_SIZE + 1];
 			memset(tmp, 0, sizeof(tmp));
-			uint8_t r;
+			buffer_index_t r;
 
 			BUFFER_READ(wifi_tx, tmp, WIFI_TX_BUFFER_SIZE, r);
 			server_client.write(tmp, r);
@@ -908,7 +908,7 @@ uint8_t mcu_bt_getc(void)
 	return c;
 }
 
-uint8_t mcu_bt_available(void)
+buffer_index_t mcu_bt_available(void)
 {
 	return BUFFER_READ_AVAILABLE(bt_rx);
 }
@@ -933,7 +933,7 @@ void mcu_bt_flush(void)
 	{
 		uint8_t tmp[BLUETOOTH_TX_BUFFER_SIZE + 1];
 		memset(tmp, 0, sizeof(tmp));
-		uint8_t r;
+		buffer_index_t r;
 
 		BUFFER_READ(bt_tx, tmp, BLUETOOTH_TX_BUFFER_SIZE, r);
 		SerialBT.write(tmp, r);
@@ -1097,11 +1097,18 @@ extern "C"
 		return c;
 	}
 
-	uint8_t mcu_usb_available(void)
+	buffer_index_t mcu_usb_available(void)
 	{
 		return BUFFER_READ_AVAILABLE(usb_rx);
 	}
 
+	buffer_index_t mcu_usb_read(uint8_t *buffer, buffer_index_t len)
+	{
+		buffer_index_t read;
+		BUFFER_READ_LINE(usb_rx, buffer, len, read);
+		return read;
+	}
+
 	void mcu_usb_clear(void)
 	{
 		BUFFER_CLEAR(usb_rx);
@@ -1122,7 +1129,7 @@ extern "C"
 		{
 			uint8_t tmp[USB_TX_BUFFER_SIZE + 1];
 			memset(tmp, 0, sizeof(tmp));
-			uint8_t r;
+			buffer_index_t r;
 
 			BUFFER_READ(usb_tx, tmp, USB_TX_BUFFER_SIZE, r);
 			Serial.write(tmp, r);
@@ -1145,11 +1152,18 @@ extern "C"
 		return c;
 	}
 
-	uint8_t mcu_uart_available(void)
+	buffer_index_t mcu_uart_available(void)
 	{
 		return BUFFER_READ_AVAILABLE(uart_rx);
 	}
 
+	buffer_index_t mcu_uart_read(uint8_t *buffer, buffer_index_t len)
+	{
+		buffer_index_t read;
+		BUFFER_READ_LINE(uart_rx, buffer, len, read);
+		return read;
+	}
+
 	void mcu_uart_clear(void)
 	{
 		BUFFER_CLEAR(uart_rx);
@@ -1170,7 +1184,7 @@ extern "C"
 		{
 			uint8_t tmp[UART_TX_BUFFER_SIZE + 1];
 			memset(tmp, 0, sizeof(tmp));
-			uint8_t r = 0;
+			buffer_index_t r = 0;
 
 			BUFFER_READ(uart_tx, tmp, UART_TX_BUFFER_SIZE, r);
 			COM_UART.write(tmp, r);
@@ -1193,11 +1207,18 @@ extern "C"
 		return c;
 	}
 
-	uint8_t mcu_uart2_available(void)
+	buffer_index_t mcu_uart2_available(void)
 	{
 		return BUFFER_READ_AVAILABLE(uart2_rx);
 	}
 
+	buffer_index_t mcu_uart2_read(uint8_t *buffer, buffer_index_t len)
+	{
+		buffer_index_t read;
+		BUFFER_READ_LINE(uart2_rx, buffer, len, read);
+		return read;
+	}
+
 	void mcu_uart2_clear(void)
 	{
 		BUFFER_CLEAR(uart2_rx);
@@ -1218,7 +1239,7 @@ extern "C"
 		{
 			uint8_t tmp[UART2_TX_BUFFER_SIZE + 1];
 			memset(tmp, 0, sizeof(tmp));
-			uint8_t r;
+			buffer_index_t r;
 
 			BUFFER_READ(uart2_tx, tmp, UART2_TX_BUFFER_SIZE, r);
 			COM2_UART.write(tmp, r);
@@ -866,7 +866,7 @@ uint8_t mcu_usb_getc(void)
 	return c;
 }
 
-uint8_t mcu_usb_available(void)
+buffer_index_t mcu_usb_available(void)
 {
 	return BUFFER_READ_AVAILABLE(usb_rx);
 }
@@ -907,7 +907,7 @@ uint8_t mcu_uart_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart_available(void)
+buffer_index_t mcu_uart_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart_rx);
 }
@@ -946,7 +946,7 @@ uint8_t mcu_uart2_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart2_available(void)
+buffer_index_t mcu_uart2_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart2_rx);
 }
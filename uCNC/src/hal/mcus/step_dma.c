@@ -0,0 +1,379 @@
+/*
+	Name: step_dma.c
+	Description: Portable DMA step engine for µCNC.
+		Builds the step/dir port words of the DMA step buffer by running the step ISR callbacks
+		against a virtual step timer from the main loop. See step_dma.h.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#include "../../cnc.h"
+
+#ifdef ENABLE_STEP_DMA
+
+#ifdef IC74HC595_HAS_STEPS
+#error "The DMA step engine requires the step pins to be MCU pins"
+#endif
+#ifdef IC74HC595_HAS_DIRS
+#error "The DMA step engine requires the dir pins to be MCU pins"
+#endif
+
+step_dma_word_t step_dma_buffer[STEP_DMA_PORTS][STEP_DMA_BUFFER_SIZE];
+
+// virtual step timer
+static volatile bool step_dma_running;
+static volatile bool step_dma_start_request;
+static volatile uint32_t step_dma_period;
+static uint32_t step_dma_slot_clocks;
+// clocks from the current slot to the next step timer event
+static int32_t step_dma_wait;
+static bool step_dma_resetstep;
+
+// output levels
+static uint8_t step_dma_steps;
+static uint8_t step_dma_dirs;
+static uint8_t step_dma_dirs_out;
+static bool step_dma_changed;
+static bool step_dma_dirs_pending;
+static bool step_dma_filling;
+
+// buffer state (halves that can be filled, next half to fill and playback state)
+static volatile uint8_t step_dma_free = 3;
+static uint8_t step_dma_fill_half;
+static volatile bool step_dma_active;
+static volatile uint8_t step_dma_generation;
+
+static step_dma_stats_t step_dma_stats;
+#ifdef ENABLE_STEP_TRACE
+static int32_t step_dma_half_position[2][STEPPER_COUNT];
+#endif
+
+#define STEP_DMA_OUTPUT(words, pin, level) words[STEP_DMA_IO_PORT(pin)] |= ((level) ? (1UL << STEP_DMA_IO_BIT(pin)) : (1UL << (STEP_DMA_IO_BIT(pin) + 16)))
+
+// writes the step/dir levels of all steppers
+static void step_dma_write(uint16_t slot, uint8_t steps, uint8_t dirs)
+{
+	step_dma_word_t words[STEP_DMA_PORTS];
+	memset(words, 0, sizeof(words));
+
+#if ASSERT_PIN(STEP0)
+	STEP_DMA_OUTPUT(words, STEP0, steps & STEP0_IO_MASK);
+#endif
+#if ASSERT_PIN(STEP1)
+	STEP_DMA_OUTPUT(words, STEP1, steps & STEP1_IO_MASK);
+#endif
+#if ASSERT_PIN(STEP2)
+	STEP_DMA_OUTPUT(words, STEP2, steps & STEP2_IO_MASK);
+#endif
+#if ASSERT_PIN(STEP3)
+	STEP_DMA_OUTPUT(words, STEP3, steps & STEP3_IO_MASK);
+#endif
+#if ASSERT_PIN(STEP4)
+	STEP_DMA_OUTPUT(words, STEP4, steps & STEP4_IO_MASK);
+#endif
+#if ASSERT_PIN(STEP5)
+	STEP_DMA_OUTPUT(words, STEP5, steps & STEP5_IO_MASK);
+#endif
+#if ASSERT_PIN(STEP6)
+	STEP_DMA_OUTPUT(words, STEP6, steps & STEP6_IO_MASK);
+#endif
+#if ASSERT_PIN(STEP7)
+	STEP_DMA_OUTPUT(words, STEP7, steps & STEP7_IO_MASK);
+#endif
+#if ASSERT_PIN(DIR0)
+	STEP_DMA_OUTPUT(words, DIR0, dirs & STEP0_IO_MASK);
+#endif
+#if ASSERT_PIN(DIR1)
+	STEP_DMA_OUTPUT(words, DIR1, dirs & STEP1_IO_MASK);
+#endif
+#if ASSERT_PIN(DIR2)
+	STEP_DMA_OUTPUT(words, DIR2, dirs & STEP2_IO_MASK);
+#endif
+#if ASSERT_PIN(DIR3)
+	STEP_DMA_OUTPUT(words, DIR3, dirs & STEP3_IO_MASK);
+#endif
+#if ASSERT_PIN(DIR4)
+	STEP_DMA_OUTPUT(words, DIR4, dirs & STEP4_IO_MASK);
+#endif
+#if ASSERT_PIN(DIR5)
+	STEP_DMA_OUTPUT(words, DIR5, dirs & STEP5_IO_MASK);
+#endif
+#if ASSERT_PIN(DIR6)
+	STEP_DMA_OUTPUT(words, DIR6, dirs & STEP6_IO_MASK);
+#endif
+#if ASSERT_PIN(DIR7)
+	STEP_DMA_OUTPUT(words, DIR7, dirs & STEP7_IO_MASK);
+#endif
+
+	for (uint8_t p = 0; p < STEP_DMA_PORTS; p++)
+	{
+		step_dma_buffer[p][slot] = words[p];
+	}
+}
+
+static void step_dma_clear_slot(uint16_t slot)
+{
+	for (uint8_t p = 0; p < STEP_DMA_PORTS; p++)
+	{
+		step_dma_buffer[p][slot] = 0;
+	}
+}
+
+void step_dma_start(uint32_t period)
+{
+	// the timer starts on the next filled slot
+	step_dma_period = period;
+	step_dma_start_request = true;
+}
+
+void step_dma_change(uint32_t period)
+{
+	// like the timer the new period is used from the next event on
+	step_dma_period = period;
+}
+
+void step_dma_stop(void)
+{
+	step_dma_running = false;
+	step_dma_start_request = false;
+}
+
+void step_dma_abort(void)
+{
+	__ATOMIC__
+	{
+		mcu_step_dma_stop();
+		step_dma_active = false;
+		step_dma_running = false;
+		step_dma_start_request = false;
+		step_dma_dirs_pending = false;
+		step_dma_changed = false;
+		step_dma_filling = false;
+		step_dma_free = 3;
+		step_dma_fill_half = 0;
+		// a fill in progress is discarded
+		step_dma_generation++;
+		memset(step_dma_buffer, 0, sizeof(step_dma_buffer));
+	}
+}
+
+bool step_dma_set_steps(uint8_t mask)
+{
+	if (step_dma_steps != mask)
+	{
+		step_dma_steps = mask;
+		step_dma_changed = true;
+	}
+
+	// outside the step callbacks the pins are written directly
+	return step_dma_filling;
+}
+
+bool step_dma_toggle_steps(uint8_t mask)
+{
+	return step_dma_set_steps(step_dma_steps ^ mask);
+}
+
+bool step_dma_set_dirs(uint8_t mask)
+{
+	if (step_dma_dirs != mask)
+	{
+		step_dma_dirs = mask;
+		step_dma_changed = true;
+	}
+
+	if (!step_dma_filling)
+	{
+		step_dma_dirs_out = mask;
+	}
+
+	return step_dma_filling;
+}
+
+// fills one half of the buffer (one step timer event per slot at most)
+static void step_dma_fill_half_buffer(uint8_t half)
+{
+	uint16_t slot = (half) ? STEP_DMA_HALF_SIZE : 0;
+	uint16_t end = slot + STEP_DMA_HALF_SIZE;
+	int32_t slot_clocks = (int32_t)step_dma_slot_clocks;
+	int32_t half_slot = slot_clocks >> 1;
+
+	for (; slot < end; slot++)
+	{
+		if (step_dma_start_request)
+		{
+			step_dma_start_request = false;
+			step_dma_running = true;
+			step_dma_resetstep = false;
+			step_dma_wait = step_dma_period;
+		}
+
+		// the event is output on the nearest slot
+		// a late event (more than one event per slot) slips to the next slot so that no pulse is lost
+		if (step_dma_running && step_dma_wait < half_slot)
+		{
+			step_dma_wait += step_dma_period;
+			if (!step_dma_resetstep)
+			{
+				mcu_step_cb();
+				// the step ISR returns with the global ISR disabled
+				mcu_enable_global_isr();
+			}
+			else
+			{
+				mcu_step_reset_cb();
+			}
+			step_dma_resetstep = !step_dma_resetstep;
+		}
+
+		if (step_dma_running)
+		{
+			step_dma_wait -= slot_clocks;
+		}
+
+		if (step_dma_changed)
+		{
+			step_dma_changed = false;
+			// a dir change that comes with a step change is delayed one slot to keep the dir hold time of the step
+			if (step_dma_dirs != step_dma_dirs_out && !step_dma_dirs_pending)
+			{
+				step_dma_dirs_pending = true;
+				step_dma_write(slot, step_dma_steps, step_dma_dirs_out);
+				continue;
+			}
+		}
+		else if (!step_dma_dirs_pending)
+		{
+			step_dma_clear_slot(slot);
+			continue;
+		}
+
+		step_dma_dirs_pending = false;
+		step_dma_dirs_out = step_dma_dirs;
+		step_dma_write(slot, step_dma_steps, step_dma_dirs_out);
+	}
+}
+
+void step_dma_fill(void)
+{
+	if (step_dma_filling)
+	{
+		return;
+	}
+
+	for (;;)
+	{
+		uint8_t half = step_dma_fill_half;
+		uint16_t margin = 0;
+		bool was_active = false;
+
+		__ATOMIC__
+		{
+			// all queued halves were played (stops playing the zeroed buffer)
+			if (step_dma_active && step_dma_free == 3)
+			{
+				mcu_step_dma_stop();
+				step_dma_active = false;
+				step_dma_fill_half = 0;
+				half = 0;
+			}
+
+			if (step_dma_active)
+			{
+				was_active = true;
+				// slots left to play before this half
+				margin = mcu_step_dma_remaining();
+				if (half)
+				{
+					margin -= STEP_DMA_HALF_SIZE;
+				}
+			}
+		}
+
+		if (!(step_dma_free & (1 << half)) || !(step_dma_running || step_dma_start_request || step_dma_dirs_pending))
+		{
+			return;
+		}
+
+		uint8_t generation = step_dma_generation;
+		step_dma_slot_clocks = STEP_DMA_CLOCK / STEP_DMA_FREQ;
+		step_dma_filling = true;
+		step_dma_fill_half_buffer(half);
+		step_dma_filling = false;
+#ifdef ENABLE_STEP_TRACE
+		itp_get_rt_position(step_dma_half_position[half]);
+#endif
+
+		__ATOMIC__
+		{
+			if (generation == step_dma_generation)
+			{
+				step_dma_free &= ~(1 << half);
+				step_dma_fill_half = half ^ 1;
+				if (!step_dma_active)
+				{
+					step_dma_active = true;
+					mcu_step_dma_start();
+				}
+				else if (was_active)
+				{
+					if (!step_dma_stats.min_margin || margin < step_dma_stats.min_margin)
+					{
+						step_dma_stats.min_margin = margin;
+					}
+				}
+			}
+		}
+	}
+}
+
+MCU_CALLBACK void step_dma_half_done(uint8_t half)
+{
+	uint16_t slot = (half) ? STEP_DMA_HALF_SIZE : 0;
+	// a half that is not refilled in time plays as idle
+	for (uint8_t p = 0; p < STEP_DMA_PORTS; p++)
+	{
+		memset(&step_dma_buffer[p][slot], 0, STEP_DMA_HALF_SIZE * sizeof(step_dma_word_t));
+	}
+
+	step_dma_stats.halves++;
+	step_dma_free |= (1 << half);
+
+	// the next half was not filled while the steps are still running
+	if ((step_dma_free & (1 << (half ^ 1))) && (step_dma_running || step_dma_filling))
+	{
+		step_dma_stats.underruns++;
+		// the steps already computed were not output (position is lost)
+		cnc_alarm(EXEC_ALARM_STEP_BUFFER_UNDERRUN);
+	}
+}
+
+void step_dma_get_stats(step_dma_stats_t *stats)
+{
+	__ATOMIC__
+	{
+		memcpy(stats, &step_dma_stats, sizeof(step_dma_stats_t));
+	}
+}
+
+#ifdef ENABLE_STEP_TRACE
+bool step_dma_get_half_position(uint8_t half, int32_t *position)
+{
+	memcpy(position, step_dma_half_position[half], sizeof(step_dma_half_position[half]));
+	// the half was filled and not yet released
+	return !(step_dma_free & (1 << half));
+}
+#endif
+
+#endif
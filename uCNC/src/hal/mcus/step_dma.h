@@ -0,0 +1,124 @@
+/*
+	Name: step_dma.h
+	Description: Portable DMA step engine for µCNC.
+		Instead of running the step ISR on every step timer event, the step ISR callbacks
+		(mcu_step_cb/mcu_step_reset_cb) are executed from the main loop against a virtual step timer
+		and their step/dir outputs are written as port set/reset words into a double buffer.
+		The MCU plays the buffer out to the GPIO set/reset register via a DMA channel paced by
+		a fixed rate timer (one word per slot) and signals when each half of the buffer was played.
+
+		Word format (one per slot and port): bits 0-15 set the port pins, bits 16-31 reset the port pins
+		(like the STM32 BSRR). A slot without output changes holds 0.
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef STEP_DMA_H
+#define STEP_DMA_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ENABLE_STEP_DMA
+
+/**
+ * The MCU must define
+ * 	STEP_DMA_CLOCK - the clock of the step timer periods passed to step_dma_start/step_dma_change
+ * 	STEP_DMA_IO_PORT(pin) - the port (buffer) index of a step/dir pin
+ * 	STEP_DMA_IO_BIT(pin) - the bit of a step/dir pin in the port
+ * and optionally STEP_DMA_PORTS (the number of ports with step/dir pins, default 1)
+ * */
+#ifndef STEP_DMA_PORTS
+#define STEP_DMA_PORTS 1
+#endif
+
+// slot rate (each slot outputs one word per port)
+#ifndef STEP_DMA_FREQ
+#define STEP_DMA_FREQ 250000UL
+#endif
+
+// slots in the buffer (two halves)
+#ifndef STEP_DMA_BUFFER_SIZE
+#define STEP_DMA_BUFFER_SIZE 512
+#endif
+
+#define STEP_DMA_HALF_SIZE (STEP_DMA_BUFFER_SIZE >> 1)
+
+// the step callbacks run from the main loop and must not be preempted by the interpolator
+#ifdef ENABLE_ITP_FEED_TASK
+#error "The DMA step engine can't be used with ENABLE_ITP_FEED_TASK"
+#endif
+
+// the step and the reset events take one slot each
+#if (F_STEP_MAX > (STEP_DMA_FREQ >> 1))
+#error "F_STEP_MAX must not exceed half of STEP_DMA_FREQ"
+#endif
+
+	typedef uint32_t step_dma_word_t;
+
+	extern step_dma_word_t step_dma_buffer[STEP_DMA_PORTS][STEP_DMA_BUFFER_SIZE];
+
+	// step timer emulation (called by mcu_start_itp_isr, mcu_change_itp_isr and mcu_stop_itp_isr)
+	void step_dma_start(uint32_t period);
+	void step_dma_change(uint32_t period);
+	void step_dma_stop(void);
+	// stops the output immediately and discards all the steps not played yet
+	void step_dma_abort(void);
+
+	// step/dir outputs (called by io_control)
+	// returns true if the output was buffered (called from the step callbacks) or false if the pins must be written directly
+	bool step_dma_set_steps(uint8_t mask);
+	bool step_dma_toggle_steps(uint8_t mask);
+	bool step_dma_set_dirs(uint8_t mask);
+
+	// refills the free halves of the buffer (main loop)
+	void step_dma_fill(void);
+	// the MCU signals that a half of the buffer was played (DMA half/full transfer ISR)
+	MCU_CALLBACK void step_dma_half_done(uint8_t half);
+
+	// implemented by the MCU
+	// starts the DMA playback from the start of the buffer (circular)
+	void mcu_step_dma_start(void);
+	// stops the DMA playback
+	void mcu_step_dma_stop(void);
+	// slots left to play until the end of the buffer
+	uint16_t mcu_step_dma_remaining(void);
+
+	typedef struct step_dma_stats_
+	{
+		uint32_t halves;
+		uint32_t underruns;
+		// smallest number of slots still queued when a half was refilled
+		uint16_t min_margin;
+	} step_dma_stats_t;
+
+	void step_dma_get_stats(step_dma_stats_t *stats);
+
+#ifdef ENABLE_STEP_TRACE
+	// step position after the last slot of a half (returns false if the half was not filled)
+	bool step_dma_get_half_position(uint8_t half, int32_t *position);
+#endif
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -501,7 +501,7 @@ uint8_t mcu_usb_getc(void)
 	return c;
 }
 
-uint8_t mcu_usb_available(void)
+buffer_index_t mcu_usb_available(void)
 {
 	return BUFFER_READ_AVAILABLE(usb_rx);
 }
@@ -542,7 +542,7 @@ uint8_t mcu_uart_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart_available(void)
+buffer_index_t mcu_uart_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart_rx);
 }
@@ -583,7 +583,7 @@ uint8_t mcu_uart2_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart2_available(void)
+buffer_index_t mcu_uart2_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart2_rx);
 }
@@ -64,9 +64,16 @@
 
 #define READ_FLASH(ram_ptr, flash_ptr) (*ram_ptr = ~(*flash_ptr))
 #define WRITE_FLASH(flash_ptr, ram_ptr) (*flash_ptr = ~(*ram_ptr))
+#ifndef ENABLE_FLASH_KV
 static uint8_t stm32_flash_page[FLASH_PAGE_SIZE];
 static uint16_t stm32_flash_current_page;
 static bool stm32_flash_modified;
+#else
+#define FLASH_KV_BASE (FLASH_LIMIT + 1 - (FLASH_KV_BANK_SIZE << 1))
+#if (FLASH_KV_BANK_SIZE % FLASH_PAGE_SIZE)
+#error "FLASH_KV_BANK_SIZE must be a multiple of FLASH_PAGE_SIZE"
+#endif
+#endif
 
 /**
  * The internal clock counter
@@ -271,6 +278,7 @@ void MCU_SERVO_ISR(void)
 
 #endif
 
+#ifndef ENABLE_STEP_DMA
 void MCU_ITP_ISR(void)
 {
 	mcu_disable_global_isr();
@@ -288,6 +296,26 @@ void MCU_ITP_ISR(void)
 
 	mcu_enable_global_isr();
 }
+#else
+// DMA step engine half/full transfer
+void STEP_DMA_ISR(void)
+{
+	mcu_disable_global_isr();
+
+	uint32_t flags = DMA1->ISR >> STEP_DMA_IFR_POS;
+	DMA1->IFCR = STEP_DMA_IFCR_MASK;
+	if (flags & DMA_ISR_HTIF1)
+	{
+		step_dma_half_done(0);
+	}
+	if (flags & DMA_ISR_TCIF1)
+	{
+		step_dma_half_done(1);
+	}
+
+	mcu_enable_global_isr();
+}
+#endif
 
 #define LIMITS_EXTIBITMASK (LIMIT_X_EXTIBITMASK | LIMIT_Y_EXTIBITMASK | LIMIT_Z_EXTIBITMASK | LIMIT_X2_EXTIBITMASK | LIMIT_Y2_EXTIBITMASK | LIMIT_Z2_EXTIBITMASK | LIMIT_A_EXTIBITMASK | LIMIT_B_EXTIBITMASK | LIMIT_C_EXTIBITMASK)
 #define CONTROLS_EXTIBITMASK (ESTOP_EXTIBITMASK | SAFETY_DOOR_EXTIBITMASK | FHOLD_EXTIBITMASK | CS_RES_EXTIBITMASK)
@@ -567,11 +595,18 @@ uint8_t mcu_usb_getc(void)
 	return c;
 }
 
-uint8_t mcu_usb_available(void)
+buffer_index_t mcu_usb_available(void)
 {
 	return BUFFER_READ_AVAILABLE(usb_rx);
 }
 
+buffer_index_t mcu_usb_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(usb_rx, buffer, len, read);
+	return read;
+}
+
 void mcu_usb_clear(void)
 {
 	BUFFER_CLEAR(usb_rx);
@@ -609,11 +644,18 @@ uint8_t mcu_uart_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart_available(void)
+buffer_index_t mcu_uart_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart_rx);
 }
 
+buffer_index_t mcu_uart_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(uart_rx, buffer, len, read);
+	return read;
+}
+
 void mcu_uart_clear(void)
 {
 	BUFFER_CLEAR(uart_rx);
@@ -651,11 +693,18 @@ uint8_t mcu_uart2_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart2_available(void)
+buffer_index_t mcu_uart2_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart2_rx);
 }
 
+buffer_index_t mcu_uart2_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(uart2_rx, buffer, len, read);
+	return read;
+}
+
 void mcu_uart2_clear(void)
 {
 	BUFFER_CLEAR(uart2_rx);
@@ -686,7 +735,9 @@ void mcu_uart2_flush(void)
 void mcu_init(void)
 {
 	mcu_clocks_init();
+#ifndef ENABLE_FLASH_KV
 	stm32_flash_current_page = -1;
+#endif
 	stm32_global_isr_enabled = false;
 	mcu_io_init();
 	mcu_usart_init();
@@ -758,6 +809,10 @@ void mcu_init(void)
 
 	mcu_disable_probe_isr();
 	mcu_enable_global_isr();
+#ifdef ENABLE_FLASH_KV
+	// builds the index (and recovers from a power fail during a save)
+	flash_kv_init();
+#endif
 }
 
 /**
@@ -835,11 +890,112 @@ void mcu_freq_to_clocks(float frequency, uint16_t *ticks, uint16_t *prescaller)
 	*ticks = (uint16_t)totalticks;
 }
 
+// same with the step rate in fixed point Q24.8 (no float math)
+void mcu_freq_to_clocks_fixed(uint32_t frequency, uint16_t *ticks, uint16_t *prescaller)
+{
+	frequency = CLAMP(((uint32_t)F_STEP_MIN << 8), frequency, ((uint32_t)F_STEP_MAX << 8));
+	// the rate is truncated to 1/16 steps/s so that the scaled clock (up to 72MHz) fits 32bit
+	uint32_t totalticks = ((uint32_t)(ITP_TIMER_CLOCK >> 1) << 4) / (frequency >> 4);
+
+	*prescaller = 1;
+	while (totalticks > 0xFFFF)
+	{
+		*prescaller <<= 1;
+		totalticks >>= 1;
+	}
+
+	(*prescaller) -= 1;
+	*ticks = (uint16_t)totalticks;
+}
+
 float mcu_clocks_to_freq(uint16_t ticks, uint16_t prescaller)
 {
 	return ((float)ITP_TIMER_CLOCK / (float)(((uint32_t)ticks) << (prescaller + 1)));
 }
 
+#ifdef ENABLE_STEP_DMA
+// the step timer is emulated by the DMA step engine (the period is in timer clocks)
+void mcu_start_itp_isr(uint16_t ticks, uint16_t prescaller)
+{
+	step_dma_start((uint32_t)ticks * (prescaller + 1));
+}
+
+void mcu_change_itp_isr(uint16_t ticks, uint16_t prescaller)
+{
+	step_dma_change((uint32_t)ticks * (prescaller + 1));
+}
+
+void mcu_stop_itp_isr(void)
+{
+	step_dma_stop();
+}
+
+static void mcu_step_dma_channel(DMA_Channel_TypeDef *channel, GPIO_TypeDef *port, step_dma_word_t *buffer)
+{
+	channel->CCR = 0;
+	channel->CPAR = (uint32_t)&port->BSRR;
+	channel->CMAR = (uint32_t)buffer;
+	channel->CNDTR = STEP_DMA_BUFFER_SIZE;
+	// very high priority, 32bit memory and peripheral, memory increment, circular, memory to peripheral
+	channel->CCR = DMA_CCR_PL | DMA_CCR_MSIZE_1 | DMA_CCR_PSIZE_1 | DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_DIR;
+}
+
+void mcu_step_dma_start(void)
+{
+	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+	RCC->ITP_TIMER_ENREG |= ITP_TIMER_APB;
+	ITP_TIMER_REG->CR1 = 0;
+	ITP_TIMER_REG->DIER = 0;
+	ITP_TIMER_REG->PSC = 0;
+	ITP_TIMER_REG->ARR = (STEP_DMA_CLOCK / STEP_DMA_FREQ) - 1;
+	ITP_TIMER_REG->CNT = 0;
+	ITP_TIMER_REG->CCER = 0;
+	ITP_TIMER_REG->CCMR1 = 0;
+	ITP_TIMER_REG->CCMR2 = 0;
+	ITP_TIMER_REG->CCR1 = 0;
+	ITP_TIMER_REG->EGR |= 0x01;
+	ITP_TIMER_REG->SR = 0;
+
+	mcu_step_dma_channel(STEP_DMA_CHANNEL0, STEP_DMA_GPIO0, step_dma_buffer[0]);
+	// the half and full transfer of the first port signal the played halves
+	STEP_DMA_CHANNEL0->CCR |= DMA_CCR_HTIE | DMA_CCR_TCIE;
+	DMA1->IFCR = STEP_DMA_IFCR_MASK;
+	STEP_DMA_CHANNEL0->CCR |= DMA_CCR_EN;
+#ifdef STEP_DMA_PORT1
+	mcu_step_dma_channel(STEP_DMA_CHANNEL1, STEP_DMA_GPIO1, step_dma_buffer[1]);
+	STEP_DMA_CHANNEL1->CCR |= DMA_CCR_EN;
+#endif
+
+	NVIC_SetPriority(STEP_DMA_IRQ, 1);
+	NVIC_ClearPendingIRQ(STEP_DMA_IRQ);
+	NVIC_EnableIRQ(STEP_DMA_IRQ);
+
+#ifdef STEP_DMA_PORT1
+	ITP_TIMER_REG->DIER = TIM_DIER_UDE | TIM_DIER_CC1DE;
+#else
+	ITP_TIMER_REG->DIER = TIM_DIER_UDE;
+#endif
+	ITP_TIMER_REG->CR1 |= 1; // enable timer upcounter no preload
+}
+
+void mcu_step_dma_stop(void)
+{
+	ITP_TIMER_REG->CR1 &= ~0x1;
+	ITP_TIMER_REG->DIER = 0;
+	STEP_DMA_CHANNEL0->CCR &= ~DMA_CCR_EN;
+#ifdef STEP_DMA_PORT1
+	STEP_DMA_CHANNEL1->CCR &= ~DMA_CCR_EN;
+#endif
+	NVIC_DisableIRQ(STEP_DMA_IRQ);
+	DMA1->IFCR = STEP_DMA_IFCR_MASK;
+	NVIC_ClearPendingIRQ(STEP_DMA_IRQ);
+}
+
+uint16_t mcu_step_dma_remaining(void)
+{
+	return (uint16_t)STEP_DMA_CHANNEL0->CNDTR;
+}
+#else
 // starts a constant rate pulse at a given frequency.
 void mcu_start_itp_isr(uint16_t ticks, uint16_t prescaller)
 {
@@ -882,6 +1038,7 @@ void mcu_stop_itp_isr(void)
 	ITP_TIMER_REG->SR &= ~0x01;
 	NVIC_DisableIRQ(MCU_ITP_IRQ);
 }
+#endif
 
 // Custom delay function
 // gets the mcu running time in ms
@@ -906,6 +1063,9 @@ void mcu_rtc_init()
 
 void mcu_dotasks()
 {
+#ifdef ENABLE_STEP_DMA
+	step_dma_fill();
+#endif
 #ifdef MCU_HAS_USB
 	tusb_cdc_task(); // tinyusb device task
 
@@ -929,6 +1089,7 @@ void mcu_dotasks()
 #endif
 }
 
+#ifndef ENABLE_FLASH_KV
 // checks if the current page is loaded to ram
 // if not loads it
 static uint16_t mcu_access_flash_page(uint16_t address)
@@ -1048,6 +1209,77 @@ void mcu_eeprom_flush()
 	}
 #endif
 }
+#else
+static void stm32_flash_unlock(void)
+{
+	while (FLASH->SR & FLASH_SR_BSY)
+		; // wait while busy
+	// unlock flash if locked
+	if (FLASH->CR & FLASH_CR_LOCK)
+	{
+		FLASH->KEYR = 0x45670123;
+		FLASH->KEYR = 0xCDEF89AB;
+	}
+}
+
+// the first page (with the bank header) is erased first
+void mcu_flash_kv_erase(uint8_t bank)
+{
+	uint32_t address = FLASH_KV_BASE + ((uint32_t)bank * FLASH_KV_BANK_SIZE);
+	for (uint16_t i = 0; i < (FLASH_KV_BANK_SIZE / FLASH_PAGE_SIZE); i++)
+	{
+		stm32_flash_unlock();
+		FLASH->CR = 0;						 // Ensure PG bit is low
+		FLASH->CR |= FLASH_CR_PER; // set the PER bit
+		FLASH->AR = address;
+		FLASH->CR |= FLASH_CR_STRT; // set the start bit
+		while (FLASH->SR & FLASH_SR_BSY)
+			; // wait while busy
+		FLASH->CR = 0;
+		address += FLASH_PAGE_SIZE;
+	}
+}
+
+void mcu_flash_kv_program(uint8_t bank, uint16_t offset, uint16_t value)
+{
+	volatile uint16_t *ptr = (volatile uint16_t *)(FLASH_KV_BASE + ((uint32_t)bank * FLASH_KV_BANK_SIZE) + offset);
+	stm32_flash_unlock();
+	mcu_disable_global_isr();
+	FLASH->CR = 0;
+	FLASH->CR |= FLASH_CR_PG; // Ensure PG bit is high
+	*ptr = value;
+	while (FLASH->SR & FLASH_SR_BSY)
+		; // wait while busy
+	mcu_enable_global_isr();
+	if (FLASH->SR & FLASH_SR_PGERR)
+		proto_error(42); // STATUS_SETTING_WRITE_FAIL
+	if (FLASH->SR & FLASH_SR_WRPRTERR)
+		proto_error(43); // STATUS_SETTING_PROTECTED_FAIL
+	FLASH->CR = 0;		 // Ensure PG bit is low
+	FLASH->SR = 0;
+}
+
+uint16_t mcu_flash_kv_read(uint8_t bank, uint16_t offset)
+{
+	return *((volatile uint16_t *)(FLASH_KV_BASE + ((uint32_t)bank * FLASH_KV_BANK_SIZE) + offset));
+}
+
+// Non volatile memory
+uint8_t mcu_eeprom_getc(uint16_t address)
+{
+	return flash_kv_getc(address);
+}
+
+void mcu_eeprom_putc(uint16_t address, uint8_t value)
+{
+	flash_kv_putc(address, value);
+}
+
+void mcu_eeprom_flush()
+{
+	flash_kv_flush();
+}
+#endif
 
 typedef enum spi_port_state_enum
 {
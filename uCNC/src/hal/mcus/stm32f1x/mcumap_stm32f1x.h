@@ -58,6 +58,10 @@ extern "C"
 #define rom_memcpy memcpy
 #define rom_read_byte *
 
+// DWT cycle counter (enabled in mcu_init)
+#define mcu_cycle_count() (DWT->CYCCNT)
+#define MCU_CYCLE_COUNTER_CLOCK F_CPU
+
 // custom cycle counter
 // #ifndef MCU_CLOCKS_PER_CYCLE
 // #define MCU_CLOCKS_PER_CYCLE 1
@@ -3774,6 +3778,8 @@ extern "C"
 #if (defined(TX2) && defined(RX2))
 #define MCU_HAS_UART2
 #endif
+// mcu_usb_read, mcu_uart_read and mcu_uart2_read
+#define MCU_HAS_STREAM_READ
 #if (defined(USB_DP) && defined(USB_DM))
 #define MCU_HAS_USB
 	extern uint32_t tud_cdc_n_write_available(uint8_t itf);
@@ -5420,6 +5426,81 @@ extern "C"
 #define ITP_TIMER_CLOCK HAL_RCC_GetPCLK1Freq()
 #endif
 
+#ifdef ENABLE_STEP_DMA
+// DMA step engine (see step_dma.h)
+// the ITP timer runs at the slot rate and its update DMA request writes the step buffer of the first port to the port BSRR
+// if the step/dir pins are split over two ports (STEP_DMA_PORT1) the CC1 DMA request of the same timer writes the second port
+#if (ITP_TIMER == 1)
+#define STEP_DMA_UP_CHANNEL_NUM 5
+#define STEP_DMA_CC1_CHANNEL_NUM 2
+#elif (ITP_TIMER == 2)
+#define STEP_DMA_UP_CHANNEL_NUM 2
+#define STEP_DMA_CC1_CHANNEL_NUM 5
+#elif (ITP_TIMER == 3)
+#define STEP_DMA_UP_CHANNEL_NUM 3
+#define STEP_DMA_CC1_CHANNEL_NUM 6
+#elif (ITP_TIMER == 4)
+#define STEP_DMA_UP_CHANNEL_NUM 7
+#define STEP_DMA_CC1_CHANNEL_NUM 1
+#else
+#error "The DMA step engine requires ITP_TIMER 1 to 4"
+#endif
+
+#if (defined(MCU_HAS_SPI) && (SPI_DMA_CONTROLLER_NUM == 1))
+#if (SPI_DMA_TX_CHANNEL_NUM == STEP_DMA_UP_CHANNEL_NUM || SPI_DMA_RX_CHANNEL_NUM == STEP_DMA_UP_CHANNEL_NUM)
+#error "The DMA step engine channel is used by the SPI DMA"
+#endif
+#if (defined(STEP_DMA_PORT1) && (SPI_DMA_TX_CHANNEL_NUM == STEP_DMA_CC1_CHANNEL_NUM || SPI_DMA_RX_CHANNEL_NUM == STEP_DMA_CC1_CHANNEL_NUM))
+#error "The DMA step engine second port channel is used by the SPI DMA"
+#endif
+#endif
+#if (defined(MCU_HAS_SPI2) && (SPI2_DMA_CONTROLLER_NUM == 1))
+#if (SPI2_DMA_TX_CHANNEL_NUM == STEP_DMA_UP_CHANNEL_NUM || SPI2_DMA_RX_CHANNEL_NUM == STEP_DMA_UP_CHANNEL_NUM)
+#error "The DMA step engine channel is used by the SPI2 DMA"
+#endif
+#if (defined(STEP_DMA_PORT1) && (SPI2_DMA_TX_CHANNEL_NUM == STEP_DMA_CC1_CHANNEL_NUM || SPI2_DMA_RX_CHANNEL_NUM == STEP_DMA_CC1_CHANNEL_NUM))
+#error "The DMA step engine second port channel is used by the SPI2 DMA"
+#endif
+#endif
+
+#define STEP_DMA_CHANNEL0 __helper__(DMA1_Channel, STEP_DMA_UP_CHANNEL_NUM, )
+#define STEP_DMA_CHANNEL1 __helper__(DMA1_Channel, STEP_DMA_CC1_CHANNEL_NUM, )
+#define STEP_DMA_IFR_POS (4 * (STEP_DMA_UP_CHANNEL_NUM - 1))
+#define STEP_DMA_IFCR_MASK (0b1111 << STEP_DMA_IFR_POS)
+#define STEP_DMA_IRQ __helper__(DMA1_Channel, STEP_DMA_UP_CHANNEL_NUM, _IRQn)
+#define STEP_DMA_ISR __helper__(DMA1_Channel, STEP_DMA_UP_CHANNEL_NUM, _IRQHandler)
+
+#ifndef STEP_DMA_PORT0
+#define STEP_DMA_PORT0 STEP0_PORT
+#endif
+#define STEP_DMA_GPIO0 (__gpio__(STEP_DMA_PORT0))
+#ifdef STEP_DMA_PORT1
+#define STEP_DMA_PORTS 2
+#define STEP_DMA_GPIO1 (__gpio__(STEP_DMA_PORT1))
+#define STEP_DMA_IO_PORT(pin) ((__indirect__(pin, GPIO) == STEP_DMA_GPIO0) ? 0 : 1)
+#else
+// all step/dir pins must be on STEP_DMA_PORT0
+#define STEP_DMA_IO_PORT(pin) 0
+#endif
+#define STEP_DMA_IO_BIT(pin) __indirect__(pin, BIT)
+// timer kernel clock (twice the APB clock if the APB is divided)
+#if (ITP_TIMER == 1)
+#define STEP_DMA_CLOCK ((RCC->CFGR & RCC_CFGR_PPRE2_2) ? (HAL_RCC_GetPCLK2Freq() << 1) : HAL_RCC_GetPCLK2Freq())
+#else
+#define STEP_DMA_CLOCK ((RCC->CFGR & RCC_CFGR_PPRE1_2) ? (HAL_RCC_GetPCLK1Freq() << 1) : HAL_RCC_GetPCLK1Freq())
+#endif
+#endif
+
+#ifdef ENABLE_FLASH_KV
+// flash key/value store (see flash_kv.h) on the last 2 banks of the flash (4KB each, 4 pages on the low and medium density devices)
+#ifndef FLASH_KV_BANK_SIZE
+#define FLASH_KV_BANK_SIZE 4096
+#endif
+#endif
+
+// integer step rate to timer conversion (ENABLE_ITP_FIXED_POINT)
+#define MCU_HAS_FIXED_FREQ_TO_CLOCKS
+
 #ifndef SERVO_TIMER
 #define SERVO_TIMER 3
 #endif
@@ -603,11 +603,18 @@ uint8_t mcu_usb_getc(void)
 	return c;
 }
 
-uint8_t mcu_usb_available(void)
+buffer_index_t mcu_usb_available(void)
 {
 	return BUFFER_READ_AVAILABLE(usb_rx);
 }
 
+buffer_index_t mcu_usb_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(usb_rx, buffer, len, read);
+	return read;
+}
+
 void mcu_usb_clear(void)
 {
 	BUFFER_CLEAR(usb_rx);
@@ -644,11 +651,18 @@ uint8_t mcu_uart_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart_available(void)
+buffer_index_t mcu_uart_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart_rx);
 }
 
+buffer_index_t mcu_uart_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(uart_rx, buffer, len, read);
+	return read;
+}
+
 void mcu_uart_clear(void)
 {
 	BUFFER_CLEAR(uart_rx);
@@ -685,11 +699,18 @@ uint8_t mcu_uart2_getc(void)
 	return c;
 }
 
-uint8_t mcu_uart2_available(void)
+buffer_index_t mcu_uart2_available(void)
 {
 	return BUFFER_READ_AVAILABLE(uart2_rx);
 }
 
+buffer_index_t mcu_uart2_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(uart2_rx, buffer, len, read);
+	return read;
+}
+
 void mcu_uart2_clear(void)
 {
 	BUFFER_CLEAR(uart2_rx);
@@ -2175,6 +2175,8 @@ extern "C"
 #if (defined(TX2) && defined(RX2))
 #define MCU_HAS_UART2
 #endif
+// mcu_usb_read, mcu_uart_read and mcu_uart2_read
+#define MCU_HAS_STREAM_READ
 #if (defined(USB_DP) && defined(USB_DM))
 #define GPIO_OTG_AF 0x0A
 #define MCU_HAS_USB
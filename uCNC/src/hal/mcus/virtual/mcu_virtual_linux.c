@@ -0,0 +1,2049 @@
+/*
+	Name: mcu_virtual_linux.c
+	Description: Implements the µCNC HAL for a virtual MCU running on a Linux/POSIX host.
+		The step (ITP) timer, the RTC tick and the oneshot timer are emulated by a single threaded
+		event scheduler driven from mcu_dotasks. Two time bases are available:
+			- realtime (default): virtual time follows the host monotonic clock
+			- simulated (--sim): each mcu_dotasks call advances virtual time by one RTC tick (1ms)
+			  and fires all timer events within it, running the core as fast as the CPU allows
+		The UART is mapped to stdin/stdout or to a pseudo terminal (--pty) and the EEPROM is backed by a file.
+		The step/dir outputs can be recorded to a binary trace file (--trace) with the timer tick timestamps.
+		A host directory can be mounted as drive C of the file system module (--fs).
+		An edge of a generic input can be scheduled at a given time (--din-edge) and fires the input change ISR.
+		With ENABLE_DUAL_CORE_MOTION the motion core is emulated by a second thread that runs the interpolator
+		and fires the step timer events (each thread has its own time and interrupt state).
+
+	Copyright: Copyright (c) João Martins
+	Author: João Martins
+	Date: 17/10/2026
+
+	µCNC is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version. Please see <http://www.gnu.org/licenses/>
+
+	µCNC is distributed WITHOUT ANY WARRANTY;
+	Also without the implied warranty of	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the	GNU General Public License for more details.
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "../../../cnc.h"
+
+#if (MCU == MCU_VIRTUAL_LINUX)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "../../../modules/file_system.h"
+#ifdef ENABLE_DUAL_CORE_MOTION
+#include <pthread.h>
+#include <sched.h>
+#endif
+#ifdef ENABLE_MODBUS_ASYNC
+#include "../../../modules/modbus.h"
+#endif
+
+#ifndef VIRTUAL_EEPROM_FILE
+#define VIRTUAL_EEPROM_FILE "virtualeeprom"
+#endif
+
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 64
+#endif
+
+#define VIRTUAL_TICKS_PER_US (VIRTUAL_TIMER_CLOCK / 1000000UL)
+#define VIRTUAL_TICKS_PER_MS (VIRTUAL_TIMER_CLOCK / 1000UL)
+
+/**
+ * Virtual machine options
+ * */
+static bool virtual_simulated_time;
+static bool virtual_use_pty;
+static const char *virtual_eeprom_file = VIRTUAL_EEPROM_FILE;
+static int virtual_uart_in = STDIN_FILENO;
+static int virtual_uart_out = STDOUT_FILENO;
+static bool virtual_uart_eof;
+static const char *virtual_trace_file;
+static const char *virtual_switches_arg;
+// pin change ISR of the simulated limit switches (runs after the step ISR that moved a switch)
+static void virtual_switches_isr(void);
+static const char *virtual_din_edge_arg;
+// toggles the scheduled input and runs the input change ISR
+static void virtual_din_edge_isr(void);
+
+// state of each emulated core (one thread per core)
+#ifdef ENABLE_DUAL_CORE_MOTION
+#define VIRTUAL_CORE_LOCAL __thread
+#else
+#define VIRTUAL_CORE_LOCAL
+#endif
+
+/**
+ * Global interrupt emulation
+ * All ISR are emulated from the core thread so this just tracks the state
+ * and prevents the timers from firing inside an atomic section or inside another ISR
+ * */
+static VIRTUAL_CORE_LOCAL volatile bool virtual_global_isr_enabled;
+static VIRTUAL_CORE_LOCAL bool virtual_isr_running;
+
+void mcu_enable_global_isr(void)
+{
+	virtual_global_isr_enabled = true;
+}
+
+void mcu_disable_global_isr(void)
+{
+	virtual_global_isr_enabled = false;
+}
+
+bool mcu_get_global_isr(void)
+{
+	return virtual_global_isr_enabled;
+}
+
+/**
+ * Timers emulation
+ * All times are in VIRTUAL_TIMER_CLOCK ticks
+ * */
+static VIRTUAL_CORE_LOCAL uint64_t virtual_ticks;
+static uint64_t virtual_wall_start;
+static uint64_t virtual_rtc_next;
+static volatile uint32_t virtual_millis;
+static volatile bool virtual_itp_running;
+static bool virtual_itp_resetstep;
+static volatile uint64_t virtual_itp_period;
+static uint64_t virtual_itp_next;
+static bool virtual_timeout_armed;
+static uint64_t virtual_timeout_period;
+static uint64_t virtual_timeout_next;
+static bool virtual_din_edge_armed;
+static uint64_t virtual_din_edge_next;
+
+static uint64_t virtual_wall_ticks(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	uint64_t us = ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000ULL);
+	return (us * VIRTUAL_TICKS_PER_US) - virtual_wall_start;
+}
+
+// the emulated timers do not advance while the code runs so the cycle profiler uses the host clock (ns)
+uint32_t virtual_cycle_count(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec);
+}
+
+#define VIRTUAL_EVENT_NONE 0
+#define VIRTUAL_EVENT_RTC 1
+#define VIRTUAL_EVENT_ITP 2
+#define VIRTUAL_EVENT_TIMEOUT 3
+#define VIRTUAL_EVENT_DMA 4
+#define VIRTUAL_EVENT_DIN 5
+
+#ifdef ENABLE_DUAL_CORE_MOTION
+// the step timer fires on the motion core and the RTC and oneshot timers on the main core
+static VIRTUAL_CORE_LOCAL bool virtual_motion_core;
+#define VIRTUAL_MAIN_CORE_EVENTS (!virtual_motion_core)
+#define VIRTUAL_MOTION_CORE_EVENTS (virtual_motion_core)
+#else
+#define VIRTUAL_MAIN_CORE_EVENTS true
+#define VIRTUAL_MOTION_CORE_EVENTS true
+#endif
+
+#ifdef ENABLE_STEP_DMA
+/**
+ * DMA step engine playback emulation
+ * One buffer slot is played every VIRTUAL_DMA_SLOT_TICKS to the step/dir outputs
+ * */
+#define VIRTUAL_DMA_SLOT_TICKS (VIRTUAL_TIMER_CLOCK / STEP_DMA_FREQ)
+static bool virtual_dma_running;
+static uint16_t virtual_dma_slot;
+static uint64_t virtual_dma_next;
+static void virtual_dma_play(void);
+#endif
+
+// fires all timer events scheduled up to the target time (in order)
+static void virtual_run_until(uint64_t target)
+{
+	// timers do not preempt an ISR or an atomic section
+	// time still advances and pending events will fire late (like a real MCU)
+	if (virtual_isr_running || !virtual_global_isr_enabled)
+	{
+		if (target > virtual_ticks)
+		{
+			virtual_ticks = target;
+		}
+		return;
+	}
+
+	for (;;)
+	{
+		uint8_t event = VIRTUAL_EVENT_NONE;
+		uint64_t next = UINT64_MAX;
+		if (VIRTUAL_MAIN_CORE_EVENTS)
+		{
+			event = VIRTUAL_EVENT_RTC;
+			next = virtual_rtc_next;
+		}
+		if (VIRTUAL_MOTION_CORE_EVENTS && virtual_itp_running && virtual_itp_next < next)
+		{
+			event = VIRTUAL_EVENT_ITP;
+			next = virtual_itp_next;
+		}
+		if (VIRTUAL_MAIN_CORE_EVENTS && virtual_timeout_armed && virtual_timeout_next < next)
+		{
+			event = VIRTUAL_EVENT_TIMEOUT;
+			next = virtual_timeout_next;
+		}
+		if (VIRTUAL_MAIN_CORE_EVENTS && virtual_din_edge_armed && virtual_din_edge_next < next)
+		{
+			event = VIRTUAL_EVENT_DIN;
+			next = virtual_din_edge_next;
+		}
+#ifdef ENABLE_STEP_DMA
+		if (virtual_dma_running && virtual_dma_next < next)
+		{
+			event = VIRTUAL_EVENT_DMA;
+			next = virtual_dma_next;
+		}
+#endif
+
+		if (event == VIRTUAL_EVENT_NONE || next > target)
+		{
+			break;
+		}
+
+		if (next > virtual_ticks)
+		{
+			virtual_ticks = next;
+		}
+
+		virtual_isr_running = true;
+		mcu_disable_global_isr();
+		switch (event)
+		{
+		case VIRTUAL_EVENT_ITP:
+			virtual_itp_next += virtual_itp_period;
+			if (!virtual_itp_resetstep)
+			{
+				mcu_step_cb();
+				virtual_switches_isr();
+			}
+			else
+			{
+				mcu_step_reset_cb();
+			}
+			virtual_itp_resetstep = !virtual_itp_resetstep;
+			break;
+#ifdef ENABLE_STEP_DMA
+		case VIRTUAL_EVENT_DMA:
+			virtual_dma_next += VIRTUAL_DMA_SLOT_TICKS;
+			virtual_dma_play();
+			break;
+#endif
+		case VIRTUAL_EVENT_DIN:
+			virtual_din_edge_armed = false;
+			virtual_din_edge_isr();
+			break;
+		case VIRTUAL_EVENT_TIMEOUT:
+			virtual_timeout_armed = false;
+			if (mcu_timeout_cb)
+			{
+				mcu_timeout_cb();
+			}
+			break;
+		default:
+			virtual_rtc_next += VIRTUAL_TICKS_PER_MS;
+			mcu_rtc_cb(++virtual_millis);
+			break;
+		}
+		mcu_enable_global_isr();
+		virtual_isr_running = false;
+	}
+
+	if (target > virtual_ticks)
+	{
+		virtual_ticks = target;
+	}
+}
+
+void virtual_delay_us(uint16_t delay)
+{
+	virtual_run_until(virtual_ticks + (uint64_t)delay * VIRTUAL_TICKS_PER_US);
+}
+
+uint32_t mcu_millis(void)
+{
+	return virtual_millis;
+}
+
+uint32_t mcu_micros(void)
+{
+	return (uint32_t)(virtual_ticks / VIRTUAL_TICKS_PER_US);
+}
+
+uint32_t mcu_free_micros(void)
+{
+	return (uint32_t)((virtual_ticks / VIRTUAL_TICKS_PER_US) % 1000UL);
+}
+
+void mcu_freq_to_clocks(float frequency, uint16_t *ticks, uint16_t *prescaller)
+{
+	frequency = CLAMP((float)F_STEP_MIN, frequency, (float)F_STEP_MAX);
+	// up and down counter (generates half the step rate at each event)
+	uint32_t totalticks = (uint32_t)((float)(VIRTUAL_TIMER_CLOCK >> 1) / frequency);
+
+	*prescaller = 0;
+	while (totalticks > 0xFFFF)
+	{
+		(*prescaller)++;
+		totalticks >>= 1;
+	}
+
+	*ticks = (uint16_t)totalticks;
+}
+
+void mcu_freq_to_clocks_fixed(uint32_t frequency, uint16_t *ticks, uint16_t *prescaller)
+{
+	frequency = CLAMP(((uint32_t)F_STEP_MIN << 8), frequency, ((uint32_t)F_STEP_MAX << 8));
+	// same as mcu_freq_to_clocks with the rate truncated to 1/16 steps/s so that the scaled clock fits 32bit
+	uint32_t totalticks = ((uint32_t)(VIRTUAL_TIMER_CLOCK >> 1) << 4) / (frequency >> 4);
+
+	*prescaller = 0;
+	while (totalticks > 0xFFFF)
+	{
+		(*prescaller)++;
+		totalticks >>= 1;
+	}
+
+	*ticks = (uint16_t)totalticks;
+}
+
+float mcu_clocks_to_freq(uint16_t ticks, uint16_t prescaller)
+{
+	return ((float)VIRTUAL_TIMER_CLOCK / (float)(((uint32_t)ticks) << (prescaller + 1)));
+}
+
+void mcu_start_itp_isr(uint16_t ticks, uint16_t prescaller)
+{
+#ifdef ENABLE_STEP_DMA
+	step_dma_start(((uint32_t)ticks) << prescaller);
+#else
+	virtual_itp_period = ((uint64_t)ticks) << prescaller;
+	virtual_itp_next = virtual_ticks + virtual_itp_period;
+	virtual_itp_running = true;
+#endif
+}
+
+void mcu_change_itp_isr(uint16_t ticks, uint16_t prescaller)
+{
+#ifdef ENABLE_STEP_DMA
+	step_dma_change(((uint32_t)ticks) << prescaller);
+#else
+	// like the hardware timer the new period takes effect on the next update event
+	virtual_itp_period = ((uint64_t)ticks) << prescaller;
+#endif
+}
+
+void mcu_stop_itp_isr(void)
+{
+#ifdef ENABLE_STEP_DMA
+	step_dma_stop();
+#else
+	virtual_itp_running = false;
+#endif
+}
+
+#ifdef ENABLE_STEP_DMA
+void mcu_step_dma_start(void)
+{
+	virtual_dma_slot = 0;
+	virtual_dma_next = virtual_ticks + VIRTUAL_DMA_SLOT_TICKS;
+	virtual_dma_running = true;
+}
+
+void mcu_step_dma_stop(void)
+{
+	virtual_dma_running = false;
+}
+
+uint16_t mcu_step_dma_remaining(void)
+{
+	return STEP_DMA_BUFFER_SIZE - virtual_dma_slot;
+}
+#endif
+
+#ifdef MCU_HAS_ONESHOT_TIMER
+void mcu_config_timeout(mcu_timeout_delgate fp, uint32_t timeout)
+{
+	mcu_timeout_cb = fp;
+	virtual_timeout_period = (uint64_t)timeout * VIRTUAL_TICKS_PER_US;
+	virtual_timeout_armed = false;
+}
+
+void mcu_start_timeout()
+{
+	virtual_timeout_next = virtual_ticks + virtual_timeout_period;
+	virtual_timeout_armed = true;
+}
+#endif
+
+/**
+ * IO emulation
+ * Same pin layout and state maps as the Windows emulator
+ * */
+// the outputs are written by both cores
+#ifdef ENABLE_DUAL_CORE_MOTION
+#define VIRTUAL_OUTPUT_SET(var, mask) ATOMIC_FETCH_OR(var, mask)
+#define VIRTUAL_OUTPUT_CLEAR(var, mask) ATOMIC_FETCH_AND(var, ~(mask))
+#define VIRTUAL_OUTPUT_TOGGLE(var, mask) __atomic_fetch_xor(&(var), (mask), __ATOMIC_SEQ_CST)
+#else
+#define VIRTUAL_OUTPUT_SET(var, mask) (var |= (mask))
+#define VIRTUAL_OUTPUT_CLEAR(var, mask) (var &= ~(mask))
+#define VIRTUAL_OUTPUT_TOGGLE(var, mask) (var ^= (mask))
+#endif
+
+static volatile uint32_t virtual_special_outputs;
+static volatile uint32_t virtual_outputs;
+static volatile uint32_t virtual_special_inputs;
+static volatile uint32_t virtual_inputs;
+static uint8_t virtual_pwm[16];
+static uint8_t virtual_servos[6];
+static uint16_t virtual_analog[16];
+
+static uint8_t mcu_get_pin_offset(uint8_t pin)
+{
+	if (pin >= 1 && pin <= 24)
+	{
+		return pin - 1;
+	}
+	else if (pin >= 47 && pin <= 78)
+	{
+		return pin - 47;
+	}
+	if (pin >= 100 && pin <= 113)
+	{
+		return pin - 100;
+	}
+	else if (pin >= 130 && pin <= 161)
+	{
+		return pin - 130;
+	}
+
+	return -1;
+}
+
+void mcu_config_input(uint8_t pin)
+{
+}
+
+void mcu_config_output(uint8_t pin)
+{
+}
+
+void mcu_config_pwm(uint8_t pin, uint16_t freq)
+{
+}
+
+uint8_t mcu_get_input(uint8_t pin)
+{
+	uint8_t offset = mcu_get_pin_offset(pin);
+	if (offset > 31)
+	{
+		return 0;
+	}
+
+	if (pin >= DIN0)
+	{
+		return (virtual_inputs & (1UL << offset)) ? 1 : 0;
+	}
+
+	return (virtual_special_inputs & (1UL << offset)) ? 1 : 0;
+}
+
+// records the generic output changes in the step/dir trace
+static void virtual_trace_output(uint8_t pin, uint8_t offset);
+
+uint8_t mcu_get_output(uint8_t pin)
+{
+	uint8_t offset = mcu_get_pin_offset(pin);
+	if (offset > 31)
+	{
+		return 0;
+	}
+
+	if (pin >= DOUT0)
+	{
+		return (virtual_outputs & (1UL << offset)) ? 1 : 0;
+	}
+
+	return (virtual_special_outputs & (1UL << offset)) ? 1 : 0;
+}
+
+void mcu_set_output(uint8_t pin)
+{
+	uint8_t offset = mcu_get_pin_offset(pin);
+	if (offset > 31)
+	{
+		return;
+	}
+
+	if (pin >= DOUT0)
+	{
+		VIRTUAL_OUTPUT_SET(virtual_outputs, (1UL << offset));
+		virtual_trace_output(pin, offset);
+	}
+	else
+	{
+		VIRTUAL_OUTPUT_SET(virtual_special_outputs, (1UL << offset));
+	}
+}
+
+void mcu_clear_output(uint8_t pin)
+{
+	uint8_t offset = mcu_get_pin_offset(pin);
+	if (offset > 31)
+	{
+		return;
+	}
+
+	if (pin >= DOUT0)
+	{
+		VIRTUAL_OUTPUT_CLEAR(virtual_outputs, (1UL << offset));
+		virtual_trace_output(pin, offset);
+	}
+	else
+	{
+		VIRTUAL_OUTPUT_CLEAR(virtual_special_outputs, (1UL << offset));
+	}
+}
+
+void mcu_toggle_output(uint8_t pin)
+{
+	uint8_t offset = mcu_get_pin_offset(pin);
+	if (offset > 31)
+	{
+		return;
+	}
+
+	if (pin >= DOUT0)
+	{
+		VIRTUAL_OUTPUT_TOGGLE(virtual_outputs, (1UL << offset));
+		virtual_trace_output(pin, offset);
+	}
+	else
+	{
+		VIRTUAL_OUTPUT_TOGGLE(virtual_special_outputs, (1UL << offset));
+	}
+}
+
+void mcu_enable_probe_isr(void)
+{
+}
+
+void mcu_disable_probe_isr(void)
+{
+}
+
+uint16_t mcu_get_analog(uint8_t channel)
+{
+	channel -= ANALOG0;
+	return (channel < 16) ? virtual_analog[channel] : 0;
+}
+
+void mcu_set_pwm(uint8_t pwm, uint8_t value)
+{
+	pwm -= PWM0;
+	if (pwm < 16)
+	{
+		virtual_pwm[pwm] = value;
+	}
+}
+
+uint8_t mcu_get_pwm(uint8_t pwm)
+{
+	pwm -= PWM0;
+	return (pwm < 16) ? virtual_pwm[pwm] : 0;
+}
+
+void mcu_set_servo(uint8_t servo, uint8_t value)
+{
+	servo -= SERVO0;
+	if (servo < 6)
+	{
+		virtual_servos[servo] = value;
+	}
+}
+
+uint8_t mcu_get_servo(uint8_t servo)
+{
+	servo -= SERVO0;
+	return (servo < 6) ? virtual_servos[servo] : 0;
+}
+
+/**
+ * UART emulation
+ * Input is only read from the host when there is room in the RX buffer
+ * so a piped file is naturally flow controlled by the parser
+ * */
+DECL_BUFFER(uint8_t, uart_tx, UART_TX_BUFFER_SIZE);
+DECL_BUFFER(uint8_t, uart_rx, RX_BUFFER_SIZE);
+
+uint8_t mcu_uart_getc(void)
+{
+	uint8_t c = 0;
+	BUFFER_DEQUEUE(uart_rx, &c);
+	return c;
+}
+
+buffer_index_t mcu_uart_available(void)
+{
+	return BUFFER_READ_AVAILABLE(uart_rx);
+}
+
+buffer_index_t mcu_uart_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(uart_rx, buffer, len, read);
+	return read;
+}
+
+void mcu_uart_clear(void)
+{
+	BUFFER_CLEAR(uart_rx);
+}
+
+void mcu_uart_putc(uint8_t c)
+{
+	while (BUFFER_FULL(uart_tx))
+	{
+		mcu_uart_flush();
+	}
+	BUFFER_ENQUEUE(uart_tx, &c);
+}
+
+void mcu_uart_flush(void)
+{
+	while (!BUFFER_EMPTY(uart_tx))
+	{
+		uint8_t c = 0;
+		BUFFER_DEQUEUE(uart_tx, &c);
+		while (write(virtual_uart_out, &c, 1) < 0)
+		{
+			if (errno != EAGAIN && errno != EINTR)
+			{
+				// nobody listening (closed pipe or pty without slave)
+				BUFFER_CLEAR(uart_tx);
+				return;
+			}
+			struct pollfd pfd = {.fd = virtual_uart_out, .events = POLLOUT};
+			poll(&pfd, 1, 1);
+		}
+	}
+}
+
+static void virtual_uart_read(void)
+{
+	if (virtual_uart_eof)
+	{
+		return;
+	}
+
+	uint8_t buff[RX_BUFFER_SIZE];
+	uint16_t len = BUFFER_WRITE_AVAILABLE(uart_rx);
+	if (!len)
+	{
+		return;
+	}
+
+	ssize_t count = read(virtual_uart_in, buff, len);
+	if (count == 0 && !virtual_use_pty)
+	{
+		virtual_uart_eof = true;
+		return;
+	}
+
+	for (ssize_t i = 0; i < count; i++)
+	{
+		uint8_t c = buff[i];
+#if !defined(DETACH_UART_FROM_MAIN_PROTOCOL)
+		if (mcu_com_rx_cb(c))
+		{
+			if (BUFFER_FULL(uart_rx))
+			{
+				STREAM_OVF(c);
+			}
+
+			BUFFER_ENQUEUE(uart_rx, &c);
+		}
+#else
+		mcu_uart_rx_cb(c);
+#endif
+	}
+}
+
+static void virtual_uart_init(void)
+{
+	if (virtual_use_pty)
+	{
+		int fd = posix_openpt(O_RDWR | O_NOCTTY);
+		if (fd < 0 || grantpt(fd) || unlockpt(fd))
+		{
+			perror("virtual uart pty");
+			exit(EXIT_FAILURE);
+		}
+
+		struct termios tio;
+		if (!tcgetattr(fd, &tio))
+		{
+			cfmakeraw(&tio);
+			tcsetattr(fd, TCSANOW, &tio);
+		}
+
+		fprintf(stderr, "µCNC virtual UART on %s\n", ptsname(fd));
+		virtual_uart_in = fd;
+		virtual_uart_out = fd;
+	}
+
+	fcntl(virtual_uart_in, F_SETFL, fcntl(virtual_uart_in, F_GETFL) | O_NONBLOCK);
+}
+
+#ifdef MCU_HAS_UART2
+/**
+ * UART2 emulation
+ * The UART2 is wired to a simulated Modbus RTU slave with a simple VFD model
+ * (Huanyang type 2 registers). The response is delivered virtual_modbus_delay ms
+ * after the request and every virtual_modbus_drop request is ignored.
+ * */
+#ifndef UART2_TX_BUFFER_SIZE
+#define UART2_TX_BUFFER_SIZE 64
+#endif
+DECL_BUFFER(uint8_t, uart2_tx, UART2_TX_BUFFER_SIZE);
+DECL_BUFFER(uint8_t, uart2_rx, RX_BUFFER_SIZE);
+
+#define VIRTUAL_MODBUS_REGISTERS 8
+static uint32_t virtual_modbus_delay = 10;
+static uint32_t virtual_modbus_drop;
+static uint8_t virtual_modbus_request[64];
+static uint8_t virtual_modbus_request_len;
+static uint8_t virtual_modbus_reply[64];
+static uint8_t virtual_modbus_reply_len;
+static uint32_t virtual_modbus_reply_at;
+static uint32_t virtual_modbus_requests;
+static uint32_t virtual_modbus_dropped;
+// sparse holding registers {address, value}
+// the VFD tool reads 2 registers and uses the last one so both hold the value
+static uint16_t virtual_modbus_regs[VIRTUAL_MODBUS_REGISTERS][2] = {
+	// max frequency (400.00Hz)
+	{0xB005, 40000},
+	{0xB006, 40000},
+	// control (6 is stop)
+	{0x2000, 6},
+	// set frequency
+	{0x1000, 0},
+	// output frequency
+	{0x700C, 0},
+	{0x700D, 0}};
+
+static uint16_t virtual_modbus_crc(uint8_t *data, uint8_t len)
+{
+	uint16_t crc = 0xFFFF;
+	for (uint8_t pos = 0; pos < len; pos++)
+	{
+		crc ^= data[pos];
+		for (uint8_t i = 8; i != 0; i--)
+		{
+			crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+		}
+	}
+	return crc;
+}
+
+static uint16_t *virtual_modbus_reg(uint16_t address)
+{
+	for (uint8_t i = 0; i < VIRTUAL_MODBUS_REGISTERS; i++)
+	{
+		if (virtual_modbus_regs[i][0] == address)
+		{
+			return &virtual_modbus_regs[i][1];
+		}
+	}
+	return NULL;
+}
+
+static void virtual_modbus_write(uint16_t address, uint16_t value)
+{
+	uint16_t *reg = virtual_modbus_reg(address);
+	if (reg)
+	{
+		*reg = value;
+	}
+
+	// the output frequency follows the set frequency while running forward or reverse
+	uint16_t control = *virtual_modbus_reg(0x2000);
+	uint16_t freq = (control == 1 || control == 2) ? *virtual_modbus_reg(0x1000) : 0;
+	*virtual_modbus_reg(0x700C) = freq;
+	*virtual_modbus_reg(0x700D) = freq;
+}
+
+// expected length of the request (0 while unknown)
+static uint8_t virtual_modbus_request_size(void)
+{
+	if (virtual_modbus_request_len < 2)
+	{
+		return 0;
+	}
+
+	switch (virtual_modbus_request[1])
+	{
+	case 0x0F:
+	case 0x10:
+		return (virtual_modbus_request_len < 7) ? 0 : (9 + virtual_modbus_request[6]);
+	}
+
+	return 8;
+}
+
+static void virtual_modbus_process(void)
+{
+	uint8_t *req = virtual_modbus_request;
+	uint8_t *rep = virtual_modbus_reply;
+	uint8_t len = virtual_modbus_request_len;
+	virtual_modbus_request_len = 0;
+	virtual_modbus_requests++;
+
+	if (virtual_modbus_crc(req, len - 2) != (req[len - 2] | (req[len - 1] << 8)))
+	{
+		return;
+	}
+
+	if (virtual_modbus_drop && !(virtual_modbus_requests % virtual_modbus_drop))
+	{
+		virtual_modbus_dropped++;
+		return;
+	}
+
+	uint16_t address = (req[2] << 8) | req[3];
+	uint16_t value = (req[4] << 8) | req[5];
+	rep[0] = req[0];
+	rep[1] = req[1];
+	switch (req[1])
+	{
+	case 0x03:
+	case 0x04:
+		// read registers (value is the count)
+		value = MIN(value, 16);
+		rep[2] = value << 1;
+		for (uint16_t i = 0; i < value; i++)
+		{
+			uint16_t *reg = virtual_modbus_reg(address + i);
+			rep[3 + (i << 1)] = reg ? (*reg >> 8) : 0;
+			rep[4 + (i << 1)] = reg ? (*reg & 0xFF) : 0;
+		}
+		len = 3 + (value << 1);
+		break;
+	case 0x05:
+	case 0x06:
+		virtual_modbus_write(address, value);
+		memcpy(rep, req, 6);
+		len = 6;
+		break;
+	case 0x10:
+		for (uint16_t i = 0; i < value && i < (req[6] >> 1); i++)
+		{
+			virtual_modbus_write(address + i, (req[7 + (i << 1)] << 8) | req[8 + (i << 1)]);
+		}
+		memcpy(rep, req, 6);
+		len = 6;
+		break;
+	default:
+		// illegal function exception
+		rep[1] |= 0x80;
+		rep[2] = 0x01;
+		len = 3;
+		break;
+	}
+
+	uint16_t crc = virtual_modbus_crc(rep, len);
+	rep[len++] = crc & 0xFF;
+	rep[len++] = crc >> 8;
+	virtual_modbus_reply_len = len;
+	virtual_modbus_reply_at = virtual_millis + virtual_modbus_delay;
+}
+
+// delivers the response when it's time
+static void virtual_modbus_task(void)
+{
+	if (virtual_modbus_reply_len && (int32_t)(virtual_millis - virtual_modbus_reply_at) >= 0)
+	{
+		for (uint8_t i = 0; i < virtual_modbus_reply_len; i++)
+		{
+			uint8_t c = virtual_modbus_reply[i];
+			mcu_uart2_rx_cb(c);
+			if (!BUFFER_FULL(uart2_rx))
+			{
+				BUFFER_ENQUEUE(uart2_rx, &c);
+			}
+		}
+		virtual_modbus_reply_len = 0;
+	}
+}
+
+uint8_t mcu_uart2_getc(void)
+{
+	uint8_t c = 0;
+	BUFFER_DEQUEUE(uart2_rx, &c);
+	return c;
+}
+
+buffer_index_t mcu_uart2_available(void)
+{
+	return BUFFER_READ_AVAILABLE(uart2_rx);
+}
+
+buffer_index_t mcu_uart2_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read;
+	BUFFER_READ_LINE(uart2_rx, buffer, len, read);
+	return read;
+}
+
+void mcu_uart2_clear(void)
+{
+	BUFFER_CLEAR(uart2_rx);
+}
+
+void mcu_uart2_putc(uint8_t c)
+{
+	while (BUFFER_FULL(uart2_tx))
+	{
+		mcu_uart2_flush();
+	}
+	BUFFER_ENQUEUE(uart2_tx, &c);
+}
+
+void mcu_uart2_flush(void)
+{
+	while (!BUFFER_EMPTY(uart2_tx))
+	{
+		uint8_t c = 0;
+		BUFFER_DEQUEUE(uart2_tx, &c);
+		if (virtual_modbus_request_len < sizeof(virtual_modbus_request))
+		{
+			virtual_modbus_request[virtual_modbus_request_len++] = c;
+		}
+		uint8_t size = virtual_modbus_request_size();
+		if (size && virtual_modbus_request_len >= size)
+		{
+			virtual_modbus_process();
+		}
+	}
+}
+#endif
+
+/**
+ * EEPROM emulation
+ * RAM image backed by a file that is written on flush
+ * */
+#ifndef ENABLE_FLASH_KV
+static uint8_t virtual_eeprom[NVM_STORAGE_SIZE];
+static bool virtual_eeprom_dirty;
+
+static void virtual_eeprom_init(void)
+{
+	FILE *fp = fopen(virtual_eeprom_file, "rb");
+	if (fp)
+	{
+		if (!fread(virtual_eeprom, 1, NVM_STORAGE_SIZE, fp))
+		{
+			memset(virtual_eeprom, 0, NVM_STORAGE_SIZE);
+		}
+		fclose(fp);
+	}
+}
+
+uint8_t mcu_eeprom_getc(uint16_t address)
+{
+	if (address >= NVM_STORAGE_SIZE)
+	{
+		return 0;
+	}
+
+	return virtual_eeprom[address];
+}
+
+void mcu_eeprom_putc(uint16_t address, uint8_t value)
+{
+	if (address >= NVM_STORAGE_SIZE)
+	{
+		return;
+	}
+
+	if (virtual_eeprom[address] != value)
+	{
+		virtual_eeprom[address] = value;
+		virtual_eeprom_dirty = true;
+	}
+}
+
+void mcu_eeprom_flush(void)
+{
+	if (!virtual_eeprom_dirty)
+	{
+		return;
+	}
+
+	FILE *fp = fopen(virtual_eeprom_file, "wb");
+	if (fp)
+	{
+		fwrite(virtual_eeprom, 1, NVM_STORAGE_SIZE, fp);
+		fclose(fp);
+		virtual_eeprom_dirty = false;
+	}
+}
+#else
+/**
+ * Flash emulation for the key/value store
+ * The EEPROM file holds the 2 banks of a NOR flash (1KB pages) and is updated on each erase and program
+ * so that an abort at any flash operation leaves the same image as a power fail.
+ * A halfword can only be programmed once after the erase. The erase and program times of the
+ * STM32F1 are added to the busy time of each commit.
+ * */
+#define VIRTUAL_FLASH_SIZE (FLASH_KV_BANK_SIZE << 1)
+#define VIRTUAL_FLASH_PAGE_SIZE 1024
+#define VIRTUAL_FLASH_PROGRAM_US 52
+#define VIRTUAL_FLASH_ERASE_US 20000
+static uint8_t virtual_flash[VIRTUAL_FLASH_SIZE];
+static int virtual_flash_fd = -1;
+// power fails at this flash operation (0 never)
+static uint32_t virtual_flash_fail_at;
+static uint32_t virtual_flash_ops;
+static uint32_t virtual_flash_programs;
+static uint32_t virtual_flash_erases;
+static uint32_t virtual_flash_errors;
+static uint64_t virtual_flash_busy_us;
+static uint64_t virtual_flash_commit_us;
+static uint64_t virtual_flash_max_commit_us;
+
+static void virtual_flash_store(uint32_t offset, uint32_t len)
+{
+	if (virtual_flash_fd >= 0 && pwrite(virtual_flash_fd, &virtual_flash[offset], len, offset) != (ssize_t)len)
+	{
+		perror("virtual flash");
+	}
+}
+
+static bool virtual_flash_power_fail(void)
+{
+	return (virtual_flash_fail_at && (++virtual_flash_ops == virtual_flash_fail_at));
+}
+
+static void virtual_flash_abort(void)
+{
+	fprintf(stderr, "flash: power fail at operation %u\n", virtual_flash_fail_at);
+	fflush(stdout);
+	_exit(3);
+}
+
+void mcu_flash_kv_erase(uint8_t bank)
+{
+	uint32_t offset = (uint32_t)bank * FLASH_KV_BANK_SIZE;
+	for (uint32_t page = 0; page < FLASH_KV_BANK_SIZE; page += VIRTUAL_FLASH_PAGE_SIZE)
+	{
+		if (virtual_flash_power_fail())
+		{
+			// the page is left half erased
+			memset(&virtual_flash[offset + page], 0xFF, VIRTUAL_FLASH_PAGE_SIZE >> 1);
+			virtual_flash_store(offset + page, VIRTUAL_FLASH_PAGE_SIZE >> 1);
+			virtual_flash_abort();
+		}
+		memset(&virtual_flash[offset + page], 0xFF, VIRTUAL_FLASH_PAGE_SIZE);
+		virtual_flash_store(offset + page, VIRTUAL_FLASH_PAGE_SIZE);
+		virtual_flash_erases++;
+		virtual_flash_busy_us += VIRTUAL_FLASH_ERASE_US;
+		virtual_flash_commit_us += VIRTUAL_FLASH_ERASE_US;
+	}
+}
+
+void mcu_flash_kv_program(uint8_t bank, uint16_t offset, uint16_t value)
+{
+	uint32_t address = ((uint32_t)bank * FLASH_KV_BANK_SIZE) + offset;
+	if (virtual_flash_power_fail())
+	{
+		virtual_flash_abort();
+	}
+	if (virtual_flash[address] != 0xFF || virtual_flash[address + 1] != 0xFF)
+	{
+		// PGERR (not erased)
+		virtual_flash_errors++;
+		return;
+	}
+	virtual_flash[address] = (uint8_t)value;
+	virtual_flash[address + 1] = (uint8_t)(value >> 8);
+	virtual_flash_store(address, 2);
+	virtual_flash_programs++;
+	virtual_flash_busy_us += VIRTUAL_FLASH_PROGRAM_US;
+	virtual_flash_commit_us += VIRTUAL_FLASH_PROGRAM_US;
+}
+
+uint16_t mcu_flash_kv_read(uint8_t bank, uint16_t offset)
+{
+	uint32_t address = ((uint32_t)bank * FLASH_KV_BANK_SIZE) + offset;
+	return virtual_flash[address] | ((uint16_t)virtual_flash[address + 1] << 8);
+}
+
+static void virtual_eeprom_init(void)
+{
+	memset(virtual_flash, 0xFF, VIRTUAL_FLASH_SIZE);
+	virtual_flash_fd = open(virtual_eeprom_file, O_RDWR | O_CREAT, 0644);
+	if (virtual_flash_fd < 0)
+	{
+		perror("virtual flash");
+	}
+	else if (pread(virtual_flash_fd, virtual_flash, VIRTUAL_FLASH_SIZE, 0) != VIRTUAL_FLASH_SIZE)
+	{
+		// new (erased) flash
+		memset(virtual_flash, 0xFF, VIRTUAL_FLASH_SIZE);
+		virtual_flash_store(0, VIRTUAL_FLASH_SIZE);
+	}
+
+	flash_kv_init();
+	virtual_flash_commit_us = 0;
+}
+
+uint8_t mcu_eeprom_getc(uint16_t address)
+{
+	return flash_kv_getc(address);
+}
+
+void mcu_eeprom_putc(uint16_t address, uint8_t value)
+{
+	flash_kv_putc(address, value);
+}
+
+void mcu_eeprom_flush(void)
+{
+	flash_kv_flush();
+	virtual_flash_max_commit_us = MAX(virtual_flash_max_commit_us, virtual_flash_commit_us);
+	virtual_flash_commit_us = 0;
+}
+
+static void virtual_flash_report(void)
+{
+	flash_kv_stats_t stats;
+	flash_kv_get_stats(&stats);
+	fprintf(stderr, "flash kv: %u records, %u commits, %u compactions, %u discarded at boot, bank %u %u/%u records\n",
+			stats.records, stats.commits, stats.compactions, stats.discarded, stats.bank, stats.used, (unsigned)FLASH_KV_RECORDS);
+	fprintf(stderr, "flash: %u halfwords programmed, %u pages erased, %u errors, %.1fms busy, %.1fms max commit\n",
+			virtual_flash_programs, virtual_flash_erases, virtual_flash_errors, virtual_flash_busy_us / 1000.0, virtual_flash_max_commit_us / 1000.0);
+}
+#endif
+
+/**
+ * File system emulation
+ * A host directory (--fs) is mounted as drive C (/C/<path>)
+ * */
+#define VIRTUAL_FS_PATH_MAX (FS_PATH_NAME_MAX_LEN + 256)
+static const char *virtual_fs_root;
+static fs_t virtual_fs;
+
+static void virtual_fs_path(const char *path, char *host_path)
+{
+	snprintf(host_path, VIRTUAL_FS_PATH_MAX, "%s/%s", virtual_fs_root, (path[0] == '/') ? &path[1] : path);
+}
+
+static bool virtual_fs_finfo(const char *path, fs_file_info_t *finfo)
+{
+	char host_path[VIRTUAL_FS_PATH_MAX];
+	struct stat st;
+
+	virtual_fs_path(path, host_path);
+	if (!finfo || stat(host_path, &st))
+	{
+		return false;
+	}
+
+	memset(finfo, 0, sizeof(fs_file_info_t));
+	strncpy(finfo->full_name, path, FS_PATH_NAME_MAX_LEN - 1);
+	finfo->is_dir = S_ISDIR(st.st_mode);
+	finfo->size = (finfo->is_dir) ? 0 : (uint32_t)st.st_size;
+	finfo->timestamp = (uint32_t)st.st_mtime;
+	return true;
+}
+
+static fs_file_t *virtual_fs_opendir(const char *path)
+{
+	char host_path[VIRTUAL_FS_PATH_MAX];
+	fs_file_t *fp = (fs_file_t *)calloc(1, sizeof(fs_file_t));
+	if (!fp)
+	{
+		return NULL;
+	}
+
+	virtual_fs_path(path, host_path);
+	fp->file_ptr = opendir(host_path);
+	if (!fp->file_ptr)
+	{
+		fs_safe_free(fp);
+		return NULL;
+	}
+
+	strncpy(fp->file_info.full_name, path, FS_PATH_NAME_MAX_LEN - 1);
+	fp->file_info.is_dir = true;
+	fp->fs_ptr = &virtual_fs;
+	return fp;
+}
+
+static fs_file_t *virtual_fs_open(const char *path, const char *mode)
+{
+	char host_path[VIRTUAL_FS_PATH_MAX];
+	fs_file_info_t finfo;
+
+	if (virtual_fs_finfo(path, &finfo) && finfo.is_dir)
+	{
+		return virtual_fs_opendir(path);
+	}
+
+	fs_file_t *fp = (fs_file_t *)calloc(1, sizeof(fs_file_t));
+	if (!fp)
+	{
+		return NULL;
+	}
+
+	virtual_fs_path(path, host_path);
+	fp->file_ptr = fopen(host_path, mode);
+	if (!fp->file_ptr)
+	{
+		fs_safe_free(fp);
+		return NULL;
+	}
+
+	// the file may have been created
+	virtual_fs_finfo(path, &fp->file_info);
+	fp->fs_ptr = &virtual_fs;
+	return fp;
+}
+
+static size_t virtual_fs_read(fs_file_t *fp, uint8_t *buffer, size_t len)
+{
+	return fread(buffer, 1, len, (FILE *)fp->file_ptr);
+}
+
+static size_t virtual_fs_write(fs_file_t *fp, const uint8_t *buffer, size_t len)
+{
+	len = fwrite(buffer, 1, len, (FILE *)fp->file_ptr);
+	long pos = ftell((FILE *)fp->file_ptr);
+	if (pos > (long)fp->file_info.size)
+	{
+		fp->file_info.size = (uint32_t)pos;
+	}
+	return len;
+}
+
+static bool virtual_fs_seek(fs_file_t *fp, uint32_t position)
+{
+	return !fseek((FILE *)fp->file_ptr, position, SEEK_SET);
+}
+
+static int virtual_fs_available(fs_file_t *fp)
+{
+	if (fp->file_info.is_dir)
+	{
+		return 0;
+	}
+	return (int)(fp->file_info.size - ftell((FILE *)fp->file_ptr));
+}
+
+static void virtual_fs_close(fs_file_t *fp)
+{
+	if (fp->file_info.is_dir)
+	{
+		closedir((DIR *)fp->file_ptr);
+	}
+	else
+	{
+		fclose((FILE *)fp->file_ptr);
+	}
+	// already released (fs_close frees the pointer)
+	fp->file_ptr = NULL;
+}
+
+static bool virtual_fs_remove(const char *path)
+{
+	char host_path[VIRTUAL_FS_PATH_MAX];
+	virtual_fs_path(path, host_path);
+	return !remove(host_path);
+}
+
+static bool virtual_fs_mkdir(const char *path)
+{
+	char host_path[VIRTUAL_FS_PATH_MAX];
+	virtual_fs_path(path, host_path);
+	return !mkdir(host_path, 0755);
+}
+
+static bool virtual_fs_rmdir(const char *path)
+{
+	char host_path[VIRTUAL_FS_PATH_MAX];
+	virtual_fs_path(path, host_path);
+	return !rmdir(host_path);
+}
+
+static bool virtual_fs_next_file(fs_file_t *fp, fs_file_info_t *finfo)
+{
+	struct dirent *entry;
+	while ((entry = readdir((DIR *)fp->file_ptr)))
+	{
+		if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+		{
+			continue;
+		}
+
+		char path[VIRTUAL_FS_PATH_MAX];
+		snprintf(path, sizeof(path), "%s/%s", (strcmp(fp->file_info.full_name, "/")) ? fp->file_info.full_name : "", entry->d_name);
+		return virtual_fs_finfo(path, finfo);
+	}
+
+	return false;
+}
+
+static void virtual_fs_init(void)
+{
+	if (!virtual_fs_root)
+	{
+		return;
+	}
+
+	virtual_fs.drive = 'C';
+	virtual_fs.open = virtual_fs_open;
+	virtual_fs.read = virtual_fs_read;
+	virtual_fs.write = virtual_fs_write;
+	virtual_fs.seek = virtual_fs_seek;
+	virtual_fs.available = virtual_fs_available;
+	virtual_fs.close = virtual_fs_close;
+	virtual_fs.remove = virtual_fs_remove;
+	virtual_fs.opendir = virtual_fs_opendir;
+	virtual_fs.mkdir = virtual_fs_mkdir;
+	virtual_fs.rmdir = virtual_fs_rmdir;
+	virtual_fs.next_file = virtual_fs_next_file;
+	virtual_fs.finfo = virtual_fs_finfo;
+	virtual_fs.next = NULL;
+	fs_mount(&virtual_fs);
+}
+
+/**
+ * Step/dir trace recorder
+ * Binary file (little endian) with a header followed by records
+ *
+ * header:
+ * 	char[4] magic "UCTR"
+ * 	uint8_t version, stepper count, step invert mask, dir invert mask
+ * 	uint32_t timer clock (timestamp ticks per second)
+ * 	float step_per_mm, max_feed_rate (mm/min), acceleration (mm/s^2) for each stepper
+ *
+ * record:
+ * 	uint8_t type
+ * 	varint ticks elapsed since the previous record
+ * 	payload: uint8_t mask (set steps, toggle steps and set dirs records)
+ * 			 uint8_t DOUT index | level << 7 (output record)
+ * 			 zigzag varint step position per stepper (position record)
+ * */
+#define VIRTUAL_TRACE_VERSION 1
+#define VIRTUAL_TRACE_POSITION 4
+#define VIRTUAL_TRACE_OUTPUT 5
+#define VIRTUAL_TRACE_POSITION_INTERVAL VIRTUAL_TICKS_PER_MS
+
+static FILE *virtual_trace_fp;
+static bool virtual_trace_started;
+static uint64_t virtual_trace_last;
+static uint64_t virtual_trace_position_last;
+
+// both cores write records (the step outputs are also set by the main core on unlock)
+#ifdef ENABLE_DUAL_CORE_MOTION
+static pthread_mutex_t virtual_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define VIRTUAL_TRACE_LOCK() pthread_mutex_lock(&virtual_trace_mutex)
+#define VIRTUAL_TRACE_UNLOCK() pthread_mutex_unlock(&virtual_trace_mutex)
+#else
+#define VIRTUAL_TRACE_LOCK()
+#define VIRTUAL_TRACE_UNLOCK()
+#endif
+
+static void virtual_trace_varint(uint64_t value)
+{
+	do
+	{
+		uint8_t c = (uint8_t)(value & 0x7F);
+		value >>= 7;
+		if (value)
+		{
+			c |= 0x80;
+		}
+		fputc(c, virtual_trace_fp);
+	} while (value);
+}
+
+static void virtual_trace_uint32(uint32_t value)
+{
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		fputc((uint8_t)(value >> (i << 3)), virtual_trace_fp);
+	}
+}
+
+static void virtual_trace_float(float value)
+{
+	uint32_t raw;
+	memcpy(&raw, &value, sizeof(raw));
+	virtual_trace_uint32(raw);
+}
+
+static void virtual_trace_record(uint8_t type)
+{
+	// the header is written on the first record so that the stored settings are already loaded
+	if (!virtual_trace_started)
+	{
+		virtual_trace_started = true;
+		fwrite("UCTR", 1, 4, virtual_trace_fp);
+		fputc(VIRTUAL_TRACE_VERSION, virtual_trace_fp);
+		fputc(STEPPER_COUNT, virtual_trace_fp);
+		fputc(g_settings.step_invert_mask, virtual_trace_fp);
+		fputc(g_settings.dir_invert_mask, virtual_trace_fp);
+		virtual_trace_uint32(VIRTUAL_TIMER_CLOCK);
+		for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+		{
+			virtual_trace_float(g_settings.step_per_mm[i]);
+			virtual_trace_float(g_settings.max_feed_rate[i]);
+			virtual_trace_float(g_settings.acceleration[i]);
+		}
+		virtual_trace_last = virtual_ticks;
+	}
+
+	// each core has its own time (a record of the other core never goes back in time)
+	uint64_t now = MAX(virtual_ticks, virtual_trace_last);
+	fputc(type, virtual_trace_fp);
+	virtual_trace_varint(now - virtual_trace_last);
+	virtual_trace_last = now;
+}
+
+static void virtual_trace_write_position(int32_t *position)
+{
+	virtual_trace_record(VIRTUAL_TRACE_POSITION);
+	for (uint8_t i = 0; i < STEPPER_COUNT; i++)
+	{
+		int32_t p = position[i];
+		virtual_trace_varint(((uint32_t)p << 1) ^ (uint32_t)(p >> 31));
+	}
+	virtual_trace_position_last = virtual_ticks;
+}
+
+static void virtual_trace_io(uint8_t type, uint8_t mask)
+{
+	VIRTUAL_TRACE_LOCK();
+	virtual_trace_record(type);
+	fputc(mask, virtual_trace_fp);
+	VIRTUAL_TRACE_UNLOCK();
+}
+
+static void virtual_trace_output(uint8_t pin, uint8_t offset)
+{
+	// the input pins share the output levels
+	if (virtual_trace_fp && pin <= DOUT31)
+	{
+		virtual_trace_io(VIRTUAL_TRACE_OUTPUT, offset | ((virtual_outputs & (1UL << offset)) ? 0x80 : 0));
+	}
+}
+
+// position checkpoints (at most one per interval)
+static void virtual_trace_position(int32_t *position)
+{
+	if ((virtual_ticks - virtual_trace_position_last) >= VIRTUAL_TRACE_POSITION_INTERVAL)
+	{
+		VIRTUAL_TRACE_LOCK();
+		virtual_trace_write_position(position);
+		VIRTUAL_TRACE_UNLOCK();
+	}
+}
+
+static void virtual_trace_close(void)
+{
+	if (virtual_trace_fp)
+	{
+		int32_t position[STEPPER_COUNT];
+		itp_get_rt_position(position);
+		virtual_trace_write_position(position);
+		fclose(virtual_trace_fp);
+		virtual_trace_fp = NULL;
+	}
+}
+
+static void virtual_trace_init(void)
+{
+	if (!virtual_trace_file)
+	{
+		return;
+	}
+
+	virtual_trace_fp = fopen(virtual_trace_file, "wb");
+	if (!virtual_trace_fp)
+	{
+		perror("virtual trace");
+		exit(EXIT_FAILURE);
+	}
+
+#ifndef ENABLE_STEP_DMA
+	HOOK_ATTACH_CALLBACK(itp_rt_step_trace, virtual_trace_position);
+#else
+	// the step position runs ahead of the outputs (the checkpoints are written by the DMA playback)
+	(void)virtual_trace_position;
+#endif
+	atexit(virtual_trace_close);
+}
+
+/**
+ * Simulated limit switches (--switches)
+ * Each stepper has a limit switch at step position 0 of it's travel (pressed at or below 0)
+ * and starts the given number of steps above it. The step position follows the step outputs
+ * so a locked stepper (multi step homing) stops moving towards it's switch.
+ * The switches are not simulated with the step DMA (the step outputs bypass the trace hook).
+ * */
+static const uint8_t virtual_switches_pin[] = {LIMIT_X, LIMIT_Y, LIMIT_Z, LIMIT_A, LIMIT_B, LIMIT_C};
+#define VIRTUAL_SWITCHES_COUNT MIN(STEPPER_COUNT, sizeof(virtual_switches_pin))
+static bool virtual_switches_enabled;
+static volatile bool virtual_switches_changed;
+static int32_t virtual_switches_pos[STEPPER_COUNT];
+static uint8_t virtual_switches_dirs;
+
+static void virtual_switches_io(uint8_t type, uint8_t mask)
+{
+	switch (type)
+	{
+	case IO_TRACE_SET_DIRS:
+		virtual_switches_dirs = mask;
+		break;
+	case IO_TRACE_TOGGLE_STEPS:
+		for (uint8_t i = 0; i < VIRTUAL_SWITCHES_COUNT; i++)
+		{
+			if (!(mask & (1 << i)))
+			{
+				continue;
+			}
+
+			int32_t pos = virtual_switches_pos[i] + ((virtual_switches_dirs & (1 << i)) ? -1 : 1);
+			virtual_switches_pos[i] = pos;
+			// the switch changes state when crossing position 0
+			if (pos == 0 || pos == 1)
+			{
+				uint32_t bit = (1UL << mcu_get_pin_offset(virtual_switches_pin[i]));
+				virtual_special_inputs = (pos <= 0) ? (virtual_special_inputs | bit) : (virtual_special_inputs & ~bit);
+				virtual_switches_changed = true;
+			}
+		}
+		break;
+	}
+}
+
+static void virtual_switches_isr(void)
+{
+	if (virtual_switches_changed)
+	{
+		virtual_switches_changed = false;
+		mcu_limits_changed_cb();
+	}
+}
+
+static void virtual_switches_init(void)
+{
+	if (!virtual_switches_arg)
+	{
+		return;
+	}
+
+	// comma separated start positions (steps), the last one repeats for the remaining steppers
+	const char *arg = virtual_switches_arg;
+	int32_t pos = 0;
+	for (uint8_t i = 0; i < VIRTUAL_SWITCHES_COUNT; i++)
+	{
+		if (*arg)
+		{
+			char *end;
+			pos = (int32_t)strtol(arg, &end, 10);
+			arg = (*end == ',') ? (end + 1) : end;
+		}
+
+		virtual_switches_pos[i] = pos;
+		if (pos <= 0)
+		{
+			virtual_special_inputs |= (1UL << mcu_get_pin_offset(virtual_switches_pin[i]));
+		}
+	}
+
+	virtual_switches_enabled = true;
+}
+
+/**
+ * Scheduled input edge (--din-edge)
+ * DIN<n> (0 to 7) is toggled once at the given virtual time (ms) and the input change ISR runs at that timer tick
+ * (the virtual board has a pin change ISR on DIN0 to DIN7)
+ * */
+static uint8_t virtual_din_edge_pin;
+
+static void virtual_din_edge_isr(void)
+{
+	virtual_inputs ^= (1UL << virtual_din_edge_pin);
+	mcu_inputs_changed_cb();
+}
+
+static void virtual_din_edge_init(void)
+{
+	if (!virtual_din_edge_arg)
+	{
+		return;
+	}
+
+	// <n>,<ms>
+	char *end;
+	long pin = strtol(virtual_din_edge_arg, &end, 10);
+	if (*end != ',' || pin < 0 || pin > 7)
+	{
+		fprintf(stderr, "invalid --din-edge %s\n", virtual_din_edge_arg);
+		exit(EXIT_FAILURE);
+	}
+
+	virtual_din_edge_pin = (uint8_t)pin;
+	virtual_din_edge_next = (uint64_t)strtoul(end + 1, NULL, 10) * VIRTUAL_TICKS_PER_MS;
+	virtual_din_edge_armed = true;
+}
+
+// the step/dir outputs feed the trace and the simulated switches
+static void virtual_step_io(uint8_t type, uint8_t mask)
+{
+	if (virtual_trace_fp)
+	{
+		virtual_trace_io(type, mask);
+	}
+
+	if (virtual_switches_enabled)
+	{
+		virtual_switches_io(type, mask);
+	}
+}
+
+#ifdef ENABLE_STEP_DMA
+// step/dir levels at the port
+static uint16_t virtual_dma_levels;
+
+static void virtual_dma_output(uint16_t changed)
+{
+	for (uint8_t i = 0; i < 16; i++)
+	{
+		if (changed & (1 << i))
+		{
+			if (virtual_dma_levels & (1 << i))
+			{
+				mcu_set_output(i + 1);
+			}
+			else
+			{
+				mcu_clear_output(i + 1);
+			}
+		}
+	}
+}
+
+static void virtual_dma_play(void)
+{
+	uint16_t slot = virtual_dma_slot;
+	step_dma_word_t word = step_dma_buffer[0][slot];
+
+	if (word)
+	{
+		uint16_t levels = (virtual_dma_levels & ~(uint16_t)(word >> 16)) | (uint16_t)word;
+		uint16_t changed = levels ^ virtual_dma_levels;
+		uint8_t invert = g_settings.step_invert_mask;
+		uint8_t steps = (uint8_t)virtual_dma_levels;
+		// step outputs that go active (a step) and that go back to idle
+		uint8_t rising = (uint8_t)changed & ((uint8_t)levels ^ invert);
+		uint8_t falling = (uint8_t)changed & ~rising;
+		virtual_dma_levels = levels;
+		virtual_dma_output(changed);
+
+		if (virtual_trace_fp)
+		{
+			if (changed >> 8)
+			{
+				virtual_trace_io(IO_TRACE_SET_DIRS, (uint8_t)(levels >> 8) ^ g_settings.dir_invert_mask);
+			}
+			if (falling)
+			{
+				steps ^= falling;
+				virtual_trace_io(IO_TRACE_SET_STEPS, steps);
+			}
+			if (rising)
+			{
+				virtual_trace_io(IO_TRACE_TOGGLE_STEPS, rising);
+			}
+		}
+	}
+
+	slot++;
+	if (slot == STEP_DMA_HALF_SIZE || slot == STEP_DMA_BUFFER_SIZE)
+	{
+		uint8_t half = (slot == STEP_DMA_BUFFER_SIZE) ? 1 : 0;
+		if (virtual_trace_fp)
+		{
+			int32_t position[STEPPER_COUNT];
+			if (step_dma_get_half_position(half, position))
+			{
+				virtual_trace_write_position(position);
+			}
+		}
+		step_dma_half_done(half);
+	}
+
+	virtual_dma_slot = (slot != STEP_DMA_BUFFER_SIZE) ? slot : 0;
+}
+#endif
+
+char *strupr(char *str)
+{
+	for (char *c = str; *c; c++)
+	{
+		if (*c >= 'a' && *c <= 'z')
+		{
+			*c -= 32;
+		}
+	}
+
+	return str;
+}
+
+#ifdef ENABLE_DUAL_CORE_MOTION
+/**
+ * Motion core emulation
+ * A second thread runs the interpolator (cnc_motion_core_dotasks) and fires the step timer events.
+ * On simulated time the main core publishes its time after each RTC tick and waits for the motion core
+ * to fire all the step events up to the published time before starting the next tick,
+ * so both cores run concurrently within each tick.
+ * On realtime both cores follow the host clock.
+ * */
+static pthread_t virtual_motion_thread;
+static volatile bool virtual_motion_running;
+static volatile uint64_t virtual_main_ticks;
+static volatile uint64_t virtual_motion_ticks;
+
+static void *virtual_motion_core_run(void *arg)
+{
+	(void)arg;
+	virtual_motion_core = true;
+	virtual_ticks = ATOMIC_LOAD_ACQUIRE(virtual_main_ticks);
+	mcu_enable_global_isr();
+
+	while (ATOMIC_LOAD_ACQUIRE(virtual_motion_running))
+	{
+		cnc_motion_core_dotasks();
+		uint64_t target = (virtual_simulated_time) ? ATOMIC_LOAD_ACQUIRE(virtual_main_ticks) : virtual_wall_ticks();
+		if (target > virtual_ticks)
+		{
+			virtual_run_until(target);
+		}
+		else if (virtual_simulated_time)
+		{
+			// waits for the main core to start the next tick
+			sched_yield();
+		}
+
+		if (!virtual_simulated_time && !virtual_itp_running)
+		{
+			// idle (nothing to step)
+			struct timespec idle = {.tv_sec = 0, .tv_nsec = 100000};
+			nanosleep(&idle, NULL);
+		}
+
+		ATOMIC_STORE_RELEASE(virtual_motion_ticks, virtual_ticks);
+	}
+
+	return NULL;
+}
+
+static void virtual_motion_core_start(void)
+{
+	ATOMIC_STORE_RELEASE(virtual_main_ticks, virtual_ticks);
+	ATOMIC_STORE_RELEASE(virtual_motion_ticks, virtual_ticks);
+	ATOMIC_STORE_RELEASE(virtual_motion_running, true);
+	if (pthread_create(&virtual_motion_thread, NULL, virtual_motion_core_run, NULL))
+	{
+		perror("virtual motion core");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void virtual_motion_core_stop(void)
+{
+	ATOMIC_STORE_RELEASE(virtual_motion_running, false);
+	pthread_join(virtual_motion_thread, NULL);
+}
+
+// the main core only starts a new tick after the motion core caught up with the previous one
+static void virtual_motion_core_sync(void)
+{
+	while (ATOMIC_LOAD_ACQUIRE(virtual_motion_ticks) < ATOMIC_LOAD_ACQUIRE(virtual_main_ticks))
+	{
+		sched_yield();
+	}
+}
+#endif
+
+/**
+ * MCU
+ * */
+void mcu_init(void)
+{
+	mcu_io_init();
+	virtual_eeprom_init();
+	virtual_uart_init();
+	virtual_trace_init();
+	virtual_switches_init();
+	virtual_din_edge_init();
+	if (virtual_trace_fp || virtual_switches_enabled)
+	{
+		HOOK_ATTACH_CALLBACK(io_step_trace, virtual_step_io);
+	}
+	virtual_fs_init();
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	virtual_wall_start = (((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000ULL)) * VIRTUAL_TICKS_PER_US;
+	virtual_ticks = 0;
+	virtual_rtc_next = VIRTUAL_TICKS_PER_MS;
+	mcu_enable_global_isr();
+}
+
+#ifdef ENABLE_TELEMETRY
+// keeps running for one more telemetry period after the input is executed
+// so that the capture ends with a sample of the final position and state
+static bool virtual_telemetry_flushed(void)
+{
+	static uint32_t exit_millis = 0;
+	uint16_t period = proto_telemetry_get_period();
+	if (!period)
+	{
+		return true;
+	}
+
+	if (!exit_millis)
+	{
+		exit_millis = mcu_millis() + period + 1;
+	}
+
+	return (mcu_millis() > exit_millis);
+}
+#endif
+
+void mcu_dotasks(void)
+{
+	virtual_uart_read();
+	mcu_uart_flush();
+#ifdef MCU_HAS_UART2
+	virtual_modbus_task();
+#endif
+#ifdef ENABLE_STEP_DMA
+	step_dma_fill();
+#endif
+
+	// a running O-code or file stream is not finished yet
+	if (virtual_uart_eof && !mcu_uart_available() && !grbl_stream_available() && planner_buffer_is_empty() && itp_is_empty() && !cnc_get_exec_state(EXEC_RUN | EXEC_HOMING)
+#ifdef ENABLE_TELEMETRY
+		&& virtual_telemetry_flushed()
+#endif
+#ifdef ENABLE_MODBUS_ASYNC
+		&& !modbus_pending()
+#endif
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+		// a motion is waiting for the steppers to cool
+		&& !duty_cycle_is_waiting()
+#endif
+#ifdef ENABLE_SYNC_OUTPUTS
+		&& !sync_output_has_report()
+#endif
+#ifdef ENABLE_ARMED_START
+		&& !armed_start_has_report()
+#endif
+	)
+	{
+#ifdef ENABLE_STEP_DMA
+		if (virtual_dma_running)
+		{
+			// the buffered steps are still being played
+			virtual_run_until(virtual_ticks + VIRTUAL_TICKS_PER_MS);
+			return;
+		}
+		step_dma_stats_t stats;
+		step_dma_get_stats(&stats);
+		fprintf(stderr, "step dma: %u halves played, %u underruns, %u slots min margin\n", stats.halves, stats.underruns, stats.min_margin);
+#endif
+#ifdef MCU_HAS_UART2
+		fprintf(stderr, "modbus slave: %u requests, %u dropped\n", virtual_modbus_requests, virtual_modbus_dropped);
+#endif
+#ifdef ENABLE_MODBUS_ASYNC
+		modbus_stats_t modbus;
+		modbus_get_stats(&modbus);
+		fprintf(stderr, "modbus master: %u sent, %u completed, %u retries, %u failed, %u dropped, %ums max latency\n", modbus.sent, modbus.completed, modbus.retries, modbus.failed, modbus.dropped, modbus.max_latency);
+#endif
+#ifdef ENABLE_DUAL_CORE_MOTION
+		virtual_motion_core_stop();
+		planner_handoff_stats_t handoff;
+		planner_handoff_get_stats(&handoff);
+		fprintf(stderr, "dual core: %u blocks handed off, %u before the look-ahead was final\n", handoff.blocks, handoff.early);
+#endif
+		// the whole input was consumed and executed
+		mcu_eeprom_flush();
+#ifdef ENABLE_FLASH_KV
+		virtual_flash_report();
+#endif
+		exit(EXIT_SUCCESS);
+	}
+
+	if (virtual_simulated_time)
+	{
+#ifdef ENABLE_DUAL_CORE_MOTION
+		virtual_motion_core_sync();
+#endif
+		// advance one RTC tick
+		virtual_run_until(virtual_rtc_next);
+#ifdef ENABLE_DUAL_CORE_MOTION
+		ATOMIC_STORE_RELEASE(virtual_main_ticks, virtual_ticks);
+#endif
+		return;
+	}
+
+	uint64_t now = virtual_wall_ticks();
+	if (now <= virtual_ticks)
+	{
+		// ahead of the host clock (nothing to emulate yet)
+		// sleep until the next RTC tick or new input arrives
+		int timeout = (int)((virtual_rtc_next - now) / VIRTUAL_TICKS_PER_MS) + 1;
+		struct pollfd pfd = {.fd = virtual_uart_in, .events = POLLIN};
+		poll(&pfd, (!virtual_uart_eof && BUFFER_WRITE_AVAILABLE(uart_rx)) ? 1 : 0, timeout);
+		now = virtual_wall_ticks();
+	}
+
+	virtual_run_until(now);
+}
+
+static void virtual_usage(const char *name)
+{
+	fprintf(stderr,
+			"usage: %s [options]\n"
+			"  -s, --sim           run on simulated time (as fast as possible)\n"
+			"  -p, --pty           use a pseudo terminal as UART instead of stdin/stdout\n"
+			"  -e, --eeprom FILE   EEPROM backing file (the flash image with ENABLE_FLASH_KV, default: " VIRTUAL_EEPROM_FILE ")\n"
+			"  -t, --trace FILE    record the step/dir outputs to a binary trace file\n"
+			"  -f, --fs DIR        mount the host directory as drive C (/C/...)\n"
+			"  --switches S0,S1,.. simulate a limit switch on each stepper S steps below it's start position\n"
+			"  --din-edge N,MS     toggle DIN<N> (0 to 7) at MS milliseconds and run the input change ISR\n"
+#ifdef ENABLE_FLASH_KV
+			"  --flash-fail N      the power fails at the Nth flash erase/program operation (exit code 3)\n"
+#endif
+#ifdef MCU_HAS_UART2
+			"  --modbus-delay MS   response time of the simulated Modbus slave on UART2 (default: 10)\n"
+			"  --modbus-drop N     the simulated Modbus slave ignores every Nth request\n"
+#endif
+			"  -h, --help          show this help\n",
+			name);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option options[] = {
+		{"sim", no_argument, NULL, 's'},
+		{"pty", no_argument, NULL, 'p'},
+		{"eeprom", required_argument, NULL, 'e'},
+		{"trace", required_argument, NULL, 't'},
+		{"fs", required_argument, NULL, 'f'},
+		{"switches", required_argument, NULL, 'L'},
+		{"din-edge", required_argument, NULL, 'I'},
+#ifdef ENABLE_FLASH_KV
+		{"flash-fail", required_argument, NULL, 'F'},
+#endif
+#ifdef MCU_HAS_UART2
+		{"modbus-delay", required_argument, NULL, 'M'},
+		{"modbus-drop", required_argument, NULL, 'D'},
+#endif
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0}};
+
+	int opt;
+	while ((opt = getopt_long(argc, argv, "spe:t:f:h", options, NULL)) != -1)
+	{
+		switch (opt)
+		{
+		case 's':
+			virtual_simulated_time = true;
+			break;
+		case 'p':
+			virtual_use_pty = true;
+			break;
+		case 'e':
+			virtual_eeprom_file = optarg;
+			break;
+		case 't':
+			virtual_trace_file = optarg;
+			break;
+		case 'f':
+			virtual_fs_root = optarg;
+			break;
+		case 'L':
+			virtual_switches_arg = optarg;
+			break;
+		case 'I':
+			virtual_din_edge_arg = optarg;
+			break;
+#ifdef ENABLE_FLASH_KV
+		case 'F':
+			virtual_flash_fail_at = (uint32_t)atol(optarg);
+			break;
+#endif
+#ifdef MCU_HAS_UART2
+		case 'M':
+			virtual_modbus_delay = (uint32_t)atol(optarg);
+			break;
+		case 'D':
+			virtual_modbus_drop = (uint32_t)atol(optarg);
+			break;
+#endif
+		case 'h':
+			virtual_usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			virtual_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	cnc_init();
+#ifdef ENABLE_DUAL_CORE_MOTION
+	virtual_motion_core_start();
+#endif
+	for (;;)
+	{
+		cnc_run();
+	}
+
+	return 0;
+}
+
+#endif
@@ -38,6 +38,7 @@
 
 #define MCU_WEAK __attribute__((weak,weakref))
 
+#if (MCU == MCU_VIRTUAL_WIN)
 /* 7.18.2.1  Limits of exact-width integer types */
 #define INT8_MIN (-128)
 #define INT16_MIN (-32768)
@@ -53,6 +54,7 @@
 #define UINT16_MAX 65535
 #define UINT32_MAX 0xffffffffU					 /* 4294967295U */
 #define UINT64_MAX 0xffffffffffffffffULL /* 18446744073709551615ULL */
+#endif
 
 // needed by software delays
 #ifndef MCU_CLOCKS_PER_CYCLE
@@ -66,11 +68,17 @@
 #endif
 
 #define MCU_HAS_UART
+#if (MCU == MCU_VIRTUAL_WIN)
 #ifndef UART_PORT_NAME
 #define UART_PORT_NAME "\\\\.\\COM14"
 #endif
 
 #define MCU_HAS_UART2
+#endif
+// the Linux UART2 is a simulated Modbus slave (VFD)
+#if (MCU == MCU_VIRTUAL_LINUX) && defined(DETACH_UART2_FROM_MAIN_PROTOCOL)
+#define MCU_HAS_UART2
+#endif
 
 // #define EMULATE_74HC595
 
@@ -306,6 +314,17 @@
 #define DIO136 136
 #define DIN7 137
 #define DIO137 137
+#if (MCU == MCU_VIRTUAL_LINUX)
+// the input change ISR runs on scheduled edges (--din-edge)
+#define DIN0_ISR
+#define DIN1_ISR
+#define DIN2_ISR
+#define DIN3_ISR
+#define DIN4_ISR
+#define DIN5_ISR
+#define DIN6_ISR
+#define DIN7_ISR
+#endif
 #else
 #define IC74HC165_COUNT 4
 #define LIMIT_X_IO_OFFSET 0
@@ -437,6 +456,11 @@
 
 #define MCU_HAS_ONESHOT_TIMER
 
+// the motion core is emulated by a second thread
+#ifdef ENABLE_DUAL_CORE_MOTION
+#define MCU_HAS_DUAL_CORE
+#endif
+
 #ifndef BOARD_HAS_CUSTOM_SYSTEM_COMMANDS
 #define BOARD_HAS_CUSTOM_SYSTEM_COMMANDS
 #endif
@@ -461,10 +485,77 @@ extern void virtual_delay_us(uint16_t delay);
 extern const tool_t spindle_pwm;
 extern const tool_t laser_ppi;
 
+#if (MCU == MCU_VIRTUAL_WIN)
 #define EMULATION_MS_TICK 100
 #define ENABLE_ITP_FEED_TASK
+#endif
 #define ENABLE_PIN_DEBUG_EXTRA_CMD
 
+#if (MCU == MCU_VIRTUAL_LINUX)
+// the Linux virtual MCU emulates the step timer of a 72MHz STM32F1
+// so the step period quantization matches the target board
+#ifndef VIRTUAL_TIMER_CLOCK
+#define VIRTUAL_TIMER_CLOCK 72000000UL
+#endif
+// integer step rate to timer conversion (ENABLE_ITP_FIXED_POINT)
+#define MCU_HAS_FIXED_FREQ_TO_CLOCKS
+// glibc does not provide this (newlib and mingw do)
+extern char *strupr(char *str);
+// step/dir trace hooks (used by the --trace option)
+#ifndef ENABLE_STEP_TRACE
+#define ENABLE_STEP_TRACE
+#endif
+// binary motion stream (makefiles/virtual_linux/gcode_compile.py)
+#ifndef ENABLE_MOTION_STREAM
+#define ENABLE_MOTION_STREAM
+#endif
+// binary telemetry (makefiles/virtual_linux/telemetry_decode.py)
+#ifndef ENABLE_TELEMETRY
+#define ENABLE_TELEMETRY
+#endif
+// cycle profiler (host clock in ns)
+extern uint32_t virtual_cycle_count(void);
+#define mcu_cycle_count() virtual_cycle_count()
+#define MCU_CYCLE_COUNTER_CLOCK 1000000000UL
+#ifndef ENABLE_CYCLE_PROFILER
+#define ENABLE_CYCLE_PROFILER
+#endif
+// motion sampler (uses the step ISR that the DMA step engine replaces)
+#if !defined(ENABLE_MOTION_SAMPLER) && !defined(ENABLE_STEP_DMA)
+#define ENABLE_MOTION_SAMPLER
+#ifndef MOTION_SAMPLER_SIZE
+#define MOTION_SAMPLER_SIZE 1024
+#endif
+#endif
+// DMA step engine (the DMA playback is emulated on a single port with step i on bit i and dir i on bit 8 + i)
+#ifdef ENABLE_STEP_DMA
+#define STEP_DMA_CLOCK VIRTUAL_TIMER_CLOCK
+#define STEP_DMA_IO_PORT(pin) 0
+#define STEP_DMA_IO_BIT(pin) ((pin) - 1)
+#endif
+// flash key/value store (see flash_kv.h) over a simulated flash file with 1KB pages
+#ifdef ENABLE_FLASH_KV
+#ifndef FLASH_KV_BANK_SIZE
+#define FLASH_KV_BANK_SIZE 4096
+#endif
+#endif
+// large RX buffer read a line at a time
+#define MCU_HAS_STREAM_READ
+#ifndef ENABLE_LARGE_STREAM_BUFFERS
+#define ENABLE_LARGE_STREAM_BUFFERS
+#endif
+#ifndef ENABLE_STREAM_BULK_READ
+#define ENABLE_STREAM_BULK_READ
+#endif
+#ifndef RX_BUFFER_CAPACITY
+#define RX_BUFFER_CAPACITY 1024
+#endif
+// windowed streaming (makefiles/virtual_linux/window_sender.py)
+#ifndef ENABLE_WINDOWED_STREAMING
+#define ENABLE_WINDOWED_STREAMING
+#endif
+#endif
+
 #define asm __asm__
 
 #endif
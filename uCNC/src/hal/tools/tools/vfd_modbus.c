@@ -55,6 +55,8 @@
 #ifndef VFD_RETRY_DELAY_MS
 #define VFD_RETRY_DELAY_MS 100
 #endif
+// uncomment to use the hardware UART2 instead of the softuart (needs DETACH_UART2_FROM_MAIN_PROTOCOL)
+// #define VFD_USE_UART2
 
 // comment this to override vfd communication error safety hold
 // #define IGNORE_VFD_COM_ERRORS
@@ -62,8 +64,17 @@
 #define VFD_HOLD_ON_ERROR
 #endif
 
-#if ASSERT_PIN(VFD_TX_PIN) && ASSERT_PIN(VFD_RX_PIN)
+#ifdef VFD_USE_UART2
+#if !defined(MCU_HAS_UART2) || !defined(DETACH_UART2_FROM_MAIN_PROTOCOL)
+#error "VFD_USE_UART2 needs the UART2 detached from the main protocol (DETACH_UART2_FROM_MAIN_PROTOCOL)"
+#endif
+#define VFD_PORT NULL
+#elif ASSERT_PIN(VFD_TX_PIN) && ASSERT_PIN(VFD_RX_PIN)
 SOFTUART(vfd_uart, VFD_BAUDRATE, VFD_TX_PIN, VFD_RX_PIN)
+#define VFD_PORT &vfd_uart
+#endif
+
+#ifdef VFD_PORT
 
 #define VFD_STOPPED 0
 #define VFD_RUN_CW 2
@@ -76,6 +87,10 @@ typedef struct vfd_state
 	volatile uint8_t needs_update : 1;
 	volatile int16_t rpm;
 	float rpm_hz;
+#ifdef ENABLE_MODBUS_ASYNC
+	uint8_t busy : 1;
+	uint16_t true_rpm;
+#endif
 } vfd_state_t;
 
 static vfd_state_t vfd_state;
@@ -240,6 +255,7 @@ static vfd_state_t vfd_state;
 #define VFD_OUT_DIV g_settings.spindle_max_rpm
 #endif
 
+#ifndef ENABLE_MODBUS_ASYNC
 static bool modvfd_command(uint8_t *cmd, modbus_response_t *response)
 {
 	// checks if is dummy command
@@ -256,8 +272,8 @@ static bool modvfd_command(uint8_t *cmd, modbus_response_t *response)
 	vfd_state.needs_update = false;
 	while (retries--)
 	{
-		send_request(request, cmd[0], &vfd_uart);
-		if (read_response(response, cmd[1], &vfd_uart, VFD_TIMEOUT))
+		send_request(request, cmd[0], VFD_PORT);
+		if (read_response(response, cmd[1], VFD_PORT, VFD_TIMEOUT))
 		{
 			return true;
 		}
@@ -426,6 +442,242 @@ uint8_t vfd_update(void)
 	return STATUS_OK;
 }
 
+#else
+/**
+ *
+ * Asynchronous mode
+ * The commands of each update (direction, speed and run) are chained by the transaction callbacks
+ * and the tool callbacks return without waiting for the VFD.
+ *
+ * */
+#define VFD_ASYNC_RPM_HZ 0
+#define VFD_ASYNC_STOP 1
+#define VFD_ASYNC_CW 2
+#define VFD_ASYNC_CCW 3
+#define VFD_ASYNC_SETRPM 4
+#define VFD_ASYNC_RUN 5
+#define VFD_ASYNC_GETRPM 6
+
+static void vfd_async_next(void);
+
+static void vfd_async_done(modbus_transaction_t *transaction, uint8_t status, modbus_response_t *response, uint8_t len)
+{
+	vfd_state.busy = 0;
+	if (status != MODBUS_OK)
+	{
+		if (status != MODBUS_ERROR_ABORTED)
+		{
+			vfd_state.connected = 0;
+			proto_feedback("VFD COMMUNICATION FAILED");
+#ifdef VFD_HOLD_ON_ERROR
+			cnc_call_rt_command(CMD_CODE_FEED_HOLD);
+#endif
+		}
+		return;
+	}
+
+	// the value is in the 2 bytes before the CRC
+	uint16_t value = (len >= 6) ? ((((uint16_t)response->data[len - 6]) << 8) | response->data[len - 5]) : 0;
+	switch ((uint8_t)(uintptr_t)transaction->user)
+	{
+	case VFD_ASYNC_RPM_HZ:
+		vfd_state.rpm_hz = value;
+		if (!value)
+		{
+			// not a valid answer (waits for the next update)
+			vfd_state.needs_update = false;
+			return;
+		}
+		vfd_state.connected = 1;
+		break;
+	case VFD_ASYNC_STOP:
+		vfd_state.running = VFD_STOPPED;
+		vfd_state.true_rpm = 0;
+		break;
+	case VFD_ASYNC_CW:
+		vfd_state.running = VFD_RUN_CW;
+		break;
+	case VFD_ASYNC_CCW:
+		vfd_state.running = VFD_RUN_CCW;
+		break;
+#ifdef VFD_RUN_CMD
+	case VFD_ASYNC_SETRPM:
+		// the speed is followed by the run command
+		if (vfd_async_submit(VFD_ASYNC_RUN))
+		{
+			return;
+		}
+		break;
+#endif
+	case VFD_ASYNC_GETRPM:
+		vfd_state.true_rpm = (uint16_t)((float)value * VFD_IN_MULT / VFD_IN_DIV);
+		break;
+	}
+
+	vfd_async_next();
+}
+
+static bool vfd_async_submit(uint8_t id)
+{
+	uint8_t cmd[7];
+	int16_t rpm = vfd_state.rpm;
+
+	switch (id)
+	{
+	case VFD_ASYNC_RPM_HZ:
+	{
+		const uint8_t rpm_hz_cmd[] = VFD_RPM_HZ_CMD;
+		if (!rpm_hz_cmd[0])
+		{
+			// dummy command (the conversion does not need the VFD max frequency)
+			vfd_state.rpm_hz = 1;
+			vfd_state.connected = 1;
+			vfd_async_next();
+			return true;
+		}
+		memcpy(cmd, rpm_hz_cmd, 7);
+	}
+	break;
+	case VFD_ASYNC_STOP:
+	{
+		const uint8_t stop_cmd[7] = VFD_STOP_CMD;
+		memcpy(cmd, stop_cmd, 7);
+	}
+	break;
+	case VFD_ASYNC_CW:
+	{
+		const uint8_t cw_cmd[7] = VFD_CW_CMD;
+		memcpy(cmd, cw_cmd, 7);
+	}
+	break;
+	case VFD_ASYNC_CCW:
+	{
+		const uint8_t ccw_cmd[7] = VFD_CCW_CMD;
+		memcpy(cmd, ccw_cmd, 7);
+	}
+	break;
+	case VFD_ASYNC_SETRPM:
+	{
+		const uint8_t setrpm_cmd[7] = VFD_SETRPM_CMD;
+		memcpy(cmd, setrpm_cmd, 7);
+		uint16_t hz = (uint16_t)lroundf((float)ABS(rpm) * VFD_OUT_MULT / VFD_OUT_DIV);
+		// cmd starts at index 1 not at 0
+		uint8_t i = cmd[0] - 4 + 1;
+		cmd[i] = (uint8_t)(hz >> 8);
+		cmd[i + 1] = (uint8_t)(hz & 0xFF);
+	}
+	break;
+#ifdef VFD_RUN_CMD
+	case VFD_ASYNC_RUN:
+	{
+		const uint8_t run_cmd[7] = VFD_RUN_CMD;
+		memcpy(cmd, run_cmd, 7);
+	}
+	break;
+#endif
+	default:
+	{
+		const uint8_t getrpm_cmd[7] = VFD_GETRPM_CMD;
+		memcpy(cmd, getrpm_cmd, 7);
+	}
+	break;
+	}
+
+	modbus_transaction_t transaction = {0};
+	memcpy(&transaction.request, &cmd[1], 6);
+	transaction.request.address = VFD_ADDRESS;
+	transaction.tx_len = cmd[0];
+	// the Huanyang type 1 frames don't have the standard length
+	transaction.rx_len = (VFD_CONTROLLER == VFD_HUANYANG_TYPE1) ? cmd[1] : 0;
+	transaction.retries = VFD_MAX_COMMAND_RETRIES;
+	transaction.timeout = VFD_TIMEOUT;
+	transaction.retry_delay = VFD_RETRY_DELAY_MS;
+	transaction.port = VFD_PORT;
+	transaction.callback = &vfd_async_done;
+	transaction.user = (void *)(uintptr_t)id;
+	if (!modbus_submit(&transaction))
+	{
+		return false;
+	}
+
+	vfd_state.busy = 1;
+	return true;
+}
+
+// sends the next command of the update (one at a time)
+static void vfd_async_next(void)
+{
+	if (vfd_state.busy || !vfd_state.loaded)
+	{
+		return;
+	}
+
+	if (vfd_state.needs_update)
+	{
+		if (!vfd_state.connected)
+		{
+			vfd_async_submit(VFD_ASYNC_RPM_HZ);
+			return;
+		}
+
+		int16_t rpm = vfd_state.rpm;
+		uint8_t id = VFD_ASYNC_SETRPM;
+		if (!rpm)
+		{
+			id = VFD_ASYNC_STOP;
+		}
+		else if (rpm < 0 && vfd_state.running != VFD_RUN_CCW)
+		{
+			id = VFD_ASYNC_CCW;
+		}
+		else if (rpm > 0 && vfd_state.running != VFD_RUN_CW)
+		{
+			id = VFD_ASYNC_CW;
+		}
+
+		// the direction change is followed by the speed (checked on the next call)
+		if (id == VFD_ASYNC_SETRPM || id == VFD_ASYNC_STOP)
+		{
+			vfd_state.needs_update = false;
+		}
+		if (!vfd_async_submit(id))
+		{
+			// queue full (retried on the next update or speed report)
+			vfd_state.needs_update = true;
+		}
+	}
+}
+
+uint8_t vfd_update(void)
+{
+	vfd_state.needs_update = true;
+	vfd_async_next();
+	return STATUS_OK;
+}
+
+static uint16_t vfd_get_rpm(bool truerpm)
+{
+	if (!vfd_state.loaded)
+	{
+		return 0;
+	}
+
+	if (truerpm)
+	{
+		// returns the last value read and polls the VFD for the next report
+		if (vfd_state.connected && !vfd_state.needs_update && vfd_state.running != VFD_STOPPED && !vfd_state.busy)
+		{
+			vfd_async_submit(VFD_ASYNC_GETRPM);
+		}
+		vfd_async_next();
+		return vfd_state.true_rpm;
+	}
+
+	return (uint16_t)ABS(vfd_state.rpm);
+}
+#endif
+
+
 /**
  *
  * Tool callbacks
@@ -434,18 +686,29 @@ uint8_t vfd_update(void)
 
 static void startup_code()
 {
+#ifndef VFD_USE_UART2
 	// initialize soft uart tx
 	vfd_uart.tx(true);
+#endif
 	// cnc_delay_ms(200);
 	vfd_state.rpm = 0;
+#ifdef ENABLE_MODBUS_ASYNC
+	vfd_state.loaded = 1;
+#endif
 	vfd_update();
 }
 
 static void shutdown_code()
 {
 	vfd_state.rpm = 0;
+#ifdef ENABLE_MODBUS_ASYNC
+	// the stop command is sent before the tool is unloaded
+	vfd_update();
+	vfd_state.loaded = 0;
+#else
 	vfd_stop();
 	vfd_state.connected = 0;
+#endif
 }
 
 static void set_speed(int16_t value)
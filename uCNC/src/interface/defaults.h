@@ -289,6 +289,33 @@ extern "C"
 #define DEFAULT_LASER_PPI_USWIDTH 1500
 #endif
 
+// duty cycle limit (on time and cooling time in seconds)
+#if (!defined(DEFAULT_DUTY_CYCLE_ON_TIME))
+#define DEFAULT_DUTY_CYCLE_ON_TIME 120
+#endif
+
+#if (!defined(DEFAULT_DUTY_CYCLE_OFF_TIME))
+#define DEFAULT_DUTY_CYCLE_OFF_TIME 1080
+#endif
+
+// jerk limited planner (max jerk in mm/s^3)
+#if (!defined(DEFAULT_JERK))
+#define DEFAULT_JERK 1000
+#endif
+
+// input shaping (frequency in Hz, 0 disables, damping ratio and impulse train 0 - ZV, 1 - ZVD, 2 - EI)
+#if (!defined(DEFAULT_INPUT_SHAPER_FREQ))
+#define DEFAULT_INPUT_SHAPER_FREQ 0
+#endif
+
+#if (!defined(DEFAULT_INPUT_SHAPER_DAMPING))
+#define DEFAULT_INPUT_SHAPER_DAMPING 0.1
+#endif
+
+#if (!defined(DEFAULT_INPUT_SHAPER_TYPE))
+#define DEFAULT_INPUT_SHAPER_TYPE 0
+#endif
+
 #define DEFAULT_PID ({0, 0, 0})
 
 #ifdef __cplusplus
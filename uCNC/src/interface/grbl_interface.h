@@ -109,6 +109,8 @@ extern "C"
 #define STATUS_STREAM_FAILED 58
 #define STATUS_JOG_CANCELED 59
 #define STATUS_MAXIMUM_PARAMS_PER_BLOCK_EXCEEDED 60
+#define STATUS_STREAM_FRAME_ERROR 61
+#define STATUS_STREAM_SEQUENCE_ERROR 62
 #define STATUS_GCODE_EXTENDED_UNSUPPORTED 254 // deprecated
 #define STATUS_CRITICAL_FAIL 255
 
@@ -134,8 +136,14 @@ extern "C"
 #define GRBL_SEND_SYSTEM_INFO (GRBL_SYSTEM_CMD + 14)
 #define GRBL_SEND_SYSTEM_INFO_EXTENDED (GRBL_SYSTEM_CMD + 15)
 #define GRBL_PRINT_PARAM (GRBL_SYSTEM_CMD + 16)
+#define GRBL_SEND_TELEMETRY_PERIOD (GRBL_SYSTEM_CMD + 17)
+#define GRBL_SEND_SAMPLER_STATUS (GRBL_SYSTEM_CMD + 18)
+#define GRBL_SAMPLER_DUMP (GRBL_SYSTEM_CMD + 19)
+#define GRBL_SEND_CYCLE_PROFILER (GRBL_SYSTEM_CMD + 20)
+#define GRBL_SEND_WINDOW_STATUS (GRBL_SYSTEM_CMD + 21)
+#define GRBL_SEND_ARM_STATUS (GRBL_SYSTEM_CMD + 22)
 
-#define GRBL_SYSTEM_CMD_EXTENDED (GRBL_SYSTEM_CMD + 20)
+#define GRBL_SYSTEM_CMD_EXTENDED (GRBL_SYSTEM_CMD + 23)
 #define GRBL_SYSTEM_CMD_EXTENDED_UNSUPPORTED 253
 
 #define EXEC_ALARM_SOFTRESET -2
@@ -156,6 +164,7 @@ extern "C"
 #define EXEC_ALARM_SPINDLE_SYNC_FAIL 12						 // failed to achieve spindle sync speed
 #define EXEC_ALARM_HARD_LIMIT_NOMOTION 13					 // hard limits were triggered without any motion (position was not lost)
 #define EXEC_ALARM_PLASMA_THC_ARC_START_FAILURE 14 // failed to start arc with plasma THC
+#define EXEC_ALARM_STEP_BUFFER_UNDERRUN 15				 // the DMA step buffer was not refilled in time (position was lost)
 
 #ifndef DISABLE_SAFE_SETTINGS
 #define EXEC_ALARM_SETTINGS_READ_ERROR -3
@@ -263,6 +272,8 @@ extern "C"
 #define MSG_STATUS_LINE "|Ln:"
 #define MSG_STATUS_PIN "|Pn:"
 #define MSG_STATUS_BUF "|Buf:"
+#define MSG_STATUS_DUTY "|Dc:"
+#define MSG_STATUS_DUTY_WAIT "|Dw:"
 
 	// #define MSG_INT "%hd"
 	// #define MSG_FLT "%0.3f"
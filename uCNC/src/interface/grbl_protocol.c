@@ -290,6 +290,105 @@ void proto_error(uint8_t error)
 	proto_print(MSG_EOL);
 }
 
+#ifdef ENABLE_WINDOWED_STREAMING
+static uint8_t proto_window_batch;
+static uint8_t proto_window_pending;
+static uint16_t proto_window_seq;
+static uint32_t proto_window_timeout;
+
+static void proto_window_ack(uint8_t error)
+{
+	if (error != STATUS_OK)
+	{
+		proto_print(MSG_ERROR);
+		proto_itoa(error);
+		proto_putc(',');
+	}
+	else
+	{
+		proto_print(MSG_OK ":");
+	}
+	proto_itoa(proto_window_seq);
+	proto_putc(',');
+	proto_itoa(grbl_stream_write_available());
+	proto_putc(',');
+	proto_itoa(planner_get_buffer_freeblocks());
+	proto_print(MSG_EOL);
+	proto_window_pending = 0;
+}
+
+void proto_window_set_batch(uint8_t batch)
+{
+	if (proto_window_pending)
+	{
+		proto_window_ack(STATUS_OK);
+	}
+	proto_window_batch = MIN(batch, GRBL_WINDOW_MAX_BATCH);
+	// the next line (the $WIN line itself) is line 0
+	proto_window_seq = UINT16_MAX;
+}
+
+uint8_t proto_window_get_batch(void)
+{
+	return proto_window_batch;
+}
+
+uint16_t proto_window_next_seq(void)
+{
+	return (uint16_t)(proto_window_seq + 1);
+}
+
+void proto_window_resync(uint16_t seq)
+{
+	// acks the lines processed with the old count
+	if (proto_window_pending)
+	{
+		proto_window_ack(STATUS_OK);
+	}
+	proto_window_seq = seq - 1;
+}
+
+// sends the pending acks if the oldest one timed out (runs in the main loop)
+void proto_window_flush(void)
+{
+	// never break a text line
+	if (!proto_window_pending || protocol_busy || grbl_stream_busy())
+	{
+		return;
+	}
+
+	if ((int32_t)(mcu_millis() - proto_window_timeout) >= 0)
+	{
+		proto_window_ack(STATUS_OK);
+	}
+}
+#endif
+
+void proto_line_ack(uint8_t error)
+{
+#ifdef ENABLE_WINDOWED_STREAMING
+	if (proto_window_batch)
+	{
+		proto_window_seq++;
+		if (error == STATUS_OK)
+		{
+			// coalesces the acks while there are more lines to process
+			if (!proto_window_pending++)
+			{
+				proto_window_timeout = mcu_millis() + GRBL_WINDOW_ACK_TIMEOUT;
+			}
+			if (proto_window_pending < proto_window_batch && grbl_stream_available())
+			{
+				return;
+			}
+		}
+		proto_window_ack(error);
+		return;
+	}
+#endif
+	proto_error(error);
+}
+
 void proto_alarm(int8_t alarm)
 {
 	grbl_stream_start_broadcast();
@@ -588,6 +687,10 @@ void proto_status(void)
 
 	proto_status_tail();
 
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+	duty_cycle_status();
+#endif
+
 	EVENT_INVOKE(proto_status, NULL);
 
 	if ((g_settings.status_report_mask & 2))
@@ -601,6 +704,123 @@ void proto_status(void)
 	proto_print(">" MSG_EOL);
 }
 
+#if (defined(ENABLE_TELEMETRY) || defined(ENABLE_MOTION_SAMPLER))
+static uint16_t proto_frame_crc;
+
+void proto_frame_start(void)
+{
+	grbl_stream_start_broadcast();
+	proto_putc(PROTO_FRAME_START);
+	proto_frame_crc = 0xFFFF;
+}
+
+void proto_frame_write(const void *data, uint8_t len)
+{
+	const uint8_t *ptr = (const uint8_t *)data;
+	uint16_t crc = proto_frame_crc;
+	while (len--)
+	{
+		uint8_t c = *ptr++;
+		crc ^= c;
+		for (uint8_t i = 8; i != 0; i--)
+		{
+			crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+		}
+
+		switch (c)
+		{
+		case '\n':
+			proto_putc(PROTO_FRAME_ESC);
+			c = PROTO_FRAME_ESC_EOL;
+			break;
+		case PROTO_FRAME_ESC:
+			proto_putc(PROTO_FRAME_ESC);
+			c = PROTO_FRAME_ESC_ESC;
+			break;
+		}
+		proto_putc(c);
+	}
+	proto_frame_crc = crc;
+}
+
+void proto_frame_end(void)
+{
+	uint8_t crc[2] = {(uint8_t)proto_frame_crc, (uint8_t)(proto_frame_crc >> 8)};
+	proto_frame_write(crc, 2);
+	proto_putc('\n');
+}
+#endif
+
+#ifdef ENABLE_TELEMETRY
+static uint16_t proto_telemetry_period;
+static uint16_t proto_telemetry_counter;
+static uint8_t proto_telemetry_seq;
+static proto_telemetry_t proto_telemetry_data;
+// set by the RTC tick when a new sample is available and cleared by the main loop after sending it
+static volatile bool proto_telemetry_ready;
+
+void proto_telemetry_set_period(uint16_t period)
+{
+	proto_telemetry_period = period;
+	proto_telemetry_counter = period;
+}
+
+uint16_t proto_telemetry_get_period(void)
+{
+	return proto_telemetry_period;
+}
+
+// runs in the RTC ISR
+void proto_telemetry_sample(uint32_t millis)
+{
+	if (!proto_telemetry_period || --proto_telemetry_counter)
+	{
+		return;
+	}
+
+	proto_telemetry_counter = proto_telemetry_period;
+	uint8_t seq = proto_telemetry_seq++;
+	// the last sample was not sent yet (this sample is dropped)
+	if (proto_telemetry_ready)
+	{
+		return;
+	}
+
+	proto_telemetry_t *data = &proto_telemetry_data;
+	data->type = PROTO_FRAME_TELEMETRY;
+	data->seq = seq;
+	data->steppers = STEPPER_COUNT;
+	data->state = cnc_get_exec_state(0xFF);
+	data->millis = millis;
+	data->feed = itp_get_rt_feed();
+	data->limits = io_get_limits();
+	data->controls = io_get_controls();
+	data->flags = (io_get_probe() ? PROTO_TELEMETRY_PROBE : 0) | (cnc_has_alarm() ? PROTO_TELEMETRY_ALARM : 0) | (mc_get_checkmode() ? PROTO_TELEMETRY_CHECKMODE : 0);
+	data->reserved = 0;
+	// the step ISR can preempt the RTC ISR
+	__ATOMIC__
+	{
+		io_get_steps_pos(data->steps);
+	}
+	proto_telemetry_ready = true;
+}
+
+// sends the pending sample (runs in the main loop)
+void proto_telemetry(void)
+{
+	// never break a text line
+	if (!proto_telemetry_ready || protocol_busy || grbl_stream_busy())
+	{
+		return;
+	}
+
+	proto_frame_start();
+	proto_frame_write(&proto_telemetry_data, sizeof(proto_telemetry_t));
+	proto_telemetry_ready = false;
+	proto_frame_end();
+}
+#endif
+
 void proto_gcode_coordsys(void)
 {
 	protocol_busy = true;
@@ -956,6 +1176,42 @@ void proto_pins_states(void)
 }
 #endif
 
+#ifdef ENABLE_CYCLE_PROFILER
+static void proto_cycle_profiler_section(const char *name, uint8_t section)
+{
+	cycle_profiler_section_t data;
+	cycle_profiler_get(section, &data);
+	uint8_t buckets = CYCLE_PROFILER_BUCKETS;
+	while (buckets && !data.histogram[buckets - 1])
+	{
+		buckets--;
+	}
+
+	proto_print("[PRF:");
+	proto_puts(name);
+	proto_printf(",%lu,%lu,%lu,%lu", data.count, data.min, (uint32_t)((data.count) ? (data.sum / data.count) : 0), data.max);
+	for (uint8_t i = 0; i < buckets; i++)
+	{
+		proto_printf(",%lu", data.histogram[i]);
+	}
+	proto_print(MSG_FEEDBACK_END);
+}
+
+void proto_cycle_profiler(void)
+{
+	protocol_busy = true;
+	proto_printf("[PRF:%lu" MSG_FEEDBACK_END, (uint32_t)MCU_CYCLE_COUNTER_CLOCK);
+	proto_cycle_profiler_section(__romstr__("STEP"), CYCLE_PROFILER_STEP);
+	proto_cycle_profiler_section(__romstr__("STEPRST"), CYCLE_PROFILER_STEP_RESET);
+	proto_cycle_profiler_section(__romstr__("RTC"), CYCLE_PROFILER_RTC);
+	proto_cycle_profiler_section(__romstr__("ITP"), CYCLE_PROFILER_ITP);
+	proto_cycle_profiler_section(__romstr__("PLANNER"), CYCLE_PROFILER_PLANNER);
+	proto_cycle_profiler_section(__romstr__("IO"), CYCLE_PROFILER_IO);
+	proto_cycle_profiler_section(__romstr__("PARSER"), CYCLE_PROFILER_PARSER);
+	protocol_busy = false;
+}
+#endif
+
 #ifdef ENABLE_SYSTEM_INFO
 #ifndef KINEMATIC_TYPE_STR
 #define KINEMATIC_TYPE_STR "UK" /*undefined kynematic*/
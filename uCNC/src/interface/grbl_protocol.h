@@ -36,6 +36,7 @@ extern "C"
 	void proto_puts(const char *str);
 #define proto_print(s) proto_puts(__romstr__(s))
 	void proto_error(uint8_t error);
+	void proto_line_ack(uint8_t error);
 	void proto_alarm(int8_t alarm);
 	void proto_status(void);
 	DECL_EVENT_HANDLER(proto_status);
@@ -55,6 +56,93 @@ extern "C"
 #ifdef ENABLE_PIN_DEBUG_EXTRA_CMD
 	void proto_pins_states(void);
 #endif
+#ifdef ENABLE_CYCLE_PROFILER
+	void proto_cycle_profiler(void);
+#endif
+
+#if (defined(ENABLE_TELEMETRY) || defined(ENABLE_MOTION_SAMPLER))
+/**
+ * Binary frames
+ * Each frame is a single line made of the start byte followed by the escaped
+ * frame data (little endian, the first byte is the frame type) and its CRC16 (MODBUS, LSB first), terminated by '\n'.
+ * Inside the frame '\n' is sent as ESC ESC_EOL and ESC as ESC ESC_ESC.
+ * The start byte is never used by the text protocol, so a host can split the output in lines
+ * and decode those that start with it (see makefiles/virtual_linux/telemetry_decode.py).
+ * */
+#define PROTO_FRAME_START 0xA5
+#define PROTO_FRAME_ESC 0xDB
+#define PROTO_FRAME_ESC_EOL 0xDC
+#define PROTO_FRAME_ESC_ESC 0xDD
+
+// frame types
+#define PROTO_FRAME_TELEMETRY 1
+#define PROTO_FRAME_SAMPLER_HEADER 2
+#define PROTO_FRAME_SAMPLE 3
+
+	void proto_frame_start(void);
+	void proto_frame_write(const void *data, uint8_t len);
+	void proto_frame_end(void);
+#endif
+
+#ifdef ENABLE_TELEMETRY
+/**
+ * Binary telemetry
+ * Sampled in the RTC tick every $TLM=<ms> milliseconds and sent from the main loop as a
+ * PROTO_FRAME_TELEMETRY frame with the proto_telemetry_t struct.
+ * A gap in the sequence number means a sample was dropped because the link was busy.
+ * */
+// flags
+#define PROTO_TELEMETRY_PROBE 1
+#define PROTO_TELEMETRY_ALARM 2
+#define PROTO_TELEMETRY_CHECKMODE 4
+
+	typedef struct proto_telemetry_
+	{
+		uint8_t type;
+		uint8_t seq;
+		uint8_t steppers;
+		uint8_t state; // cnc exec state flags
+		uint32_t millis;
+		float feed; // realtime feed (units/min)
+		uint8_t limits;
+		uint8_t controls;
+		uint8_t flags;
+		uint8_t reserved;
+		int32_t steps[STEPPER_COUNT]; // realtime machine position (steps)
+	} proto_telemetry_t;
+
+	void proto_telemetry_sample(uint32_t millis);
+	void proto_telemetry(void);
+	void proto_telemetry_set_period(uint16_t period);
+	uint16_t proto_telemetry_get_period(void);
+#endif
+#ifdef ENABLE_WINDOWED_STREAMING
+/**
+ * Windowed streaming
+ * $WIN=<n> (1 to GRBL_WINDOW_MAX_BATCH) replaces the ok/error sent after each line by
+ * 	ok:<seq>,<free RX bytes>,<free planner blocks>
+ * 	error:<code>,<seq>,<free RX bytes>,<free planner blocks>
+ * where seq is the 16-bit number of the last line processed (the $WIN=<n> line is line 0).
+ * Each ack covers all lines up to seq. An error is sent right away and an ok is sent after n lines,
+ * when the RX buffer has no more chars or GRBL_WINDOW_ACK_TIMEOUT ms after the oldest pending line was processed.
+ * A line can start with @<seq>. If seq is not the expected line number the line is discarded
+ * with error 62 (STATUS_STREAM_SEQUENCE_ERROR) and the line count continues from seq.
+ * $WIN=0 returns to an ok/error per line and $WIN prints [WIN:<n>,<RX buffer size>,<planner blocks>].
+ * See makefiles/virtual_linux/window_sender.py.
+ * */
+#ifndef GRBL_WINDOW_MAX_BATCH
+#define GRBL_WINDOW_MAX_BATCH 32
+#endif
+#ifndef GRBL_WINDOW_ACK_TIMEOUT
+#define GRBL_WINDOW_ACK_TIMEOUT 10
+#endif
+
+	void proto_window_set_batch(uint8_t batch);
+	uint8_t proto_window_get_batch(void);
+	uint16_t proto_window_next_seq(void);
+	void proto_window_resync(uint16_t seq);
+	void proto_window_flush(void);
+#endif
 #ifdef ENABLE_SYSTEM_INFO
 	void proto_cnc_info(bool extended);
 	DECL_EVENT_HANDLER(proto_cnc_info);
@@ -141,6 +141,18 @@ const settings_t __rom__ default_settings =
 #ifdef ENABLE_BACKLASH_COMPENSATION
 						.backlash_steps = DEFAULT_ARRAY(AXIS_TO_STEPPERS, 0),
 #endif
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+				.duty_cycle_on_time = DEFAULT_ARRAY(STEPPER_COUNT, DEFAULT_DUTY_CYCLE_ON_TIME),
+				.duty_cycle_off_time = DEFAULT_ARRAY(STEPPER_COUNT, DEFAULT_DUTY_CYCLE_OFF_TIME),
+#endif
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+				.jerk = DEFAULT_ARRAY(STEPPER_COUNT, DEFAULT_JERK),
+#endif
+#ifdef ENABLE_INPUT_SHAPING
+				.input_shaper_freq = DEFAULT_ARRAY(STEPPER_COUNT, DEFAULT_INPUT_SHAPER_FREQ),
+				.input_shaper_damping = DEFAULT_ARRAY(STEPPER_COUNT, DEFAULT_INPUT_SHAPER_DAMPING),
+				.input_shaper_type = DEFAULT_ARRAY(STEPPER_COUNT, DEFAULT_INPUT_SHAPER_TYPE),
+#endif
 #ifdef ENABLE_SKEW_COMPENSATION
 				.skew_xy_factor = 0,
 #ifndef SKEW_COMPENSATION_XY_ONLY
@@ -215,6 +227,18 @@ const setting_id_t __rom__ g_settings_id_table[] = {
 #ifdef ENABLE_BACKLASH_COMPENSATION
 		{.id = 140, .memptr = &g_settings.backlash_steps, .type = SETTING_TYPE_UINT16 | SETTING_ARRAY | SETTING_ARRCNT(AXIS_TO_STEPPERS)},
 #endif
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+		{.id = 150, .memptr = &g_settings.duty_cycle_on_time, .type = SETTING_TYPE_UINT16 | SETTING_ARRAY | SETTING_ARRCNT(STEPPER_COUNT)},
+		{.id = 160, .memptr = &g_settings.duty_cycle_off_time, .type = SETTING_TYPE_UINT16 | SETTING_ARRAY | SETTING_ARRCNT(STEPPER_COUNT)},
+#endif
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		{.id = 170, .memptr = &g_settings.jerk, .type = SETTING_TYPE_FLOAT | SETTING_ARRAY | SETTING_ARRCNT(STEPPER_COUNT)},
+#endif
+#ifdef ENABLE_INPUT_SHAPING
+		{.id = 180, .memptr = &g_settings.input_shaper_freq, .type = SETTING_TYPE_FLOAT | SETTING_ARRAY | SETTING_ARRCNT(STEPPER_COUNT)},
+		{.id = 190, .memptr = &g_settings.input_shaper_damping, .type = SETTING_TYPE_FLOAT | SETTING_ARRAY | SETTING_ARRCNT(STEPPER_COUNT)},
+		{.id = 200, .memptr = &g_settings.input_shaper_type, .type = SETTING_TYPE_UINT8 | SETTING_ARRAY | SETTING_ARRCNT(STEPPER_COUNT)},
+#endif
 #ifdef H_MAPPING_EEPROM_STORE_ENABLED
 #define H_MAPING_ARRAY_HALF_SIZE ((H_MAPING_GRID_FACTOR * H_MAPING_GRID_FACTOR) >> 1)
 		{.id = 215, .memptr = &g_settings.hmap_x, .type = SETTING_TYPE_FLOAT},
@@ -90,6 +90,18 @@ extern "C"
 #ifdef ENABLE_BACKLASH_COMPENSATION
 				uint16_t backlash_steps[AXIS_TO_STEPPERS];
 #endif
+#ifdef ENABLE_DUTY_CYCLE_LIMIT
+		uint16_t duty_cycle_on_time[STEPPER_COUNT];
+		uint16_t duty_cycle_off_time[STEPPER_COUNT];
+#endif
+#ifdef ENABLE_JERK_LIMITED_PLANNER
+		float jerk[STEPPER_COUNT];
+#endif
+#ifdef ENABLE_INPUT_SHAPING
+		float input_shaper_freq[STEPPER_COUNT];
+		float input_shaper_damping[STEPPER_COUNT];
+		uint8_t input_shaper_type[STEPPER_COUNT];
+#endif
 #ifdef ENABLE_SKEW_COMPENSATION
 		float skew_xy_factor;
 #ifndef SKEW_COMPENSATION_XY_ONLY
@@ -144,8 +156,13 @@ extern "C"
 #define STARTUP_BLOCKS_COUNT 2
 #endif
 #ifndef STARTUP_BLOCK_SIZE
+#ifdef ENABLE_LARGE_STREAM_BUFFERS
+// keeps the startup blocks size (and the settings layout) independent of the RX buffer size
+#define STARTUP_BLOCK_SIZE (128 + SAFEMARGIN)
+#else
 #define STARTUP_BLOCK_SIZE RX_BUFFER_SIZE
 #endif
+#endif
 #ifndef STARTUP_BLOCK0_ADDRESS_OFFSET
 #ifdef G92_STORE_NONVOLATILE
 #define STARTUP_BLOCK0_ADDRESS_OFFSET (SETTINGS_PARSER_PARAMETERS_ADDRESS_OFFSET + (PARSER_PARAM_ADDR_OFFSET * (TOTAL_COORDINATE_SYSTEMS + 1)))
@@ -153,7 +170,7 @@ extern "C"
 #define STARTUP_BLOCK0_ADDRESS_OFFSET (SETTINGS_PARSER_PARAMETERS_ADDRESS_OFFSET + (PARSER_PARAM_ADDR_OFFSET * TOTAL_COORDINATE_SYSTEMS))
 #endif
 #endif
-#define STARTUP_BLOCK_ADDRESS_OFFSET(NBLOCK) (STARTUP_BLOCK0_ADDRESS_OFFSET + (NBLOCK * RX_BUFFER_SIZE))
+#define STARTUP_BLOCK_ADDRESS_OFFSET(NBLOCK) (STARTUP_BLOCK0_ADDRESS_OFFSET + (NBLOCK * STARTUP_BLOCK_SIZE))
 
 #ifndef MODULES_SETTINGS_ADDRESS_OFFSET
 #define MODULES_SETTINGS_ADDRESS_OFFSET STARTUP_BLOCK_ADDRESS_OFFSET(STARTUP_BLOCKS_COUNT)
@@ -22,6 +22,7 @@
 static grbl_stream_getc_cb stream_getc;
 static grbl_stream_available_cb stream_available;
 static grbl_stream_clear_cb stream_clear;
+static grbl_stream_read_cb stream_read;
 
 static FORCEINLINE void grbl_stream_flush(void);
 
@@ -40,14 +41,21 @@ static volatile uint8_t debug_tx_lines;
 grbl_stream_t *default_stream;
 static grbl_stream_t *current_stream;
 
+// the MCU bulk read callbacks
+#ifdef MCU_HAS_STREAM_READ
+#define MCU_STREAM_READ(read_cb) read_cb
+#else
+#define MCU_STREAM_READ(read_cb) NULL
+#endif
+
 #if defined(MCU_HAS_UART) && !defined(DETACH_UART_FROM_MAIN_PROTOCOL)
-DECL_GRBL_STREAM(uart_grbl_stream, mcu_uart_getc, mcu_uart_available, mcu_uart_clear, mcu_uart_putc, mcu_uart_flush);
+DECL_GRBL_BULK_STREAM(uart_grbl_stream, mcu_uart_getc, mcu_uart_available, mcu_uart_clear, mcu_uart_putc, mcu_uart_flush, MCU_STREAM_READ(mcu_uart_read));
 #endif
 #if defined(MCU_HAS_UART2) && !defined(DETACH_UART2_FROM_MAIN_PROTOCOL)
-DECL_GRBL_STREAM(uart2_grbl_stream, mcu_uart2_getc, mcu_uart2_available, mcu_uart2_clear, mcu_uart2_putc, mcu_uart2_flush);
+DECL_GRBL_BULK_STREAM(uart2_grbl_stream, mcu_uart2_getc, mcu_uart2_available, mcu_uart2_clear, mcu_uart2_putc, mcu_uart2_flush, MCU_STREAM_READ(mcu_uart2_read));
 #endif
 #if defined(MCU_HAS_USB) && !defined(DETACH_USB_FROM_MAIN_PROTOCOL)
-DECL_GRBL_STREAM(usb_grbl_stream, mcu_usb_getc, mcu_usb_available, mcu_usb_clear, mcu_usb_putc, mcu_usb_flush);
+DECL_GRBL_BULK_STREAM(usb_grbl_stream, mcu_usb_getc, mcu_usb_available, mcu_usb_clear, mcu_usb_putc, mcu_usb_flush, MCU_STREAM_READ(mcu_usb_read));
 #endif
 #if defined(MCU_HAS_WIFI) && !defined(DETACH_WIFI_FROM_MAIN_PROTOCOL)
 DECL_GRBL_STREAM(wifi_grbl_stream, mcu_wifi_getc, mcu_wifi_available, mcu_wifi_clear, mcu_wifi_putc, mcu_wifi_flush);
@@ -59,6 +67,16 @@ DECL_GRBL_STREAM(bt_grbl_stream, mcu_bt_getc, mcu_bt_available, mcu_bt_clear, mc
 
 static uint8_t grbl_stream_peek_buffer;
 
+#ifdef ENABLE_STREAM_BULK_READ
+// the current line (or part of it) read from a stream with a bulk read callback
+static uint8_t grbl_stream_line[GRBL_STREAM_LINE_SIZE];
+static buffer_index_t grbl_stream_line_head;
+static buffer_index_t grbl_stream_line_tail;
+#define grbl_stream_line_clear() grbl_stream_line_head = grbl_stream_line_tail = 0
+#else
+#define grbl_stream_line_clear()
+#endif
+
 void grbl_stream_init(void)
 {
 #ifdef FORCE_GLOBALS_TO_0
@@ -162,6 +180,7 @@ void stream_stdin(uint8_t *p)
 	stream_getc = current_stream->stream_getc;
 	stream_available = current_stream->stream_available;
 	stream_clear = current_stream->stream_clear;
+	stream_read = current_stream->stream_read;
 }
 #endif
 
@@ -181,6 +200,7 @@ bool grbl_stream_change(grbl_stream_t *stream)
 	}
 #endif
 	grbl_stream_peek_buffer = 0;
+	grbl_stream_line_clear();
 	if (stream != NULL)
 	{
 		current_stream = stream;
@@ -193,11 +213,17 @@ bool grbl_stream_change(grbl_stream_t *stream)
 	stream_getc = mcu_getc;
 	stream_available = mcu_available;
 	stream_clear = mcu_clear;
+	stream_read = NULL;
 #endif
 	return true;
 }
 
 bool grbl_stream_readonly(grbl_stream_getc_cb getc_cb, grbl_stream_available_cb available_cb, grbl_stream_clear_cb clear_cb)
+{
+	return grbl_stream_readonly_bulk(getc_cb, available_cb, clear_cb, NULL);
+}
+
+bool grbl_stream_readonly_bulk(grbl_stream_getc_cb getc_cb, grbl_stream_available_cb available_cb, grbl_stream_clear_cb clear_cb, grbl_stream_read_cb read_cb)
 {
 #ifdef ENABLE_MULTISTREAM_GUARD
 	if (grbl_stream_rx_busy)
@@ -206,9 +232,11 @@ bool grbl_stream_readonly(grbl_stream_getc_cb getc_cb, grbl_stream_available_cb
 	}
 #endif
 	grbl_stream_peek_buffer = 0;
+	grbl_stream_line_clear();
 	stream_getc = getc_cb;
 	stream_available = available_cb;
 	stream_clear = clear_cb;
+	stream_read = read_cb;
 	return true;
 }
 
@@ -238,6 +266,14 @@ char grbl_stream_getc(void)
 	uint8_t peek = grbl_stream_peek();
 #ifdef ENABLE_MULTISTREAM_GUARD
 	grbl_stream_rx_busy = (peek != EOL);
+#endif
+#ifdef ENABLE_STREAM_BULK_READ
+	if (!grbl_stream_peek_buffer && grbl_stream_line_tail != grbl_stream_line_head)
+	{
+		// the char came from the line buffer
+		grbl_stream_line_tail++;
+		return peek;
+	}
 #endif
 	grbl_stream_peek_buffer = 0;
 	return peek;
@@ -251,6 +287,15 @@ static FORCEINLINE char _grbl_stream_peek(void)
 		return peek;
 	}
 
+#ifdef ENABLE_STREAM_BULK_READ
+	if (grbl_stream_line_tail != grbl_stream_line_head)
+	{
+		peek = (char)grbl_stream_line[grbl_stream_line_tail];
+		// prevents null char reading from eeprom
+		return (peek) ? peek : '\n';
+	}
+#endif
+
 	while (!grbl_stream_available())
 	{
 		cnc_dotasks();
@@ -263,6 +308,21 @@ static FORCEINLINE char _grbl_stream_peek(void)
 		return OVF;
 	}
 #endif
+
+#ifdef ENABLE_STREAM_BULK_READ
+	if (stream_read)
+	{
+		// reads the line (or as much of it as fits the line buffer) with a single call
+		grbl_stream_line_tail = 0;
+		grbl_stream_line_head = stream_read(grbl_stream_line, GRBL_STREAM_LINE_SIZE);
+		if (grbl_stream_line_head)
+		{
+			peek = (char)grbl_stream_line[0];
+			return (peek) ? peek : '\n';
+		}
+	}
+#endif
+
 	peek = (char)stream_getc();
 	// prevents null char reading from eeprom
 	if (!peek)
@@ -288,6 +348,77 @@ char grbl_stream_peek(void)
 	return peek;
 }
 
+buffer_index_t grbl_stream_peek_span(const uint8_t **span)
+{
+#ifdef ENABLE_STREAM_BULK_READ
+	// fills the line buffer if empty
+	_grbl_stream_peek();
+	if (!grbl_stream_peek_buffer)
+	{
+		*span = &grbl_stream_line[grbl_stream_line_tail];
+		return (grbl_stream_line_head - grbl_stream_line_tail);
+	}
+#endif
+	*span = NULL;
+	return 0;
+}
+
+void grbl_stream_skip(buffer_index_t len)
+{
+#ifdef ENABLE_STREAM_BULK_READ
+	len = MIN(len, (grbl_stream_line_head - grbl_stream_line_tail));
+	grbl_stream_line_tail += len;
+#ifdef ENABLE_MULTISTREAM_GUARD
+	if (len)
+	{
+		grbl_stream_rx_busy = true;
+	}
+#endif
+#endif
+}
+
+buffer_index_t grbl_stream_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t count = 0;
+	while (count < len)
+	{
+		const uint8_t *span;
+		buffer_index_t n = grbl_stream_peek_span(&span);
+		if (!n)
+		{
+			// no line buffer (one char at a time)
+			char c = grbl_stream_peek();
+			if (c == EOL)
+			{
+				break;
+			}
+			buffer[count++] = (uint8_t)grbl_stream_getc();
+			continue;
+		}
+
+		n = MIN(n, len - count);
+		buffer_index_t i = 0;
+		while (i < n)
+		{
+			uint8_t c = span[i];
+			if (c == '\n' || c == '\r' || !c)
+			{
+				break;
+			}
+			buffer[count++] = c;
+			i++;
+		}
+		grbl_stream_skip(i);
+		if (i < n)
+		{
+			// reached the end of line
+			break;
+		}
+	}
+
+	return count;
+}
+
 uint8_t grbl_stream_overflow_count;
 void grbl_stream_overflow(uint8_t c)
 {
@@ -304,7 +435,22 @@ void grbl_stream_overflow(uint8_t c)
 
 void grbl_stream_overflow_flush(void)
 {
-	uint8_t avail = (!!stream_available) ? stream_available() : 1;
+#ifdef ENABLE_STREAM_BULK_READ
+	// discards the rest of the line buffer
+	while (grbl_stream_line_tail != grbl_stream_line_head)
+	{
+		switch (grbl_stream_line[grbl_stream_line_tail++])
+		{
+		case '\n':
+		case '\r':
+		case 0:
+			proto_line_ack(STATUS_OVERFLOW);
+			break;
+		}
+	}
+	grbl_stream_line_clear();
+#endif
+	buffer_index_t avail = (!!stream_available) ? stream_available() : 1;
 	while (avail && stream_getc)
 	{
 		uint8_t c = stream_getc();
@@ -313,7 +459,7 @@ void grbl_stream_overflow_flush(void)
 		case '\n':
 		case '\r':
 		case 0:
-			proto_error(STATUS_OVERFLOW);
+			proto_line_ack(STATUS_OVERFLOW);
 			break;
 		}
 
@@ -327,14 +473,23 @@ void grbl_stream_overflow_flush(void)
 
 	while (grbl_stream_overflow_count--)
 	{
-		proto_error(STATUS_OVERFLOW);
+		proto_line_ack(STATUS_OVERFLOW);
 	}
 
 	grbl_stream_peek_buffer = 0;
 }
 
-uint8_t grbl_stream_available(void)
+buffer_index_t grbl_stream_available(void)
 {
+#ifdef ENABLE_STREAM_BULK_READ
+	buffer_index_t line = grbl_stream_line_head - grbl_stream_line_tail;
+	if (line)
+	{
+		// the rest of the line is still in the line buffer (the stream can't be changed)
+		return line + ((stream_available) ? stream_available() : 0);
+	}
+#endif
+
 	if (stream_available == NULL)
 	{
 		// if undef allow to continue
@@ -342,7 +497,7 @@ uint8_t grbl_stream_available(void)
 	}
 
 #ifndef DISABLE_MULTISTREAM_SERIAL
-	uint8_t count = stream_available();
+	buffer_index_t count = stream_available();
 	if (!count)
 	{
 #ifdef ENABLE_MULTISTREAM_GUARD
@@ -369,9 +524,11 @@ uint8_t grbl_stream_available(void)
 #endif
 }
 
-uint8_t grbl_stream_write_available(void)
+buffer_index_t grbl_stream_write_available(void)
 {
-	return (RX_BUFFER_SIZE - grbl_stream_available());
+	// free bytes of the advertised RX buffer capacity (the safety margin is not reported)
+	buffer_index_t available = grbl_stream_available();
+	return (available < RX_BUFFER_CAPACITY) ? (RX_BUFFER_CAPACITY - available) : 0;
 }
 
 void grbl_stream_clear(void)
@@ -385,6 +542,7 @@ void grbl_stream_clear(void)
 	mcu_clear();
 #endif
 	grbl_stream_peek_buffer = 0;
+	grbl_stream_line_clear();
 }
 
 #ifndef DISABLE_MULTISTREAM_SERIAL
@@ -37,13 +37,26 @@ extern "C"
 #endif
 #define RX_BUFFER_SIZE (RX_BUFFER_CAPACITY + SAFEMARGIN) // buffer sizes
 
+#ifndef ENABLE_LARGE_STREAM_BUFFERS
 #if RX_BUFFER_SIZE > 255
-#error "RX_BUFFER_SIZE cannot exceed 255"
+#error "RX_BUFFER_SIZE cannot exceed 255 (enable ENABLE_LARGE_STREAM_BUFFERS)"
+#endif
+#elif RX_BUFFER_SIZE > 65535
+#error "RX_BUFFER_SIZE cannot exceed 65535"
+#endif
+
+#ifdef ENABLE_STREAM_BULK_READ
+// size of the line buffer filled by the stream bulk read callback
+#ifndef GRBL_STREAM_LINE_SIZE
+#define GRBL_STREAM_LINE_SIZE 128
+#endif
 #endif
 
 	typedef uint8_t (*grbl_stream_getc_cb)(void);
-	typedef uint8_t (*grbl_stream_available_cb)(void);
+	typedef buffer_index_t (*grbl_stream_available_cb)(void);
 	typedef void (*grbl_stream_clear_cb)(void);
+	// reads up to len chars stopping after the first end of line char ('\n', '\r' or 0) and returns the number of chars read
+	typedef buffer_index_t (*grbl_stream_read_cb)(uint8_t *buffer, buffer_index_t len);
 
 	typedef struct grbl_stream_
 	{
@@ -53,15 +66,18 @@ extern "C"
 		void (*stream_putc)(uint8_t);
 		void (*stream_flush)(void);
 		struct grbl_stream_ *next;
+		grbl_stream_read_cb stream_read; // optional bulk read (used with ENABLE_STREAM_BULK_READ)
 	} grbl_stream_t;
 
-#define DECL_GRBL_STREAM(name, getc_cb, available_cb, clear_cb, putc_cb, flush_cb) grbl_stream_t name = {getc_cb, available_cb, clear_cb, putc_cb, flush_cb, NULL}
+#define DECL_GRBL_STREAM(name, getc_cb, available_cb, clear_cb, putc_cb, flush_cb) grbl_stream_t name = {getc_cb, available_cb, clear_cb, putc_cb, flush_cb, NULL, NULL}
+#define DECL_GRBL_BULK_STREAM(name, getc_cb, available_cb, clear_cb, putc_cb, flush_cb, read_cb) grbl_stream_t name = {getc_cb, available_cb, clear_cb, putc_cb, flush_cb, NULL, read_cb}
 
 	void grbl_stream_init();
 
 	void grbl_stream_register(grbl_stream_t *stream);
 	bool grbl_stream_change(grbl_stream_t *stream);
 	bool grbl_stream_readonly(grbl_stream_getc_cb getc_cb, grbl_stream_available_cb available_cb, grbl_stream_clear_cb clear_cb);
+	bool grbl_stream_readonly_bulk(grbl_stream_getc_cb getc_cb, grbl_stream_available_cb available_cb, grbl_stream_clear_cb clear_cb, grbl_stream_read_cb read_cb);
 	void grbl_stream_eeprom(uint16_t address);
 
 	void grbl_stream_start_broadcast(void);
@@ -77,9 +93,16 @@ extern "C"
 
 	char grbl_stream_getc(void);
 	char grbl_stream_peek(void);
-	uint8_t grbl_stream_available(void);
+	// reads the rest of the current line (up to len chars) without the end of line (left in the stream)
+	buffer_index_t grbl_stream_read(uint8_t *buffer, buffer_index_t len);
+	// gets the unread chars of the line buffer (raw chars without conversion) without copying them
+	// returns 0 if the stream has no bulk read (use grbl_stream_getc)
+	buffer_index_t grbl_stream_peek_span(const uint8_t **span);
+	// consumes len chars of the span returned by grbl_stream_peek_span
+	void grbl_stream_skip(buffer_index_t len);
+	buffer_index_t grbl_stream_available(void);
 	void grbl_stream_clear(void);
-	uint8_t grbl_stream_write_available(void);
+	buffer_index_t grbl_stream_write_available(void);
 	uint8_t grbl_stream_busy(void);
 
 #ifdef ENABLE_DEBUG_STREAM
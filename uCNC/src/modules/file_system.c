@@ -91,6 +91,177 @@ static fs_t *fs_search_drive(const char *path)
 	return NULL;
 }
 
+#ifdef ENABLE_FS_CACHE
+/**
+ * File cache
+ * Each open file gets one of the FS_CACHE_PAGES pages (while there are free pages, the others run uncached).
+ * The driver is read a page at a time (read-ahead) and the writes are kept in the page until it's full or
+ * the file is seeked, read or closed (write-behind).
+ * The driver file position is at the end of a clean page (offset + len) and at the start of a dirty page (offset).
+ * The driver available count is kept until the driver file position changes.
+ * */
+static fs_cache_page_t fs_cache_pages[FS_CACHE_PAGES];
+
+static void fs_cache_attach(fs_file_t *fp, const char *mode)
+{
+	if (fp->file_info.is_dir)
+	{
+		return;
+	}
+
+	for (uint8_t i = 0; i < FS_CACHE_PAGES; i++)
+	{
+		fs_cache_page_t *page = &fs_cache_pages[i];
+		if (!page->owner)
+		{
+			page->owner = fp;
+			// append writes at the end of the file
+			page->offset = (mode[0] == 'a') ? fp->file_info.size : 0;
+			page->remaining = -1;
+			page->len = 0;
+			page->pos = 0;
+			page->dirty = false;
+			fp->cache = page;
+			return;
+		}
+	}
+}
+
+// writes the dirty page to the driver
+static bool fs_cache_flush(fs_file_t *fp)
+{
+	fs_cache_page_t *page = fp->cache;
+	if (!page->dirty)
+	{
+		return true;
+	}
+
+	uint16_t len = page->len;
+	size_t written = fp->fs_ptr->write(fp, page->data, len);
+	page->offset += written;
+	page->remaining = -1;
+	page->len = 0;
+	page->pos = 0;
+	page->dirty = false;
+	return (written == len);
+}
+
+// reads the next page from the driver
+static uint16_t fs_cache_fill(fs_file_t *fp)
+{
+	fs_cache_page_t *page = fp->cache;
+	page->offset += page->len;
+	page->pos = 0;
+	page->remaining = -1;
+	page->len = (uint16_t)fp->fs_ptr->read(fp, page->data, FS_CACHE_PAGE_SIZE);
+	return page->len;
+}
+
+static size_t fs_cache_read(fs_file_t *fp, uint8_t *buffer, size_t len)
+{
+	fs_cache_page_t *page = fp->cache;
+	size_t n = 0;
+
+	if (!fs_cache_flush(fp))
+	{
+		return 0;
+	}
+
+	while (n < len)
+	{
+		if (page->pos == page->len)
+		{
+			if ((len - n) >= FS_CACHE_PAGE_SIZE)
+			{
+				// large reads go straight to the buffer
+				page->offset += page->len;
+				page->remaining = -1;
+				page->len = 0;
+				page->pos = 0;
+				size_t read = fp->fs_ptr->read(fp, &buffer[n], len - n);
+				page->offset += read;
+				return n + read;
+			}
+
+			if (!fs_cache_fill(fp))
+			{
+				break;
+			}
+		}
+
+		size_t count = MIN(len - n, (size_t)(page->len - page->pos));
+		memcpy(&buffer[n], &page->data[page->pos], count);
+		page->pos += count;
+		n += count;
+	}
+
+	return n;
+}
+
+static size_t fs_cache_write(fs_file_t *fp, const uint8_t *buffer, size_t len)
+{
+	fs_cache_page_t *page = fp->cache;
+	size_t n = 0;
+
+	if (!page->dirty && page->len)
+	{
+		// drops the read-ahead data and moves the driver to the file position
+		uint32_t position = page->offset + page->pos;
+		if (!fp->fs_ptr->seek(fp, position))
+		{
+			return 0;
+		}
+		page->offset = position;
+		page->remaining = -1;
+		page->len = 0;
+		page->pos = 0;
+	}
+
+	while (n < len)
+	{
+		size_t count = MIN(len - n, (size_t)(FS_CACHE_PAGE_SIZE - page->len));
+		memcpy(&page->data[page->len], &buffer[n], count);
+		page->len += count;
+		page->pos = page->len;
+		page->dirty = true;
+		n += count;
+		if (page->len == FS_CACHE_PAGE_SIZE && !fs_cache_flush(fp))
+		{
+			return 0;
+		}
+	}
+
+	return n;
+}
+
+static bool fs_cache_seek(fs_file_t *fp, uint32_t position)
+{
+	fs_cache_page_t *page = fp->cache;
+	if (!fs_cache_flush(fp))
+	{
+		return false;
+	}
+
+	// inside the page
+	if (position >= page->offset && position <= (page->offset + page->len))
+	{
+		page->pos = (uint16_t)(position - page->offset);
+		return true;
+	}
+
+	if (!fp->fs_ptr->seek(fp, position))
+	{
+		return false;
+	}
+
+	page->offset = position;
+	page->remaining = -1;
+	page->len = 0;
+	page->pos = 0;
+	return true;
+}
+#endif
+
 // emulates basic chdir and opens the dir or file if it exists
 static fs_file_t *fs_path_parse(fs_file_info_t *current_path, const char *new_path, const char *mode)
 {
@@ -195,6 +366,9 @@ static fs_file_t *fs_path_parse(fs_file_info_t *current_path, const char *new_pa
 	if (fp)
 	{
 		fp->fs_ptr = fs;
+#ifdef ENABLE_FS_CACHE
+		fs_cache_attach(fp, mode);
+#endif
 		if (current_path)
 		{
 			memset(current_path->full_name, 0, FS_PATH_NAME_MAX_LEN);
@@ -242,20 +416,83 @@ static uint8_t running_file_getc(void)
 	return c;
 }
 
-static uint8_t running_file_available()
+static buffer_index_t running_file_available()
 {
-	uint8_t avail = 0;
+	buffer_index_t avail = 0;
 #ifdef ENABLE_MAIN_LOOP_MODULES
 	avail = BUFFER_READ_AVAILABLE(fs_file_buffer);
 #else
 	if (fs_running_file)
 	{
-		avail = (uint8_t)MIN(255, fs_available(fs_running_file));
+		avail = (buffer_index_t)MIN(RX_BUFFER_SIZE, fs_available(fs_running_file));
 	}
 #endif
 	return avail;
 }
 
+#ifdef ENABLE_STREAM_BULK_READ
+// reads the next line (up to len chars) from the running file
+static buffer_index_t running_file_read(uint8_t *buffer, buffer_index_t len)
+{
+	buffer_index_t read = 0;
+#ifdef ENABLE_MAIN_LOOP_MODULES
+	BUFFER_READ_LINE(fs_file_buffer, buffer, len, read);
+#else
+	if (fs_running_file)
+	{
+		const uint8_t *page;
+		buffer_index_t n = (buffer_index_t)MIN(len, fs_read_borrow(fs_running_file, &page));
+		if (n)
+		{
+			// copies up to the end of line straight from the cache page
+			while (read < n)
+			{
+				uint8_t c = page[read];
+				buffer[read++] = c;
+				if (c == '\n' || c == '\r' || !c)
+				{
+					break;
+				}
+			}
+			fs_read_release(fs_running_file, read);
+			if (!fs_available(fs_running_file))
+			{
+				fs_close(fs_running_file);
+				fs_running_file = NULL;
+			}
+			return read;
+		}
+
+		int avail = fs_available(fs_running_file);
+		n = (buffer_index_t)fs_read(fs_running_file, buffer, MIN(len, avail));
+		while (read < n)
+		{
+			uint8_t c = buffer[read++];
+			if (c == '\n' || c == '\r' || !c)
+			{
+				break;
+			}
+		}
+		avail -= read;
+		// rewinds the chars read past the end of line
+		if (read < n)
+		{
+			fs_seek(fs_running_file, fs_running_file->file_info.size - avail);
+		}
+		// auto close file
+		if (!avail)
+		{
+			fs_close(fs_running_file);
+			fs_running_file = NULL;
+		}
+	}
+#endif
+	return read;
+}
+#else
+#define running_file_read NULL
+#endif
+
 static void running_file_clear()
 {
 #ifdef ENABLE_MAIN_LOOP_MODULES
@@ -270,22 +507,39 @@ static void running_file_clear()
 #ifdef ENABLE_PARSER_MODULES
 
 #ifdef ENABLE_MAIN_LOOP_MODULES
-bool running_file_loop(void *args)
+// moves the file data to the stream buffer
+static void running_file_fill(void)
 {
 	if (fs_running_file)
 	{
-		size_t r = BUFFER_WRITE_AVAILABLE(fs_file_buffer);
-		uint8_t tmp[RX_BUFFER_SIZE];
-		size_t read = fs_read(fs_running_file, tmp, r);
-		uint8_t w = 0;
-		BUFFER_WRITE(fs_file_buffer, tmp, read, w);
-		if (read < r || !fs_available(fs_running_file))
+		buffer_index_t r = BUFFER_WRITE_AVAILABLE(fs_file_buffer);
+		buffer_index_t w = 0;
+		const uint8_t *page;
+		size_t read = fs_read_borrow(fs_running_file, &page);
+		if (read)
+		{
+			// straight from the cache page
+			BUFFER_WRITE(fs_file_buffer, page, MIN(read, r), w);
+			fs_read_release(fs_running_file, w);
+		}
+		else
+		{
+			uint8_t tmp[RX_BUFFER_SIZE];
+			read = fs_read(fs_running_file, tmp, r);
+			BUFFER_WRITE(fs_file_buffer, tmp, read, w);
+		}
+
+		if (!fs_available(fs_running_file))
 		{
 			fs_close(fs_running_file);
 			fs_running_file = NULL;
 		}
 	}
+}
 
+bool running_file_loop(void *args)
+{
+	running_file_fill();
 	return EVENT_CONTINUE;
 }
 CREATE_EVENT_LISTENER(cnc_dotasks, running_file_loop);
@@ -414,19 +668,15 @@ void fs_file_run(char *params)
 		startline = MAX(1, startline);
 		proto_info("Running file from line - %lu", startline);
 #ifdef DECL_SERIAL_STREAM
+		// open a readonly stream
+		// the output is sent to the current holding interface
+		fs_running_file = fp;
 #ifdef ENABLE_MAIN_LOOP_MODULES
 		// prefill buffer
 		BUFFER_CLEAR(fs_file_buffer);
-		size_t r = BUFFER_WRITE_AVAILABLE(fs_file_buffer);
-		uint8_t tmp[RX_BUFFER_SIZE];
-		size_t read = fs_read(fs_running_file, tmp, r);
-		uint8_t w = 0;
-		BUFFER_WRITE(fs_file_buffer, tmp, read, w);
+		running_file_fill();
 #endif
-		// open a readonly stream
-		// the output is sent to the current holding interface
-		fs_running_file = fp;
-		serial_stream_readonly(&running_file_getc, &running_file_available, &running_file_clear);
+		grbl_stream_readonly_bulk(&running_file_getc, &running_file_available, &running_file_clear, running_file_read);
 		while (--startline)
 		{
 			parser_discard_command();
@@ -441,22 +691,24 @@ void fs_file_run(char *params)
 /**
  * Handles grbl commands for the SD card
  * */
+// the command arguments length is limited to 127 chars (int8_t)
+#define FS_CMD_PARAMS_SIZE MIN(RX_BUFFER_CAPACITY, INT8_MAX)
 bool fs_cmd_parser(void *args)
 {
 	grbl_cmd_args_t *cmd = (grbl_cmd_args_t *)args;
-	char params[RX_BUFFER_CAPACITY]; /* get remaining command parammeters */
+	char params[FS_CMD_PARAMS_SIZE]; /* get remaining command parammeters */
 	memset(params, 0, sizeof(params));
 
-	if (!strcmp("LS", (char *)(cmd->cmd)))
+	if (cmd->id == GRBL_CMD_LS)
 	{
 		fs_dir_list();
 		*(cmd->error) = STATUS_OK;
 		return EVENT_HANDLED;
 	}
 
-	if (!strcmp("CD", (char *)(cmd->cmd)))
+	if (cmd->id == GRBL_CMD_CD)
 	{
-		int8_t len = parser_get_grbl_cmd_arg(params, RX_BUFFER_CAPACITY);
+		int8_t len = parser_get_grbl_cmd_arg(params, FS_CMD_PARAMS_SIZE);
 
 		if (len < 0)
 		{
@@ -469,9 +721,9 @@ bool fs_cmd_parser(void *args)
 		return EVENT_HANDLED;
 	}
 
-	if (!strcmp("LPR", (char *)(cmd->cmd)))
+	if (cmd->id == GRBL_CMD_LPR)
 	{
-		int8_t len = parser_get_grbl_cmd_arg(params, RX_BUFFER_CAPACITY);
+		int8_t len = parser_get_grbl_cmd_arg(params, FS_CMD_PARAMS_SIZE);
 
 		if (len < 0)
 		{
@@ -483,9 +735,9 @@ bool fs_cmd_parser(void *args)
 		return EVENT_HANDLED;
 	}
 
-	if (!strcmp("RUN", (char *)(cmd->cmd)))
+	if (cmd->id == GRBL_CMD_RUN)
 	{
-		int8_t len = parser_get_grbl_cmd_arg(params, RX_BUFFER_CAPACITY);
+		int8_t len = parser_get_grbl_cmd_arg(params, FS_CMD_PARAMS_SIZE);
 
 		if (len < 0)
 		{
@@ -880,7 +1132,7 @@ bool system_menu_fs_action(uint8_t action)
 					system_menu_go_idle();
 					rom_strcpy(buffer, __romstr__(FS_STR_FILE_RUNNING));
 					system_menu_show_modal_popup(SYSTEM_MENU_MODAL_POPUP_MS, buffer);
-					grbl_stream_readonly(&running_file_getc, &running_file_available, &running_file_clear);
+					grbl_stream_readonly_bulk(&running_file_getc, &running_file_available, &running_file_clear, running_file_read);
 				}
 				else
 				{
@@ -1069,6 +1321,17 @@ void fs_close(fs_file_t *fp)
 {
 	if (fp)
 	{
+#ifdef ENABLE_FS_CACHE
+		if (fp->cache)
+		{
+			if (fp->file_ptr)
+			{
+				fs_cache_flush(fp);
+			}
+			fp->cache->owner = NULL;
+			fp->cache = NULL;
+		}
+#endif
 		if (fp->file_ptr)
 		{
 			fp->fs_ptr->close(fp);
@@ -1084,6 +1347,12 @@ size_t fs_read(fs_file_t *fp, uint8_t *buffer, size_t len)
 	{
 		if (fp->file_ptr)
 		{
+#ifdef ENABLE_FS_CACHE
+			if (fp->cache)
+			{
+				return fs_cache_read(fp, buffer, len);
+			}
+#endif
 			return fp->fs_ptr->read(fp, buffer, len);
 		}
 	}
@@ -1097,6 +1366,12 @@ size_t fs_write(fs_file_t *fp, const uint8_t *buffer, size_t len)
 	{
 		if (fp->file_ptr)
 		{
+#ifdef ENABLE_FS_CACHE
+			if (fp->cache)
+			{
+				return fs_cache_write(fp, buffer, len);
+			}
+#endif
 			return fp->fs_ptr->write(fp, buffer, len);
 		}
 	}
@@ -1110,6 +1385,12 @@ bool fs_seek(fs_file_t *fp, uint32_t position)
 	{
 		if (fp->file_ptr)
 		{
+#ifdef ENABLE_FS_CACHE
+			if (fp->cache)
+			{
+				return fs_cache_seek(fp, position);
+			}
+#endif
 			return fp->fs_ptr->seek(fp, position);
 		}
 	}
@@ -1123,6 +1404,21 @@ int fs_available(fs_file_t *fp)
 	{
 		if (fp->file_ptr)
 		{
+#ifdef ENABLE_FS_CACHE
+			if (fp->cache)
+			{
+				fs_cache_page_t *page = fp->cache;
+				if (!fs_cache_flush(fp))
+				{
+					return 0;
+				}
+				if (page->remaining < 0)
+				{
+					page->remaining = fp->fs_ptr->available(fp);
+				}
+				return page->remaining + (page->len - page->pos);
+			}
+#endif
 			return fp->fs_ptr->available(fp);
 		}
 	}
@@ -1130,6 +1426,41 @@ int fs_available(fs_file_t *fp)
 	return 0;
 }
 
+size_t fs_read_borrow(fs_file_t *fp, const uint8_t **data)
+{
+	*data = NULL;
+#ifdef ENABLE_FS_CACHE
+	if (fp && fp->file_ptr && fp->cache)
+	{
+		fs_cache_page_t *page = fp->cache;
+		if (!fs_cache_flush(fp))
+		{
+			return 0;
+		}
+
+		if (page->pos == page->len && !fs_cache_fill(fp))
+		{
+			return 0;
+		}
+
+		*data = &page->data[page->pos];
+		return (page->len - page->pos);
+	}
+#endif
+	return 0;
+}
+
+void fs_read_release(fs_file_t *fp, size_t len)
+{
+#ifdef ENABLE_FS_CACHE
+	if (fp && fp->cache)
+	{
+		fs_cache_page_t *page = fp->cache;
+		page->pos += (uint16_t)MIN(len, (size_t)(page->len - page->pos));
+	}
+#endif
+}
+
 bool fs_next_file(fs_file_t *fp, fs_file_info_t *finfo)
 {
 	if (fp)
@@ -41,11 +41,36 @@ extern "C"
 		uint32_t timestamp;
 	} fs_file_info_t;
 
+#ifdef ENABLE_FS_CACHE
+#ifndef FS_CACHE_PAGE_SIZE
+#define FS_CACHE_PAGE_SIZE 512
+#endif
+#ifndef FS_CACHE_PAGES
+#define FS_CACHE_PAGES 2
+#endif
+	// a page of a open file (read-ahead or write-behind)
+	// the page holds the file data from offset to offset + len and pos is the file position inside the page
+	// remaining is the driver available count after the page (-1 if unknown)
+	typedef struct fs_cache_page_
+	{
+		struct fs_file_ *owner;
+		uint32_t offset;
+		int32_t remaining;
+		uint16_t len;
+		uint16_t pos;
+		bool dirty;
+		uint8_t data[FS_CACHE_PAGE_SIZE];
+	} fs_cache_page_t;
+#endif
+
 	typedef struct fs_file_
 	{
 		fs_file_info_t file_info;
 		struct fs_ *fs_ptr;
 		void *file_ptr;
+#ifdef ENABLE_FS_CACHE
+		fs_cache_page_t *cache;
+#endif
 	} fs_file_t;
 
 	typedef struct fs_
@@ -73,6 +98,11 @@ extern "C"
 	size_t fs_write(fs_file_t *fp, const uint8_t *buffer, size_t len);
 	bool fs_seek(fs_file_t *fp, uint32_t position);
 	int fs_available(fs_file_t *fp);
+	// zero-copy read from the file cache page
+	// returns the number of bytes available at the current file position (and points data to them)
+	// or 0 if the file is not cached or at the end of file. fs_read_release consumes len bytes of them
+	size_t fs_read_borrow(fs_file_t *fp, const uint8_t **data);
+	void fs_read_release(fs_file_t *fp, size_t len);
 	void fs_close(fs_file_t *fp);
 	bool fs_remove(const char *path);
 	fs_file_t *fs_opendir(const char *path);
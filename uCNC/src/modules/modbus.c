@@ -45,22 +45,27 @@ FORCEINLINE static uint16_t crc16(uint8_t *data, uint8_t len)
 	return crc;
 }
 
-void send_request(modbus_request_t request, uint8_t len, softuart_port_t *port)
+// length of the request frame without the CRC
+static uint8_t modbus_request_len(modbus_request_t *request, uint8_t len)
 {
-	uint8_t *data = (uint8_t *)&request;
 	if (!len)
 	{
 		len = 6;
-		if (request.fcode >= MODBUS_FORCE_MULTIPLE_COILS)
+		if (request->fcode >= MODBUS_FORCE_MULTIPLE_COILS)
 		{
-			len += 1 + request.datalen;
+			len += 1 + request->datalen;
 		}
-	}
-	else
-	{
-		len -= 2;
+		return len;
 	}
 
+	return (len - 2);
+}
+
+void send_request(modbus_request_t request, uint8_t len, softuart_port_t *port)
+{
+	uint8_t *data = (uint8_t *)&request;
+	len = modbus_request_len(&request, len);
+
 	request.crc = crc16(data, len);
 
 #ifdef ENABLE_MODBUS_VERBOSE
@@ -118,3 +123,310 @@ bool read_response(modbus_response_t *response, uint8_t len, softuart_port_t *po
 	response->crc = *((uint16_t *)data);
 	return true;
 }
+
+#ifdef ENABLE_MODBUS_ASYNC
+// silence after the last received byte that ends a frame of unknown length (ms)
+#ifndef MODBUS_FRAME_GAP_MS
+#define MODBUS_FRAME_GAP_MS 5
+#endif
+// address + function code + data + CRC
+#define MODBUS_FRAME_MAX_LEN (MODBUS_DATA_MAX_LEN + 4)
+
+#define MODBUS_STATE_WAIT 0
+#define MODBUS_STATE_RECEIVE 1
+
+static modbus_transaction_t modbus_queue[MODBUS_QUEUE_SIZE];
+static uint32_t modbus_submitted[MODBUS_QUEUE_SIZE];
+static uint8_t modbus_head;
+static uint8_t modbus_count;
+static uint8_t modbus_state;
+static uint8_t modbus_attempt;
+// start of the current state (ms)
+static uint32_t modbus_time;
+static uint32_t modbus_last_rx;
+static uint8_t modbus_rx[MODBUS_FRAME_MAX_LEN];
+static uint8_t modbus_rx_len;
+static bool modbus_running;
+static modbus_stats_t modbus_stats;
+
+bool modbus_submit(modbus_transaction_t *transaction)
+{
+	if (modbus_count >= MODBUS_QUEUE_SIZE)
+	{
+		modbus_stats.dropped++;
+		return false;
+	}
+
+	uint8_t index = modbus_head + modbus_count;
+	if (index >= MODBUS_QUEUE_SIZE)
+	{
+		index -= MODBUS_QUEUE_SIZE;
+	}
+
+	memcpy(&modbus_queue[index], transaction, sizeof(modbus_transaction_t));
+	modbus_submitted[index] = mcu_millis();
+	if (!modbus_count)
+	{
+		// starts the delay of the first attempt
+		modbus_state = MODBUS_STATE_WAIT;
+		modbus_attempt = 0;
+		modbus_time = modbus_submitted[index] + transaction->delay;
+	}
+	modbus_count++;
+	return true;
+}
+
+uint8_t modbus_pending(void)
+{
+	return modbus_count;
+}
+
+void modbus_get_stats(modbus_stats_t *stats)
+{
+	memcpy(stats, &modbus_stats, sizeof(modbus_stats_t));
+}
+
+// expected length of the response frame (0 while unknown)
+static uint8_t modbus_response_len(modbus_transaction_t *transaction)
+{
+	if (transaction->rx_len)
+	{
+		return transaction->rx_len;
+	}
+
+	if (modbus_rx_len < 2)
+	{
+		return 0;
+	}
+
+	uint8_t fcode = modbus_rx[1];
+	if (fcode & 0x80)
+	{
+		// exception
+		return 5;
+	}
+
+	switch (fcode)
+	{
+	case MODBUS_READ_COIL_STATUS:
+	case MODBUS_READ_INPUT_STATUS:
+	case MODBUS_READ_HOLDING_REGISTERS:
+	case MODBUS_READ_INPUT_REGISTERS:
+	case MODBUS_READ_WRITE_MULTIPLE_REGISTERS:
+		// byte count
+		return (modbus_rx_len < 3) ? 0 : (5 + modbus_rx[2]);
+	case MODBUS_FORCE_SINGLE_COIL:
+	case MODBUS_PRESET_SINGLE_REGISTER:
+	case MODBUS_FORCE_MULTIPLE_COILS:
+	case MODBUS_PRESET_MULTIPLE_REGISTERS:
+		return 8;
+	}
+
+	// unknown (ends after the frame gap)
+	return 0;
+}
+
+static void modbus_send(modbus_transaction_t *transaction)
+{
+	modbus_rx_len = 0;
+#if (defined(MCU_HAS_UART2) && defined(DETACH_UART2_FROM_MAIN_PROTOCOL) && !defined(UART2_DISABLE_BUFFER))
+	if (!transaction->port)
+	{
+		modbus_request_t request;
+		memcpy(&request, &transaction->request, sizeof(modbus_request_t));
+		uint8_t len = modbus_request_len(&request, transaction->tx_len);
+		uint16_t crc = crc16((uint8_t *)&request, len);
+		uint8_t *data = (uint8_t *)&request;
+		// drops any late reply of the previous attempt
+		mcu_uart2_clear();
+		for (uint8_t i = 0; i < len; i++)
+		{
+			mcu_uart2_putc(data[i]);
+		}
+		mcu_uart2_putc((uint8_t)(crc & 0xFF));
+		mcu_uart2_putc((uint8_t)(crc >> 8));
+		mcu_uart2_flush();
+		return;
+	}
+#endif
+	send_request(transaction->request, transaction->tx_len, transaction->port);
+}
+
+// reads the available bytes of the response
+static void modbus_receive(modbus_transaction_t *transaction)
+{
+	if (transaction->port)
+	{
+		// the softuart can only be read while waiting for it
+		uint32_t elapsed = mcu_millis() - modbus_time;
+		uint32_t timeout = (elapsed < transaction->timeout) ? (transaction->timeout - elapsed) : 0;
+		uint8_t len = modbus_response_len(transaction);
+		while (timeout && modbus_rx_len < MODBUS_FRAME_MAX_LEN && (!len || modbus_rx_len < len))
+		{
+			uint32_t wait = (modbus_rx_len) ? MODBUS_FRAME_GAP_MS : timeout;
+			uint32_t start = mcu_millis();
+			int16_t c = softuart_getc(transaction->port, wait);
+			// softuart_getc returns 0 on timeout
+			if (!c && (mcu_millis() - start) >= wait)
+			{
+				break;
+			}
+			elapsed = mcu_millis() - modbus_time;
+			timeout = (elapsed < transaction->timeout) ? (transaction->timeout - elapsed) : 0;
+			modbus_rx[modbus_rx_len++] = (uint8_t)c;
+			modbus_last_rx = mcu_millis();
+			len = modbus_response_len(transaction);
+		}
+		return;
+	}
+
+#if (defined(MCU_HAS_UART2) && defined(DETACH_UART2_FROM_MAIN_PROTOCOL) && !defined(UART2_DISABLE_BUFFER))
+	while (mcu_uart2_available())
+	{
+		uint8_t c = mcu_uart2_getc();
+		if (modbus_rx_len < MODBUS_FRAME_MAX_LEN)
+		{
+			modbus_rx[modbus_rx_len++] = c;
+		}
+		modbus_last_rx = mcu_millis();
+	}
+#endif
+}
+
+// removes the transaction from the queue and calls the callback
+static void modbus_finish(uint8_t status)
+{
+	modbus_transaction_t transaction;
+	modbus_response_t response;
+	uint8_t len = 0;
+
+	memcpy(&transaction, &modbus_queue[modbus_head], sizeof(modbus_transaction_t));
+	uint32_t latency = mcu_millis() - modbus_submitted[modbus_head];
+	memset(&response, 0, sizeof(modbus_response_t));
+	if (status == MODBUS_OK || status == MODBUS_ERROR_EXCEPTION)
+	{
+		len = modbus_rx_len;
+		response.address = modbus_rx[0];
+		response.fcode = modbus_rx[1];
+		memcpy(response.data, &modbus_rx[2], len - 4);
+		response.crc = modbus_rx[len - 2] | ((uint16_t)modbus_rx[len - 1] << 8);
+	}
+
+	if (status == MODBUS_OK)
+	{
+		modbus_stats.completed++;
+	}
+	else
+	{
+		modbus_stats.failed++;
+	}
+	if (latency > modbus_stats.max_latency)
+	{
+		modbus_stats.max_latency = (uint16_t)MIN(latency, UINT16_MAX);
+	}
+
+	modbus_head++;
+	if (modbus_head >= MODBUS_QUEUE_SIZE)
+	{
+		modbus_head = 0;
+	}
+	modbus_count--;
+	modbus_state = MODBUS_STATE_WAIT;
+	modbus_attempt = 0;
+	if (modbus_count)
+	{
+		modbus_time = mcu_millis() + modbus_queue[modbus_head].delay;
+	}
+
+	// the callback can submit new transactions
+	if (transaction.callback)
+	{
+		transaction.callback(&transaction, status, &response, len);
+	}
+}
+
+static void modbus_retry_or_fail(uint8_t status)
+{
+	modbus_transaction_t *transaction = &modbus_queue[modbus_head];
+	if (++modbus_attempt < transaction->retries)
+	{
+		modbus_stats.retries++;
+		modbus_state = MODBUS_STATE_WAIT;
+		modbus_time = mcu_millis() + transaction->retry_delay;
+		return;
+	}
+
+	modbus_finish(status);
+}
+
+void modbus_abort(void)
+{
+	if (modbus_running)
+	{
+		return;
+	}
+
+	modbus_running = true;
+	while (modbus_count)
+	{
+		modbus_finish(MODBUS_ERROR_ABORTED);
+	}
+	modbus_running = false;
+}
+
+void modbus_task(void)
+{
+	// the callbacks may call cnc_delay_ms that runs cnc_io_dotasks
+	if (modbus_running || !modbus_count)
+	{
+		return;
+	}
+
+	modbus_running = true;
+	modbus_transaction_t *transaction = &modbus_queue[modbus_head];
+	switch (modbus_state)
+	{
+	case MODBUS_STATE_WAIT:
+		if ((int32_t)(mcu_millis() - modbus_time) < 0)
+		{
+			break;
+		}
+		modbus_send(transaction);
+		modbus_stats.sent++;
+		modbus_time = mcu_millis();
+		modbus_last_rx = modbus_time;
+		modbus_state = MODBUS_STATE_RECEIVE;
+		// softuart ports are read now
+		if (!transaction->port)
+		{
+			break;
+		}
+		__FALL_THROUGH__
+	case MODBUS_STATE_RECEIVE:
+		modbus_receive(transaction);
+		uint8_t len = modbus_response_len(transaction);
+		uint32_t now = mcu_millis();
+		if (modbus_rx_len && ((len && modbus_rx_len >= len) || (!len && (now - modbus_last_rx) >= MODBUS_FRAME_GAP_MS)))
+		{
+			if (len)
+			{
+				modbus_rx_len = len;
+			}
+			if (modbus_rx_len < 4 || modbus_rx_len > MODBUS_FRAME_MAX_LEN || crc16(modbus_rx, modbus_rx_len - 2) != (modbus_rx[modbus_rx_len - 2] | ((uint16_t)modbus_rx[modbus_rx_len - 1] << 8)))
+			{
+				modbus_retry_or_fail(MODBUS_ERROR_CRC);
+			}
+			else
+			{
+				modbus_finish((modbus_rx[1] & 0x80) ? MODBUS_ERROR_EXCEPTION : MODBUS_OK);
+			}
+		}
+		else if ((now - modbus_time) >= transaction->timeout)
+		{
+			modbus_retry_or_fail(MODBUS_ERROR_TIMEOUT);
+		}
+		break;
+	}
+	modbus_running = false;
+}
+#endif
@@ -64,6 +64,69 @@ extern "C"
 	void send_request(modbus_request_t request, uint8_t len, softuart_port_t *port);
 	bool read_response(modbus_response_t *response, uint8_t len, softuart_port_t *port, uint32_t ms_timeout);
 
+#ifdef ENABLE_MODBUS_ASYNC
+/**
+ * Asynchronous Modbus RTU master
+ * Transactions are queued and run by a state machine from the main loop (cnc_io_dotasks) so the
+ * caller never waits for the slave. The result is delivered to the transaction callback.
+ * With the hardware UART2 transport (port NULL, needs DETACH_UART2_FROM_MAIN_PROTOCOL) nothing blocks.
+ * With a softuart port the frame is bit-banged and the response is read inside the task (up to the timeout)
+ * since the pins can't be sampled in the background, but the retries and delays still don't block.
+ * */
+#ifndef MODBUS_QUEUE_SIZE
+#define MODBUS_QUEUE_SIZE 4
+#endif
+
+// transaction status
+#define MODBUS_OK 0
+#define MODBUS_ERROR_TIMEOUT 1
+#define MODBUS_ERROR_CRC 2
+#define MODBUS_ERROR_EXCEPTION 3
+#define MODBUS_ERROR_ABORTED 4
+
+	typedef struct modbus_transaction_ modbus_transaction_t;
+	// response is only valid if status is MODBUS_OK or MODBUS_ERROR_EXCEPTION (len is the frame length with the CRC)
+	typedef void (*modbus_callback_t)(modbus_transaction_t *transaction, uint8_t status, modbus_response_t *response, uint8_t len);
+
+	struct modbus_transaction_
+	{
+		modbus_request_t request;
+		// frame lengths with the CRC (0 for the standard length of the function code)
+		uint8_t tx_len;
+		uint8_t rx_len;
+		// number of attempts (0 is the same as 1)
+		uint8_t retries;
+		// response timeout, delay between retries and delay before the first attempt (ms)
+		uint16_t timeout;
+		uint16_t retry_delay;
+		uint16_t delay;
+		// softuart port or NULL for the hardware UART2
+		softuart_port_t *port;
+		modbus_callback_t callback;
+		void *user;
+	};
+
+	typedef struct modbus_stats_
+	{
+		uint16_t sent;
+		uint16_t completed;
+		uint16_t retries;
+		uint16_t failed;
+		uint16_t dropped;
+		uint16_t max_latency; // ms from submit to completion
+	} modbus_stats_t;
+
+	// queues a copy of the transaction (returns false if the queue is full)
+	bool modbus_submit(modbus_transaction_t *transaction);
+	// number of queued transactions (including the one running)
+	uint8_t modbus_pending(void);
+	// aborts all transactions (the callbacks are called with MODBUS_ERROR_ABORTED)
+	void modbus_abort(void);
+	void modbus_get_stats(modbus_stats_t *stats);
+	// runs the state machine (called from cnc_io_dotasks)
+	void modbus_task(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
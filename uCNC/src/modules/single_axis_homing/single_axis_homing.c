@@ -114,42 +114,42 @@ bool single_axis_homing_system_cmd(void *args)
 	strupr((char *)ptr->cmd);
 
 #if AXIS_X_HOMING_MASK != 0
-	if (!strcmp((char *)ptr->cmd, "HX"))
+	if (ptr->id == GRBL_CMD_HX)
 	{
 		*(ptr->error) = single_axis_homing_motion(AXIS_X, AXIS_X_HOMING_MASK, LINACT0_LIMIT_MASK);
 		return EVENT_HANDLED;
 	}
 #endif
 #if AXIS_Y_HOMING_MASK != 0
-	if (!strcmp((char *)ptr->cmd, "HY"))
+	if (ptr->id == GRBL_CMD_HY)
 	{
 		*(ptr->error) = single_axis_homing_motion(AXIS_Y, AXIS_Y_HOMING_MASK, LINACT1_LIMIT_MASK);
 		return EVENT_HANDLED;
 	}
 #endif
 #if AXIS_Z_HOMING_MASK != 0
-	if (!strcmp((char *)ptr->cmd, "HZ"))
+	if (ptr->id == GRBL_CMD_HZ)
 	{
 		*(ptr->error) = single_axis_homing_motion(AXIS_Z, AXIS_Z_HOMING_MASK, LINACT2_LIMIT_MASK);
 		return EVENT_HANDLED;
 	}
 #endif
 #if AXIS_A_HOMING_MASK != 0
-	if (!strcmp((char *)ptr->cmd, "HA"))
+	if (ptr->id == GRBL_CMD_HA)
 	{
 		*(ptr->error) = single_axis_homing_motion(AXIS_A, AXIS_A_HOMING_MASK, LINACT3_LIMIT_MASK);
 		return EVENT_HANDLED;
 	}
 #endif
 #if AXIS_B_HOMING_MASK != 0
-	if (!strcmp((char *)ptr->cmd, "HB"))
+	if (ptr->id == GRBL_CMD_HB)
 	{
 		*(ptr->error) = single_axis_homing_motion(AXIS_B, AXIS_B_HOMING_MASK, LINACT4_LIMIT_MASK);
 		return EVENT_HANDLED;
 	}
 #endif
 #if AXIS_C_HOMING_MASK != 0
-	if (!strcmp((char *)ptr->cmd, "HC"))
+	if (ptr->id == GRBL_CMD_HC)
 	{
 		*(ptr->error) = single_axis_homing_motion(AXIS_C, AXIS_C_HOMING_MASK, LINACT5_LIMIT_MASK);
 		return EVENT_HANDLED;
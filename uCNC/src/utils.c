@@ -18,12 +18,12 @@
 
 #include "cnc.h"
 
-uint8_t buffer_write_available(ring_buffer_t *buffer)
+buffer_index_t buffer_write_available(ring_buffer_t *buffer)
 {
 	return (buffer->size - buffer->count);
 }
 
-uint8_t buffer_read_available(ring_buffer_t *buffer)
+buffer_index_t buffer_read_available(ring_buffer_t *buffer)
 {
 	return buffer->count;
 }
@@ -52,7 +52,7 @@ void buffer_dequeue(ring_buffer_t *buffer, void *ptr)
 {
 	if (!buffer_empty(buffer))
 	{
-		uint8_t tail;
+		buffer_index_t tail;
 		__ATOMIC__
 		{
 			tail = buffer->tail;
@@ -73,7 +73,7 @@ void buffer_enqueue(ring_buffer_t *buffer, void *ptr)
 {
 	if (!buffer_full(buffer))
 	{
-		uint8_t head;
+		buffer_index_t head;
 		__ATOMIC__
 		{
 			head = buffer->head;
@@ -89,9 +89,10 @@ void buffer_enqueue(ring_buffer_t *buffer, void *ptr)
 	}
 }
 
-void buffer_write(ring_buffer_t *buffer, void *ptr, uint8_t len, uint8_t *written)
+void buffer_write(ring_buffer_t *buffer, void *ptr, buffer_index_t len, buffer_index_t *written)
 {
-	uint8_t count, head, *p = (uint8_t *)ptr;
+	buffer_index_t count, head;
+	uint8_t *p = (uint8_t *)ptr;
 	__ATOMIC__
 	{
 		head = buffer->head;
@@ -100,7 +101,7 @@ void buffer_write(ring_buffer_t *buffer, void *ptr, uint8_t len, uint8_t *writte
 		*written = 0;
 		if (count)
 		{
-			uint8_t avail = (buffer->size - head);
+			buffer_index_t avail = (buffer->size - head);
 			if (avail < count && avail)
 			{
 				memcpy(&buffer->data[head * buffer->elem_size], ptr, avail * buffer->elem_size);
@@ -128,9 +129,10 @@ void buffer_write(ring_buffer_t *buffer, void *ptr, uint8_t len, uint8_t *writte
 	}
 }
 
-void buffer_read(ring_buffer_t *buffer, void *ptr, uint8_t len, uint8_t *read)
+void buffer_read(ring_buffer_t *buffer, void *ptr, buffer_index_t len, buffer_index_t *read)
 {
-	uint8_t count, tail, *p = (uint8_t *)ptr;
+	buffer_index_t count, tail;
+	uint8_t *p = (uint8_t *)ptr;
 	__ATOMIC__
 	{
 		tail = buffer->tail;
@@ -142,7 +144,7 @@ void buffer_read(ring_buffer_t *buffer, void *ptr, uint8_t len, uint8_t *read)
 		*read = 0;
 		if (count)
 		{
-			uint8_t avail = buffer->size - tail;
+			buffer_index_t avail = buffer->size - tail;
 			if (avail < count && avail)
 			{
 				memcpy(ptr, &buffer->data[tail * buffer->elem_size], avail * buffer->elem_size);
@@ -170,6 +172,43 @@ void buffer_read(ring_buffer_t *buffer, void *ptr, uint8_t len, uint8_t *read)
 	}
 }
 
+// reads up to len chars stopping after the first end of line char ('\n', '\r' or 0)
+// the chars are copied without blocking the ISR (only the producer can change the buffer meanwhile)
+void buffer_read_line(ring_buffer_t *buffer, uint8_t *ptr, buffer_index_t len, buffer_index_t *read)
+{
+	buffer_index_t count, tail, n = 0;
+	__ATOMIC__
+	{
+		tail = buffer->tail;
+		count = buffer->count;
+	}
+
+	count = MIN(count, len);
+	while (n < count)
+	{
+		uint8_t c = buffer->data[tail];
+		ptr[n++] = c;
+		if (++tail == buffer->size)
+		{
+			tail = 0;
+		}
+		if (c == '\n' || c == '\r' || !c)
+		{
+			break;
+		}
+	}
+
+	if (n)
+	{
+		__ATOMIC__
+		{
+			buffer->tail = tail;
+			buffer->count -= n;
+		}
+	}
+	*read = n;
+}
+
 void buffer_clear(ring_buffer_t *buffer)
 {
 	__ATOMIC__
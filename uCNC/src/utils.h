@@ -234,6 +234,30 @@ extern "C"
 #endif
 #ifndef __ATOMIC_FORCEON__
 #define __ATOMIC_FORCEON__ for (uint8_t __restore_atomic__ __attribute__((__cleanup__(__atomic_out_on))) = 1, __AtomLock = __atomic_in(); __AtomLock; __AtomLock = 0)
+#endif
+
+	/**
+	 * MULTICORE ATOMIC UTILS
+	 * __ATOMIC__ only masks the interrupts of the core that runs it.
+	 * Data shared by two cores (ENABLE_DUAL_CORE_MOTION) is accessed with these (GCC atomic builtins, the MCU can override them).
+	 * **/
+#ifndef ATOMIC_LOAD_ACQUIRE
+#define ATOMIC_LOAD_ACQUIRE(var) __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#endif
+#ifndef ATOMIC_STORE_RELEASE
+#define ATOMIC_STORE_RELEASE(var, value) __atomic_store_n(&(var), (value), __ATOMIC_RELEASE)
+#endif
+#ifndef ATOMIC_FENCE
+#define ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+#ifndef ATOMIC_EXCHANGE
+#define ATOMIC_EXCHANGE(var, value) __atomic_exchange_n(&(var), (value), __ATOMIC_ACQ_REL)
+#endif
+#ifndef ATOMIC_FETCH_OR
+#define ATOMIC_FETCH_OR(var, mask) __atomic_fetch_or(&(var), (mask), __ATOMIC_SEQ_CST)
+#endif
+#ifndef ATOMIC_FETCH_AND
+#define ATOMIC_FETCH_AND(var, mask) __atomic_fetch_and(&(var), (mask), __ATOMIC_SEQ_CST)
 #endif
 
 #ifndef DECL_MUTEX
@@ -286,11 +310,11 @@ extern "C"
 
 	typedef struct ring_buffer_
 	{
-		volatile uint8_t count;
-		volatile uint8_t head;
-		volatile uint8_t tail;
+		volatile buffer_index_t count;
+		volatile buffer_index_t head;
+		volatile buffer_index_t tail;
 		uint8_t *data;
-		const uint8_t size;
+		const buffer_index_t size;
 		const uint8_t elem_size;
 	} ring_buffer_t;
 
@@ -300,15 +324,16 @@ extern "C"
 	static type name##_bufferdata[size]; \
 	ring_buffer_t name = {0, 0, 0, name##_bufferdata, size, sizeof(type)}
 
-	uint8_t buffer_write_available(ring_buffer_t *buffer);
-	uint8_t buffer_read_available(ring_buffer_t *buffer);
+	buffer_index_t buffer_write_available(ring_buffer_t *buffer);
+	buffer_index_t buffer_read_available(ring_buffer_t *buffer);
 	bool buffer_empty(ring_buffer_t *buffer);
 	bool buffer_full(ring_buffer_t *buffer);
 	void buffer_peek(ring_buffer_t *buffer, void *ptr);
 	void buffer_dequeue(ring_buffer_t *buffer, void *ptr);
 	void buffer_enqueue(ring_buffer_t *buffer, void *ptr);
-	void buffer_write(ring_buffer_t *buffer, void *ptr, uint8_t len, uint8_t *written);
-	void buffer_read(ring_buffer_t *buffer, void *ptr, uint8_t len, uint8_t *read);
+	void buffer_write(ring_buffer_t *buffer, void *ptr, buffer_index_t len, buffer_index_t *written);
+	void buffer_read(ring_buffer_t *buffer, void *ptr, buffer_index_t len, buffer_index_t *read);
+	void buffer_read_line(ring_buffer_t *buffer, uint8_t *ptr, buffer_index_t len, buffer_index_t *read);
 	void buffer_clear(ring_buffer_t *buffer);
 
 #define BUFFER_INIT(type, buffer, size)
@@ -321,12 +346,13 @@ extern "C"
 #define BUFFER_ENQUEUE(buffer, ptr) buffer_enqueue(&buffer, ptr)
 #define BUFFER_WRITE(buffer, ptr, len, written) buffer_write(&buffer, ptr, len, &written)
 #define BUFFER_READ(buffer, ptr, len, read) buffer_read(&buffer, ptr, len, &read)
+#define BUFFER_READ_LINE(buffer, ptr, len, read) buffer_read_line(&buffer, ptr, len, &read)
 #define BUFFER_CLEAR(buffer) buffer_clear(&buffer)
 #endif
 #else
 #define DECL_BUFFER(type, name, size)      \
 	static type name##_bufferdata[size];     \
-	static const uint8_t name##_size = size; \
+	static const buffer_index_t name##_size = size; \
 	ring_buffer_t name
 
 #define BUFFER_INIT(type, buffer, size)
@@ -340,7 +366,7 @@ extern "C"
 	{                                                                            \
 		if (!BUFFER_EMPTY(buffer))                                                 \
 		{                                                                          \
-			uint8_t tail;                                                            \
+			buffer_index_t tail;                                                     \
 			__ATOMIC__                                                               \
 			{                                                                        \
 				tail = buffer.tail;                                                    \
@@ -363,7 +389,7 @@ extern "C"
 	{                                                                            \
 		if (!BUFFER_FULL(buffer))                                                  \
 		{                                                                          \
-			uint8_t head;                                                            \
+			buffer_index_t head;                                                     \
 			__ATOMIC__                                                               \
 			{                                                                        \
 				head = buffer.head;                                                    \
@@ -383,7 +409,7 @@ extern "C"
 	}
 
 #define BUFFER_WRITE(buffer, ptr, len, written) ({                                             \
-	uint8_t count, head;                                                                         \
+	buffer_index_t count, head;                                                                  \
 	__ATOMIC__                                                                                   \
 	{                                                                                            \
 		head = buffer.head;                                                                        \
@@ -393,7 +419,7 @@ extern "C"
 	written = 0;                                                                                 \
 	if (count)                                                                                   \
 	{                                                                                            \
-		uint8_t avail = (buffer##_size - head);                                                    \
+		buffer_index_t avail = (buffer##_size - head);                                             \
 		if (avail < count && avail)                                                                \
 		{                                                                                          \
 			memcpy(&buffer##_bufferdata[head], ptr, avail * sizeof(buffer##_bufferdata[0]));         \
@@ -424,7 +450,7 @@ extern "C"
 })
 
 #define BUFFER_READ(buffer, ptr, len, read) ({                                                 \
-	uint8_t count, tail;                                                                         \
+	buffer_index_t count, tail;                                                                  \
 	__ATOMIC__                                                                                   \
 	{                                                                                            \
 		tail = buffer.tail;                                                                        \
@@ -437,7 +463,7 @@ extern "C"
 	read = 0;                                                                                    \
 	if (count)                                                                                   \
 	{                                                                                            \
-		uint8_t avail = buffer##_size - tail;                                                      \
+		buffer_index_t avail = buffer##_size - tail;                                               \
 		if (avail < count && avail)                                                                \
 		{                                                                                          \
 			memcpy(ptr, &buffer##_bufferdata[tail], avail * sizeof(buffer##_bufferdata[0]));         \
@@ -478,6 +504,23 @@ extern "C"
 	}
 #endif
 
+#ifndef BUFFER_READ_LINE
+// reads up to len chars stopping after the first end of line char ('\n', '\r' or 0)
+#define BUFFER_READ_LINE(buffer, ptr, len, read) ({ \
+	read = 0;                                         \
+	while (read < len && !BUFFER_EMPTY(buffer))       \
+	{                                                 \
+		uint8_t __c;                                    \
+		BUFFER_DEQUEUE(buffer, &__c);                   \
+		ptr[read++] = __c;                              \
+		if (__c == '\n' || __c == '\r' || !__c)          \
+		{                                               \
+			break;                                        \
+		}                                               \
+	}                                                 \
+})
+#endif
+
 #if defined(__GNUC__) && __GNUC__ >= 7
 #define __FALL_THROUGH__ __attribute__((fallthrough));
 #else